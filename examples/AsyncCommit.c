@@ -0,0 +1,193 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Demonstrates asynchronous transaction commits using the patcher thread.
+ *
+ * The example exits with a non-zero status, if a transaction fails or any of the calls does not
+ * end up in the expected function.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/Patcher.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+/* ============================================================================================== */
+/* Target function                                                                                */
+/* ============================================================================================== */
+
+typedef ZyanU32 (FnHookType)(ZyanU32 param);
+
+ZyanU32 ZYAN_NOINLINE FnHookTarget(ZyanU32 param)
+{
+    puts("  hello from original");
+
+    return param;
+}
+
+/* ============================================================================================== */
+/* Hook callback                                                                                  */
+/* ============================================================================================== */
+
+static FnHookType* volatile FnHookOriginal = ZYAN_NULL;
+
+ZyanU32 ZYAN_NOINLINE FnHookCallback(ZyanU32 param)
+{
+    puts("  hello from callback");
+
+    return (*FnHookOriginal)(param) + 1;
+}
+
+/* ============================================================================================== */
+/* Helper functions                                                                               */
+/* ============================================================================================== */
+
+static void OnCompletion(ZyrexTransaction* transaction, ZyanStatus status,
+    const void* failed_operation, void* context)
+{
+    ZYAN_UNUSED(transaction);
+
+    // Invoked on the patcher thread
+    printf("  %s applied: 0x%08X (failed operation: %p)\n", (const char*)context,
+        (unsigned)status, failed_operation);
+}
+
+/**
+ * @brief   Queues the given transaction and waits for the patcher thread to apply it.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   name        The name of the transaction.
+ *
+ * @return  The status code of the commit or a generic zyan status code.
+ */
+static ZyanStatus ApplyAsync(ZyrexTransaction* transaction, const char* name)
+{
+    ZYAN_CHECK(ZyrexTransactionUpdateAllThreads(transaction));
+
+    ZyrexCompletion* completion;
+    ZYAN_CHECK(ZyrexTransactionApplyAsync(transaction, &OnCompletion, (void*)name, &completion));
+
+    // The calling thread is free to continue until the result is needed
+    ZyanUSize polls = 0;
+    while (ZyrexCompletionPoll(completion) == ZYAN_STATUS_FALSE)
+    {
+        if (++polls == 1000)
+        {
+            break;
+        }
+    }
+
+    // The failed operation was already reported by the completion callback
+    const ZyanStatus status = ZyrexCompletionWait(completion, ZYAN_NULL);
+    ZYAN_CHECK(ZyrexCompletionDestroy(completion));
+
+    return status;
+}
+
+/**
+ * @brief   Calls the target function and compares the result.
+ *
+ * @param   expected    The expected result.
+ *
+ * @return  `ZYAN_TRUE`, if the result matches or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool Expect(ZyanU32 expected)
+{
+    const ZyanU32 result = FnHookTarget(0x1337);
+    printf("  result: %x\n", result);
+    if (result != expected)
+    {
+        printf("  expected %x\n", expected);
+        return ZYAN_FALSE;
+    }
+
+    return ZYAN_TRUE;
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    ZyrexTransaction* transaction;
+    if (!ZYAN_SUCCESS(ZyrexTransactionCreate(&transaction)))
+    {
+        puts("Failed to create the transaction");
+        return EXIT_FAILURE;
+    }
+
+    puts("install:");
+    ZyanStatus status = ZyrexTransactionInstallInlineHook(transaction,
+        (void*)(ZyanUPointer)&FnHookTarget, (const void*)(ZyanUPointer)&FnHookCallback,
+        (ZyanConstVoidPointer*)&FnHookOriginal);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ApplyAsync(transaction, "install");
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to install the hook: 0x%08X\n", (unsigned)status);
+        ZyrexTransactionDestroy(transaction);
+        return EXIT_FAILURE;
+    }
+
+    ZyanBool is_correct = Expect(0x1338);
+
+    // The transaction object is empty after it was applied and can be reused
+    puts("remove:");
+    status = ZyrexTransactionRemoveInlineHook(transaction,
+        (ZyanConstVoidPointer*)&FnHookOriginal);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ApplyAsync(transaction, "remove");
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to remove the hook: 0x%08X\n", (unsigned)status);
+        ZyrexTransactionDestroy(transaction);
+        return EXIT_FAILURE;
+    }
+
+    is_correct &= Expect(0x1337);
+
+    ZyrexTransactionDestroy(transaction);
+    ZyrexShutdown();
+
+    return is_correct ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,288 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Compares the installation of a large number of inline hooks one by one to the batch
+ *          installation.
+ *
+ * Every benchmark is executed with the targets in corpus order and in random order. The batch
+ * installation sorts the targets by address, which makes it independent of the input order. The
+ * batch installation is additionally executed with a single worker thread to show how the
+ * prologue analysis and relocation scale with the number of processors.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/HookRegistry.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+#define BENCHMARK_ENABLE_CORPUS
+#include "Benchmark.h"
+
+/* ============================================================================================== */
+/* Helper functions                                                                               */
+/* ============================================================================================== */
+
+/**
+ * @brief   Checks, if all corpus functions are redirected to the callback.
+ *
+ * @return  `ZYAN_TRUE`, if all corpus functions are hooked or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool IsCorpusHooked(void)
+{
+    for (ZyanUSize i = 0; i < BENCHMARK_CORPUS_SIZE; ++i)
+    {
+        if (g_corpus[i]((ZyanU32)i) != CorpusCallback((ZyanU32)i))
+        {
+            return ZYAN_FALSE;
+        }
+    }
+
+    return ZYAN_TRUE;
+}
+
+/**
+ * @brief   Shuffles the given array of hook specifications.
+ *
+ * @param   specs   An array of hook specifications.
+ * @param   count   The number of elements in the `specs` array.
+ *
+ * A fixed seed is used to make the results reproducible.
+ */
+static void ShuffleSpecs(ZyrexHookSpec* specs, ZyanUSize count)
+{
+    ZyanU32 seed = 0x7A726578;
+    for (ZyanUSize i = count - 1; i > 0; --i)
+    {
+        seed = seed * 1103515245 + 12345;
+        const ZyanUSize j = (seed >> 8) % (i + 1);
+        const ZyrexHookSpec temp = specs[i];
+        specs[i] = specs[j];
+        specs[j] = temp;
+    }
+}
+
+/**
+ * @brief   Prints the result of a single benchmark run and removes all hooks.
+ *
+ * @param   name            The name of the benchmark run.
+ * @param   install_time    The time spent in the hook installation functions (in nanoseconds).
+ * @param   commit_time     The time spent in `ZyrexTransactionCommit` (in nanoseconds).
+ * @param   total_time      Receives the sum of `install_time` and `commit_time`.
+ *
+ * @return  `ZYAN_STATUS_FAILED`, if not all corpus functions were hooked, or a zyan status code.
+ */
+static ZyanStatus FinishRun(const char* name, ZyanU64 install_time, ZyanU64 commit_time,
+    ZyanU64* total_time)
+{
+    const ZyanBool is_hooked = IsCorpusHooked();
+    printf("%-20s install: %8.2f ms, commit: %8.2f ms, hooked: %s\n", name,
+        (double)install_time / 1000000, (double)commit_time / 1000000, is_hooked ? "yes" : "no");
+    *total_time = install_time + commit_time;
+
+    ZYAN_CHECK(ZyrexRemoveAllHooks());
+
+    return is_hooked ? ZYAN_STATUS_SUCCESS : ZYAN_STATUS_FAILED;
+}
+
+/**
+ * @brief   Prints the ratio between the shuffled and the sorted run of a benchmark.
+ *
+ * @param   name        The name of the benchmark.
+ * @param   sorted      The total time of the sorted run (in nanoseconds).
+ * @param   shuffled    The total time of the shuffled run (in nanoseconds).
+ */
+static void PrintOrderRatio(const char* name, ZyanU64 sorted, ZyanU64 shuffled)
+{
+    printf("%-20s shuffled / sorted: %.2fx\n", name,
+        sorted ? (double)shuffled / (double)sorted : 0.0);
+}
+
+/* ============================================================================================== */
+/* Benchmarks                                                                                     */
+/* ============================================================================================== */
+
+/**
+ * @brief   Installs a hook for every corpus function by calling `ZyrexInstallInlineHook` in a
+ *          loop.
+ *
+ * @param   name    The name of the benchmark run.
+ * @param   specs   An array of hook specifications for all corpus functions.
+ * @param   time    Receives the total time of the run (in nanoseconds).
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus BenchmarkLoop(const char* name, const ZyrexHookSpec* specs, ZyanU64* time)
+{
+    ZYAN_CHECK(ZyrexTransactionBegin());
+
+    const ZyanU64 install_begin = BenchmarkGetTimestamp();
+    for (ZyanUSize i = 0; i < BENCHMARK_CORPUS_SIZE; ++i)
+    {
+        const ZyanStatus status = ZyrexInstallInlineHook(specs[i].address, specs[i].callback,
+            specs[i].trampoline);
+        if (!ZYAN_SUCCESS(status))
+        {
+            ZyrexTransactionAbort();
+            return status;
+        }
+    }
+    const ZyanU64 install_end = BenchmarkGetTimestamp();
+
+    ZYAN_CHECK(ZyrexUpdateAllThreads());
+    ZYAN_CHECK(ZyrexTransactionCommit());
+    const ZyanU64 commit_end = BenchmarkGetTimestamp();
+
+    return FinishRun(name, install_end - install_begin, commit_end - install_end, time);
+}
+
+/**
+ * @brief   Installs a hook for every corpus function by calling `ZyrexInstallInlineHooks` once.
+ *
+ * @param   name    The name of the benchmark run.
+ * @param   specs   An array of hook specifications for all corpus functions.
+ * @param   results An array that receives the individual status codes.
+ * @param   time    Receives the total time of the run (in nanoseconds).
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus BenchmarkBatch(const char* name, const ZyrexHookSpec* specs,
+    ZyanStatus* results, ZyanU64* time)
+{
+    ZYAN_CHECK(ZyrexTransactionBegin());
+
+    const ZyanU64 install_begin = BenchmarkGetTimestamp();
+    const ZyanStatus status = ZyrexInstallInlineHooks(specs, BENCHMARK_CORPUS_SIZE, results);
+    const ZyanU64 install_end = BenchmarkGetTimestamp();
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        return status;
+    }
+    for (ZyanUSize i = 0; i < BENCHMARK_CORPUS_SIZE; ++i)
+    {
+        if (!ZYAN_SUCCESS(results[i]))
+        {
+            printf("Failed to hook %p: 0x%08X\n", specs[i].address, (unsigned)results[i]);
+        }
+    }
+
+    ZYAN_CHECK(ZyrexUpdateAllThreads());
+    ZYAN_CHECK(ZyrexTransactionCommit());
+    const ZyanU64 commit_end = BenchmarkGetTimestamp();
+
+    return FinishRun(name, install_end - install_begin, commit_end - install_end, time);
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    ZyanConstVoidPointer* const trampolines =
+        malloc(BENCHMARK_CORPUS_SIZE * sizeof(ZyanConstVoidPointer));
+    ZyrexHookSpec* const specs = malloc(BENCHMARK_CORPUS_SIZE * sizeof(ZyrexHookSpec));
+    ZyrexHookSpec* const shuffled_specs = malloc(BENCHMARK_CORPUS_SIZE * sizeof(ZyrexHookSpec));
+    ZyanStatus* const results = malloc(BENCHMARK_CORPUS_SIZE * sizeof(ZyanStatus));
+    if (!trampolines || !specs || !shuffled_specs || !results)
+    {
+        puts("Failed to allocate memory");
+        return EXIT_FAILURE;
+    }
+    for (ZyanUSize i = 0; i < BENCHMARK_CORPUS_SIZE; ++i)
+    {
+        specs[i].address = (void*)(ZyanUPointer)g_corpus[i];
+        specs[i].callback = (const void*)(ZyanUPointer)&CorpusCallback;
+        specs[i].trampoline = &trampolines[i];
+        specs[i].patch_size = 0;
+        specs[i].flags = ZYREX_INLINE_HOOK_FLAG_NONE;
+        shuffled_specs[i] = specs[i];
+    }
+    ShuffleSpecs(shuffled_specs, BENCHMARK_CORPUS_SIZE);
+
+    printf("Hooking %u functions\n\n", (unsigned)BENCHMARK_CORPUS_SIZE);
+
+    ZyanU64 loop_sorted = 0;
+    ZyanU64 loop_shuffled = 0;
+    ZyanU64 batch_sorted = 0;
+    ZyanU64 batch_shuffled = 0;
+    ZyanU64 batch_single = 0;
+    ZyanStatus status = BenchmarkLoop("loop (sorted)", specs, &loop_sorted);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = BenchmarkLoop("loop (shuffled)", shuffled_specs, &loop_shuffled);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = BenchmarkBatch("batch (sorted)", specs, results, &batch_sorted);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = BenchmarkBatch("batch (shuffled)", shuffled_specs, results, &batch_shuffled);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        ZyrexSetBatchWorkerCount(1);
+        status = BenchmarkBatch("batch (1 worker)", specs, results, &batch_single);
+        ZyrexSetBatchWorkerCount(0);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        puts("");
+        PrintOrderRatio("loop", loop_sorted, loop_shuffled);
+        PrintOrderRatio("batch", batch_sorted, batch_shuffled);
+        printf("%-20s 1 worker / default: %.2fx\n", "batch",
+            batch_sorted ? (double)batch_single / (double)batch_sorted : 0.0);
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Benchmark failed: 0x%08X\n", (unsigned)status);
+    }
+
+    free(results);
+    free(shuffled_specs);
+    free(specs);
+    free(trampolines);
+    ZyrexShutdown();
+
+    return ZYAN_SUCCESS(status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,152 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Shared helpers for the benchmark examples.
+ *
+ * This header defines a monotonic timestamp function and, if `BENCHMARK_ENABLE_CORPUS` is
+ * defined, a corpus of `BENCHMARK_CORPUS_SIZE` distinct hook targets. It must only be included by
+ * a single translation unit.
+ */
+
+#ifndef ZYREX_EXAMPLES_BENCHMARK_H
+#define ZYREX_EXAMPLES_BENCHMARK_H
+
+#include <Zycore/Defines.h>
+#include <Zycore/Types.h>
+
+#if defined(ZYAN_WINDOWS)
+#   include <windows.h>
+#else
+#   include <time.h>
+#endif
+
+#if defined(BENCHMARK_ENABLE_CORPUS)
+
+/* ============================================================================================== */
+/* Corpus                                                                                         */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the number of functions in the benchmark corpus.
+ */
+#define BENCHMARK_CORPUS_SIZE 10000
+
+/**
+ * @brief   Invokes the macro `m` for 10, 100, 1000 or 10000 consecutive names with the prefix `p`.
+ */
+#define BENCHMARK_REPEAT_10(m, p) \
+    m(p##0) m(p##1) m(p##2) m(p##3) m(p##4) m(p##5) m(p##6) m(p##7) m(p##8) m(p##9)
+#define BENCHMARK_REPEAT_100(m, p) \
+    BENCHMARK_REPEAT_10(m, p##0) BENCHMARK_REPEAT_10(m, p##1) BENCHMARK_REPEAT_10(m, p##2) \
+    BENCHMARK_REPEAT_10(m, p##3) BENCHMARK_REPEAT_10(m, p##4) BENCHMARK_REPEAT_10(m, p##5) \
+    BENCHMARK_REPEAT_10(m, p##6) BENCHMARK_REPEAT_10(m, p##7) BENCHMARK_REPEAT_10(m, p##8) \
+    BENCHMARK_REPEAT_10(m, p##9)
+#define BENCHMARK_REPEAT_1000(m, p) \
+    BENCHMARK_REPEAT_100(m, p##0) BENCHMARK_REPEAT_100(m, p##1) BENCHMARK_REPEAT_100(m, p##2) \
+    BENCHMARK_REPEAT_100(m, p##3) BENCHMARK_REPEAT_100(m, p##4) BENCHMARK_REPEAT_100(m, p##5) \
+    BENCHMARK_REPEAT_100(m, p##6) BENCHMARK_REPEAT_100(m, p##7) BENCHMARK_REPEAT_100(m, p##8) \
+    BENCHMARK_REPEAT_100(m, p##9)
+#define BENCHMARK_REPEAT_10000(m, p) \
+    BENCHMARK_REPEAT_1000(m, p##0) BENCHMARK_REPEAT_1000(m, p##1) \
+    BENCHMARK_REPEAT_1000(m, p##2) BENCHMARK_REPEAT_1000(m, p##3) \
+    BENCHMARK_REPEAT_1000(m, p##4) BENCHMARK_REPEAT_1000(m, p##5) \
+    BENCHMARK_REPEAT_1000(m, p##6) BENCHMARK_REPEAT_1000(m, p##7) \
+    BENCHMARK_REPEAT_1000(m, p##8) BENCHMARK_REPEAT_1000(m, p##9)
+
+/**
+ * @brief   Defines a single corpus function.
+ *
+ * Every function references its own string literal, which prevents the linker from folding
+ * identical function bodies.
+ */
+#define BENCHMARK_DEFINE_FUNCTION(n) \
+    static ZyanU32 ZYAN_NOINLINE CorpusFunction##n(ZyanU32 value) \
+    { \
+        return value * 31 + (ZyanU32)(ZyanUPointer)#n; \
+    }
+
+/**
+ * @brief   Defines a single entry of the corpus table.
+ */
+#define BENCHMARK_DEFINE_ENTRY(n) &CorpusFunction##n,
+
+typedef ZyanU32 (CorpusFunction)(ZyanU32 value);
+
+BENCHMARK_REPEAT_10000(BENCHMARK_DEFINE_FUNCTION, F)
+
+/**
+ * @brief   Contains the addresses of all corpus functions.
+ */
+static CorpusFunction* const g_corpus[BENCHMARK_CORPUS_SIZE] =
+{
+    BENCHMARK_REPEAT_10000(BENCHMARK_DEFINE_ENTRY, F)
+};
+
+/**
+ * @brief   The callback function that is used for all corpus hooks.
+ *
+ * @param   value   The input value.
+ *
+ * @return  The bitwise complement of `value`.
+ */
+static ZyanU32 ZYAN_NOINLINE CorpusCallback(ZyanU32 value)
+{
+    return ~value;
+}
+
+#endif
+
+/* ============================================================================================== */
+/* Timing                                                                                         */
+/* ============================================================================================== */
+
+/**
+ * @brief   Returns a monotonic timestamp in nanoseconds.
+ *
+ * @return  The current value of the monotonic clock in nanoseconds.
+ */
+static ZyanU64 BenchmarkGetTimestamp(void)
+{
+#if defined(ZYAN_WINDOWS)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (ZyanU64)((double)counter.QuadPart * 1000000000 / (double)frequency.QuadPart);
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (ZyanU64)time.tv_sec * 1000000000 + (ZyanU64)time.tv_nsec;
+#endif
+}
+
+/* ============================================================================================== */
+
+#endif /* ZYREX_EXAMPLES_BENCHMARK_H */
@@ -0,0 +1,228 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Demonstrates call-site hooks on the callers of a function in the executable.
+ *
+ * The example exits with a non-zero status, if a call site can not be hooked or any of the calls
+ * does not end up in the expected function.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/CallSite.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+/**
+ * @brief   The exit code that tells CTest the example was skipped.
+ */
+#define EXIT_SKIPPED 77
+
+/* ============================================================================================== */
+/* Target functions                                                                               */
+/* ============================================================================================== */
+
+typedef ZyanU32 (FnHookType)(ZyanU32 param);
+
+ZyanU32 ZYAN_NOINLINE FnHookTarget(ZyanU32 param)
+{
+    puts("  hello from original");
+
+    return param;
+}
+
+ZyanU32 ZYAN_NOINLINE FnHookCaller(ZyanU32 param)
+{
+    // Not a tail call, so the call site stays a `call rel32`
+    return FnHookTarget(param) + 2;
+}
+
+/* ============================================================================================== */
+/* Hook callback                                                                                  */
+/* ============================================================================================== */
+
+static FnHookType* volatile FnHookOriginal = &FnHookTarget;
+
+ZyanU32 ZYAN_NOINLINE FnHookCallback(ZyanU32 param)
+{
+    puts("  hello from callback");
+
+    return (*FnHookOriginal)(param) + 1;
+}
+
+/* ============================================================================================== */
+/* Helper functions                                                                               */
+/* ============================================================================================== */
+
+#define MAX_CALL_SITES 16
+
+typedef struct CallSites_
+{
+    void* sites[MAX_CALL_SITES];
+    ZyanConstVoidPointer originals[MAX_CALL_SITES];
+    ZyanUSize count;
+} CallSites;
+
+static ZyanStatus CollectCallSite(void* call_site, void* context)
+{
+    CallSites* call_sites = (CallSites*)context;
+
+    printf("  call site: %p\n", call_site);
+    call_sites->sites[call_sites->count++] = call_site;
+
+    return (call_sites->count == MAX_CALL_SITES) ? ZYAN_STATUS_FALSE : ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Compares the result of a call with the expected value.
+ *
+ * @param   name        The name of the call.
+ * @param   result      The result of the call.
+ * @param   expected    The expected result.
+ *
+ * @return  `ZYAN_TRUE`, if the result matches or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool Expect(const char* name, ZyanU32 result, ZyanU32 expected)
+{
+    printf("  %s: %x\n", name, result);
+    if (result != expected)
+    {
+        printf("  expected %x\n", expected);
+        return ZYAN_FALSE;
+    }
+
+    return ZYAN_TRUE;
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    // Only the callers in the executable itself are scanned
+    CallSites call_sites;
+    call_sites.count = 0;
+    puts("enumerate:");
+    ZyanStatus status = ZyrexEnumerateCallSites((const void*)(ZyanUPointer)&FnHookTarget,
+        (const void*)(ZyanUPointer)&main, &CollectCallSite, &call_sites);
+    if (status == ZYAN_STATUS_NOT_FOUND)
+    {
+        puts("No function information available for the executable");
+        return EXIT_SKIPPED;
+    }
+    if (!ZYAN_SUCCESS(status) || !call_sites.count)
+    {
+        printf("Failed to find the call sites: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    puts("install:");
+    status = ZyrexTransactionBegin();
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to begin the transaction: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+    for (ZyanUSize i = 0; i < call_sites.count; ++i)
+    {
+        status = ZyrexInstallCallSiteHook(call_sites.sites[i],
+            (const void*)(ZyanUPointer)&FnHookCallback, &call_sites.originals[i]);
+        if (!ZYAN_SUCCESS(status))
+        {
+            break;
+        }
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexUpdateAllThreads();
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        printf("Failed to install the call-site hooks: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+    status = ZyrexTransactionCommit();
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to commit the call-site hooks: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    // Only the hooked callers are redirected, the function itself is left untouched
+    ZyanBool is_correct = Expect("caller", FnHookCaller(0x1337), 0x133A);
+    is_correct &= Expect("direct", (*FnHookOriginal)(0x1337), 0x1337);
+
+    puts("remove:");
+    status = ZyrexTransactionBegin();
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to begin the transaction: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+    for (ZyanUSize i = 0; i < call_sites.count; ++i)
+    {
+        status = ZyrexRemoveCallSiteHook(call_sites.sites[i], call_sites.originals[i]);
+        if (!ZYAN_SUCCESS(status))
+        {
+            break;
+        }
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexUpdateAllThreads();
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        printf("Failed to remove the call-site hooks: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+    status = ZyrexTransactionCommit();
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to commit the removal: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    is_correct &= Expect("caller", FnHookCaller(0x1337), 0x1339);
+
+    ZyrexShutdown();
+
+    return is_correct ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,152 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Compares the code writer backends by installing and removing a large number of inline
+ *          hooks.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/HookRegistry.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+#define BENCHMARK_ENABLE_CORPUS
+#include "Benchmark.h"
+
+/* ============================================================================================== */
+/* Benchmarks                                                                                     */
+/* ============================================================================================== */
+
+/**
+ * @brief   Installs and removes a hook for every corpus function using the given code writer
+ *          backend.
+ *
+ * @param   name        The name of the backend.
+ * @param   backend     The code writer backend.
+ * @param   specs       An array of hook specifications for all corpus functions.
+ * @param   results     An array that receives the individual status codes.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus BenchmarkBackend(const char* name, ZyrexCodeWriterBackend backend,
+    const ZyrexHookSpec* specs, ZyanStatus* results)
+{
+    const ZyanStatus status = ZyrexSetCodeWriterBackend(backend);
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("%-16s not supported (0x%08X)\n", name, (unsigned)status);
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    // Trampolines are written by the code writer as well, so the installation is measured as a
+    // whole
+    const ZyanU64 install_begin = BenchmarkGetTimestamp();
+    ZYAN_CHECK(ZyrexTransactionBegin());
+    ZYAN_CHECK(ZyrexInstallInlineHooks(specs, BENCHMARK_CORPUS_SIZE, results));
+    ZYAN_CHECK(ZyrexUpdateAllThreads());
+    ZYAN_CHECK(ZyrexTransactionCommit());
+    const ZyanU64 install_end = BenchmarkGetTimestamp();
+
+    ZyanUSize failed_count = 0;
+    for (ZyanUSize i = 0; i < BENCHMARK_CORPUS_SIZE; ++i)
+    {
+        if (!ZYAN_SUCCESS(results[i]) || (g_corpus[i]((ZyanU32)i) != CorpusCallback((ZyanU32)i)))
+        {
+            ++failed_count;
+        }
+    }
+
+    ZYAN_CHECK(ZyrexRemoveAllHooks());
+    const ZyanU64 remove_end = BenchmarkGetTimestamp();
+
+    printf("%-16s install: %8.2f ms, remove: %8.2f ms, failed: %u\n", name,
+        (double)(install_end - install_begin) / 1000000,
+        (double)(remove_end - install_end) / 1000000, (unsigned)failed_count);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    ZyanConstVoidPointer* const trampolines =
+        malloc(BENCHMARK_CORPUS_SIZE * sizeof(ZyanConstVoidPointer));
+    ZyrexHookSpec* const specs = malloc(BENCHMARK_CORPUS_SIZE * sizeof(ZyrexHookSpec));
+    ZyanStatus* const results = malloc(BENCHMARK_CORPUS_SIZE * sizeof(ZyanStatus));
+    if (!trampolines || !specs || !results)
+    {
+        puts("Failed to allocate memory");
+        return EXIT_FAILURE;
+    }
+    for (ZyanUSize i = 0; i < BENCHMARK_CORPUS_SIZE; ++i)
+    {
+        specs[i].address = (void*)(ZyanUPointer)g_corpus[i];
+        specs[i].callback = (const void*)(ZyanUPointer)&CorpusCallback;
+        specs[i].trampoline = &trampolines[i];
+        specs[i].patch_size = 0;
+        specs[i].flags = ZYREX_INLINE_HOOK_FLAG_NONE;
+    }
+
+    printf("Hooking %u functions\n\n", (unsigned)BENCHMARK_CORPUS_SIZE);
+
+    ZyanStatus status = BenchmarkBackend("protect", ZYREX_CODE_WRITER_BACKEND_PROTECT, specs,
+        results);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = BenchmarkBackend("process memory", ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY,
+            specs, results);
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Benchmark failed: 0x%08X\n", (unsigned)status);
+    }
+
+    free(results);
+    free(specs);
+    free(trampolines);
+    ZyrexShutdown();
+
+    return ZYAN_SUCCESS(status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,231 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Toggles and retargets an inline hook whose hook jump redirects to the callback
+ *          function directly.
+ *
+ * The first toggle redirects the hook jump to the callback jump of the trampoline. The example
+ * exits with a non-zero status, if any of the calls does not end up in the expected function.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+/* ============================================================================================== */
+/* Target function                                                                                */
+/* ============================================================================================== */
+
+typedef ZyanU32 (FnHookType)(ZyanU32 param);
+
+ZyanU32 ZYAN_NOINLINE FnHookTarget(ZyanU32 param)
+{
+    return param;
+}
+
+/* ============================================================================================== */
+/* Hook callbacks                                                                                 */
+/* ============================================================================================== */
+
+static FnHookType* volatile FnHookOriginal = ZYAN_NULL;
+
+ZyanU32 ZYAN_NOINLINE FnHookCallbackA(ZyanU32 param)
+{
+    return (*FnHookOriginal)(param) + 1;
+}
+
+ZyanU32 ZYAN_NOINLINE FnHookCallbackB(ZyanU32 param)
+{
+    return (*FnHookOriginal)(param) + 2;
+}
+
+/* ============================================================================================== */
+/* Helper functions                                                                               */
+/* ============================================================================================== */
+
+/**
+ * @brief   Installs the hook using the given flags.
+ *
+ * @param   flags   A combination of `ZyrexInlineHookFlags` values.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus InstallHook(ZyanU32 flags)
+{
+    ZyrexHookSpec spec;
+    spec.address = (void*)(ZyanUPointer)&FnHookTarget;
+    spec.callback = (const void*)(ZyanUPointer)&FnHookCallbackA;
+    spec.trampoline = (ZyanConstVoidPointer*)&FnHookOriginal;
+    spec.patch_size = 0;
+    spec.flags = flags;
+
+    ZYAN_CHECK(ZyrexTransactionBegin());
+    ZyanStatus result;
+    ZyanStatus status = ZyrexInstallInlineHooks(&spec, 1, &result);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = result;
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexUpdateAllThreads();
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        return status;
+    }
+
+    return ZyrexTransactionCommit();
+}
+
+/**
+ * @brief   Removes the hook.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus RemoveHook(void)
+{
+    ZYAN_CHECK(ZyrexTransactionBegin());
+    ZyanStatus status = ZyrexRemoveInlineHook((ZyanConstVoidPointer*)&FnHookOriginal);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexUpdateAllThreads();
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        return status;
+    }
+
+    return ZyrexTransactionCommit();
+}
+
+/**
+ * @brief   Calls the target function and compares the result.
+ *
+ * @param   step        The name of the current step.
+ * @param   expected    The expected result.
+ *
+ * @return  `ZYAN_TRUE`, if the result matches or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool Expect(const char* step, ZyanU32 expected)
+{
+    const ZyanU32 result = FnHookTarget(0x1337);
+    printf("  %-10s %x\n", step, result);
+    if (result != expected)
+    {
+        printf("  expected %x\n", expected);
+        return ZYAN_FALSE;
+    }
+
+    return ZYAN_TRUE;
+}
+
+/**
+ * @brief   Toggles and retargets the hook.
+ *
+ * @return  `ZYAN_TRUE`, if the hook behaved as expected or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool ToggleHook(void)
+{
+    const ZyanConstVoidPointer original = (ZyanConstVoidPointer)FnHookOriginal;
+
+    ZyanBool is_correct = Expect("hooked:", 0x1338);
+
+    is_correct &= ZYAN_SUCCESS(ZyrexSetInlineHookEnabled(original, ZYAN_FALSE));
+    is_correct &= Expect("disabled:", 0x1337);
+    is_correct &= ZYAN_SUCCESS(ZyrexSetInlineHookEnabled(original, ZYAN_TRUE));
+    is_correct &= Expect("enabled:", 0x1338);
+    is_correct &= ZYAN_SUCCESS(ZyrexSetInlineHookCallback(original,
+        (const void*)(ZyanUPointer)&FnHookCallbackB));
+    is_correct &= Expect("retarget:", 0x1339);
+    is_correct &= ZYAN_SUCCESS(ZyrexSetInlineHookEnabled(original, ZYAN_FALSE));
+    is_correct &= Expect("disabled:", 0x1337);
+
+    return is_correct;
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    // Both flags at once are rejected before anything is patched
+    ZyanBool is_correct = (InstallHook(ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK |
+        ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP) == ZYAN_STATUS_INVALID_ARGUMENT);
+    is_correct &= Expect("unhooked:", 0x1337);
+
+    static const struct
+    {
+        const char* name;
+        ZyanU32 flags;
+    } variants[] =
+    {
+        { "direct callback", ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK },
+        { "callback jump",   ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP   }
+    };
+
+    for (ZyanUSize i = 0; i < ZYAN_ARRAY_LENGTH(variants); ++i)
+    {
+        printf("%s\n", variants[i].name);
+
+        // The callback is part of the same image, so it is always within reach of the hook jump
+        ZyanStatus status = InstallHook(variants[i].flags);
+        if (!ZYAN_SUCCESS(status))
+        {
+            printf("Failed to install the hook: 0x%08X\n", (unsigned)status);
+            return EXIT_FAILURE;
+        }
+
+        is_correct &= ToggleHook();
+
+        status = RemoveHook();
+        if (!ZYAN_SUCCESS(status))
+        {
+            printf("Failed to remove the hook: 0x%08X\n", (unsigned)status);
+            return EXIT_FAILURE;
+        }
+        is_correct &= Expect("removed:", 0x1337);
+    }
+
+    ZyrexShutdown();
+
+    return is_correct ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
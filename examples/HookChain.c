@@ -0,0 +1,159 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Demonstrates hook chains with multiple prioritized callbacks.
+ *
+ * The example exits with a non-zero status, if any of the calls does not end up in the expected
+ * functions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/HookChain.h>
+#include <Zyrex/Zyrex.h>
+
+/* ============================================================================================== */
+/* Target function                                                                                */
+/* ============================================================================================== */
+
+typedef ZyanU32 (FnHookType)(ZyanU32 param);
+
+ZyanU32 ZYAN_NOINLINE FnHookTarget(ZyanU32 param)
+{
+    puts("  hello from original");
+
+    return param;
+}
+
+/* ============================================================================================== */
+/* Hook callbacks                                                                                 */
+/* ============================================================================================== */
+
+static FnHookType* volatile FnHookNextA = ZYAN_NULL;
+static FnHookType* volatile FnHookNextB = ZYAN_NULL;
+
+ZyanU32 ZYAN_NOINLINE FnHookCallbackA(ZyanU32 param)
+{
+    puts("  hello from callback A");
+
+    return (*FnHookNextA)(param) + 1;
+}
+
+ZyanU32 ZYAN_NOINLINE FnHookCallbackB(ZyanU32 param)
+{
+    puts("  hello from callback B");
+
+    return (*FnHookNextB)(param) * 2;
+}
+
+/* ============================================================================================== */
+/* Helper functions                                                                               */
+/* ============================================================================================== */
+
+/**
+ * @brief   Calls the target function and compares the result.
+ *
+ * @param   expected    The expected result.
+ *
+ * @return  `ZYAN_TRUE`, if the result matches or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool Expect(ZyanU32 expected)
+{
+    const ZyanU32 result = FnHookTarget(0x1337);
+    printf("  result: %x\n", result);
+    if (result != expected)
+    {
+        printf("  expected %x\n", expected);
+        return ZYAN_FALSE;
+    }
+
+    return ZYAN_TRUE;
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    // Callback `B` has the higher priority and is invoked first
+    ZyanStatus status = ZyrexInstallChainedHook((void*)(ZyanUPointer)&FnHookTarget,
+        (const void*)(ZyanUPointer)&FnHookCallbackA, ZYREX_HOOK_CHAIN_DEFAULT_PRIORITY,
+        (ZyanConstVoidPointer*)&FnHookNextA);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexInstallChainedHook((void*)(ZyanUPointer)&FnHookTarget,
+            (const void*)(ZyanUPointer)&FnHookCallbackB, ZYREX_HOOK_CHAIN_DEFAULT_PRIORITY + 1,
+            (ZyanConstVoidPointer*)&FnHookNextB);
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to install the hook chain: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    puts("B -> A -> original:");
+    ZyanBool is_correct = Expect((0x1337 + 1) * 2);
+
+    // Removing a callback only updates the `next` pointer of its predecessor
+    status = ZyrexRemoveChainedHook((void*)(ZyanUPointer)&FnHookTarget,
+        (const void*)(ZyanUPointer)&FnHookCallbackA);
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to remove callback A: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    puts("B -> original:");
+    is_correct &= Expect(0x1337 * 2);
+
+    // The inline hook is removed together with the last callback
+    status = ZyrexRemoveChainedHook((void*)(ZyanUPointer)&FnHookTarget,
+        (const void*)(ZyanUPointer)&FnHookCallbackB);
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to remove callback B: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    puts("original:");
+    is_correct &= Expect(0x1337);
+
+    ZyrexShutdown();
+
+    return is_correct ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
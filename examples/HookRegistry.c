@@ -0,0 +1,204 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Demonstrates hook lookup, enumeration and teardown using the hook registry.
+ *
+ * The example exits with a non-zero status, if a hook can not be found, the number of hooks does
+ * not match or any of the calls does not end up in the expected function.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/HookRegistry.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+/* ============================================================================================== */
+/* Target functions                                                                               */
+/* ============================================================================================== */
+
+typedef ZyanU32 (FnHookType)(ZyanU32 param);
+
+ZyanU32 ZYAN_NOINLINE FnHookTargetA(ZyanU32 param)
+{
+    return param;
+}
+
+ZyanU32 ZYAN_NOINLINE FnHookTargetB(ZyanU32 param)
+{
+    return param + 2;
+}
+
+/* ============================================================================================== */
+/* Hook callbacks                                                                                 */
+/* ============================================================================================== */
+
+static FnHookType* volatile FnHookOriginalA = ZYAN_NULL;
+static FnHookType* volatile FnHookOriginalB = ZYAN_NULL;
+
+ZyanU32 ZYAN_NOINLINE FnHookCallbackA(ZyanU32 param)
+{
+    return (*FnHookOriginalA)(param) + 1;
+}
+
+ZyanU32 ZYAN_NOINLINE FnHookCallbackB(ZyanU32 param)
+{
+    return (*FnHookOriginalB)(param) + 1;
+}
+
+/* ============================================================================================== */
+/* Helper functions                                                                               */
+/* ============================================================================================== */
+
+static ZyanStatus PrintHook(const ZyrexHookInfo* info, void* context)
+{
+    ZyanUSize* count = (ZyanUSize*)context;
+    ++*count;
+
+    printf("  %p -> %p (original: %p, enabled: %d)\n", info->address, info->callback,
+        info->original, info->is_enabled);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+static ZyanUSize CountHooks(void)
+{
+    ZyanUSize count = 0;
+    if (!ZYAN_SUCCESS(ZyrexEnumerateHooks(&PrintHook, &count)))
+    {
+        puts("  enumeration failed");
+        return (ZyanUSize)(-1);
+    }
+
+    return count;
+}
+
+/**
+ * @brief   Calls both target functions and compares the results.
+ *
+ * @param   expected_a  The expected result of `FnHookTargetA`.
+ * @param   expected_b  The expected result of `FnHookTargetB`.
+ *
+ * @return  `ZYAN_TRUE`, if both results match or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool Expect(ZyanU32 expected_a, ZyanU32 expected_b)
+{
+    const ZyanU32 result_a = FnHookTargetA(0x1337);
+    const ZyanU32 result_b = FnHookTargetB(0x1337);
+    printf("A: %x, B: %x\n", result_a, result_b);
+
+    return (result_a == expected_a) && (result_b == expected_b);
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    ZyanStatus status = ZyrexTransactionBegin();
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to begin the transaction: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+    status = ZyrexInstallInlineHook((void*)(ZyanUPointer)&FnHookTargetA,
+        (const void*)(ZyanUPointer)&FnHookCallbackA, (ZyanConstVoidPointer*)&FnHookOriginalA);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexInstallInlineHook((void*)(ZyanUPointer)&FnHookTargetB,
+            (const void*)(ZyanUPointer)&FnHookCallbackB, (ZyanConstVoidPointer*)&FnHookOriginalB);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexUpdateAllThreads();
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        printf("Failed to install the hooks: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+    status = ZyrexTransactionCommit();
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to commit the hooks: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    ZyanBool is_correct = Expect(0x1338, 0x133A);
+
+    ZyrexHookInfo info;
+    if ((ZyrexFindHook((const void*)(ZyanUPointer)&FnHookTargetA, &info) == ZYAN_STATUS_TRUE) &&
+        (info.callback == (const void*)(ZyanUPointer)&FnHookCallbackA))
+    {
+        printf("Found hook for A, callback: %p\n", info.callback);
+    } else
+    {
+        puts("Failed to find the hook for A");
+        is_correct = ZYAN_FALSE;
+    }
+    if ((ZyrexFindHookByOriginal((ZyanConstVoidPointer)FnHookOriginalB, &info) ==
+         ZYAN_STATUS_TRUE) && (info.address == (const void*)(ZyanUPointer)&FnHookTargetB))
+    {
+        printf("Found hook for trampoline B, target: %p\n", info.address);
+    } else
+    {
+        puts("Failed to find the hook for trampoline B");
+        is_correct = ZYAN_FALSE;
+    }
+
+    puts("Installed hooks:");
+    const ZyanUSize installed = CountHooks();
+
+    // Removes every hook using a single transaction
+    status = ZyrexRemoveAllHooks();
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Failed to remove the hooks: 0x%08X\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    puts("Remaining hooks:");
+    const ZyanUSize remaining = CountHooks();
+
+    is_correct &= Expect(0x1337, 0x1339);
+
+    ZyrexShutdown();
+
+    return (is_correct && (installed == 2) && (remaining == 0)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,254 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Hooks functions whose entry can be patched without relocating any instructions.
+ *
+ * The target functions are written in assembly to get exact control over the instruction
+ * encoding:
+ * - A profiling call to a function that does work (`call __fentry__` emitted by `-mfentry`),
+ *   which has to keep being called while the hook is active
+ * - A profiling call to an empty stub function, which is skipped while the hook is active
+ * - Multi-byte `NOP` padding in front of the function entry, which can only be decoded from
+ *   the aligned start of the padding
+ *
+ * The example exits with a non-zero status, if a hook does not use the expected patch site or a
+ * call does not end up in the expected function.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+/**
+ * @brief   The exit code that tells CTest the example was skipped.
+ */
+#define EXIT_SKIPPED 77
+
+#if defined(ZYAN_X64) && defined(ZYAN_LINUX) && (defined(ZYAN_GCC) || defined(ZYAN_CLANG))
+
+/* ============================================================================================== */
+/* Target functions                                                                               */
+/* ============================================================================================== */
+
+typedef ZyanU32 (FnHookType)(ZyanU32 param);
+
+/**
+ * @brief   The number of calls to `FnProfilingFunction`.
+ */
+volatile ZyanU32 g_profiling_calls = 0;
+
+ZyanU32 FnProfiledTarget(ZyanU32 param);
+ZyanU32 FnStubbedTarget(ZyanU32 param);
+ZyanU32 FnPaddedTarget(ZyanU32 param);
+
+__asm__(
+    "    .text\n"
+
+    // Preserves all registers, just like `__fentry__`
+    "    .p2align 4\n"
+    "FnProfilingFunction:\n"
+    "    lock incl g_profiling_calls(%rip)\n"
+    "    ret\n"
+
+    "    .p2align 4\n"
+    "FnEmptyStub:\n"
+    "    ret\n"
+
+    "    .p2align 4\n"
+    "    .globl FnProfiledTarget\n"
+    "    .type FnProfiledTarget, @function\n"
+    "FnProfiledTarget:\n"
+    "    call FnProfilingFunction\n"
+    "    movl %edi, %eax\n"
+    "    ret\n"
+    "    .size FnProfiledTarget, .-FnProfiledTarget\n"
+
+    "    .p2align 4\n"
+    "    .globl FnStubbedTarget\n"
+    "    .type FnStubbedTarget, @function\n"
+    "FnStubbedTarget:\n"
+    "    call FnEmptyStub\n"
+    "    movl %edi, %eax\n"
+    "    ret\n"
+    "    .size FnStubbedTarget, .-FnStubbedTarget\n"
+
+    // Two 8-byte `NOP`s. Decoding 5 bytes in front of the entry yields `add [rax], al`
+    "    .p2align 4\n"
+    "    .byte 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00\n"
+    "    .byte 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00\n"
+    "    .globl FnPaddedTarget\n"
+    "    .type FnPaddedTarget, @function\n"
+    "FnPaddedTarget:\n"
+    "    xchg %ax, %ax\n"
+    "    movl %edi, %eax\n"
+    "    ret\n"
+    "    .size FnPaddedTarget, .-FnPaddedTarget\n"
+);
+
+/* ============================================================================================== */
+/* Hook callbacks                                                                                 */
+/* ============================================================================================== */
+
+static FnHookType* volatile FnHookOriginal = ZYAN_NULL;
+
+ZyanU32 ZYAN_NOINLINE FnHookCallback(ZyanU32 param)
+{
+    return (*FnHookOriginal)(param) + 1;
+}
+
+/* ============================================================================================== */
+/* Helper functions                                                                               */
+/* ============================================================================================== */
+
+/**
+ * @brief   Installs or removes the hook.
+ *
+ * @param   target  The target function or `ZYAN_NULL` to remove the hook.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus UpdateHook(FnHookType* target)
+{
+    ZYAN_CHECK(ZyrexTransactionBegin());
+    ZyanStatus status = target
+        ? ZyrexInstallInlineHook((void*)(ZyanUPointer)target,
+            (const void*)(ZyanUPointer)&FnHookCallback, (ZyanConstVoidPointer*)&FnHookOriginal)
+        : ZyrexRemoveInlineHook((ZyanConstVoidPointer*)&FnHookOriginal);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexUpdateAllThreads();
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        return status;
+    }
+
+    return ZyrexTransactionCommit();
+}
+
+/**
+ * @brief   Calls the target function and compares the result and the number of profiling
+ *          calls.
+ *
+ * @param   step                The name of the current step.
+ * @param   target              The target function.
+ * @param   expected            The expected result.
+ * @param   expected_profiling  The expected number of profiling calls.
+ *
+ * @return  `ZYAN_TRUE`, if the results match or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool Expect(const char* step, FnHookType* target, ZyanU32 expected,
+    ZyanU32 expected_profiling)
+{
+    g_profiling_calls = 0;
+    const ZyanU32 result = target(0x1337);
+    printf("  %-10s %x (%u profiling calls)\n", step, result, (unsigned)g_profiling_calls);
+
+    return (result == expected) && (g_profiling_calls == expected_profiling);
+}
+
+/**
+ * @brief   Hooks the target function and checks the opcode written to its entry.
+ *
+ * @param   name        The name of the target function.
+ * @param   target      The target function.
+ * @param   opcode      The expected opcode at the function entry while the hook is active.
+ * @param   profiling   The expected number of profiling calls per call to the target function.
+ *
+ * @return  `ZYAN_TRUE`, if the hook behaved as expected or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool TestPatchSite(const char* name, FnHookType* target, ZyanU8 opcode,
+    ZyanU32 profiling)
+{
+    printf("%s\n", name);
+
+    const ZyanU8 original_opcode = *(const volatile ZyanU8*)target;
+    ZyanBool is_correct = Expect("unhooked:", target, 0x1337, profiling);
+
+    ZyanStatus status = UpdateHook(target);
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("  failed to install the hook: 0x%08X\n", (unsigned)status);
+        return ZYAN_FALSE;
+    }
+
+    const ZyanU8 hooked_opcode = *(const volatile ZyanU8*)target;
+    printf("  entry:     %02X\n", (unsigned)hooked_opcode);
+    is_correct &= (hooked_opcode == opcode);
+    is_correct &= Expect("hooked:", target, 0x1338, profiling);
+
+    status = UpdateHook(ZYAN_NULL);
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("  failed to remove the hook: 0x%08X\n", (unsigned)status);
+        return ZYAN_FALSE;
+    }
+
+    is_correct &= (*(const volatile ZyanU8*)target == original_opcode);
+    is_correct &= Expect("removed:", target, 0x1337, profiling);
+
+    return is_correct;
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    // The hook jump replaces the call, so the entry starts with a `JMP rel32` in all cases,
+    // except for the padding, where a short jump at the entry leads to the hook jump
+    ZyanBool is_correct = TestPatchSite("profiling call", &FnProfiledTarget, 0xE9, 1);
+    is_correct &= TestPatchSite("empty stub", &FnStubbedTarget, 0xE9, 0);
+    is_correct &= TestPatchSite("nop padding", &FnPaddedTarget, 0xEB, 0);
+
+    ZyrexShutdown();
+
+    return is_correct ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#else
+
+int main()
+{
+    puts("This example requires x86-64 Linux and a GCC compatible compiler");
+    return EXIT_SKIPPED;
+}
+
+#endif
+
+/* ============================================================================================== */
@@ -0,0 +1,285 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Measures the per-call latency of trampolines and hooked functions.
+ *
+ * The latency of a call through the trampoline is compared to the latency of a direct call of
+ * the unhooked function. The difference is the cost of the relocated prologue and the backjump.
+ *
+ * The hooked function is measured twice: once with the hook jump redirecting to the callback
+ * jump of the trampoline (`ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP`) and once with
+ * `ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK`, which saves the indirect branch on every call.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+#include "Benchmark.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the number of calls per measurement.
+ */
+#define LATENCY_ITERATIONS 10000000
+
+/**
+ * @brief   Defines the number of inputs used to verify the results of the hooked function.
+ */
+#define CHECK_ITERATIONS 1024
+
+/* ============================================================================================== */
+/* Target functions                                                                               */
+/* ============================================================================================== */
+
+typedef ZyanU32 (TargetFunction)(ZyanU32 value);
+
+/**
+ * @brief   A target function that usually starts with a short conditional branch.
+ *
+ * @param   value   The input value.
+ *
+ * @return  The result value.
+ */
+static ZyanU32 ZYAN_NOINLINE TargetBranch(ZyanU32 value)
+{
+    if (value & 1)
+    {
+        return value * 3 + 1;
+    }
+
+    return value / 2;
+}
+
+/**
+ * @brief   A target function without any branches.
+ *
+ * @param   value   The input value.
+ *
+ * @return  The result value.
+ */
+static ZyanU32 ZYAN_NOINLINE TargetStraight(ZyanU32 value)
+{
+    return (value ^ 0x5A5A5A5A) * 0x01000193 + (value >> 7);
+}
+
+/* ============================================================================================== */
+/* Hook callback                                                                                  */
+/* ============================================================================================== */
+
+/**
+ * @brief   The trampoline of the currently hooked target function.
+ */
+static TargetFunction* volatile g_original;
+
+/**
+ * @brief   Passes the call on to the original function.
+ *
+ * @param   value   The input value.
+ *
+ * @return  The result of the original function.
+ */
+static ZyanU32 ZYAN_NOINLINE CallbackPassThrough(ZyanU32 value)
+{
+    return g_original(value);
+}
+
+/* ============================================================================================== */
+/* Measurement                                                                                    */
+/* ============================================================================================== */
+
+/**
+ * @brief   Measures the average latency of a single call of the given function.
+ *
+ * @param   function    The function to call.
+ *
+ * @return  The average latency of a single call (in nanoseconds).
+ */
+static double MeasureLatency(TargetFunction* function)
+{
+    TargetFunction* volatile target = function;
+    volatile ZyanU32 sink = 0;
+
+    // Warm up caches and branch predictors
+    for (ZyanU32 i = 0; i < LATENCY_ITERATIONS / 10; ++i)
+    {
+        sink += target(i);
+    }
+
+    const ZyanU64 begin = BenchmarkGetTimestamp();
+    for (ZyanU32 i = 0; i < LATENCY_ITERATIONS; ++i)
+    {
+        sink += target(i);
+    }
+    const ZyanU64 end = BenchmarkGetTimestamp();
+
+    return (double)(end - begin) / LATENCY_ITERATIONS;
+}
+
+/**
+ * @brief   Hooks the given target function, measures the call latency of the trampoline and the
+ *          hooked function and removes the hook again.
+ *
+ * @param   target      The target function.
+ * @param   flags       A combination of `ZyrexInlineHookFlags` values.
+ * @param   trampoline  Receives the average latency of a call through the trampoline.
+ * @param   hooked      Receives the average latency of a call of the hooked function.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus MeasureHook(TargetFunction* target, ZyanU32 flags, double* trampoline,
+    double* hooked)
+{
+    ZyrexHookSpec spec;
+    spec.address = (void*)(ZyanUPointer)target;
+    spec.callback = (const void*)(ZyanUPointer)&CallbackPassThrough;
+    spec.trampoline = (ZyanConstVoidPointer*)&g_original;
+    spec.patch_size = 0;
+    spec.flags = flags;
+
+    // Record reference results of the unhooked function to verify the relocated prologue
+    ZyanU32 expected[CHECK_ITERATIONS];
+    for (ZyanU32 i = 0; i < CHECK_ITERATIONS; ++i)
+    {
+        expected[i] = target(i);
+    }
+
+    ZYAN_CHECK(ZyrexTransactionBegin());
+    ZyanStatus result;
+    ZyanStatus status = ZyrexInstallInlineHooks(&spec, 1, &result);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = result;
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexUpdateAllThreads();
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        return status;
+    }
+    ZYAN_CHECK(ZyrexTransactionCommit());
+
+    for (ZyanU32 i = 0; i < CHECK_ITERATIONS; ++i)
+    {
+        if ((g_original(i) != expected[i]) || (target(i) != expected[i]))
+        {
+            printf("Result mismatch for input %u\n", (unsigned)i);
+            status = ZYAN_STATUS_FAILED;
+            break;
+        }
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        *trampoline = MeasureLatency(g_original);
+        *hooked = MeasureLatency(target);
+    }
+
+    ZYAN_CHECK(ZyrexTransactionBegin());
+    const ZyanStatus remove_status = ZyrexRemoveInlineHook((ZyanConstVoidPointer*)&g_original);
+    if (!ZYAN_SUCCESS(remove_status))
+    {
+        ZyrexTransactionAbort();
+        return remove_status;
+    }
+    ZYAN_CHECK(ZyrexUpdateAllThreads());
+    ZYAN_CHECK(ZyrexTransactionCommit());
+
+    return status;
+}
+
+/**
+ * @brief   Measures the call latency of the given target function before and after hooking it.
+ *
+ * @param   name    The name of the target function.
+ * @param   target  The target function.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus MeasureTarget(const char* name, TargetFunction* target)
+{
+    const double direct = MeasureLatency(target);
+
+    double trampoline;
+    double hooked;
+    ZYAN_CHECK(MeasureHook(target, ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP, &trampoline, &hooked));
+    double trampoline_direct;
+    double hooked_direct;
+    ZYAN_CHECK(MeasureHook(target, ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK, &trampoline_direct,
+        &hooked_direct));
+
+    printf("%s\n", name);
+    printf("  direct call:              %6.2f ns\n", direct);
+    printf("  trampoline:               %6.2f ns (%+6.2f ns)\n", trampoline,
+        trampoline - direct);
+    printf("  hooked (callback jump):   %6.2f ns\n", hooked);
+    printf("  hooked (direct callback): %6.2f ns (%+6.2f ns)\n", hooked_direct,
+        hooked_direct - hooked);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+    ZyanStatus status = MeasureTarget("TargetBranch", &TargetBranch);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = MeasureTarget("TargetStraight", &TargetStraight);
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        printf("Benchmark failed: 0x%08X\n", (unsigned)status);
+    }
+
+    ZyrexShutdown();
+
+    return ZYAN_SUCCESS(status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,258 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Installs an inline hook while a worker thread, that is passed to `ZyrexUpdateThread`,
+ *          keeps calling the hooked function.
+ *
+ * The example exits with a non-zero status, if the worker thread was not suspended during the
+ * commit or does not observe the hook afterwards.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Zycore/Defines.h>
+#include <Zycore/API/Thread.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Zyrex.h>
+
+#if defined(ZYAN_WINDOWS)
+#   include <windows.h>
+#else
+#   include <pthread.h>
+#endif
+
+/* ============================================================================================== */
+/* Target function                                                                                */
+/* ============================================================================================== */
+
+typedef ZyanU32 (FnHookType)(ZyanU32 param);
+
+ZyanU32 ZYAN_NOINLINE FnHookTarget(ZyanU32 param)
+{
+    return param;
+}
+
+/* ============================================================================================== */
+/* Hook callback                                                                                  */
+/* ============================================================================================== */
+
+static FnHookType* volatile FnHookOriginal = ZYAN_NULL;
+
+ZyanU32 ZYAN_NOINLINE FnHookCallback(ZyanU32 param)
+{
+    return (*FnHookOriginal)(param) + 1;
+}
+
+/* ============================================================================================== */
+/* Worker thread                                                                                  */
+/* ============================================================================================== */
+
+/**
+ * @brief   The id of the worker thread or `0`, if the worker thread did not start yet.
+ */
+static volatile ZyanThreadId g_worker_id = 0;
+
+/**
+ * @brief   The last result the worker thread received from the target function.
+ */
+static volatile ZyanU32 g_worker_result = 0;
+
+/**
+ * @brief   Signals the worker thread to exit.
+ */
+static volatile ZyanBool g_worker_exit = ZYAN_FALSE;
+
+/**
+ * @brief   Calls the target function until `g_worker_exit` is set.
+ */
+static void Worker(void)
+{
+    ZyanThreadId thread_id;
+    if (!ZYAN_SUCCESS(ZyrexGetCurrentThreadId(&thread_id)))
+    {
+        return;
+    }
+    g_worker_id = thread_id;
+
+    while (!g_worker_exit)
+    {
+        g_worker_result = FnHookTarget(0x1337);
+    }
+}
+
+#if defined(ZYAN_WINDOWS)
+
+static DWORD WINAPI WorkerEntry(LPVOID parameter)
+{
+    ZYAN_UNUSED(parameter);
+    Worker();
+    return 0;
+}
+
+#else
+
+static void* WorkerEntry(void* parameter)
+{
+    ZYAN_UNUSED(parameter);
+    Worker();
+    return ZYAN_NULL;
+}
+
+#endif
+
+/**
+ * @brief   Waits until `value` becomes `expected`.
+ *
+ * @param   value       A pointer to the value to observe.
+ * @param   expected    The expected value.
+ *
+ * @return  `ZYAN_TRUE`, if the value was observed in time or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool WaitForValue(const volatile ZyanU32* value, ZyanU32 expected)
+{
+    for (ZyanU32 i = 0; i < 5000; ++i)
+    {
+        if (*value == expected)
+        {
+            return ZYAN_TRUE;
+        }
+        ZyanThreadSleep(1);
+    }
+
+    return ZYAN_FALSE;
+}
+
+/* ============================================================================================== */
+/* Helper functions                                                                               */
+/* ============================================================================================== */
+
+/**
+ * @brief   Installs or removes the hook and updates only the worker thread.
+ *
+ * @param   install `ZYAN_TRUE` to install the hook or `ZYAN_FALSE` to remove it.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus UpdateHook(ZyanBool install)
+{
+    ZYAN_CHECK(ZyrexTransactionBegin());
+    ZyanStatus status = install
+        ? ZyrexInstallInlineHook((void*)(ZyanUPointer)&FnHookTarget,
+            (const void*)(ZyanUPointer)&FnHookCallback, (ZyanConstVoidPointer*)&FnHookOriginal)
+        : ZyrexRemoveInlineHook((ZyanConstVoidPointer*)&FnHookOriginal);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexUpdateThread(g_worker_id);
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexTransactionAbort();
+        return status;
+    }
+
+    return ZyrexTransactionCommit();
+}
+
+/**
+ * @brief   Checks, if the worker thread was suspended by the last commit.
+ *
+ * @return  `ZYAN_TRUE`, if exactly one thread was suspended or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool ExpectWorkerSuspended(void)
+{
+    ZyrexTransactionStatistics statistics;
+    if (!ZYAN_SUCCESS(ZyrexGetTransactionStatistics(&statistics)))
+    {
+        puts("  failed to query the transaction statistics");
+        return ZYAN_FALSE;
+    }
+
+    printf("  suspended threads: %u\n", (unsigned)statistics.thread_count);
+    return (statistics.thread_count == 1);
+}
+
+/* ============================================================================================== */
+/* Entry point                                                                                    */
+/* ============================================================================================== */
+
+int main()
+{
+    if (!ZYAN_SUCCESS(ZyrexInitialize()))
+    {
+        puts("Failed to initialize Zyrex");
+        return EXIT_FAILURE;
+    }
+
+#if defined(ZYAN_WINDOWS)
+    const HANDLE worker = CreateThread(ZYAN_NULL, 0, &WorkerEntry, ZYAN_NULL, 0, ZYAN_NULL);
+    if (!worker)
+#else
+    pthread_t worker;
+    if (pthread_create(&worker, ZYAN_NULL, &WorkerEntry, ZYAN_NULL) != 0)
+#endif
+    {
+        puts("Failed to create the worker thread");
+        return EXIT_FAILURE;
+    }
+
+    ZyanBool is_correct = WaitForValue(&g_worker_result, 0x1337);
+
+    ZyanStatus status = UpdateHook(ZYAN_TRUE);
+    if (ZYAN_SUCCESS(status))
+    {
+        puts("installed");
+        is_correct &= ExpectWorkerSuspended();
+        is_correct &= WaitForValue(&g_worker_result, 0x1338);
+
+        status = UpdateHook(ZYAN_FALSE);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        puts("removed");
+        is_correct &= ExpectWorkerSuspended();
+        is_correct &= WaitForValue(&g_worker_result, 0x1337);
+    } else
+    {
+        printf("Failed to update the hook: 0x%08X\n", (unsigned)status);
+        is_correct = ZYAN_FALSE;
+    }
+
+    g_worker_exit = ZYAN_TRUE;
+#if defined(ZYAN_WINDOWS)
+    WaitForSingleObject(worker, INFINITE);
+    CloseHandle(worker);
+#else
+    pthread_join(worker, ZYAN_NULL);
+#endif
+
+    ZyrexShutdown();
+
+    return is_correct ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ============================================================================================== */
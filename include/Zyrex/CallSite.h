@@ -0,0 +1,96 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+/**
+ * @file
+ * @brief   Enumeration of the relative call and jump instructions that target a function.
+ */
+
+#ifndef ZYREX_CALL_SITE_H
+#define ZYREX_CALL_SITE_H
+
+#include <ZyrexExportConfig.h>
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexCallSiteCallback` function prototype.
+ *
+ * @param   call_site   The address of the `call rel32` or `jmp rel32` instruction.
+ * @param   context     The user-defined context.
+ *
+ * @return  `ZYAN_STATUS_FALSE` to stop the enumeration, a generic zyan status code to continue
+ *          or an error code that is passed on to the caller of `ZyrexEnumerateCallSites`.
+ */
+typedef ZyanStatus (*ZyrexCallSiteCallback)(void* call_site, void* context);
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Enumeration                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Enumerates all `call rel32` and `jmp rel32` instructions that target the given
+ *          `function`.
+ *
+ * @param   function    The address of the target function.
+ * @param   module      An address inside of the module to search. Only the functions of this
+ *                      module are scanned.
+ * @param   callback    The callback function that is invoked for every call site.
+ * @param   context     A user-defined context that is passed to the callback function.
+ *
+ * @return  `ZYAN_STATUS_NOT_FOUND`, if no module contains the given address or no information
+ *          about the functions of the module is available, or a zyan status code.
+ *
+ * Every function is disassembled starting at its entry, so only real instruction boundaries are
+ * reported. The function bounds are taken from the symbol table of the module on Linux and from
+ * the exception directory on 64-bit Windows. Code that is not covered by this information (e.g.
+ * Windows leaf functions) is not scanned and 32-bit Windows modules are not supported.
+ *
+ * The reported addresses can be passed to `ZyrexInstallCallSiteHook`.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexEnumerateCallSites(const void* function, const void* module,
+    ZyrexCallSiteCallback callback, void* context);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_CALL_SITE_H */
@@ -0,0 +1,118 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Hook chains with multiple prioritized callbacks per target function.
+ */
+
+#ifndef ZYREX_HOOK_CHAIN_H
+#define ZYREX_HOOK_CHAIN_H
+
+#include <ZyrexExportConfig.h>
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Macros                                                                                         */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Constants                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the default priority of a chained hook.
+ */
+#define ZYREX_HOOK_CHAIN_DEFAULT_PRIORITY   0
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook chain                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Adds a callback to the hook chain of the given `address`.
+ *
+ * @param   address     The address to hook.
+ * @param   callback    The callback address. Every callback can only be added once per chain.
+ * @param   priority    The priority of the callback. Callbacks with a higher priority are invoked
+ *                      first. Callbacks with equal priority are invoked in the order they were
+ *                      added.
+ * @param   next        A pointer to the memory that receives the address of the next callback in
+ *                      the chain (or the trampoline to the original function). The callback must
+ *                      invoke this address to pass the call on. The memory must stay valid until
+ *                      the callback is removed from the chain.
+ *
+ * @return  A zyan status code.
+ *
+ * All callbacks of a chain share a single inline hook and trampoline. The inline hook is
+ * installed when the first callback is added, which suspends all other threads. Adding or
+ * removing further callbacks only atomically updates the `next` pointers of the adjacent
+ * callbacks and never modifies the hooked code. Passing the call on costs one indirect call.
+ *
+ * The `next` pointer of the new callback is published before the callback becomes reachable, so
+ * concurrently executing threads always observe a consistent chain.
+ *
+ * This function must not be called while the calling thread owns the global transaction.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexInstallChainedHook(void* address, const void* callback,
+    ZyanI32 priority, ZyanConstVoidPointer* next);
+
+/**
+ * @brief   Removes a callback from the hook chain of the given `address`.
+ *
+ * @param   address     The hooked address.
+ * @param   callback    The callback address.
+ *
+ * @return  A zyan status code.
+ *
+ * The `next` pointer of the removed callback is left untouched, as other threads might still be
+ * executing the callback. The inline hook is removed together with the last callback of the
+ * chain, in which case the `next` pointer receives the address of the original function.
+ *
+ * This function must not be called while the calling thread owns the global transaction.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexRemoveChainedHook(void* address, const void* callback);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_HOOK_CHAIN_H */
@@ -0,0 +1,164 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Registry of all installed hooks.
+ */
+
+#ifndef ZYREX_HOOK_REGISTRY_H
+#define ZYREX_HOOK_REGISTRY_H
+
+#include <ZyrexExportConfig.h>
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+#include <Zyrex/Transaction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook information                                                                               */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexHookInfo` struct.
+ */
+typedef struct ZyrexHookInfo_
+{
+    /**
+     * @brief   The hook type.
+     */
+    ZyrexHookType type;
+    /**
+     * @brief   The address of the hooked function.
+     */
+    const void* address;
+    /**
+     * @brief   The trampoline to the original function.
+     */
+    ZyanConstVoidPointer original;
+    /**
+     * @brief   The address of the callback function.
+     */
+    const void* callback;
+    /**
+     * @brief   Signals, if the hook is enabled.
+     */
+    ZyanBool is_enabled;
+} ZyrexHookInfo;
+
+/**
+ * @brief   Defines the `ZyrexHookCallback` function prototype.
+ *
+ * @param   info    A pointer to the `ZyrexHookInfo` struct of the current hook.
+ * @param   context A user-defined context pointer.
+ *
+ * @return  A zyan status code. Returning an error status stops the enumeration.
+ */
+typedef ZyanStatus (*ZyrexHookCallback)(const ZyrexHookInfo* info, void* context);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Lookup                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Searches the hook installed at the given `address`.
+ *
+ * @param   address The address of the hooked function.
+ * @param   info    Receives information about the hook, if found.
+ *
+ * @return  `ZYAN_STATUS_TRUE`, if a hook was found, `ZYAN_STATUS_FALSE`, if not, or a generic
+ *          zyan status code.
+ *
+ * This function does not acquire any locks and does not allocate memory. It can be used from hook
+ * callbacks and signal handlers.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexFindHook(const void* address, ZyrexHookInfo* info);
+
+/**
+ * @brief   Searches the hook that belongs to the given trampoline.
+ *
+ * @param   original    The trampoline address received during the hook installation.
+ * @param   info        Receives information about the hook, if found.
+ *
+ * @return  `ZYAN_STATUS_TRUE`, if a hook was found, `ZYAN_STATUS_FALSE`, if not, or a generic
+ *          zyan status code.
+ *
+ * This function does not acquire any locks and does not allocate memory. It can be used from hook
+ * callbacks and signal handlers.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexFindHookByOriginal(ZyanConstVoidPointer original,
+    ZyrexHookInfo* info);
+
+/**
+ * @brief   Enumerates all installed hooks.
+ *
+ * @param   callback    The callback function that is invoked for each hook.
+ * @param   context     A user-defined context pointer that is passed to the callback.
+ *
+ * @return  A zyan status code.
+ *
+ * Hooks that are installed or removed during the enumeration might or might not be reported.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexEnumerateHooks(ZyrexHookCallback callback, void* context);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Teardown                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Removes all installed hooks.
+ *
+ * @return  A zyan status code.
+ *
+ * All hooks (including hook chains) are removed using a single transaction, which suspends all
+ * other threads once.
+ *
+ * This function must not be called while the calling thread owns the global transaction.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexRemoveAllHooks(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_HOOK_REGISTRY_H */
@@ -0,0 +1,242 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#ifndef ZYREX_INTERNAL_CODE_WRITER_H
+#define ZYREX_INTERNAL_CODE_WRITER_H
+
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+#include <Zycore/Vector.h>
+#include <Zycore/API/Memory.h>
+#include <Zyrex/Transaction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexProtectedRegion` struct.
+ *
+ * Describes a page-aligned memory region and its original protection.
+ */
+typedef struct ZyrexProtectedRegion_
+{
+    /**
+     * @brief   The start address of the region.
+     */
+    ZyanUPointer address;
+    /**
+     * @brief   The size of the region.
+     */
+    ZyanUSize size;
+    /**
+     * @brief   The original protection of the region.
+     */
+    ZyanMemoryPageProtection protection;
+} ZyrexProtectedRegion;
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Synchronization                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the code writer.
+ *
+ * @return  A zyan status code.
+ *
+ * Registers the process for core serializing memory barriers, if supported by the system.
+ */
+ZyanStatus ZyrexCodeWriterInit(void);
+
+/**
+ * @brief   Executes a serializing instruction on all processors that currently run threads of
+ *          the calling process.
+ *
+ * @return  A zyan status code.
+ *
+ * After this function returns, no processor executes stale instruction bytes of code that was
+ * modified before calling this function.
+ */
+ZyanStatus ZyrexSerializeAllCores(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Backend                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Sets the backend that is used to write code.
+ *
+ * @param   backend The code writer backend.
+ *
+ * @return  A zyan status code.
+ *
+ * The caller has to make sure that no code is written concurrently.
+ */
+ZyanStatus ZyrexCodeWriterSetBackend(ZyrexCodeWriterBackend backend);
+
+/**
+ * @brief   Returns the backend that is used to write code.
+ *
+ * @return  The code writer backend.
+ */
+ZyrexCodeWriterBackend ZyrexCodeWriterGetBackend(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Memory protection                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Adds the pages that contain the given code range to a set of regions.
+ *
+ * @param   regions A pointer to the sorted `ZyanVector` of `ZyrexProtectedRegion` structs.
+ * @param   address The start address of the code range.
+ * @param   size    The size of the code range.
+ *
+ * @return  A zyan status code.
+ *
+ * Overlapping and adjacent regions are merged. No memory is allocated, if `regions` has room for
+ * one region per added code range.
+ */
+ZyanStatus ZyrexProtectedRegionsAdd(ZyanVector* regions, const void* address, ZyanUSize size);
+
+/**
+ * @brief   Makes all given page ranges writable.
+ *
+ * @param   ranges  A pointer to the sorted `ZyanVector` of `ZyrexProtectedRegion` structs.
+ * @param   regions A pointer to the `ZyanVector` that receives the `ZyrexProtectedRegion` structs
+ *                  with the original protection of all affected pages.
+ *
+ * @return  A zyan status code.
+ *
+ * The ranges are split at mapping boundaries and stored in `regions` together with their original
+ * protection, which is looked up from the system (`/proc/self/maps` on Linux). Regions that are
+ * already writable and executable are left untouched.
+ *
+ * No memory is allocated, if `regions` has room for one region per page of `ranges`. A vector
+ * with a custom buffer can be used to guarantee that while other threads are suspended.
+ *
+ * The protection is not changed at all, if the `ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY`
+ * backend is active. In this case, `regions` receives a copy of `ranges`.
+ */
+ZyanStatus ZyrexProtectedRegionsUnprotect(const ZyanVector* ranges, ZyanVector* regions);
+
+/**
+ * @brief   Restores the original protection of all given regions.
+ *
+ * @param   regions A pointer to the `ZyanVector` of `ZyrexProtectedRegion` structs that was
+ *                  filled by `ZyrexProtectedRegionsUnprotect`.
+ *
+ * @return  A zyan status code.
+ */
+ZyanStatus ZyrexProtectedRegionsRestore(const ZyanVector* regions);
+
+/**
+ * @brief   Flushes the instruction cache for all given regions and serializes all processors
+ *          once.
+ *
+ * @param   regions A pointer to the `ZyanVector` of `ZyrexProtectedRegion` structs.
+ *
+ * @return  A zyan status code.
+ *
+ * This function has to be called after all code was written using `ZyrexWriteCode` and before
+ * any suspended thread is resumed.
+ */
+ZyanStatus ZyrexProtectedRegionsSynchronize(const ZyanVector* regions);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Code writing                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Writes the given code to the given `address`.
+ *
+ * @param   address The destination address.
+ * @param   code    A pointer to the code to write.
+ * @param   size    The size of the code.
+ *
+ * @return  A zyan status code.
+ *
+ * The code must be writable, unless the `ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY` backend is
+ * active. This function is only safe to use, if no other thread executes the modified code at
+ * the same time (e.g. because all other threads are suspended or the code is
+ * unreachable).
+ *
+ * The instruction cache is not flushed. Call `ZyrexProtectedRegionsSynchronize` once after all
+ * code was written.
+ */
+ZyanStatus ZyrexWriteCode(void* address, const void* code, ZyanUSize size);
+
+/**
+ * @brief   Writes the given code to the given `address`, while other threads might execute it
+ *          concurrently.
+ *
+ * @param   address The destination address.
+ * @param   code    A pointer to the code to write. The code must form a single instruction.
+ * @param   size    The size of the code.
+ * @param   detour  The address to redirect threads to, that hit the transient breakpoint. The
+ *                  code at this address must have the same effect as the new instruction.
+ *
+ * @return  A zyan status code.
+ *
+ * All processors are serialized first, which publishes code that was previously written using
+ * `ZyrexWriteCode`.
+ *
+ * If the code fits in a single aligned 8-byte word and the
+ * `ZYREX_CODE_WRITER_BACKEND_PROTECT` backend is active, it is written using a single atomic
+ * store. Otherwise the code is written in three phases with a cross-core serialization step in between:
+ * 1. The first byte is replaced with an `INT3` breakpoint
+ * 2. The remaining bytes are written
+ * 3. The first byte is written
+ *
+ * Threads that hit the breakpoint in the meantime are redirected to the `detour` address by a
+ * `SIGTRAP` signal handler (or a vectored exception handler on Windows). The breakpoint site is
+ * remembered after the operation, so a trap that is delivered late lets the thread execute the
+ * new instruction instead of being forwarded to the previous handler.
+ *
+ * The code must be writable, unless the `ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY` backend is
+ * active. The bytes at `address` must form a single instruction before and
+ * after the operation, as threads might execute the code at any time.
+ */
+ZyanStatus ZyrexWriteCodeLive(void* address, const void* code, ZyanUSize size,
+    const void* detour);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_INTERNAL_CODE_WRITER_H */
@@ -0,0 +1,149 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#ifndef ZYREX_INTERNAL_FUNCTION_INDEX_H
+#define ZYREX_INTERNAL_FUNCTION_INDEX_H
+
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+#include <Zycore/Vector.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexFunctionRange` struct.
+ */
+typedef struct ZyrexFunctionRange_
+{
+    /**
+     * @brief   The start address of the function.
+     */
+    ZyanUPointer address;
+    /**
+     * @brief   The size of the function.
+     */
+    ZyanUPointer size;
+} ZyrexFunctionRange;
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Initialization & Finalization                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the function index, if not already done.
+ *
+ * @return  A zyan status code.
+ *
+ * This function must not be called concurrently with any other function index function.
+ */
+ZyanStatus ZyrexFunctionIndexInit(void);
+
+/**
+ * @brief   Releases all cached module indices.
+ *
+ * @return  A zyan status code.
+ */
+ZyanStatus ZyrexFunctionIndexClear(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Validation                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Checks, if the given patch window can be safely overwritten.
+ *
+ * @param   function        The entry address of the target function.
+ * @param   patch_address   The start address of the patch window.
+ * @param   patch_size      The size of the patch window.
+ *
+ * @return  `ZYAN_STATUS_SUCCESS` if the patch window is safe, `ZYREX_STATUS_UNSAFE_PATCH_WINDOW`
+ *          if a branch inside the module targets the interior of the patch window or the patch
+ *          window exceeds the bounds of the target function, or a generic zyan status code if an
+ *          error occured.
+ *
+ * The function entry itself is a valid branch target, as it is still covered by the hook jump.
+ *
+ * This function always succeeds, if patch window validation is disabled or if no information
+ * about the containing module is available.
+ *
+ * The index for a specific module is built on first use and cached afterwards. All cached indices
+ * are rebuilt on demand after the dynamic linker unloaded a module. This function is thread-safe.
+ */
+ZyanStatus ZyrexFunctionIndexValidatePatchWindow(const void* function, const void* patch_address,
+    ZyanUSize patch_size);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Lookup                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the bounds of the function that starts at the given `address`.
+ *
+ * @param   address A pointer to the entry of the function.
+ * @param   begin   Receives the start address of the function.
+ * @param   end     Receives the end address of the function (exclusive).
+ *
+ * @return  `ZYAN_STATUS_NOT_FOUND`, if the function index is not initialized or no information
+ *          about the function is available, or a zyan status code.
+ *
+ * This function works independently of the patch window validation setting. It is thread-safe.
+ */
+ZyanStatus ZyrexFunctionIndexGetFunctionRange(const void* address, ZyanUPointer* begin,
+    ZyanUPointer* end);
+
+/**
+ * @brief   Copies the bounds of all functions of the module that contains the given `address`.
+ *
+ * @param   address     An address inside of the module.
+ * @param   functions   A pointer to an initialized `ZyanVector` instance with `ZyrexFunctionRange`
+ *                      elements that receives the function bounds, sorted by address.
+ *
+ * @return  `ZYAN_STATUS_NOT_FOUND`, if the function index is not initialized or no information
+ *          about the functions of the module is available, or a zyan status code.
+ *
+ * Aliases of the same function are only reported once. This function is thread-safe.
+ */
+ZyanStatus ZyrexFunctionIndexGetFunctions(const void* address, ZyanVector* functions);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_INTERNAL_FUNCTION_INDEX_H */
@@ -0,0 +1,107 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#ifndef ZYREX_INTERNAL_HOOK_REGISTRY_H
+#define ZYREX_INTERNAL_HOOK_REGISTRY_H
+
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+#include <Zyrex/Internal/Trampoline.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook registry                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Reserves room for the given number of insertions and removals.
+ *
+ * @param   insert_count    The number of hooks that will be inserted.
+ * @param   remove_count    The number of hooks that will be removed.
+ *
+ * @return  A zyan status code.
+ *
+ * This function might allocate memory and must not be called while other threads are suspended.
+ * Every reserved insertion and removal has to be consumed by `ZyrexHookRegistryInsert` and
+ * `ZyrexHookRegistryRemove` or released by `ZyrexHookRegistryUnreserve`.
+ */
+ZyanStatus ZyrexHookRegistryReserve(ZyanUSize insert_count, ZyanUSize remove_count);
+
+/**
+ * @brief   Releases reserved insertions and removals that are not used.
+ *
+ * @param   insert_count    The number of unused insertions.
+ * @param   remove_count    The number of unused removals.
+ */
+void ZyrexHookRegistryUnreserve(ZyanUSize insert_count, ZyanUSize remove_count);
+
+/**
+ * @brief   Adds the inline hook of the given trampoline chunk to the hook registry.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ *
+ * Consumes a reserved insertion.
+ */
+void ZyrexHookRegistryInsert(const ZyrexTrampolineChunk* trampoline);
+
+/**
+ * @brief   Removes the inline hook of the given trampoline chunk from the hook registry and
+ *          releases the trampoline chunk.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ *
+ * Consumes a reserved removal. The trampoline chunk is released as soon as no lock-free reader
+ * can access it anymore.
+ */
+void ZyrexHookRegistryRemove(ZyrexTrampolineChunk* trampoline);
+
+/**
+ * @brief   Releases all resources of the hook registry.
+ *
+ * @return  `ZYAN_STATUS_INVALID_OPERATION`, if a transaction is currently applied or a zyan
+ *          status code.
+ *
+ * Waits for all active lock-free readers. This function must not be called from a
+ * `ZyrexHookCallback`.
+ */
+ZyanStatus ZyrexHookRegistryClear(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_INTERNAL_HOOK_REGISTRY_H */
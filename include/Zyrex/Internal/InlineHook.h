@@ -28,8 +28,10 @@
 #define ZYREX_INLINE_HOOK_H
 
 #include <Zycore/Defines.h>
-#ifdef ZYAN_WINDOWS
+#if defined(ZYAN_WINDOWS)
 #   include <windows.h>
+#elif defined(ZYAN_LINUX)
+#   include <ucontext.h>
 #endif
 #include <Zycore/Types.h>
 #include <Zyrex/Internal/Trampoline.h>
@@ -71,6 +73,29 @@ ZyanStatus ZyrexMigrateThread(HANDLE thread_handle, const void* source, ZyanUSiz
     const ZyrexInstructionTranslationMap* translation_map, 
     ZyrexThreadMigrationDirection direction);
 
+#elif defined(ZYAN_LINUX)
+
+/**
+ * @brief   Migrates the instruction pointer of a suspended thread from the `source` code to the
+ *          `destination` code.
+ *
+ * @param   context             A pointer to the saved signal context of the suspended thread.
+ * @param   source              A pointer to the source code.
+ * @param   source_length       The length of the source code.
+ * @param   destination         A pointer to the destination code.
+ * @param   destination_length  The length of the destination code.
+ * @param   translation_map     A pointer to the instruction translation map.
+ * @param   direction           The migration direction.
+ *
+ * @return  A zyan status code.
+ *
+ * The instruction pointer is left untouched, if it does not point into the source code.
+ */
+ZyanStatus ZyrexMigrateThread(ucontext_t* context, const void* source, ZyanUSize source_length,
+    const void* destination, ZyanUSize destination_length,
+    const ZyrexInstructionTranslationMap* translation_map,
+    ZyrexThreadMigrationDirection direction);
+
 #endif
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -0,0 +1,109 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#ifndef ZYREX_INTERNAL_PARALLEL_H
+#define ZYREX_INTERNAL_PARALLEL_H
+
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the minimum amount of work items per worker thread.
+ *
+ * Batches smaller than this value are processed on the calling thread, as the cost of creating
+ * additional worker threads would outweigh the gain.
+ */
+#define ZYREX_PARALLEL_MIN_ITEMS_PER_WORKER     64
+
+/**
+ * @brief   Defines the maximum amount of worker threads.
+ */
+#define ZYREX_PARALLEL_MAX_WORKERS              64
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexParallelCallback` function prototype.
+ *
+ * @param   context The user defined context.
+ * @param   index   The index of the work item to process.
+ */
+typedef void (*ZyrexParallelCallback)(void* context, ZyanUSize index);
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Information                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the number of logical processors available to the current process.
+ *
+ * @return  The number of logical processors available to the current process.
+ */
+ZyanUSize ZyrexGetProcessorCount(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Parallel execution                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Invokes the given `callback` for every index in the range `[0, count)` using a pool of
+ *          short-lived worker threads.
+ *
+ * @param   count       The number of work items.
+ * @param   callback    The callback function.
+ * @param   context     The user defined context passed to the callback function.
+ *
+ * @return  A zyan status code.
+ *
+ * The calling thread participates in processing the work items. This function returns after all
+ * work items have been processed. The callback must not assume any particular processing order
+ * and has to be thread-safe.
+ */
+ZyanStatus ZyrexParallelFor(ZyanUSize count, ZyrexParallelCallback callback, void* context);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_INTERNAL_PARALLEL_H */
@@ -50,6 +50,9 @@ extern "C" {
  * @param   source_length       The maximum amount of bytes that can be safely read from the 
  *                              source buffer.
  * @param   trampoline          A pointer to the destination trampoline chunk.
+ * @param   trampoline_address  The runtime address of the destination trampoline chunk. This
+ *                              might differ from `trampoline`, if the code is relocated to a
+ *                              private buffer first.
  * @param   min_bytes_to_reloc  Specifies the minimum amount of bytes that should be relocated.
  *                              This function might copy more bytes on demand to keep individual
  *                              instructions intact.
@@ -59,8 +62,8 @@ extern "C" {
  * @return  A zyan status code.
  */
 ZyanStatus ZyrexRelocateCode(const void* source, ZyanUSize source_length, 
-    ZyrexTrampolineChunk* trampoline, ZyanUSize min_bytes_to_reloc, ZyanUSize* bytes_read, 
-    ZyanUSize* bytes_written);
+    ZyrexTrampolineChunk* trampoline, ZyanUPointer trampoline_address, 
+    ZyanUSize min_bytes_to_reloc, ZyanUSize* bytes_read, ZyanUSize* bytes_written);
 
 /* ---------------------------------------------------------------------------------------------- */
 
@@ -0,0 +1,112 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+#ifndef ZYREX_INTERNAL_STACK_CHECK_H
+#define ZYREX_INTERNAL_STACK_CHECK_H
+
+#include <Zycore/Defines.h>
+#if defined(ZYAN_WINDOWS)
+#   include <windows.h>
+#elif defined(ZYAN_LINUX)
+#   include <ucontext.h>
+#endif
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the maximum number of code addresses that are captured per thread.
+ */
+#define ZYREX_STACK_CHECK_MAX_ADDRESSES 64
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Stack capture                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+#if defined(ZYAN_WINDOWS)
+
+/**
+ * @brief   Captures the code addresses a suspended thread might return to.
+ *
+ * @param   thread_handle   The handle of the suspended thread.
+ * @param   addresses       Receives the captured addresses. The buffer must be able to hold
+ *                          `ZYREX_STACK_CHECK_MAX_ADDRESSES` entries.
+ * @param   count           Receives the number of captured addresses.
+ *
+ * @return  `ZYREX_STATUS_UNSAFE_THREAD_STATE`, if the stack is too deep to be captured completely
+ *          or a zyan status code.
+ *
+ * See the Linux version of this function for details.
+ */
+ZyanStatus ZyrexCaptureThreadStack(HANDLE thread_handle, ZyanUPointer* addresses,
+    ZyanUSize* count);
+
+#elif defined(ZYAN_LINUX)
+
+/**
+ * @brief   Captures the code addresses a suspended thread might return to.
+ *
+ * @param   context     A pointer to the saved signal context of the suspended thread.
+ * @param   addresses   Receives the captured addresses. The buffer must be able to hold
+ *                      `ZYREX_STACK_CHECK_MAX_ADDRESSES` entries.
+ * @param   count       Receives the number of captured addresses.
+ *
+ * @return  `ZYREX_STATUS_UNSAFE_THREAD_STATE`, if the stack is too deep to be captured completely
+ *          or a zyan status code.
+ *
+ * The captured addresses are the instruction pointer, the value on top of the stack and the
+ * return addresses of the frame-pointer chain. The value on top of the stack covers functions
+ * that did not set up a frame yet. Values that are not return addresses might be reported as
+ * well, which only makes the check more conservative.
+ *
+ * The stack is read without dereferencing any pointers directly, so a corrupted or missing
+ * frame-pointer chain ends the walk instead of crashing. Return addresses of frames that do not
+ * maintain a frame pointer are not captured.
+ */
+ZyanStatus ZyrexCaptureThreadStack(const ucontext_t* context, ZyanUPointer* addresses,
+    ZyanUSize* count);
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_INTERNAL_STACK_CHECK_H */
@@ -0,0 +1,125 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#ifndef ZYREX_INTERNAL_THREAD_REGISTRY_H
+#define ZYREX_INTERNAL_THREAD_REGISTRY_H
+
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+#include <Zycore/Vector.h>
+#include <Zycore/API/Thread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexThreadCallback` function prototype.
+ *
+ * @param   thread_id   The native id of the thread.
+ * @param   context     A user-defined context pointer.
+ *
+ * @return  A zyan status code. Returning an error status stops the enumeration.
+ */
+typedef ZyanStatus (*ZyrexThreadCallback)(ZyanThreadId thread_id, void* context);
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread enumeration                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the native id of the calling thread.
+ *
+ * @return  The native id of the calling thread (the kernel thread id on Linux).
+ */
+ZyanThreadId ZyrexGetCurrentNativeThreadId(void);
+
+/**
+ * @brief   Enumerates all threads of the current process (including the calling one).
+ *
+ * @param   callback    The callback function that is invoked for each thread.
+ * @param   context     A user-defined context pointer that is passed to the callback.
+ *
+ * @return  A zyan status code.
+ *
+ * On Linux, no memory is allocated, which makes this function safe to use while other threads
+ * are suspended.
+ */
+ZyanStatus ZyrexEnumerateThreads(ZyrexThreadCallback callback, void* context);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread registry                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Acquires the thread registry, if it is enabled.
+ *
+ * @param   threads Receives a pointer to the vector of registered native thread ids. The vector
+ *                  can be modified until the registry is released.
+ *
+ * @return  `ZYAN_STATUS_TRUE`, if the registry was acquired, `ZYAN_STATUS_FALSE`, if the
+ *          registry is disabled or a generic zyan status code if an error occured.
+ *
+ * Threads that try to register or unregister themselves are blocked until the registry is
+ * released.
+ *
+ * Entries can be marked for removal by setting them to `0`, which does not reallocate the vector.
+ */
+ZyanStatus ZyrexThreadRegistryAcquire(ZyanVector** threads);
+
+/**
+ * @brief   Releases the thread registry.
+ *
+ * @return  A zyan status code.
+ *
+ * Entries that were marked for removal are deleted before the registry is released.
+ */
+ZyanStatus ZyrexThreadRegistryRelease(void);
+
+/**
+ * @brief   Disables the thread registry and releases all resources.
+ *
+ * @return  A zyan status code.
+ */
+ZyanStatus ZyrexThreadRegistryClear(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_INTERNAL_THREAD_REGISTRY_H */
@@ -0,0 +1,119 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#ifndef ZYREX_INTERNAL_THREAD_SUSPENSION_H
+#define ZYREX_INTERNAL_THREAD_SUSPENSION_H
+
+#include <Zycore/Defines.h>
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+#include <Zycore/API/Thread.h>
+#ifdef ZYAN_LINUX
+#   include <ucontext.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ZYAN_LINUX
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexSuspendedThread` struct.
+ */
+typedef struct ZyrexSuspendedThread_
+{
+    /**
+     * @brief   The kernel id of the suspended thread.
+     */
+    ZyanThreadId thread_id;
+    /**
+     * @brief   The saved signal context of the suspended thread.
+     *
+     * Changes to the context are applied when the thread is resumed.
+     */
+    ucontext_t* context;
+} ZyrexSuspendedThread;
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread suspension                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the kernel id of the calling thread.
+ *
+ * @return  The kernel id of the calling thread.
+ */
+ZyanThreadId ZyrexGetCurrentKernelThreadId(void);
+
+/**
+ * @brief   Suspends the thread with the given kernel id.
+ *
+ * @param   thread_id   The kernel id of the thread to suspend.
+ * @param   thread      Receives information about the suspended thread.
+ *
+ * @return  `ZYAN_STATUS_NOT_FOUND`, if the thread does not exist,
+ *          `ZYREX_STATUS_THREAD_NOT_SUSPENDED`, if the thread is alive but did not acknowledge the
+ *          request in time or a zyan status code.
+ *
+ * The thread is parked inside of a real-time signal handler until `ZyrexResumeThreads` is
+ * called. This function returns after the thread acknowledged the suspension request.
+ *
+ * Threads that block the suspend signal or sleep uninterruptibly for too long can not be
+ * suspended. They are never reported as exited.
+ *
+ * This function must not be used to suspend the calling thread.
+ */
+ZyanStatus ZyrexSuspendThread(ZyanThreadId thread_id, ZyrexSuspendedThread* thread);
+
+/**
+ * @brief   Resumes all threads that were suspended by `ZyrexSuspendThread`.
+ *
+ * @return  A zyan status code.
+ *
+ * All threads are released at once.
+ */
+ZyanStatus ZyrexResumeThreads(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_INTERNAL_THREAD_SUSPENSION_H */
@@ -29,6 +29,7 @@
 
 #include <Zycore/Types.h>
 #include <Zyrex/Status.h>
+#include <Zyrex/Transaction.h>
 #include <Zyrex/Internal/Utils.h>
 
 #ifdef __cplusplus
@@ -43,13 +44,13 @@ extern "C" {
  * @brief   Defines the maximum amount of instruction bytes that can be saved to a trampoline.
  *
  * This formula is based on the following edge case consideration:
- * - If `SIZEOF_SAVED_INSTRUCTIONS == SIZEOF_RELATIVE_JUMP - 1 == 4`
+ * - If `SIZEOF_SAVED_INSTRUCTIONS == MAX_PATCH_SIZE - 1`
  *   - We have to save exactly one additional instruction
- *   - We already saved 4 bytes
+ *   - We already saved `MAX_PATCH_SIZE - 1` bytes
  *   - The additional instructions maximum length is 15 bytes
  */
 #define ZYREX_TRAMPOLINE_MAX_CODE_SIZE \
-    (ZYDIS_MAX_INSTRUCTION_LENGTH + ZYREX_SIZEOF_RELATIVE_JUMP - 1)
+    (ZYDIS_MAX_INSTRUCTION_LENGTH + ZYREX_MAX_PATCH_SIZE - 1)
 
 /**
  * @brief   Defines an additional amount of bytes to reserve in the trampoline code buffer which
@@ -69,7 +70,7 @@ extern "C" {
  * @brief   Defines the maximum amount of instructions that can be saved to a trampoline.
  */
 #define ZYREX_TRAMPOLINE_MAX_INSTRUCTION_COUNT \
-    (ZYREX_SIZEOF_RELATIVE_JUMP)
+    (ZYREX_MAX_PATCH_SIZE)
 
 /**
  * @brief   Defines an additional amount of slots to reserve in the instruction translation map
@@ -78,6 +79,10 @@ extern "C" {
 #define ZYREX_TRAMPOLINE_MAX_INSTRUCTION_COUNT_BONUS \
     2
 
+#if (ZYREX_MAX_PATCH_SIZE < ZYREX_DEFAULT_PATCH_SIZE) || (ZYREX_MAX_PATCH_SIZE > 64)
+#   error "ZYREX_MAX_PATCH_SIZE must be in the range of ZYREX_DEFAULT_PATCH_SIZE to 64"
+#endif
+
 /**
  * @brief   Defines the trampoline region signature.
  *
@@ -89,6 +94,49 @@ extern "C" {
 /* Enums and types                                                                                */
 /* ============================================================================================== */
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Patch site                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexPatchSiteType` enum.
+ */
+typedef enum ZyrexPatchSiteType_
+{
+    /**
+     * @brief   The hook jump overwrites the function prologue, which gets relocated to the
+     *          trampoline.
+     */
+    ZYREX_PATCH_SITE_TYPE_DEFAULT,
+    /**
+     * @brief   The hook jump overwrites a NOP sled at the function entry (e.g. emitted by
+     *          `-fpatchable-function-entry` or `-mnop-mcount`).
+     *
+     * No code is relocated and the trampoline consists of a single jump to the original function
+     * body.
+     */
+    ZYREX_PATCH_SITE_TYPE_NOP,
+    /**
+     * @brief   The hook jump overwrites a profiling call at the function entry (e.g.
+     *          `call __fentry__` emitted by `-mfentry`).
+     *
+     * No code is relocated. If the call targets an empty stub, the trampoline consists of a
+     * single jump to the original function body and the stub is skipped while the hook is
+     * active. Otherwise the trampoline pushes the address of the original function body and
+     * jumps to the profiling function, which returns to the function body instead of the
+     * trampoline.
+     */
+    ZYREX_PATCH_SITE_TYPE_PROFILING_CALL,
+    /**
+     * @brief   The hook jump is written to the NOP padding in front of the function entry and
+     *          reached by a short jump that overwrites a NOP at the function entry.
+     *
+     * No code is relocated and the trampoline consists of a single jump to the original function
+     * body.
+     */
+    ZYREX_PATCH_SITE_TYPE_NOP_PADDING
+} ZyrexPatchSiteType;
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Translation map                                                                                */
 /* ---------------------------------------------------------------------------------------------- */
@@ -155,6 +203,37 @@ typedef struct ZyrexInstructionTranslationMap_
 /* Trampoline chunk                                                                               */
 /* ---------------------------------------------------------------------------------------------- */
 
+/**
+ * @brief   Defines the `ZyrexTrampolineCallback` struct.
+ *
+ * The callback data of every trampoline chunk lives in the callback table of its region, which
+ * stays writable all the time. This allows to exchange the callback function without changing
+ * the protection of the executable memory.
+ */
+typedef struct ZyrexTrampolineCallback_
+{
+    /**
+     * @brief   The address the callback jump redirects to.
+     *
+     * This is either the address of the user callback function or the address of the code
+     * buffer, if the hook is disabled.
+     */
+    ZyanUPointer callback_address;
+    /**
+     * @brief   The address of the user callback function.
+     */
+    ZyanUPointer user_callback_address;
+    /**
+     * @brief   Signals, if the hook jump redirects to the user callback function directly
+     *          instead of the callback jump.
+     *
+     * The hook jump has to be redirected to the callback jump, before the callback of such a
+     * hook can be exchanged or the hook can be disabled. This flag is cleared afterwards and
+     * never set again.
+     */
+    ZyanBool is_direct;
+} ZyrexTrampolineCallback;
+
 /**
  * @brief   Defines the `ZyrexTrampolineChunk` struct.
  */
@@ -165,21 +244,23 @@ typedef struct ZyrexTrampolineChunk_
      */
     ZyanBool is_used;
     /**
-     * @brief   The address of the callback function.
+     * @brief   A pointer to the callback data of the trampoline chunk.
      */
-    ZyanUPointer callback_address;
-
-#if defined(ZYAN_X64)
-
+    ZyrexTrampolineCallback* callback;
     /**
      * @brief   The absolute jump to the callback function.
+     *
+     * The hook jump redirects to this instruction, unless `callback->is_direct` is set, which
+     * allows to exchange the callback function by atomically updating
+     * `callback->callback_address`.
      */
     ZyanU8 callback_jump[ZYREX_SIZEOF_ABSOLUTE_JUMP];
 
-#endif
-
     /**
      * @brief   The backjump address.
+     *
+     * The backjump is encoded as a direct relative jump, if the address is within reach. This
+     * field is only read by the backjump, if an absolute jump had to be used instead.
      */
     ZyanUPointer backjump_address;
     /**
@@ -204,8 +285,77 @@ typedef struct ZyrexTrampolineChunk_
      * @brief   The number of instruction bytes saved from the hooked function.
      */
     ZyanU8 original_code_size;
+    /**
+     * @brief   The size of the patch window that is overwritten by the hook jump.
+     */
+    ZyanU8 patch_size;
+    /**
+     * @brief   The type of the patch site.
+     */
+    ZyrexPatchSiteType patch_site_type;
+    /**
+     * @brief   The offset of the function entry relative to the first byte of the patched code.
+     *
+     * This value is `0` for most patch sites, negative if the patched code starts behind the
+     * function entry (e.g. after an `ENDBR64` instruction) and positive if the patched code
+     * starts in front of the function entry.
+     */
+    ZyanI8 entry_offset;
 } ZyrexTrampolineChunk;
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Trampoline analysis                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexTrampolineAnalysis` struct.
+ *
+ * Contains all information about a target function that is required to place and initialize a
+ * trampoline chunk for it.
+ */
+typedef struct ZyrexTrampolineAnalysis_
+{
+    /**
+     * @brief   The address of the function to create the trampoline for.
+     */
+    const void* address;
+    /**
+     * @brief   The maximum amount of bytes that can be safely read from `address`.
+     */
+    ZyanUSize source_size;
+    /**
+     * @brief   The minimum amount of bytes that need to be relocated to the trampoline.
+     */
+    ZyanUSize min_bytes_to_reloc;
+    /**
+     * @brief   The lowest address the trampoline chunk needs to reach using a relative offset.
+     */
+    ZyanUPointer address_lo;
+    /**
+     * @brief   The highest address the trampoline chunk needs to reach using a relative offset.
+     */
+    ZyanUPointer address_hi;
+    /**
+     * @brief   The type of the patch site.
+     */
+    ZyrexPatchSiteType patch_site_type;
+    /**
+     * @brief   The address of the first byte of code that gets overwritten by the hook.
+     */
+    const void* patch_address;
+    /**
+     * @brief   The number of bytes that get saved from the patch site, if the patch site is not of
+     *          type `ZYREX_PATCH_SITE_TYPE_DEFAULT`.
+     */
+    ZyanUSize patch_size;
+    /**
+     * @brief   The target of the profiling call that is preserved by the trampoline, if the patch
+     *          site is of type `ZYREX_PATCH_SITE_TYPE_PROFILING_CALL`, or `0`, if the call is
+     *          skipped.
+     */
+    ZyanUPointer profiling_call_target;
+} ZyrexTrampolineAnalysis;
+
 /* ---------------------------------------------------------------------------------------------- */
 
 /* ============================================================================================== */
@@ -233,6 +383,69 @@ typedef struct ZyrexTrampolineChunk_
 ZyanStatus ZyrexTrampolineCreate(const void* address, const void* callback,
     ZyanUSize min_bytes_to_reloc, ZyrexTrampolineChunk** trampoline);
 
+/**
+ * @brief   Analyzes the target function and gathers all information required to place a new
+ *          trampoline chunk.
+ *
+ * @param   address             The address of the function to create the trampoline for.
+ * @param   min_bytes_to_reloc  Specifies the minimum amount of bytes that need to be relocated
+ *                              to the trampoline.
+ * @param   analysis            Receives the analysis result.
+ *
+ * @return  A zyan status code.
+ *
+ * This function does not access any global state and is safe to be called concurrently.
+ */
+ZyanStatus ZyrexTrampolineAnalyze(const void* address, ZyanUSize min_bytes_to_reloc,
+    ZyrexTrampolineAnalysis* analysis);
+
+/**
+ * @brief   Reserves an unused trampoline chunk that satisfies the range requirements of the given
+ *          `analysis`.
+ *
+ * @param   analysis    A pointer to the `ZyrexTrampolineAnalysis` struct.
+ * @param   trampoline  Receives the reserved trampoline chunk.
+ *
+ * @return  A zyan status code.
+ *
+ * The chunk is marked as used, but not initialized. Use `ZyrexTrampolineFree` to release a
+ * reservation that is no longer needed.
+ */
+ZyanStatus ZyrexTrampolineReserve(const ZyrexTrampolineAnalysis* analysis,
+    ZyrexTrampolineChunk** trampoline);
+
+/**
+ * @brief   Initializes a trampoline chunk in a private `buffer` and relocates the instructions
+ *          from the original function.
+ *
+ * @param   buffer      A pointer to the private buffer that receives the chunk data.
+ * @param   trampoline  The runtime address of the (reserved) trampoline chunk. Relative offsets
+ *                      are calculated against this address.
+ * @param   analysis    A pointer to the `ZyrexTrampolineAnalysis` struct.
+ * @param   callback    The address of the callback function the hook will redirect to.
+ *
+ * @return  A zyan status code.
+ *
+ * This function does not access any global state and is safe to be called concurrently. The
+ * buffer has to be published to the trampoline chunk using `ZyrexTrampolinePublish` afterwards.
+ */
+ZyanStatus ZyrexTrampolineInit(ZyrexTrampolineChunk* buffer,
+    const ZyrexTrampolineChunk* trampoline, const ZyrexTrampolineAnalysis* analysis,
+    const void* callback);
+
+/**
+ * @brief   Copies the data from the given private `buffer` to the trampoline chunk.
+ *
+ * @param   trampoline  The (reserved) trampoline chunk.
+ * @param   buffer      A pointer to the private buffer initialized by `ZyrexTrampolineInit`.
+ *
+ * @return  A zyan status code.
+ *
+ * The chunk is written through the active code writer backend.
+ */
+ZyanStatus ZyrexTrampolinePublish(ZyrexTrampolineChunk* trampoline,
+    const ZyrexTrampolineChunk* buffer);
+
 /**
  * @brief   Destroys the given trampoline.
  *
@@ -242,6 +455,73 @@ ZyanStatus ZyrexTrampolineCreate(const void* address, const void* callback,
  */
 ZyanStatus ZyrexTrampolineFree(ZyrexTrampolineChunk* trampoline);
 
+/**
+ * @brief   Atomically exchanges the callback function of the given trampoline chunk.
+ *
+ * @param   trampoline  A pointer to the trampoline chunk.
+ * @param   callback    The address of the new callback function.
+ *
+ * @return  A zyan status code.
+ *
+ * Threads that execute the hook jump after this function returned are redirected to the new
+ * callback function. No code is modified. If the hook is disabled, the new callback function
+ * takes effect as soon as the hook is enabled again.
+ *
+ * Returns `ZYAN_STATUS_INVALID_OPERATION`, if the hook jump still redirects to the callback
+ * directly.
+ */
+ZyanStatus ZyrexTrampolineSetCallback(ZyrexTrampolineChunk* trampoline, const void* callback);
+
+/**
+ * @brief   Atomically enables or disables the given trampoline chunk.
+ *
+ * @param   trampoline  A pointer to the trampoline chunk.
+ * @param   enable      `ZYAN_TRUE` to redirect the hook jump to the user callback function or
+ *                      `ZYAN_FALSE` to redirect it to the code buffer.
+ *
+ * @return  A zyan status code.
+ *
+ * A disabled hook passes all calls straight through to the original function. No code is
+ * modified.
+ *
+ * Returns `ZYAN_STATUS_INVALID_OPERATION`, if the hook jump still redirects to the callback
+ * directly.
+ */
+ZyanStatus ZyrexTrampolineSetEnabled(ZyrexTrampolineChunk* trampoline, ZyanBool enable);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Information                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the address of the first byte of code that gets overwritten by the hook.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ *
+ * @return  The address of the first byte of code that gets overwritten by the hook.
+ */
+ZYAN_INLINE void* ZyrexTrampolineGetPatchAddress(const ZyrexTrampolineChunk* trampoline)
+{
+    ZYAN_ASSERT(trampoline);
+
+    return (void*)(trampoline->backjump_address - trampoline->original_code_size);
+}
+
+/**
+ * @brief   Returns the address of the hooked function.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ *
+ * @return  The address of the hooked function.
+ */
+ZYAN_INLINE void* ZyrexTrampolineGetTargetAddress(const ZyrexTrampolineChunk* trampoline)
+{
+    ZYAN_ASSERT(trampoline);
+
+    return (void*)((ZyanIPointer)ZyrexTrampolineGetPatchAddress(trampoline) +
+        trampoline->entry_offset);
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Searching                                                                                      */
 /* ---------------------------------------------------------------------------------------------- */
@@ -0,0 +1,95 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#ifndef ZYREX_INTERNAL_TRANSACTION_H
+#define ZYREX_INTERNAL_TRANSACTION_H
+
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+#include <Zyrex/Transaction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexApplyResult` struct.
+ */
+typedef struct ZyrexApplyResult_
+{
+    /**
+     * @brief   The status code of the transaction.
+     */
+    ZyanStatus status;
+    /**
+     * @brief   The trampoline address of the operation that failed the transaction or
+     *          `ZYAN_NULL`.
+     */
+    const void* failed_operation;
+    /**
+     * @brief   The number of operations that were applied.
+     */
+    ZyanUSize applied_count;
+} ZyrexApplyResult;
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transaction objects                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Applies multiple transactions using a single patch phase.
+ *
+ * @param   transactions    A pointer to an array of transaction objects.
+ * @param   count           The number of elements in the `transactions` array.
+ * @param   results         A pointer to an array of `count` `ZyrexApplyResult` structs that
+ *                          receives the result of each individual transaction.
+ *
+ * @return  A zyan status code.
+ *
+ * The threads of all transactions are suspended and resumed once. Each transaction is committed
+ * on its own, which means a transaction that fails the code verification does not affect the
+ * other ones. The same transaction object must not be passed more than once.
+ */
+ZyanStatus ZyrexTransactionApplyMultiple(ZyrexTransaction* const* transactions, ZyanUSize count,
+    ZyrexApplyResult* results);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_INTERNAL_TRANSACTION_H */
@@ -28,9 +28,15 @@
 #define ZYREX_INTERNAL_UTILS_H
 
 #include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
 #include <Zycore/Types.h>
+#include <Zycore/API/Thread.h>
 #include <Zydis/Zydis.h>
 
+#if defined(ZYAN_MSVC)
+#   include <intrin.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -43,6 +49,11 @@ extern "C" {
 /* Constants                                                                                      */
 /* ---------------------------------------------------------------------------------------------- */
 
+/**
+ * @brief   The size of the short relative jump instruction (in bytes).
+ */
+#define ZYREX_SIZEOF_SHORT_JUMP         2
+
 /**
  * @brief   The size of the relative jump instruction (in bytes).
  */
@@ -53,11 +64,41 @@ extern "C" {
  */
 #define ZYREX_SIZEOF_ABSOLUTE_JUMP      6
 
+/**
+ * @brief   The size of the absolute jump instruction with an inline destination address
+ *          (in bytes).
+ */
+#define ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP \
+    (ZYREX_SIZEOF_ABSOLUTE_JUMP + sizeof(ZyanUPointer))
+
 /**
  * @brief   The target range of the relative jump instruction.
  */
 #define ZYREX_RANGEOF_RELATIVE_JUMP     0x7FFFFFFF
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Spin lock                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines an initializer for the `ZyrexSpinLock` type.
+ */
+#define ZYREX_SPIN_LOCK_INITIALIZER     0
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexSpinLock` type.
+ *
+ * A spin lock does not require any initialization at runtime, which makes it suitable for
+ * protecting lazily initialized global data.
+ */
+typedef volatile ZyanUPointer ZyrexSpinLock;
+
 /* ---------------------------------------------------------------------------------------------- */
 
 /* ============================================================================================== */
@@ -84,6 +125,41 @@ ZYAN_INLINE ZyanI32 ZyrexCalculateRelativeOffset(ZyanU8 instruction_length,
     return (ZyanI32)(destination_address - source_address - instruction_length);    
 }
 
+/**
+ * @brief   Parses a hexadecimal number.
+ *
+ * @param   buffer  A pointer to the buffer.
+ * @param   length  The length of the buffer.
+ * @param   offset  The offset of the number. Receives the offset of the first character after the
+ *                  number.
+ *
+ * @return  The parsed number.
+ */
+ZYAN_INLINE ZyanUPointer ZyrexParseHexNumber(const char* buffer, ZyanUSize length,
+    ZyanUSize* offset)
+{
+    ZYAN_ASSERT(buffer);
+    ZYAN_ASSERT(offset);
+
+    ZyanUPointer value = 0;
+    for (; *offset < length; ++*offset)
+    {
+        const char c = buffer[*offset];
+        if ((c >= '0') && (c <= '9'))
+        {
+            value = (value << 4) | (ZyanUPointer)(c - '0');
+        } else if ((c >= 'a') && (c <= 'f'))
+        {
+            value = (value << 4) | (ZyanUPointer)(c - 'a' + 10);
+        } else
+        {
+            break;
+        }
+    }
+
+    return value;
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Jumps                                                                                          */
 /* ---------------------------------------------------------------------------------------------- */
@@ -125,6 +201,23 @@ ZYAN_INLINE void ZyrexWriteAbsoluteJump(void* address, ZyanUPointer destination)
 #endif
 }
 
+/**
+ * @brief   Writes an absolute indirect jump instruction at the given `address`, directly
+ *          followed by the absolute destination address.
+ *
+ * @param   address     The jump address.
+ * @param   destination The absolute destination address of the jump.
+ *
+ * This function writes `ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP` bytes in total.
+ */
+ZYAN_INLINE void ZyrexWriteInlineAbsoluteJump(void* address, ZyanUPointer destination)
+{
+    ZyanU8* const instr = (ZyanU8*)address;
+
+    ZyrexWriteAbsoluteJump(instr, (ZyanUPointer)(instr + ZYREX_SIZEOF_ABSOLUTE_JUMP));
+    ZYAN_MEMCPY(instr + ZYREX_SIZEOF_ABSOLUTE_JUMP, &destination, sizeof(destination));
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Instruction decoding                                                                           */
 /* ---------------------------------------------------------------------------------------------- */
@@ -198,6 +291,187 @@ ZYAN_INLINE ZyanStatus ZyrexCalcAbsoluteAddress(const ZydisDecodedInstruction* i
     ZYAN_UNREACHABLE;
 }
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Atomic operations                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Atomically adds `value` to the pointer-sized integer at the given `destination`.
+ *
+ * @param   destination A pointer to the destination value.
+ * @param   value       The value to add.
+ *
+ * @return  The value of `destination` before the operation.
+ */
+ZYAN_INLINE ZyanUPointer ZyrexAtomicFetchAdd(volatile ZyanUPointer* destination,
+    ZyanUPointer value)
+{
+#if defined(ZYAN_MSVC) && defined(ZYAN_X64)
+    return (ZyanUPointer)_InterlockedExchangeAdd64((volatile __int64*)destination,
+        (__int64)value);
+#elif defined(ZYAN_MSVC)
+    return (ZyanUPointer)_InterlockedExchangeAdd((volatile long*)destination, (long)value);
+#else
+    return __atomic_fetch_add(destination, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief   Atomically reads the pointer-sized integer at the given `source`.
+ *
+ * @param   source  A pointer to the source value.
+ *
+ * @return  The value of `source`.
+ */
+ZYAN_INLINE ZyanUPointer ZyrexAtomicLoad(const volatile ZyanUPointer* source)
+{
+#if defined(ZYAN_MSVC)
+    const ZyanUPointer value = *source;
+    _ReadWriteBarrier();
+    return value;
+#else
+    return __atomic_load_n(source, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief   Atomically writes `value` to the pointer-sized integer at the given `destination`.
+ *
+ * @param   destination A pointer to the destination value.
+ * @param   value       The value to write.
+ */
+ZYAN_INLINE void ZyrexAtomicStore(volatile ZyanUPointer* destination, ZyanUPointer value)
+{
+#if defined(ZYAN_MSVC) && defined(ZYAN_X64)
+    _InterlockedExchange64((volatile __int64*)destination, (__int64)value);
+#elif defined(ZYAN_MSVC)
+    _InterlockedExchange((volatile long*)destination, (long)value);
+#else
+    __atomic_store_n(destination, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief   Atomically replaces the pointer-sized integer at the given `destination` with `value`,
+ *          if it equals `comparand`.
+ *
+ * @param   destination A pointer to the destination value.
+ * @param   comparand   The value to compare with.
+ * @param   value       The value to write.
+ *
+ * @return  The value of `destination` before the operation.
+ */
+ZYAN_INLINE ZyanUPointer ZyrexAtomicCompareExchange(volatile ZyanUPointer* destination,
+    ZyanUPointer comparand, ZyanUPointer value)
+{
+#if defined(ZYAN_MSVC) && defined(ZYAN_X64)
+    return (ZyanUPointer)_InterlockedCompareExchange64((volatile __int64*)destination,
+        (__int64)value, (__int64)comparand);
+#elif defined(ZYAN_MSVC)
+    return (ZyanUPointer)_InterlockedCompareExchange((volatile long*)destination, (long)value,
+        (long)comparand);
+#else
+    __atomic_compare_exchange_n(destination, &comparand, value, ZYAN_FALSE, __ATOMIC_SEQ_CST,
+        __ATOMIC_SEQ_CST);
+    return comparand;
+#endif
+}
+
+/**
+ * @brief   Atomically reads the 64-bit integer at the given `source`.
+ *
+ * @param   source  A pointer to the source value. Must be aligned to 8 bytes.
+ *
+ * @return  The value of `source`.
+ */
+ZYAN_INLINE ZyanU64 ZyrexAtomicLoad64(const volatile ZyanU64* source)
+{
+    ZYAN_ASSERT(ZYAN_IS_ALIGNED_TO((ZyanUPointer)source, 8));
+
+#if defined(ZYAN_MSVC)
+    return (ZyanU64)_InterlockedCompareExchange64((volatile __int64*)source, 0, 0);
+#else
+    return __atomic_load_n(source, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief   Atomically writes `value` to the 64-bit integer at the given `destination`.
+ *
+ * @param   destination A pointer to the destination value. Must be aligned to 8 bytes.
+ * @param   value       The value to write.
+ */
+ZYAN_INLINE void ZyrexAtomicStore64(volatile ZyanU64* destination, ZyanU64 value)
+{
+    ZYAN_ASSERT(ZYAN_IS_ALIGNED_TO((ZyanUPointer)destination, 8));
+
+#if defined(ZYAN_MSVC)
+    __int64 expected = *(volatile __int64*)destination;
+    while (ZYAN_TRUE)
+    {
+        const __int64 previous = 
+            _InterlockedCompareExchange64((volatile __int64*)destination, (__int64)value, 
+                expected);
+        if (previous == expected)
+        {
+            break;
+        }
+        expected = previous;
+    }
+#else
+    __atomic_store_n(destination, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Spin lock                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Acquires the given spin lock.
+ *
+ * @param   lock    A pointer to the `ZyrexSpinLock`.
+ *
+ * The calling thread yields its time slice while the lock is held by another thread. The lock is
+ * not recursive.
+ */
+ZYAN_INLINE void ZyrexSpinLockAcquire(ZyrexSpinLock* lock)
+{
+    ZYAN_ASSERT(lock);
+
+    while (ZyrexAtomicCompareExchange(lock, 0, 1) != 0)
+    {
+        ZyanThreadYield();
+    }
+}
+
+/**
+ * @brief   Tries to acquire the given spin lock without blocking.
+ *
+ * @param   lock    A pointer to the `ZyrexSpinLock`.
+ *
+ * @return  `ZYAN_TRUE`, if the lock was acquired or `ZYAN_FALSE`, if it is held by another
+ *          thread.
+ */
+ZYAN_INLINE ZyanBool ZyrexSpinLockTryAcquire(ZyrexSpinLock* lock)
+{
+    ZYAN_ASSERT(lock);
+
+    return (ZyrexAtomicCompareExchange(lock, 0, 1) == 0) ? ZYAN_TRUE : ZYAN_FALSE;
+}
+
+/**
+ * @brief   Releases the given spin lock.
+ *
+ * @param   lock    A pointer to the `ZyrexSpinLock`.
+ */
+ZYAN_INLINE void ZyrexSpinLockRelease(ZyrexSpinLock* lock)
+{
+    ZYAN_ASSERT(lock);
+
+    ZyrexAtomicStore(lock, 0);
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 
 /* ============================================================================================== */
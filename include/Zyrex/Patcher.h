@@ -0,0 +1,146 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Asynchronous transaction commit on a dedicated patcher thread.
+ */
+
+#ifndef ZYREX_PATCHER_H
+#define ZYREX_PATCHER_H
+
+#include <ZyrexExportConfig.h>
+#include <Zycore/Status.h>
+#include <Zycore/Types.h>
+#include <Zyrex/Transaction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Completion                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexCompletion` type.
+ *
+ * A completion handle tracks a transaction that was queued for asynchronous commit.
+ */
+typedef struct ZyrexCompletion_ ZyrexCompletion;
+
+/**
+ * @brief   Defines the `ZyrexCompletionCallback` function prototype.
+ *
+ * @param   transaction         A pointer to the transaction object.
+ * @param   status              The status code of the commit.
+ * @param   failed_operation    The trampoline address of the operation that failed the
+ *                              transaction or `ZYAN_NULL`.
+ * @param   context             A user-defined context pointer.
+ *
+ * The callback is invoked on the patcher thread after all threads were resumed. The patcher does
+ * not access the transaction object anymore, which allows the callback to reuse or destroy it.
+ */
+typedef void (*ZyrexCompletionCallback)(ZyrexTransaction* transaction, ZyanStatus status,
+    const void* failed_operation, void* context);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Asynchronous commit                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Queues the given transaction for asynchronous commit.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   callback    An optional callback that is invoked when the transaction was applied.
+ * @param   context     A user-defined context pointer that is passed to the callback.
+ * @param   completion  Receives a new completion handle. This parameter is optional. The handle
+ *                      has to be destroyed using `ZyrexCompletionDestroy`.
+ *
+ * @return  A zyan status code.
+ *
+ * The transaction is applied by an internal patcher thread, which is started on first use. The
+ * calling thread does not wait for the suspend/patch/resume cycle. All transactions that are
+ * queued while the patcher thread is busy are applied together, suspending all threads only once.
+ *
+ * The transaction object must not be accessed until the commit completed. Afterwards it is in the
+ * same state as after calling `ZyrexTransactionApply`.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionApplyAsync(ZyrexTransaction* transaction,
+    ZyrexCompletionCallback callback, void* context, ZyrexCompletion** completion);
+
+/**
+ * @brief   Checks, if the transaction of the given completion handle was applied.
+ *
+ * @param   completion  A pointer to the completion handle.
+ *
+ * @return  `ZYAN_STATUS_TRUE`, if the transaction was applied, `ZYAN_STATUS_FALSE`, if not, or a
+ *          generic zyan status code.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexCompletionPoll(const ZyrexCompletion* completion);
+
+/**
+ * @brief   Waits until the transaction of the given completion handle was applied.
+ *
+ * @param   completion          A pointer to the completion handle.
+ * @param   failed_operation    Receives the trampoline address of the operation that failed the
+ *                              transaction or `ZYAN_NULL`. This parameter is optional.
+ *
+ * @return  The status code of the commit or a generic zyan status code.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexCompletionWait(ZyrexCompletion* completion,
+    const void** failed_operation);
+
+/**
+ * @brief   Destroys the given completion handle.
+ *
+ * @param   completion  A pointer to the completion handle.
+ *
+ * @return  A zyan status code.
+ *
+ * This function waits for the transaction to be applied.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexCompletionDestroy(ZyrexCompletion* completion);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZYREX_PATCHER_H */
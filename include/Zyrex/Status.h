@@ -61,6 +61,34 @@ extern "C" {
 #define ZYREX_STATUS_COULD_NOT_ALLOCATE_TRAMPOLINE \
     ZYAN_MAKE_STATUS(1, ZYAN_MODULE_ZYDIS, 0x00)
 
+/**
+ * @brief   The patch window contains a branch target or exceeds the bounds of the target
+ *          function.
+ */
+#define ZYREX_STATUS_UNSAFE_PATCH_WINDOW \
+    ZYAN_MAKE_STATUS(1, ZYAN_MODULE_ZYREX, 0x01)
+
+/**
+ * @brief   The code at the target address was modified after the hook was added to the
+ *          transaction.
+ */
+#define ZYREX_STATUS_CODE_MODIFIED \
+    ZYAN_MAKE_STATUS(1, ZYAN_MODULE_ZYREX, 0x02)
+
+/**
+ * @brief   A suspended thread is executing or returns into code that is retired by the
+ *          transaction.
+ */
+#define ZYREX_STATUS_UNSAFE_THREAD_STATE \
+    ZYAN_MAKE_STATUS(1, ZYAN_MODULE_ZYREX, 0x03)
+
+/**
+ * @brief   A thread that is still alive did not acknowledge the suspension request (e.g. because
+ *          it blocks the suspend signal).
+ */
+#define ZYREX_STATUS_THREAD_NOT_SUSPENDED \
+    ZYAN_MAKE_STATUS(1, ZYAN_MODULE_ZYREX, 0x04)
+
 /* ---------------------------------------------------------------------------------------------- */
 
 /* ============================================================================================== */
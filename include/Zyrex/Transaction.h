@@ -36,6 +36,28 @@
 extern "C" {
 #endif
 
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the default size of the patch window (in bytes).
+ *
+ * The patch window is the range of bytes at the hooked address that gets overwritten by the hook
+ * jump. The default size fits a relative `JMP` instruction.
+ */
+#define ZYREX_DEFAULT_PATCH_SIZE    5
+
+/**
+ * @brief   Defines the maximum size of the patch window (in bytes).
+ *
+ * This value determines the size of the instruction buffers in each trampoline chunk and can be
+ * overridden at compile time.
+ */
+#ifndef ZYREX_MAX_PATCH_SIZE
+#   define ZYREX_MAX_PATCH_SIZE     16
+#endif
+
 /* ============================================================================================== */
 /* Enums and types                                                                                */
 /* ============================================================================================== */
@@ -74,9 +96,80 @@ typedef enum ZyrexHookType_
      *
      * This hook
      */
-    ZYREX_HOOK_TYPE_CONTEXT
+    ZYREX_HOOK_TYPE_CONTEXT,
+    /**
+     * @brief   Call-site hook.
+     *
+     * The call-site hook rewrites the displacement of a single `call rel32` or `jmp rel32`
+     * instruction to redirect code-flow to the callback function. The original branch target
+     * serves as the trampoline. Other callers of the target function are not affected.
+     */
+    ZYREX_HOOK_TYPE_CALL_SITE,
+    /**
+     * @brief   Replacement hook.
+     *
+     * The replacement hook overwrites the begin of the target function with a jump to the
+     * replacement function. The original function can not be called anymore, which allows to
+     * skip the relocation of its prologue and the allocation of a trampoline.
+     */
+    ZYREX_HOOK_TYPE_REPLACEMENT
 } ZyrexHookType;
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Patch mode                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexPatchMode` enum.
+ */
+typedef enum ZyrexPatchMode_
+{
+    /**
+     * @brief   The hooked code is overwritten directly.
+     *
+     * This mode is only safe, if all threads that might execute the hooked code were added to
+     * the thread-update list of the transaction.
+     */
+    ZYREX_PATCH_MODE_SUSPEND,
+    /**
+     * @brief   The hooked code is overwritten using a transient `INT3` breakpoint.
+     *
+     * This mode does not require any threads to be suspended. Threads that hit the transient
+     * breakpoint are redirected to the hook (or the original code) by a breakpoint handler.
+     *
+     * Hooks whose patch window spans more than a single original instruction fall back to
+     * `ZYREX_PATCH_MODE_SUSPEND`, as threads might be executing any of the overwritten
+     * instructions. The commit fails with `ZYAN_STATUS_INVALID_OPERATION` for such hooks, if no
+     * threads were added to the transaction.
+     */
+    ZYREX_PATCH_MODE_BREAKPOINT
+} ZyrexPatchMode;
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Code writer backend                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexCodeWriterBackend` enum.
+ */
+typedef enum ZyrexCodeWriterBackend_
+{
+    /**
+     * @brief   The affected pages are made writable before the code is written and their original
+     *          protection is restored afterwards.
+     */
+    ZYREX_CODE_WRITER_BACKEND_PROTECT,
+    /**
+     * @brief   The code is written through the `/proc/self/mem` file, which bypasses the page
+     *          protection without changing it.
+     *
+     * This backend does not split mappings, does not require any `mprotect` calls and works
+     * under policies that forbid writable and executable mappings. It is only supported on
+     * Linux.
+     */
+    ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY
+} ZyrexCodeWriterBackend;
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Hook                                                                                           */
 /* ---------------------------------------------------------------------------------------------- */
@@ -99,6 +192,125 @@ typedef struct ZyrexHook_
     void* address;
 } ZyrexHook;
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook specification                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexInlineHookFlags` enum.
+ */
+typedef enum ZyrexInlineHookFlags_
+{
+    /**
+     * @brief   No flags.
+     */
+    ZYREX_INLINE_HOOK_FLAG_NONE             = 0,
+    /**
+     * @brief   The hook jump has to redirect to the callback function directly.
+     *
+     * By default, the hook jump redirects to the callback function directly, if it is within
+     * reach, which saves an indirect branch on every call of the hooked function. With this flag,
+     * the hook can not be added and `ZYAN_STATUS_OUT_OF_RANGE` is returned instead of falling
+     * back to the callback jump of the trampoline.
+     *
+     * On x64, the callback is within reach, if it is located within +/-2GiB of the patch
+     * address or the patch window is large enough for an absolute jump.
+     */
+    ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK  = 1 << 0,
+    /**
+     * @brief   The hook jump always redirects to the callback jump of the trampoline.
+     *
+     * The first call to `ZyrexSetInlineHookEnabled` or `ZyrexSetInlineHookCallback` for a hook
+     * that redirects to its callback directly rewrites the hook jump while other threads might
+     * execute it. Hooks that are toggled or exchange their callback right away should pass this
+     * flag to avoid that. Hooks of a hook chain always use the callback jump.
+     *
+     * This flag can not be combined with `ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK`.
+     */
+    ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP    = 1 << 1
+} ZyrexInlineHookFlags;
+
+/**
+ * @brief   Defines the `ZyrexHookSpec` struct.
+ *
+ * Describes a single inline hook to be installed by `ZyrexInstallInlineHooks`.
+ */
+typedef struct ZyrexHookSpec_
+{
+    /**
+     * @brief   The address to hook.
+     */
+    void* address;
+    /**
+     * @brief   The callback address.
+     */
+    const void* callback;
+    /**
+     * @brief   Receives the address of the trampoline to the original function, if the
+     *          operation succeeded.
+     */
+    ZyanConstVoidPointer* trampoline;
+    /**
+     * @brief   The size of the patch window or `0` to use `ZYREX_DEFAULT_PATCH_SIZE`.
+     */
+    ZyanUSize patch_size;
+    /**
+     * @brief   A combination of `ZyrexInlineHookFlags` values.
+     */
+    ZyanU32 flags;
+} ZyrexHookSpec;
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transaction statistics                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexTransactionStatistics` struct.
+ */
+typedef struct ZyrexTransactionStatistics_
+{
+    /**
+     * @brief   The maximum number of threads that were suspended at once during the transaction.
+     */
+    ZyanUSize thread_count;
+    /**
+     * @brief   The total time between the suspension of the first thread and the resumption of
+     *          all threads of every pause (in nanoseconds).
+     */
+    ZyanU64 pause_time;
+    /**
+     * @brief   The number of pauses the transaction was committed in.
+     */
+    ZyanUSize slice_count;
+    /**
+     * @brief   The duration of the longest pause (in nanoseconds).
+     */
+    ZyanU64 max_pause_time;
+} ZyrexTransactionStatistics;
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transaction                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the opaque `ZyrexTransaction` type.
+ *
+ * A transaction object collects hook operations independently of all other transactions. Only
+ * the final patch phase of `ZyrexTransactionApply` is serialized with other transactions.
+ */
+typedef struct ZyrexTransaction_ ZyrexTransaction;
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Replacement hook                                                                               */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the opaque `ZyrexReplacementHook` type.
+ *
+ * Holds the original bytes of a replaced function, which are required to remove the hook.
+ */
+typedef struct ZyrexReplacementHook_ ZyrexReplacementHook;
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Hook operation                                                                                 */
 /* ---------------------------------------------------------------------------------------------- */
@@ -109,34 +321,226 @@ typedef struct ZyrexHook_
 /* Exported functions                                                                             */
 /* ============================================================================================== */
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Configuration                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Enables or disables the validation of patch windows.
+ *
+ * @param   enable  `ZYAN_TRUE` to enable validation or `ZYAN_FALSE` to disable it.
+ *
+ * @return  A zyan status code.
+ *
+ * If enabled, the function bodies of every module that contains a hook target are indexed using
+ * the symbol sizes from the ELF symbol table. Hooks are rejected with
+ * `ZYREX_STATUS_UNSAFE_PATCH_WINDOW` before any trampoline memory is allocated, if a relative
+ * branch inside the module targets the interior of the patch window, or if the patch window
+ * exceeds the bounds of the target function.
+ *
+ * The index is built once per module and cached until `ZyrexShutdown` is called. Modules without
+ * symbol information are not validated. Validation is currently only supported on Linux.
+ *
+ * This function must not be called concurrently with any of the hook installation functions.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetPatchWindowValidation(ZyanBool enable);
+
+/**
+ * @brief   Sets the mode that is used to write hook jumps during transaction commits.
+ *
+ * @param   mode    The patch mode. The default mode is `ZYREX_PATCH_MODE_SUSPEND`.
+ *
+ * @return  A zyan status code.
+ *
+ * The patch mode can not be changed while a transaction is active. The breakpoint mode installs
+ * a `SIGTRAP` signal handler (or a vectored exception handler on Windows) on first use, which
+ * forwards all unrelated breakpoints to the previous handler.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetPatchMode(ZyrexPatchMode mode);
+
+/**
+ * @brief   Sets the maximum time threads are kept suspended at once during transaction commits.
+ *
+ * @param   budget  The pause budget (in nanoseconds) or `0` to commit transactions without
+ *                  interruption. The default budget is `0`.
+ *
+ * @return  A zyan status code.
+ *
+ * If a budget is set, the operations of a transaction are applied in slices of consecutive
+ * operations that patch the same page. Once a slice exceeds the budget, all threads are resumed
+ * and the threads in the thread-update list are suspended again before the next slice is
+ * applied. A single slice is never interrupted, so the budget might be exceeded by the time it
+ * takes to apply one slice.
+ *
+ * The commit stays atomic: all targets are verified before the first slice is applied and all
+ * slices that were already applied are reverted, if a later slice fails. Threads that run in
+ * between slices might however observe some of the hooks before the commit completes.
+ *
+ * The pause budget can not be changed while a transaction is active.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetPauseBudget(ZyanU64 budget);
+
+/**
+ * @brief   Enables or disables the stack check that makes sure no thread still uses code that is
+ *          retired by a transaction.
+ *
+ * @param   enable      `ZYAN_TRUE` to enable the stack check or `ZYAN_FALSE` to disable it. The
+ *                      stack check is disabled by default.
+ * @param   retry_count The number of times the check is repeated, before the commit fails.
+ * @param   retry_delay The time all threads are resumed for before each retry (in
+ *                      milliseconds). `0` only yields the processor.
+ *
+ * @return  A zyan status code.
+ *
+ * The retired code of a hook operation is the target function of an inline or replacement hook
+ * or the callback function of a removed hook. Before any code is written, the suspended threads
+ * are checked for an instruction pointer or a return address inside the retired code. If such a
+ * thread is found, all threads are resumed for `retry_delay` and suspended again. If the code is
+ * still in use after `retry_count` retries, the commit fails with
+ * `ZYREX_STATUS_UNSAFE_THREAD_STATE` and no operation is applied. With a pause budget set, each
+ * slice is checked separately.
+ *
+ * The stacks are walked using frame pointers, so frames of functions compiled without frame
+ * pointers are not detected. The bounds of the retired functions are taken from the function
+ * index (see `ZyrexSetPatchWindowValidation`). Without symbol information, only the patch window
+ * of the function is checked.
+ *
+ * The setting applies to operations that are added to a transaction after this function was
+ * called. It can not be changed while a transaction is active and must not be changed
+ * concurrently with any of the hook installation functions.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetStackCheck(ZyanBool enable, ZyanU32 retry_count,
+    ZyanU32 retry_delay);
+
+/**
+ * @brief   Sets the backend that is used to write hook patches and trampolines.
+ *
+ * @param   backend The code writer backend. The default backend is
+ *                  `ZYREX_CODE_WRITER_BACKEND_PROTECT`.
+ *
+ * @return  `ZYAN_STATUS_INVALID_OPERATION`, if the backend is not supported on this platform,
+ *          `ZYAN_STATUS_BAD_SYSTEMCALL`, if the system does not allow writing code through the
+ *          backend, or a generic zyan status code.
+ *
+ * Selecting `ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY` opens `/proc/self/mem` once and verifies
+ * that it can be written to. The descriptor is cached for the lifetime of the process.
+ *
+ * Trampoline bookkeeping still uses protection changes, as it requires plain stores. Callback
+ * changes do not modify any protected memory.
+ *
+ * The backend can not be changed while a transaction is active. This function must not be called
+ * concurrently with any of the hook installation functions.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetCodeWriterBackend(ZyrexCodeWriterBackend backend);
+
+/**
+ * @brief   Sets the maximum number of worker threads used by `ZyrexInstallInlineHooks`.
+ *
+ * @param   count   The maximum number of worker threads (including the calling thread) or `0` to
+ *                  use one worker per logical processor. The default value is `0`.
+ *
+ * @return  A zyan status code.
+ *
+ * Values above the number of logical processors are accepted. Small batches are still processed
+ * by fewer workers. This function must not be called concurrently with any of the hook
+ * installation functions.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetBatchWorkerCount(ZyanUSize count);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread registry                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Enables or disables the thread registry.
+ *
+ * @param   enable  `ZYAN_TRUE` to enable the registry or `ZYAN_FALSE` to disable it.
+ *
+ * @return  A zyan status code.
+ *
+ * If enabled, transactions that update all threads suspend the registered threads instead of
+ * enumerating all threads of the process, and do not suspend anything at all, if the calling
+ * thread is the only registered thread.
+ *
+ * Without the registry, the threads are enumerated repeatedly, while some of them are already
+ * suspended. On Windows, the thread snapshot might use the heap, which a suspended thread could
+ * have locked. The registry keeps the commit path free of allocations on all platforms.
+ *
+ * Enabling the registry registers all threads that exist at this time. Threads that are created
+ * afterwards have to call `ZyrexRegisterThread` on startup and should call
+ * `ZyrexUnregisterThread` before they exit. Unregistered threads are not suspended during
+ * transactions.
+ *
+ * This function must not be called concurrently with any other thread registry function.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetThreadRegistry(ZyanBool enable);
+
+/**
+ * @brief   Adds the calling thread to the thread registry.
+ *
+ * @return  A zyan status code.
+ *
+ * This function does nothing, if the thread registry is disabled. It blocks while a transaction
+ * that updates all threads is active.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexRegisterThread(void);
+
+/**
+ * @brief   Removes the calling thread from the thread registry.
+ *
+ * @return  A zyan status code.
+ *
+ * This function does nothing, if the thread registry is disabled. It blocks while a transaction
+ * that updates all threads is active.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexUnregisterThread(void);
+
+/**
+ * @brief   Returns the id of the calling thread in the form expected by `ZyrexUpdateThread`.
+ *
+ * @param   thread_id   Receives the id of the calling thread.
+ *
+ * @return  A zyan status code.
+ *
+ * On Linux, this is the kernel thread id as returned by `gettid`, which differs from the value
+ * returned by `ZyanThreadGetCurrentThreadId`.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexGetCurrentThreadId(ZyanThreadId* thread_id);
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Transaction                                                                                    */
 /* ---------------------------------------------------------------------------------------------- */
 
 /**
- * @brief   Starts a new transaction.
+ * @brief   Starts the global transaction.
  *
  * @return  A zyan status code.
+ *
+ * Only a single global transaction can be active at a time. Use `ZyrexTransactionCreate` to
+ * prepare multiple transactions concurrently.
  */
 ZYREX_EXPORT ZyanStatus ZyrexTransactionBegin(void);
 
 /**
  * @brief   Adds a specific thread to the thread-update list.
  *
- * The given thread is immediately suspended and later on resumed after the transaction was either
- * been committed or canceled.
+ * The given thread is suspended when the transaction is committed and resumed afterwards. Threads
+ * that exit in the meantime are ignored.
  *
- * @param   thread_id   The id of the thread to add to the update list.
+ * @param   thread_id   The id of the thread to add to the update list, as returned by
+ *                      `ZyrexGetCurrentThreadId` on that thread. On Linux, this is the kernel
+ *                      thread id as returned by `gettid`.
  *
  * @return  A zyan status code.
+ *
+ * On Linux, the thread is parked inside of a real-time signal handler.
  */
 ZYREX_EXPORT ZyanStatus ZyrexUpdateThread(ZyanThreadId thread_id);
 
 /**
  * @brief   Adds all threads (except the calling one) to the update list.
  *
- * All threads are immediately suspended and later on resumed after the transaction was either
- * been committed or canceled.
+ * All threads are suspended when the transaction is committed and resumed afterwards.
  *
  * @return  A zyan status code.
  */
@@ -148,6 +552,10 @@ ZYREX_EXPORT ZyanStatus ZyrexUpdateAllThreads(void);
  * This function performs the pending hook attach/remove operations and updates all threads in the
  * thread-update list.
  *
+ * All memory the commit needs is allocated before the first thread is suspended. Between the
+ * suspension of the first thread and the resumption of the last one, no heap memory is allocated
+ * or freed and no lock is taken that a suspended thread might hold.
+ *
  * @return  A zyan status code.
  */
 ZYREX_EXPORT ZyanStatus ZyrexTransactionCommit(void);
@@ -155,9 +563,20 @@ ZYREX_EXPORT ZyanStatus ZyrexTransactionCommit(void);
 /**
  * @brief   Commits the current transaction.
  *
- * @param   failed_operation    Receives a pointer to the operation that failed the transaction.
+ * @param   failed_operation    Receives the trampoline address of the operation that failed the
+ *                              transaction or `ZYAN_NULL`. This parameter is optional.
  *
  * @return  A zyan status code.
+ *
+ * Before any code is written, the prologue of every hooked function is compared to the original
+ * code saved when the hook was added. If another component modified the code in the meantime,
+ * the transaction is aborted as a whole and `ZYREX_STATUS_CODE_MODIFIED` is returned. On any
+ * other error, the operations that were already applied are reverted and the transaction is
+ * aborted as well.
+ *
+ * On Linux, `ZYREX_STATUS_THREAD_NOT_SUSPENDED` is returned, if a thread that has to be updated
+ * is alive but does not acknowledge the suspension request (e.g. because it blocks the suspend
+ * signal). Only threads that exited are skipped.
  */
 ZYREX_EXPORT ZyanStatus ZyrexTransactionCommitEx(const void** failed_operation);
 
@@ -168,6 +587,96 @@ ZYREX_EXPORT ZyanStatus ZyrexTransactionCommitEx(const void** failed_operation);
  */
 ZYREX_EXPORT ZyanStatus ZyrexTransactionAbort(void);
 
+/**
+ * @brief   Returns statistics about the last committed or aborted transaction.
+ *
+ * @param   statistics  Receives the transaction statistics.
+ *
+ * @return  A zyan status code.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexGetTransactionStatistics(ZyrexTransactionStatistics* statistics);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transaction objects                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Creates a new transaction object.
+ *
+ * @param   transaction Receives a pointer to the new transaction object.
+ *
+ * @return  A zyan status code.
+ *
+ * In contrast to `ZyrexTransactionBegin`, any number of transaction objects can be prepared
+ * concurrently on different threads. A single transaction object must not be used by multiple
+ * threads at the same time.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionCreate(ZyrexTransaction** transaction);
+
+/**
+ * @brief   Destroys the given transaction object.
+ *
+ * @param   transaction A pointer to the transaction object.
+ *
+ * @return  A zyan status code.
+ *
+ * Pending operations that were not applied yet are discarded.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionDestroy(ZyrexTransaction* transaction);
+
+/**
+ * @brief   Adds a specific thread to the thread-update list of the given transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   thread_id   The id of the thread to add to the update list, as returned by
+ *                      `ZyrexGetCurrentThreadId` on that thread. On Linux, this is the kernel
+ *                      thread id as returned by `gettid`.
+ *
+ * @return  A zyan status code.
+ *
+ * The thread is suspended when the transaction is applied. Threads that exit in the meantime
+ * are ignored.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionUpdateThread(ZyrexTransaction* transaction,
+    ZyanThreadId thread_id);
+
+/**
+ * @brief   Adds all threads (except the calling one) to the thread-update list of the given
+ *          transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ *
+ * @return  A zyan status code.
+ *
+ * The threads are suspended when the transaction is applied.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionUpdateAllThreads(ZyrexTransaction* transaction);
+
+/**
+ * @brief   Applies the given transaction.
+ *
+ * @param   transaction         A pointer to the transaction object.
+ * @param   failed_operation    Receives the trampoline address of the operation that failed the
+ *                              transaction or `ZYAN_NULL`. This parameter is optional.
+ *
+ * @return  A zyan status code.
+ *
+ * This function waits for the patch phase of concurrent transactions to complete, suspends all
+ * threads in the thread-update list, performs the pending hook attach/remove operations and
+ * resumes the threads afterwards.
+ *
+ * Before any code is written, the prologue of every hooked function is compared to the original
+ * code saved when the hook was added. If another component modified the code in the meantime,
+ * `ZYREX_STATUS_CODE_MODIFIED` is returned and the transaction object is left untouched. On any
+ * other error, the operations that were already applied are reverted and the transaction object
+ * is left untouched as well.
+ *
+ * The transaction object is empty after it was applied successfully and can be reused. It still
+ * has to be destroyed using `ZyrexTransactionDestroy`.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionApply(ZyrexTransaction* transaction,
+    const void** failed_operation);
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Hook installation                                                                              */
 /* ---------------------------------------------------------------------------------------------- */
@@ -185,6 +694,102 @@ ZYREX_EXPORT ZyanStatus ZyrexTransactionAbort(void);
 ZYREX_EXPORT ZyanStatus ZyrexInstallInlineHook(void* address, const void* callback,
     ZyanConstVoidPointer* trampoline);
 
+/**
+ * @brief   Installs an inline hook at the given `address` using a custom patch window size.
+ *
+ * @param   address     The address to hook.
+ * @param   callback    The callback address.
+ * @param   patch_size  The size of the patch window. Must be in the range of
+ *                      `ZYREX_DEFAULT_PATCH_SIZE` to `ZYREX_MAX_PATCH_SIZE`.
+ * @param   trampoline  Receives the address of the trampoline to the original function, if the
+ *                      operation succeeded.
+ *
+ * @return  A zyan status code.
+ *
+ * At least `patch_size` bytes of code are relocated to the trampoline. The part of the patch
+ * window not covered by the hook jump is filled with `INT3` instructions.
+ *
+ * On x64, a patch window of at least 14 bytes uses an absolute hook jump, which does not require
+ * the trampoline to be within range of a relative jump from the hooked address.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexInstallInlineHookEx(void* address, const void* callback,
+    ZyanUSize patch_size, ZyanConstVoidPointer* trampoline);
+
+/**
+ * @brief   Installs multiple inline hooks at once.
+ *
+ * @param   specs   A pointer to an array of `ZyrexHookSpec` structs.
+ * @param   count   The number of elements in the `specs` array.
+ * @param   results A pointer to an array of `count` status codes that receives the result for
+ *                  each individual hook.
+ *
+ * @return  A zyan status code.
+ *
+ * Prologue analysis and code relocation are performed in parallel on a pool of worker threads,
+ * while trampoline placement and all writes to executable memory are performed serially.
+ *
+ * The targets are processed in ascending address order, regardless of their order in the `specs`
+ * array. Neighbouring targets share their trampoline-region and the commit touches the prologue
+ * pages in order, with a single protection change per page range. The `results` array and the
+ * trampoline pointers still correspond to the original order of the `specs` array.
+ *
+ * This function returns `ZYAN_STATUS_SUCCESS` as soon as the batch was processed, even if some
+ * of the individual hooks could not be installed. Check the `results` array to obtain the status
+ * of each individual hook. Hooks that failed are not part of the current transaction.
+ *
+ * A generic error status is returned, if the batch could not be processed as a whole. In this
+ * case none of the hooks are added to the current transaction.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexInstallInlineHooks(const ZyrexHookSpec* specs, ZyanUSize count,
+    ZyanStatus* results);
+
+/**
+ * @brief   Adds an inline hook at the given `address` to the given transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   address     The address to hook.
+ * @param   callback    The callback address.
+ * @param   trampoline  Receives the address of the trampoline to the original function, if the
+ *                      operation succeeded.
+ *
+ * @return  A zyan status code.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionInstallInlineHook(ZyrexTransaction* transaction,
+    void* address, const void* callback, ZyanConstVoidPointer* trampoline);
+
+/**
+ * @brief   Adds an inline hook at the given `address` using a custom patch window size to the
+ *          given transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   address     The address to hook.
+ * @param   callback    The callback address.
+ * @param   patch_size  The size of the patch window. Must be in the range of
+ *                      `ZYREX_DEFAULT_PATCH_SIZE` to `ZYREX_MAX_PATCH_SIZE`.
+ * @param   trampoline  Receives the address of the trampoline to the original function, if the
+ *                      operation succeeded.
+ *
+ * @return  A zyan status code.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionInstallInlineHookEx(ZyrexTransaction* transaction,
+    void* address, const void* callback, ZyanUSize patch_size, ZyanConstVoidPointer* trampoline);
+
+/**
+ * @brief   Adds multiple inline hooks to the given transaction at once.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   specs       A pointer to an array of `ZyrexHookSpec` structs.
+ * @param   count       The number of elements in the `specs` array.
+ * @param   results     A pointer to an array of `count` status codes that receives the result for
+ *                      each individual hook.
+ *
+ * @return  A zyan status code.
+ *
+ * See `ZyrexInstallInlineHooks` for details.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionInstallInlineHooks(ZyrexTransaction* transaction,
+    const ZyrexHookSpec* specs, ZyanUSize count, ZyanStatus* results);
+
 ///**
 // * @brief   Attaches an exception hook.
 // *
@@ -207,6 +812,86 @@ ZYREX_EXPORT ZyanStatus ZyrexInstallInlineHook(void* address, const void* callba
 // */
 //ZYREX_EXPORT ZyanStatus ZyrexAttachContextHook(const void** address, const void* callback);
 
+/**
+ * @brief   Installs a call-site hook at the given `address`.
+ *
+ * @param   address     The address of a `call rel32` or `jmp rel32` instruction.
+ * @param   callback    The address of the callback function.
+ * @param   original    Receives the original branch target of the instruction, which can be used
+ *                      to call the original function.
+ *
+ * @return  `ZYAN_STATUS_INVALID_ARGUMENT`, if the instruction at `address` is not a relative
+ *          call or jump, `ZYAN_STATUS_OUT_OF_RANGE`, if the callback is not within reach of a
+ *          32-bit displacement or a zyan status code.
+ *
+ * Only the 4-byte displacement of the instruction is written and no trampoline is allocated.
+ * In the breakpoint patch mode, a displacement that crosses an aligned 8-byte word or that can
+ * only be written through the process memory file can not be stored atomically. The commit fails
+ * with `ZYAN_STATUS_INVALID_OPERATION` for such call sites, unless threads were added to the
+ * transaction.
+ *
+ * Call-site hooks are not tracked by the hook registry and are not affected by
+ * `ZyrexRemoveAllHooks`. Use `ZyrexEnumerateCallSites` to find the call sites of a function.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexInstallCallSiteHook(void* address, const void* callback,
+    ZyanConstVoidPointer* original);
+
+/**
+ * @brief   Adds the installation of a call-site hook to the given transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   address     The address of a `call rel32` or `jmp rel32` instruction.
+ * @param   callback    The address of the callback function.
+ * @param   original    Receives the original branch target of the instruction.
+ *
+ * @return  A zyan status code.
+ *
+ * See `ZyrexInstallCallSiteHook` for details.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionInstallCallSiteHook(ZyrexTransaction* transaction,
+    void* address, const void* callback, ZyanConstVoidPointer* original);
+
+/**
+ * @brief   Installs a replacement hook at the given `address`.
+ *
+ * @param   address     The address of the function to replace.
+ * @param   replacement The address of the replacement function.
+ * @param   hook        Receives the replacement hook handle, which is required to remove the
+ *                      hook.
+ *
+ * @return  A zyan status code.
+ *
+ * The function entry is overwritten with a jump to the replacement function. This uses a 5-byte
+ * relative jump, if the replacement function is in reach, or a 14-byte absolute jump otherwise.
+ * Unlike an inline hook, a replacement hook does not relocate the prologue or allocate a
+ * trampoline. Only the overwritten bytes are saved, so the original function can no longer be
+ * called while the hook is installed.
+ *
+ * Threads are not migrated, as there is no relocated code. Threads that are suspended behind the
+ * first instruction of the overwritten bytes might crash after they resume. This is not an issue
+ * for functions that are not running while the hook is installed.
+ *
+ * Replacement hooks are not tracked by the hook registry and are not affected by
+ * `ZyrexRemoveAllHooks`.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexInstallReplacementHook(void* address, const void* replacement,
+    ZyrexReplacementHook** hook);
+
+/**
+ * @brief   Adds the installation of a replacement hook to the given transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   address     The address of the function to replace.
+ * @param   replacement The address of the replacement function.
+ * @param   hook        Receives the replacement hook handle.
+ *
+ * @return  A zyan status code.
+ *
+ * See `ZyrexInstallReplacementHook` for details.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionInstallReplacementHook(ZyrexTransaction* transaction,
+    void* address, const void* replacement, ZyrexReplacementHook** hook);
+
 // TODO: IAT/EAT, VTable, ..
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -223,6 +908,113 @@ ZYREX_EXPORT ZyanStatus ZyrexInstallInlineHook(void* address, const void* callba
  */
 ZYREX_EXPORT ZyanStatus ZyrexRemoveInlineHook(ZyanConstVoidPointer* original);
 
+/**
+ * @brief   Adds the removal of an inline hook to the given transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   original    A pointer to the trampoline address received during the hook attaching.
+ *                      Receives the address of the original function after removing the hook.
+ *
+ * @return  A zyan status code.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionRemoveInlineHook(ZyrexTransaction* transaction,
+    ZyanConstVoidPointer* original);
+
+/**
+ * @brief   Removes a call-site hook at the given `address`.
+ *
+ * @param   address     The address of the hooked `call rel32` or `jmp rel32` instruction.
+ * @param   original    The original branch target received during the hook installation.
+ *
+ * @return  A zyan status code.
+ *
+ * The commit fails with `ZYREX_STATUS_CODE_MODIFIED`, if the instruction was modified after the
+ * removal has been added to the transaction.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexRemoveCallSiteHook(void* address, const void* original);
+
+/**
+ * @brief   Adds the removal of a call-site hook to the given transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   address     The address of the hooked `call rel32` or `jmp rel32` instruction.
+ * @param   original    The original branch target received during the hook installation.
+ *
+ * @return  A zyan status code.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionRemoveCallSiteHook(ZyrexTransaction* transaction,
+    void* address, const void* original);
+
+/**
+ * @brief   Removes a replacement hook.
+ *
+ * @param   hook    The replacement hook handle received during the hook installation.
+ *
+ * @return  A zyan status code.
+ *
+ * The original bytes of the function are restored and the handle is released after the
+ * transaction was committed successfully.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexRemoveReplacementHook(ZyrexReplacementHook* hook);
+
+/**
+ * @brief   Adds the removal of a replacement hook to the given transaction.
+ *
+ * @param   transaction A pointer to the transaction object.
+ * @param   hook        The replacement hook handle received during the hook installation.
+ *
+ * @return  A zyan status code.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexTransactionRemoveReplacementHook(ZyrexTransaction* transaction,
+    ZyrexReplacementHook* hook);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook control                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Enables or disables an inline hook.
+ *
+ * @param   original    The trampoline address received during the hook attaching.
+ * @param   enable      `ZYAN_TRUE` to enable the hook or `ZYAN_FALSE` to disable it.
+ *
+ * @return  A zyan status code.
+ *
+ * A disabled hook passes all calls straight through to the trampoline, which continues execution
+ * in the original function. The callback address is exchanged atomically inside the trampoline,
+ * which does not require a transaction, thread suspension or any modification of the hooked
+ * code.
+ *
+ * Threads that already entered the callback function are not affected. All hooks are enabled
+ * after the installation.
+ *
+ * If the hook jump redirects to the callback function directly, it is redirected to the
+ * callback jump of the trampoline first. The jump is rewritten once while other threads might
+ * execute it, using a single atomic store or a transient breakpoint. Use
+ * `ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP` to avoid this.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetInlineHookEnabled(ZyanConstVoidPointer original,
+    ZyanBool enable);
+
+/**
+ * @brief   Redirects an inline hook to a different callback function.
+ *
+ * @param   original    The trampoline address received during the hook attaching.
+ * @param   callback    The address of the new callback function.
+ *
+ * @return  A zyan status code.
+ *
+ * The callback address is exchanged atomically without modifying the hooked code. If the hook is
+ * disabled, the new callback function is used as soon as the hook is enabled again.
+ *
+ * If the hook jump redirects to the callback function directly, it is redirected to the
+ * callback jump of the trampoline first (see `ZyrexSetInlineHookEnabled`).
+ *
+ * This function must not be used with hooks that belong to a hook chain.
+ */
+ZYREX_EXPORT ZyanStatus ZyrexSetInlineHookCallback(ZyanConstVoidPointer original,
+    const void* callback);
+
 /* ---------------------------------------------------------------------------------------------- */
 
 /* ============================================================================================== */
@@ -111,6 +111,8 @@ ZYREX_EXPORT ZyanStatus ZyrexInitialize(void);
  *
  * @return  A zyan status code.
  *
+ * All installed hooks are removed using a single transaction.
+ *
  * No `Zyrex*` API function should be called after invoking this function.
  */
 ZYREX_EXPORT ZyanStatus ZyrexShutdown(void);
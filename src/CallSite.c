@@ -0,0 +1,285 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zycore/Vector.h>
+#include <Zydis/Zydis.h>
+#include <Zyrex/CallSite.h>
+#include <Zyrex/Internal/FunctionIndex.h>
+
+#if defined(ZYAN_WINDOWS)
+#   include <windows.h>
+#endif
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the size of a `call rel32` or `jmp rel32` instruction.
+ */
+#define ZYREX_SIZEOF_CALL_SITE      5
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Module information                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+#if defined(ZYAN_WINDOWS)
+
+/**
+ * @brief   Collects the bounds of all functions of the module that contains the given `address`.
+ *
+ * @param   address     An address inside of the module.
+ * @param   functions   A pointer to an initialized `ZyanVector` instance that receives the
+ *                      function bounds.
+ *
+ * @return  `ZYAN_STATUS_NOT_FOUND`, if no module contains the given address or the module does
+ *          not provide a function table, or a zyan status code.
+ *
+ * The function bounds are taken from the exception directory of the module. Functions without
+ * unwind information (e.g. leaf functions) are not reported.
+ */
+static ZyanStatus ZyrexGetFunctions(const void* address, ZyanVector* functions)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(functions);
+
+#if defined(ZYAN_X64)
+    HMODULE handle;
+    if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+        GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)address, &handle))
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    const ZyanUPointer base = (ZyanUPointer)handle;
+    const IMAGE_DOS_HEADER* const dos_header = (const IMAGE_DOS_HEADER*)base;
+    if (dos_header->e_magic != IMAGE_DOS_SIGNATURE)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+    const IMAGE_NT_HEADERS* const nt_headers =
+        (const IMAGE_NT_HEADERS*)(base + dos_header->e_lfanew);
+    if ((nt_headers->Signature != IMAGE_NT_SIGNATURE) ||
+        (nt_headers->OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_EXCEPTION))
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    const IMAGE_DATA_DIRECTORY* const directory =
+        &nt_headers->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION];
+    const IMAGE_RUNTIME_FUNCTION_ENTRY* const entries =
+        (const IMAGE_RUNTIME_FUNCTION_ENTRY*)(base + directory->VirtualAddress);
+    const ZyanUSize count = directory->Size / sizeof(IMAGE_RUNTIME_FUNCTION_ENTRY);
+    if (!directory->VirtualAddress || !count)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        if (entries[i].EndAddress <= entries[i].BeginAddress)
+        {
+            continue;
+        }
+
+        ZyrexFunctionRange function;
+        function.address = base + entries[i].BeginAddress;
+        function.size = entries[i].EndAddress - entries[i].BeginAddress;
+        ZYAN_CHECK(ZyanVectorPushBack(functions, &function));
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+#else
+    // 32-bit images do not contain a function table
+    ZYAN_UNUSED(address);
+    ZYAN_UNUSED(functions);
+
+    return ZYAN_STATUS_NOT_FOUND;
+#endif
+}
+
+#elif defined(ZYAN_LINUX)
+
+/**
+ * @brief   Collects the bounds of all functions of the module that contains the given `address`.
+ *
+ * @param   address     An address inside of the module.
+ * @param   functions   A pointer to an initialized `ZyanVector` instance that receives the
+ *                      function bounds.
+ *
+ * @return  `ZYAN_STATUS_NOT_FOUND`, if no module contains the given address or the module does
+ *          not provide a symbol table, or a zyan status code.
+ *
+ * The function bounds are taken from the function index.
+ */
+static ZyanStatus ZyrexGetFunctions(const void* address, ZyanVector* functions)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(functions);
+
+    ZYAN_CHECK(ZyrexFunctionIndexInit());
+
+    return ZyrexFunctionIndexGetFunctions(address, functions);
+}
+
+#else
+#   error "Unsupported platform detected"
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Scanning                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Scans the given function for call sites of the given `target`.
+ *
+ * @param   decoder     A pointer to the `ZydisDecoder` instance.
+ * @param   function    A pointer to the `ZyrexFunctionRange` struct.
+ * @param   target      The address of the target function.
+ * @param   callback    The callback function that is invoked for every call site.
+ * @param   context     The user-defined context.
+ *
+ * @return  `ZYAN_STATUS_FALSE`, if the enumeration was stopped by the callback or a zyan status
+ *          code.
+ *
+ * Decoding starts at the function entry and stops at the first byte sequence that can not be
+ * decoded (e.g. embedded data), as the instruction boundaries behind it are unknown.
+ */
+static ZyanStatus ZyrexScanFunction(const ZydisDecoder* decoder,
+    const ZyrexFunctionRange* function, ZyanUPointer target, ZyrexCallSiteCallback callback,
+    void* context)
+{
+    ZYAN_ASSERT(decoder);
+    ZYAN_ASSERT(function);
+    ZYAN_ASSERT(callback);
+
+    ZydisDecodedInstruction instruction;
+    ZyanUSize offset = 0;
+    while (offset < function->size)
+    {
+        const ZyanUPointer address = function->address + offset;
+        if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(decoder, ZYAN_NULL, (const void*)address,
+            function->size - offset, &instruction)))
+        {
+            break;
+        }
+        offset += instruction.length;
+
+        // Only unprefixed instructions can be redirected by rewriting the displacement
+        const ZyanU8 opcode = *(const ZyanU8*)address;
+        if ((instruction.length != ZYREX_SIZEOF_CALL_SITE) ||
+            ((opcode != 0xE8) && (opcode != 0xE9)))
+        {
+            continue;
+        }
+
+        ZyanI32 displacement;
+        ZYAN_MEMCPY(&displacement, (const ZyanU8*)address + 1, sizeof(displacement));
+        const ZyanUPointer destination =
+            address + ZYREX_SIZEOF_CALL_SITE + (ZyanUPointer)(ZyanIPointer)displacement;
+        if (destination != target)
+        {
+            continue;
+        }
+
+        const ZyanStatus status = callback((void*)address, context);
+        if (!ZYAN_SUCCESS(status) || (status == ZYAN_STATUS_FALSE))
+        {
+            return status;
+        }
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Enumeration                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexEnumerateCallSites(const void* function, const void* module,
+    ZyrexCallSiteCallback callback, void* context)
+{
+    if (!function || !module || !callback)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyanVector functions;
+    ZYAN_CHECK(ZyanVectorInit(&functions, sizeof(ZyrexFunctionRange), 256, ZYAN_NULL));
+    ZyanStatus status = ZyrexGetFunctions(module, &functions);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyanVectorDestroy(&functions);
+        return status;
+    }
+
+    ZydisDecoder decoder;
+#if defined(ZYAN_X86)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_COMPAT_32, ZYDIS_STACK_WIDTH_32);
+#elif defined(ZYAN_X64)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+#else
+#   error "Unsupported architecture detected"
+#endif
+
+    // Functions that are nested inside of an already scanned function are skipped to avoid
+    // reporting the same call site twice
+    ZyanUPointer scanned_end = 0;
+    for (ZyanUSize i = 0; i < functions.size; ++i)
+    {
+        const ZyrexFunctionRange* const range = ZyanVectorGet(&functions, i);
+        ZYAN_ASSERT(range);
+        if (range->address + range->size <= scanned_end)
+        {
+            continue;
+        }
+        scanned_end = range->address + range->size;
+
+        status = ZyrexScanFunction(&decoder, range, (ZyanUPointer)function, callback, context);
+        if (!ZYAN_SUCCESS(status) || (status == ZYAN_STATUS_FALSE))
+        {
+            break;
+        }
+    }
+    ZyanVectorDestroy(&functions);
+
+    return ZYAN_SUCCESS(status) ? ZYAN_STATUS_SUCCESS : status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
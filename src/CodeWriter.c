@@ -0,0 +1,1126 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zycore/API/Memory.h>
+#include <Zycore/API/Process.h>
+#include <Zycore/Vector.h>
+#include <Zyrex/Internal/CodeWriter.h>
+#include <Zyrex/Internal/Utils.h>
+
+#if   defined(ZYAN_WINDOWS)
+#   include <Windows.h>
+#elif defined(ZYAN_POSIX)
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <signal.h>
+#   include <sys/mman.h>
+#   include <ucontext.h>
+#   include <unistd.h>
+#   if defined(ZYAN_LINUX)
+#       include <sys/syscall.h>
+#   endif
+#else
+#   error "Unsupported platform detected"
+#endif
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+#if defined(ZYAN_LINUX)
+
+/**
+ * @brief   The `MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE` command of the `membarrier` syscall.
+ */
+#define ZYREX_MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE            (1 << 5)
+
+/**
+ * @brief   The `MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_SYNC_CORE` command of the `membarrier`
+ *          syscall.
+ */
+#define ZYREX_MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_SYNC_CORE   (1 << 6)
+
+#endif
+
+/**
+ * @brief   The number of transient breakpoint sites that are remembered.
+ *
+ * Retired sites are only recycled after this many newer sites were used, which gives threads
+ * with a late `SIGTRAP` delivery time to be redirected.
+ */
+#define ZYREX_BREAKPOINT_SITE_COUNT 64
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexMembarrierState` enum.
+ */
+typedef enum ZyrexMembarrierState_
+{
+    /**
+     * @brief   The `membarrier` syscall has not been probed yet.
+     */
+    ZYREX_MEMBARRIER_STATE_UNKNOWN,
+    /**
+     * @brief   The `membarrier` syscall supports core serialization.
+     */
+    ZYREX_MEMBARRIER_STATE_AVAILABLE,
+    /**
+     * @brief   The `membarrier` syscall is not available or does not support core
+     *          serialization.
+     */
+    ZYREX_MEMBARRIER_STATE_UNAVAILABLE
+} ZyrexMembarrierState;
+
+/**
+ * @brief   Defines the `ZyrexBreakpointSite` struct.
+ *
+ * Describes an address at which `ZyrexWriteCodeLive` placed a transient breakpoint.
+ */
+typedef struct ZyrexBreakpointSite_
+{
+    /**
+     * @brief   The address of the breakpoint or `0`, if the slot is unused.
+     */
+    volatile ZyanUPointer address;
+    /**
+     * @brief   The address to redirect threads to, that hit the breakpoint, or `0`, if the
+     *          breakpoint was already replaced and all processors were serialized afterwards.
+     */
+    volatile ZyanUPointer detour;
+} ZyrexBreakpointSite;
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   Contains global code writer data.
+ *
+ * Thread-safety is implicitly guaranteed by the transactional API as only one transaction can be
+ * committed at a time. The breakpoint fields are accessed concurrently by the breakpoint handler.
+ */
+static struct
+{
+    /**
+     * @brief   Signals, if the breakpoint handler is installed.
+     */
+    ZyanBool is_handler_installed;
+    /**
+     * @brief   The active and the most recently retired transient breakpoint sites.
+     */
+    ZyrexBreakpointSite breakpoint_sites[ZYREX_BREAKPOINT_SITE_COUNT];
+    /**
+     * @brief   The index of the breakpoint site slot that is used next.
+     */
+    ZyanUSize next_breakpoint_site;
+    /**
+     * @brief   The state of the `membarrier` syscall.
+     */
+    ZyrexMembarrierState membarrier_state;
+    /**
+     * @brief   The backend that is used to write code.
+     */
+    ZyrexCodeWriterBackend backend;
+
+#if defined(ZYAN_POSIX)
+
+    /**
+     * @brief   The previous `SIGTRAP` signal action.
+     */
+    struct sigaction previous_action;
+    /**
+     * @brief   A page that is used to trigger inter-processor interrupts, if the `membarrier`
+     *          syscall is not available.
+     */
+    void* serialization_page;
+
+#endif
+
+#if defined(ZYAN_LINUX)
+
+    /**
+     * @brief   Signals, if the `/proc/self/mem` file was opened.
+     */
+    ZyanBool is_process_memory_open;
+    /**
+     * @brief   The cached `/proc/self/mem` file descriptor.
+     */
+    int process_memory;
+
+#endif
+} g_code_writer_data;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Breakpoint handler                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the new instruction pointer for a thread that hit a breakpoint at the given
+ *          `address`.
+ *
+ * @param   address The address of the breakpoint.
+ *
+ * @return  The new instruction pointer or `0`, if the breakpoint is not a transient breakpoint.
+ *
+ * Traps of retired sites can still arrive, if the signal was delivered late. As the breakpoint
+ * was already replaced, such threads simply execute the new instruction.
+ */
+static ZyanUPointer ZyrexGetBreakpointRedirection(ZyanUPointer address)
+{
+    for (ZyanUSize i = 0; i < ZYREX_BREAKPOINT_SITE_COUNT; ++i)
+    {
+        ZyrexBreakpointSite* const site = &g_code_writer_data.breakpoint_sites[i];
+        if (ZyrexAtomicLoad(&site->address) != address)
+        {
+            continue;
+        }
+
+        // The breakpoint might already have been replaced by the new instruction
+        if (*(const volatile ZyanU8*)address != 0xCC)
+        {
+            return address;
+        }
+
+        // A breakpoint at a retired site was not placed by us
+        const ZyanUPointer detour = ZyrexAtomicLoad(&site->detour);
+        if (detour)
+        {
+            return detour;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Activates a breakpoint site slot for the given address.
+ *
+ * @param   address The address of the breakpoint.
+ * @param   detour  The address to redirect threads to, that hit the breakpoint.
+ *
+ * @return  A pointer to the `ZyrexBreakpointSite` struct.
+ *
+ * A slot that already belongs to the given address is reused. Otherwise the least recently used
+ * slot is recycled. Only one site is active at a time, as live writes are serialized by the
+ * transactional API.
+ */
+static ZyrexBreakpointSite* ZyrexActivateBreakpointSite(ZyanUPointer address, ZyanUPointer detour)
+{
+    ZyrexBreakpointSite* site = ZYAN_NULL;
+    for (ZyanUSize i = 0; i < ZYREX_BREAKPOINT_SITE_COUNT; ++i)
+    {
+        if (ZyrexAtomicLoad(&g_code_writer_data.breakpoint_sites[i].address) == address)
+        {
+            site = &g_code_writer_data.breakpoint_sites[i];
+            break;
+        }
+    }
+    if (!site)
+    {
+        site = &g_code_writer_data.breakpoint_sites[g_code_writer_data.next_breakpoint_site];
+        g_code_writer_data.next_breakpoint_site =
+            (g_code_writer_data.next_breakpoint_site + 1) % ZYREX_BREAKPOINT_SITE_COUNT;
+
+        // Unpublish the old address first, so the handler never pairs it with the new detour
+        ZyrexAtomicStore(&site->address, 0);
+    }
+
+    // Publish the detour before the address and before the breakpoint becomes visible
+    ZyrexAtomicStore(&site->detour, detour);
+    ZyrexAtomicStore(&site->address, address);
+
+    return site;
+}
+
+#if defined(ZYAN_WINDOWS)
+
+/**
+ * @brief   The vectored exception handler that redirects threads hitting a transient breakpoint.
+ *
+ * @param   info    A pointer to the `EXCEPTION_POINTERS` struct.
+ *
+ * @return  `EXCEPTION_CONTINUE_EXECUTION`, if the exception was handled or
+ *          `EXCEPTION_CONTINUE_SEARCH`, if not.
+ */
+static LONG CALLBACK ZyrexBreakpointHandler(PEXCEPTION_POINTERS info)
+{
+    if (info->ExceptionRecord->ExceptionCode != EXCEPTION_BREAKPOINT)
+    {
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    const ZyanUPointer ip =
+        ZyrexGetBreakpointRedirection((ZyanUPointer)info->ExceptionRecord->ExceptionAddress);
+    if (!ip)
+    {
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+#if defined(ZYAN_X64)
+    info->ContextRecord->Rip = ip;
+#else
+    info->ContextRecord->Eip = ip;
+#endif
+
+    return EXCEPTION_CONTINUE_EXECUTION;
+}
+
+#elif defined(ZYAN_LINUX)
+
+/**
+ * @brief   The `SIGTRAP` signal handler that redirects threads hitting a transient breakpoint.
+ *
+ * @param   signal_number   The signal number.
+ * @param   info            A pointer to the `siginfo_t` struct.
+ * @param   context         A pointer to the `ucontext_t` struct.
+ *
+ * Signals not caused by a transient breakpoint are forwarded to the previous signal action.
+ */
+static void ZyrexBreakpointHandler(int signal_number, siginfo_t* info, void* context)
+{
+    ucontext_t* const ucontext = (ucontext_t*)context;
+#if defined(ZYAN_X64)
+    greg_t* const ip = &ucontext->uc_mcontext.gregs[REG_RIP];
+#else
+    greg_t* const ip = &ucontext->uc_mcontext.gregs[REG_EIP];
+#endif
+
+    // `INT3` reports `SI_KERNEL` and leaves the instruction pointer behind the breakpoint
+    if (info->si_code == SI_KERNEL)
+    {
+        const ZyanUPointer redirection = ZyrexGetBreakpointRedirection((ZyanUPointer)*ip - 1);
+        if (redirection)
+        {
+            *ip = (greg_t)redirection;
+            return;
+        }
+    }
+
+    const struct sigaction* const previous = &g_code_writer_data.previous_action;
+    if (previous->sa_flags & SA_SIGINFO)
+    {
+        previous->sa_sigaction(signal_number, info, context);
+        return;
+    }
+    if (previous->sa_handler == SIG_IGN)
+    {
+        return;
+    }
+    if (previous->sa_handler == SIG_DFL)
+    {
+        // Restore the default action and let the signal terminate the process
+        signal(signal_number, SIG_DFL);
+        raise(signal_number);
+        return;
+    }
+    previous->sa_handler(signal_number);
+}
+
+#endif
+
+/**
+ * @brief   Installs the breakpoint handler, if not already done.
+ *
+ * @return  A zyan status code.
+ *
+ * The handler stays installed for the lifetime of the process.
+ */
+static ZyanStatus ZyrexInstallBreakpointHandler(void)
+{
+    if (g_code_writer_data.is_handler_installed)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+#if defined(ZYAN_WINDOWS)
+
+    if (!AddVectoredExceptionHandler(1, &ZyrexBreakpointHandler))
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+#elif defined(ZYAN_LINUX)
+
+    struct sigaction action;
+    ZYAN_MEMSET(&action, 0, sizeof(action));
+    action.sa_sigaction = &ZyrexBreakpointHandler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGTRAP, &action, &g_code_writer_data.previous_action) != 0)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+#else
+
+    return ZYAN_STATUS_INVALID_OPERATION;
+
+#endif
+
+    g_code_writer_data.is_handler_installed = ZYAN_TRUE;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Synchronization                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Registers the process for the core serializing `membarrier` command, if not already
+ *          done.
+ *
+ * The registration is only attempted once. If it fails, `ZyrexSerializeAllCores` uses the
+ * `mprotect` based fallback.
+ */
+static void ZyrexRegisterMembarrier(void)
+{
+#if defined(ZYAN_LINUX) && defined(SYS_membarrier)
+
+    if (g_code_writer_data.membarrier_state == ZYREX_MEMBARRIER_STATE_UNKNOWN)
+    {
+        g_code_writer_data.membarrier_state = (syscall(SYS_membarrier,
+            ZYREX_MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_SYNC_CORE, 0) == 0)
+            ? ZYREX_MEMBARRIER_STATE_AVAILABLE
+            : ZYREX_MEMBARRIER_STATE_UNAVAILABLE;
+    }
+
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Process memory                                                                                 */
+/* ---------------------------------------------------------------------------------------------- */
+
+#if defined(ZYAN_LINUX)
+
+/**
+ * @brief   Writes the given data to the given `address` through the `/proc/self/mem` file.
+ *
+ * @param   address The destination address.
+ * @param   data    A pointer to the data to write.
+ * @param   size    The size of the data.
+ *
+ * @return  A zyan status code.
+ *
+ * The kernel writes to the underlying page regardless of its protection, which is left
+ * untouched.
+ */
+static ZyanStatus ZyrexWriteProcessMemory(void* address, const void* data, ZyanUSize size)
+{
+    ZYAN_ASSERT(g_code_writer_data.is_process_memory_open);
+
+    const ZyanU8* source = (const ZyanU8*)data;
+    ZyanUPointer destination = (ZyanUPointer)address;
+    while (size)
+    {
+        const ssize_t written = pwrite64(g_code_writer_data.process_memory, source, size,
+            (off64_t)destination);
+        if (written <= 0)
+        {
+            if ((written < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            return ZYAN_STATUS_BAD_SYSTEMCALL;
+        }
+
+        source += written;
+        destination += (ZyanUPointer)written;
+        size -= (ZyanUSize)written;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Opens the `/proc/self/mem` file, if not already done, and verifies that code can be
+ *          written through it.
+ *
+ * @return  A zyan status code.
+ *
+ * Some systems restrict forced writes to read-only mappings (e.g. `proc_mem.force_override`).
+ * The verification writes back the first byte of this function, which does not change any code.
+ */
+static ZyanStatus ZyrexOpenProcessMemory(void)
+{
+    if (!g_code_writer_data.is_process_memory_open)
+    {
+        const int fd = open("/proc/self/mem", O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return ZYAN_STATUS_BAD_SYSTEMCALL;
+        }
+        g_code_writer_data.process_memory = fd;
+        g_code_writer_data.is_process_memory_open = ZYAN_TRUE;
+    }
+
+    void* const probe = (void*)(ZyanUPointer)&ZyrexOpenProcessMemory;
+    const ZyanU8 value = *(const volatile ZyanU8*)probe;
+
+    return ZyrexWriteProcessMemory(probe, &value, sizeof(value));
+}
+
+#endif
+
+/**
+ * @brief   Writes a single byte of code.
+ *
+ * @param   address The destination address.
+ * @param   value   The byte to write.
+ *
+ * @return  A zyan status code.
+ *
+ * Single bytes are always written atomically, regardless of the backend.
+ */
+static ZyanStatus ZyrexWriteCodeByte(ZyanU8* address, ZyanU8 value)
+{
+    ZYAN_ASSERT(address);
+
+#if defined(ZYAN_LINUX)
+
+    if (g_code_writer_data.backend == ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY)
+    {
+        return ZyrexWriteProcessMemory(address, &value, sizeof(value));
+    }
+
+#endif
+
+    *(volatile ZyanU8*)address = value;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Memory protection                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Appends a protected region to the given vector and merges it with the previous region,
+ *          if both are adjacent and share the same protection.
+ *
+ * @param   regions     A pointer to the `ZyanVector` of `ZyrexProtectedRegion` structs.
+ * @param   address     The page-aligned start address of the region.
+ * @param   size        The size of the region.
+ * @param   protection  The protection of the region.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexProtectedRegionsAppend(ZyanVector* regions, ZyanUPointer address,
+    ZyanUSize size, ZyanMemoryPageProtection protection)
+{
+    ZYAN_ASSERT(regions);
+
+    if (regions->size)
+    {
+        ZyrexProtectedRegion* const last = ZyanVectorGetMutable(regions, regions->size - 1);
+        ZYAN_ASSERT(last);
+
+        if ((last->address + last->size == address) && (last->protection == protection))
+        {
+            last->size += size;
+            return ZYAN_STATUS_SUCCESS;
+        }
+    }
+
+    const ZyrexProtectedRegion region = { address, size, protection };
+    return ZyanVectorPushBack(regions, &region);
+}
+
+#if defined(ZYAN_LINUX)
+
+/**
+ * @brief   Splits the given page ranges at mapping boundaries and determines the original
+ *          protection of each part by reading `/proc/self/maps`.
+ *
+ * @param   ranges  A pointer to the sorted `ZyanVector` of `ZyrexProtectedRegion` structs.
+ * @param   regions A pointer to the `ZyanVector` that receives the protected regions.
+ *
+ * @return  A zyan status code.
+ *
+ * The maps file is parsed using a stack buffer to avoid heap allocations while other threads
+ * might be suspended.
+ */
+static ZyanStatus ZyrexQueryProtection(const ZyanVector* ranges, ZyanVector* regions)
+{
+    ZYAN_ASSERT(ranges);
+    ZYAN_ASSERT(regions);
+
+    const int fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+    char buffer[4096];
+    ZyanUSize length = 0;
+    ZyanUSize range_index = 0;
+    ZyanUPointer cursor = ranges->size
+        ? ((const ZyrexProtectedRegion*)ZyanVectorGet(ranges, 0))->address
+        : 0;
+    ZyanBool is_eof = ZYAN_FALSE;
+    ZyanBool is_skipping = ZYAN_FALSE;
+    while ((range_index < ranges->size) && ZYAN_SUCCESS(status))
+    {
+        // Find the end of the current line
+        ZyanUSize line_length = 0;
+        while ((line_length < length) && (buffer[line_length] != '\n'))
+        {
+            ++line_length;
+        }
+        if ((line_length == length) && (length < sizeof(buffer)) && !is_eof)
+        {
+            const ssize_t count = read(fd, buffer + length, sizeof(buffer) - length);
+            if (count < 0)
+            {
+                status = ZYAN_STATUS_BAD_SYSTEMCALL;
+                break;
+            }
+            is_eof = (count == 0);
+            length += (ZyanUSize)count;
+            continue;
+        }
+        if (length == 0)
+        {
+            break;
+        }
+
+        // Overlong lines are processed partially. The relevant fields are at the start
+        const ZyanBool is_complete = (line_length < length);
+        if (is_skipping)
+        {
+            is_skipping = !is_complete;
+        } else
+        {
+            is_skipping = !is_complete && !is_eof;
+
+            // Parse `start-end perms ...`
+            ZyanUSize offset = 0;
+            const ZyanUPointer start = ZyrexParseHexNumber(buffer, line_length, &offset);
+            ++offset;
+            const ZyanUPointer end = ZyrexParseHexNumber(buffer, line_length, &offset);
+            ++offset;
+            int flags = PROT_NONE;
+            if (offset + 3 <= line_length)
+            {
+                flags |= (buffer[offset + 0] == 'r') ? PROT_READ  : 0;
+                flags |= (buffer[offset + 1] == 'w') ? PROT_WRITE : 0;
+                flags |= (buffer[offset + 2] == 'x') ? PROT_EXEC  : 0;
+            }
+
+            while (range_index < ranges->size)
+            {
+                const ZyrexProtectedRegion* const range = ZyanVectorGet(ranges, range_index);
+                ZYAN_ASSERT(range);
+
+                if (cursor >= end)
+                {
+                    break;
+                }
+                if (cursor < start)
+                {
+                    // The range is not completely mapped
+                    status = ZYAN_STATUS_INVALID_ARGUMENT;
+                    break;
+                }
+
+                const ZyanUPointer hi = ZYAN_MIN(range->address + range->size, end);
+                status = ZyrexProtectedRegionsAppend(regions, cursor, hi - cursor,
+                    (ZyanMemoryPageProtection)flags);
+                if (!ZYAN_SUCCESS(status))
+                {
+                    break;
+                }
+                cursor = hi;
+                if (hi < range->address + range->size)
+                {
+                    break;
+                }
+                if (++range_index < ranges->size)
+                {
+                    cursor = 
+                        ((const ZyrexProtectedRegion*)ZyanVectorGet(ranges, range_index))->address;
+                }
+            }
+        }
+
+        // Consume the line
+        const ZyanUSize consumed = is_complete ? line_length + 1 : length;
+        ZYAN_MEMMOVE(buffer, buffer + consumed, length - consumed);
+        length -= consumed;
+    }
+
+    close(fd);
+
+    if (ZYAN_SUCCESS(status) && (range_index < ranges->size))
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return status;
+}
+
+#elif defined(ZYAN_WINDOWS)
+
+/**
+ * @brief   Splits the given page ranges at allocation boundaries and determines the original
+ *          protection of each part.
+ *
+ * @param   ranges  A pointer to the sorted `ZyanVector` of `ZyrexProtectedRegion` structs.
+ * @param   regions A pointer to the `ZyanVector` that receives the protected regions.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexQueryProtection(const ZyanVector* ranges, ZyanVector* regions)
+{
+    ZYAN_ASSERT(ranges);
+    ZYAN_ASSERT(regions);
+
+    for (ZyanUSize i = 0; i < ranges->size; ++i)
+    {
+        const ZyrexProtectedRegion* const range = ZyanVectorGet(ranges, i);
+        ZYAN_ASSERT(range);
+
+        ZyanUPointer address = range->address;
+        while (address < range->address + range->size)
+        {
+            MEMORY_BASIC_INFORMATION info;
+            if (!VirtualQuery((LPCVOID)address, &info, sizeof(info)))
+            {
+                return ZYAN_STATUS_BAD_SYSTEMCALL;
+            }
+            if (info.State != MEM_COMMIT)
+            {
+                return ZYAN_STATUS_INVALID_ARGUMENT;
+            }
+
+            const ZyanUPointer end = ZYAN_MIN(range->address + range->size,
+                (ZyanUPointer)info.BaseAddress + info.RegionSize);
+            // Modifiers like `PAGE_GUARD` are not preserved
+            ZYAN_CHECK(ZyrexProtectedRegionsAppend(regions, address, end - address,
+                (ZyanMemoryPageProtection)(info.Protect & 0xFF)));
+            address = end;
+        }
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+#else
+
+/**
+ * @brief   Assigns the default code protection to all given page ranges.
+ *
+ * @param   ranges  A pointer to the sorted `ZyanVector` of `ZyrexProtectedRegion` structs.
+ * @param   regions A pointer to the `ZyanVector` that receives the protected regions.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexQueryProtection(const ZyanVector* ranges, ZyanVector* regions)
+{
+    ZYAN_ASSERT(ranges);
+    ZYAN_ASSERT(regions);
+
+    for (ZyanUSize i = 0; i < ranges->size; ++i)
+    {
+        const ZyrexProtectedRegion* const range = ZyanVectorGet(ranges, i);
+        ZYAN_ASSERT(range);
+
+        ZYAN_CHECK(ZyrexProtectedRegionsAppend(regions, range->address, range->size,
+            ZYAN_PAGE_EXECUTE_READ));
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Synchronization                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexCodeWriterInit(void)
+{
+    // The registration is slow and should not be part of the first commit
+    ZyrexRegisterMembarrier();
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexSerializeAllCores(void)
+{
+#if defined(ZYAN_WINDOWS)
+
+    // Sends an inter-processor interrupt to all processors that run threads of the process
+    FlushProcessWriteBuffers();
+    return ZYAN_STATUS_SUCCESS;
+
+#else
+
+#if defined(ZYAN_LINUX) && defined(SYS_membarrier)
+
+    ZyrexRegisterMembarrier();
+    if ((g_code_writer_data.membarrier_state == ZYREX_MEMBARRIER_STATE_AVAILABLE) &&
+        (syscall(SYS_membarrier, ZYREX_MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE, 0) == 0))
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+#endif
+
+    // Revoking write access to a dirty page forces a TLB shootdown on all processors that run
+    // threads of the process. The interrupt handling serializes the interrupted processors
+    const ZyanUSize page_size = ZyanMemoryGetSystemPageSize();
+    if (!g_code_writer_data.serialization_page)
+    {
+        void* const page = mmap(ZYAN_NULL, page_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (page == MAP_FAILED)
+        {
+            return ZYAN_STATUS_BAD_SYSTEMCALL;
+        }
+        g_code_writer_data.serialization_page = page;
+    }
+    if (mprotect(g_code_writer_data.serialization_page, page_size, PROT_READ | PROT_WRITE) != 0)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+    *(volatile ZyanU8*)g_code_writer_data.serialization_page = 1;
+    if (mprotect(g_code_writer_data.serialization_page, page_size, PROT_NONE) != 0)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Backend                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexCodeWriterSetBackend(ZyrexCodeWriterBackend backend)
+{
+    switch (backend)
+    {
+    case ZYREX_CODE_WRITER_BACKEND_PROTECT:
+        break;
+    case ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY:
+#if defined(ZYAN_LINUX)
+        ZYAN_CHECK(ZyrexOpenProcessMemory());
+        break;
+#else
+        return ZYAN_STATUS_INVALID_OPERATION;
+#endif
+    default:
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    g_code_writer_data.backend = backend;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyrexCodeWriterBackend ZyrexCodeWriterGetBackend(void)
+{
+    return g_code_writer_data.backend;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Memory protection                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexProtectedRegionsAdd(ZyanVector* regions, const void* address, ZyanUSize size)
+{
+    if (!regions || !address || !size)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    const ZyanUPointer page_size = ZyanMemoryGetSystemPageSize();
+    ZyanUPointer lo = ZYAN_ALIGN_DOWN((ZyanUPointer)address, page_size);
+    ZyanUPointer hi = ZYAN_ALIGN_UP((ZyanUPointer)address + size, page_size);
+
+    // Fast path for address-sorted input: The new range lies behind or touches the last region
+    if (regions->size > 0)
+    {
+        ZyrexProtectedRegion* const last = ZyanVectorGetMutable(regions, regions->size - 1);
+        ZYAN_ASSERT(last);
+
+        if (lo > last->address + last->size)
+        {
+            const ZyrexProtectedRegion region = { lo, hi - lo, ZYAN_PAGE_EXECUTE_READ };
+            return ZyanVectorPushBack(regions, &region);
+        }
+        if (lo >= last->address)
+        {
+            last->size = ZYAN_MAX(hi, last->address + last->size) - last->address;
+            return ZYAN_STATUS_SUCCESS;
+        }
+    }
+
+    // Merge with all overlapping or adjacent regions
+    ZyanUSize index = 0;
+    while (index < regions->size)
+    {
+        const ZyrexProtectedRegion* const region = ZyanVectorGet(regions, index);
+        ZYAN_ASSERT(region);
+
+        if (region->address > hi)
+        {
+            break;
+        }
+        if (region->address + region->size < lo)
+        {
+            ++index;
+            continue;
+        }
+
+        lo = ZYAN_MIN(lo, region->address);
+        hi = ZYAN_MAX(hi, region->address + region->size);
+        ZYAN_CHECK(ZyanVectorDelete(regions, index));
+    }
+
+    const ZyrexProtectedRegion region = { lo, hi - lo, ZYAN_PAGE_EXECUTE_READ };
+    return ZyanVectorInsert(regions, index, &region);
+}
+
+ZyanStatus ZyrexProtectedRegionsUnprotect(const ZyanVector* ranges, ZyanVector* regions)
+{
+    if (!ranges || !regions)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZYAN_CHECK(ZyanVectorClear(regions));
+
+    if (g_code_writer_data.backend == ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY)
+    {
+        // The regions are still needed to flush the instruction cache
+        for (ZyanUSize i = 0; i < ranges->size; ++i)
+        {
+            const ZyrexProtectedRegion* const range = ZyanVectorGet(ranges, i);
+            ZYAN_ASSERT(range);
+
+            ZYAN_CHECK(ZyanVectorPushBack(regions, range));
+        }
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZYAN_CHECK(ZyrexQueryProtection(ranges, regions));
+
+    for (ZyanUSize i = 0; i < regions->size; ++i)
+    {
+        const ZyrexProtectedRegion* const region = ZyanVectorGet(regions, i);
+        ZYAN_ASSERT(region);
+
+        if (region->protection == ZYAN_PAGE_EXECUTE_READWRITE)
+        {
+            continue;
+        }
+
+        const ZyanStatus status = ZyanMemoryVirtualProtect((void*)region->address, region->size,
+            ZYAN_PAGE_EXECUTE_READWRITE);
+        if (!ZYAN_SUCCESS(status))
+        {
+            // Restore the regions that were already modified
+            ZyanVector modified = *regions;
+            modified.size = i;
+            ZyrexProtectedRegionsRestore(&modified);
+            return status;
+        }
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexProtectedRegionsRestore(const ZyanVector* regions)
+{
+    if (!regions)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+    if (g_code_writer_data.backend == ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZyanStatus result = ZYAN_STATUS_SUCCESS;
+    for (ZyanUSize i = 0; i < regions->size; ++i)
+    {
+        const ZyrexProtectedRegion* const region = ZyanVectorGet(regions, i);
+        ZYAN_ASSERT(region);
+
+        if (region->protection == ZYAN_PAGE_EXECUTE_READWRITE)
+        {
+            continue;
+        }
+
+        // Continue with the remaining regions on failure
+        const ZyanStatus status = 
+            ZyanMemoryVirtualProtect((void*)region->address, region->size, region->protection);
+        if (!ZYAN_SUCCESS(status))
+        {
+            result = status;
+        }
+    }
+
+    return result;
+}
+
+ZyanStatus ZyrexProtectedRegionsSynchronize(const ZyanVector* regions)
+{
+    if (!regions)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+    if (!regions->size)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    for (ZyanUSize i = 0; i < regions->size; ++i)
+    {
+        const ZyrexProtectedRegion* const region = ZyanVectorGet(regions, i);
+        ZYAN_ASSERT(region);
+
+        ZYAN_CHECK(ZyanProcessFlushInstructionCache((void*)region->address, region->size));
+    }
+
+    return ZyrexSerializeAllCores();
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Code writing                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexWriteCode(void* address, const void* code, ZyanUSize size)
+{
+    if (!address || !code || !size)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+#if defined(ZYAN_LINUX)
+
+    if (g_code_writer_data.backend == ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY)
+    {
+        return ZyrexWriteProcessMemory(address, code, size);
+    }
+
+#endif
+
+    ZYAN_MEMCPY(address, code, size);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexWriteCodeLive(void* address, const void* code, ZyanUSize size,
+    const void* detour)
+{
+    if (!address || !code || !size || !detour)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyanU8* const target = (ZyanU8*)address;
+    const ZyanU8* const source = (const ZyanU8*)code;
+
+    // Code that was written directly before (e.g. the destination of the new instruction) has to
+    // be visible to all processors before the new instruction becomes reachable
+    ZYAN_CHECK(ZyrexSerializeAllCores());
+
+    // Use a single atomic store, if the code fits in an aligned 8-byte word. Writes through the
+    // process memory file are only atomic for single bytes
+    const ZyanUPointer word = ZYAN_ALIGN_DOWN((ZyanUPointer)address, 8);
+    if ((g_code_writer_data.backend == ZYREX_CODE_WRITER_BACKEND_PROTECT) &&
+        ((ZyanUPointer)address + size <= word + 8))
+    {
+        ZyanU64 value = ZyrexAtomicLoad64((const volatile ZyanU64*)word);
+        ZYAN_MEMCPY((ZyanU8*)&value + ((ZyanUPointer)address - word), source, size);
+        ZyrexAtomicStore64((volatile ZyanU64*)word, value);
+
+        return ZyanProcessFlushInstructionCache(address, size);
+    }
+
+    ZYAN_CHECK(ZyrexInstallBreakpointHandler());
+
+    ZyrexBreakpointSite* const site =
+        ZyrexActivateBreakpointSite((ZyanUPointer)address, (ZyanUPointer)detour);
+
+    // Phase 1: Replace the first byte with a breakpoint
+    const ZyanStatus status = ZyrexWriteCodeByte(target, 0xCC);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexAtomicStore(&site->detour, 0);
+        return status;
+    }
+    ZYAN_CHECK(ZyanProcessFlushInstructionCache(address, 1));
+    ZYAN_CHECK(ZyrexSerializeAllCores());
+
+    // Phase 2: Write the remaining bytes, which are unreachable while the breakpoint is present
+    if (size > 1)
+    {
+        ZYAN_CHECK(ZyrexWriteCode(target + 1, source + 1, size - 1));
+        ZYAN_CHECK(ZyanProcessFlushInstructionCache(target + 1, size - 1));
+        ZYAN_CHECK(ZyrexSerializeAllCores());
+    }
+
+    // Phase 3: Replace the breakpoint with the first byte of the new instruction
+    ZYAN_CHECK(ZyrexWriteCodeByte(target, source[0]));
+    ZYAN_CHECK(ZyanProcessFlushInstructionCache(address, 1));
+    ZYAN_CHECK(ZyrexSerializeAllCores());
+
+    // The site stays known, so traps that are delivered late are not forwarded
+    ZyrexAtomicStore(&site->detour, 0);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
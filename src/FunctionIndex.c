@@ -0,0 +1,996 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
+#include <Zycore/Comparison.h>
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zycore/Vector.h>
+#include <Zycore/API/Synchronization.h>
+#include <Zydis/Zydis.h>
+#include <Zyrex/Status.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Internal/FunctionIndex.h>
+#include <Zyrex/Internal/Utils.h>
+
+#if defined(ZYAN_LINUX)
+#   include <fcntl.h>
+#   include <link.h>
+#   include <limits.h>
+#   include <stddef.h>
+#   include <stdlib.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the maximum number of executable segments per module.
+ */
+#define ZYREX_FUNCTION_INDEX_MAX_SEGMENTS   16
+
+/**
+ * @brief   Extracts the symbol type from the `st_info` field of a native ELF symbol.
+ */
+#if defined(ZYAN_X64)
+#   define ZYREX_ELF_ST_TYPE(info) ELF64_ST_TYPE(info)
+#else
+#   define ZYREX_ELF_ST_TYPE(info) ELF32_ST_TYPE(info)
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexModuleIndex` struct.
+ *
+ * The module index is immutable after construction. It is released, if the module might have
+ * been unloaded, and therefore must only be accessed while holding the lock.
+ */
+typedef struct ZyrexModuleIndex_
+{
+    /**
+     * @brief   The lowest address of the module image.
+     */
+    ZyanUPointer address_lo;
+    /**
+     * @brief   The highest address of the module image (exclusive).
+     */
+    ZyanUPointer address_hi;
+    /**
+     * @brief   All functions of the module, sorted by address.
+     */
+    ZyanVector functions;
+    /**
+     * @brief   The unique targets of all relative branches inside the module, sorted by address.
+     */
+    ZyanVector branch_targets;
+} ZyrexModuleIndex;
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   Contains global data for the function index.
+ */
+static struct
+{
+    /**
+     * @brief   Signals, if the global data is initialized.
+     */
+    ZyanBool is_initialized;
+    /**
+     * @brief   Signals, if patch window validation is enabled.
+     */
+    ZyanBool is_enabled;
+    /**
+     * @brief   The critical section that guards the `modules` vector.
+     */
+    ZyanCriticalSection lock;
+    /**
+     * @brief   A vector that contains pointers to the cached `ZyrexModuleIndex` structs.
+     */
+    ZyanVector modules;
+    /**
+     * @brief   The number of modules unloaded by the dynamic linker at the time the cached module
+     *          indices were validated the last time.
+     */
+    ZyanU64 module_unload_count;
+} g_function_index_data;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+#if defined(ZYAN_LINUX)
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Module information                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ZyrexModuleInfo` struct.
+ */
+typedef struct ZyrexModuleInfo_
+{
+    /**
+     * @brief   The address to search for.
+     */
+    ZyanUPointer address;
+    /**
+     * @brief   Signals, if a module containing `address` was found.
+     */
+    ZyanBool is_found;
+    /**
+     * @brief   The load bias of the module.
+     */
+    ZyanUPointer base;
+    /**
+     * @brief   The lowest address of the module image.
+     */
+    ZyanUPointer address_lo;
+    /**
+     * @brief   The highest address of the module image (exclusive).
+     */
+    ZyanUPointer address_hi;
+    /**
+     * @brief   The number of executable segments.
+     */
+    ZyanUSize segment_count;
+    /**
+     * @brief   The address ranges of the executable segments.
+     */
+    ZyrexFunctionRange segments[ZYREX_FUNCTION_INDEX_MAX_SEGMENTS];
+    /**
+     * @brief   The path of the module file.
+     */
+    char path[PATH_MAX];
+} ZyrexModuleInfo;
+
+/**
+ * @brief   The `dl_iterate_phdr` callback used to find the module that contains a specific
+ *          address.
+ *
+ * @param   info    A pointer to the `dl_phdr_info` struct.
+ * @param   size    The size of the `dl_phdr_info` struct.
+ * @param   data    A pointer to the `ZyrexModuleInfo` struct.
+ *
+ * @return  `1` to stop the enumeration, if the module was found or `0`, if not.
+ */
+static int ZyrexFindModuleCallback(struct dl_phdr_info* info, size_t size, void* data)
+{
+    ZYAN_UNUSED(size);
+
+    ZyrexModuleInfo* const module = (ZyrexModuleInfo*)data;
+
+    ZyanUPointer lo = (ZyanUPointer)(-1);
+    ZyanUPointer hi = 0;
+    ZyanBool is_found = ZYAN_FALSE;
+    for (ZyanUSize i = 0; i < info->dlpi_phnum; ++i)
+    {
+        const ElfW(Phdr)* const phdr = &info->dlpi_phdr[i];
+        if (phdr->p_type != PT_LOAD)
+        {
+            continue;
+        }
+        const ZyanUPointer segment_lo = info->dlpi_addr + phdr->p_vaddr;
+        const ZyanUPointer segment_hi = segment_lo + phdr->p_memsz;
+        lo = ZYAN_MIN(lo, segment_lo);
+        hi = ZYAN_MAX(hi, segment_hi);
+        if ((module->address >= segment_lo) && (module->address < segment_hi))
+        {
+            is_found = ZYAN_TRUE;
+        }
+    }
+    if (!is_found)
+    {
+        return 0;
+    }
+
+    module->is_found = ZYAN_TRUE;
+    module->base = info->dlpi_addr;
+    module->address_lo = lo;
+    module->address_hi = hi;
+    module->segment_count = 0;
+    for (ZyanUSize i = 0; i < info->dlpi_phnum; ++i)
+    {
+        const ElfW(Phdr)* const phdr = &info->dlpi_phdr[i];
+        if ((phdr->p_type != PT_LOAD) || !(phdr->p_flags & PF_X) ||
+            (module->segment_count == ZYREX_FUNCTION_INDEX_MAX_SEGMENTS))
+        {
+            continue;
+        }
+        module->segments[module->segment_count].address = info->dlpi_addr + phdr->p_vaddr;
+        module->segments[module->segment_count].size = phdr->p_memsz;
+        ++module->segment_count;
+    }
+
+    // The main executable is reported with an empty name
+    const char* const path = (info->dlpi_name && info->dlpi_name[0])
+        ? info->dlpi_name
+        : "/proc/self/exe";
+    const ZyanUSize length = ZYAN_STRLEN(path);
+    if (length >= sizeof(module->path))
+    {
+        module->path[0] = '\0';
+        return 1;
+    }
+    ZYAN_MEMCPY(module->path, path, length + 1);
+
+    return 1;
+}
+
+/**
+ * @brief   The `dl_iterate_phdr` callback used to query the number of modules unloaded by the
+ *          dynamic linker.
+ *
+ * @param   info    A pointer to the `dl_phdr_info` struct.
+ * @param   size    The size of the `dl_phdr_info` struct.
+ * @param   data    A pointer to a `ZyanU64` value that receives the unload count.
+ *
+ * @return  `1` to stop the enumeration after the first module.
+ *
+ * The value is left untouched, if the dynamic linker does not provide the counter.
+ */
+static int ZyrexGetModuleUnloadCountCallback(struct dl_phdr_info* info, size_t size, void* data)
+{
+    if (size >= offsetof(struct dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs))
+    {
+        *(ZyanU64*)data = (ZyanU64)info->dlpi_subs;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief   Checks, if the given function range is fully contained in one of the executable
+ *          segments of the module.
+ *
+ * @param   module      A pointer to the `ZyrexModuleInfo` struct.
+ * @param   function    A pointer to the `ZyrexFunctionRange` struct.
+ *
+ * @return  `ZYAN_TRUE` if the function range is executable or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool ZyrexIsExecutableRange(const ZyrexModuleInfo* module,
+    const ZyrexFunctionRange* function)
+{
+    ZYAN_ASSERT(module);
+    ZYAN_ASSERT(function);
+
+    for (ZyanUSize i = 0; i < module->segment_count; ++i)
+    {
+        const ZyrexFunctionRange* const segment = &module->segments[i];
+        if ((function->address >= segment->address) &&
+            (function->address + function->size <= segment->address + segment->size))
+        {
+            return ZYAN_TRUE;
+        }
+    }
+
+    return ZYAN_FALSE;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Sorting                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Compares two `ZyrexFunctionRange` structs by address.
+ *
+ * @param   left    A pointer to the first element.
+ * @param   right   A pointer to the second element.
+ *
+ * @return  A value less than, equal to or greater than zero.
+ */
+static int ZyrexSortCompareFunctionRange(const void* left, const void* right)
+{
+    const ZyanUPointer a = ((const ZyrexFunctionRange*)left)->address;
+    const ZyanUPointer b = ((const ZyrexFunctionRange*)right)->address;
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/**
+ * @brief   Compares two `ZyanUPointer` values.
+ *
+ * @param   left    A pointer to the first element.
+ * @param   right   A pointer to the second element.
+ *
+ * @return  A value less than, equal to or greater than zero.
+ */
+static int ZyrexSortCompareAddress(const void* left, const void* right)
+{
+    const ZyanUPointer a = *(const ZyanUPointer*)left;
+    const ZyanUPointer b = *(const ZyanUPointer*)right;
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Index construction                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Collects all function symbols of the given module.
+ *
+ * @param   module      A pointer to the `ZyrexModuleInfo` struct.
+ * @param   functions   A pointer to an initialized `ZyanVector` instance that receives the
+ *                      function ranges.
+ *
+ * @return  A zyan status code.
+ *
+ * The regular symbol table (`.symtab`) is preferred over the dynamic one (`.dynsym`), as it
+ * includes the sizes of non-exported functions as well. Missing or stripped module files are not
+ * considered an error.
+ */
+static ZyanStatus ZyrexCollectFunctions(const ZyrexModuleInfo* module, ZyanVector* functions)
+{
+    ZYAN_ASSERT(module);
+    ZYAN_ASSERT(functions);
+
+    if (!module->path[0])
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    const int fd = open(module->path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+    struct stat file_stat;
+    if ((fstat(fd, &file_stat) != 0) || (file_stat.st_size < (off_t)sizeof(ElfW(Ehdr))))
+    {
+        close(fd);
+        return ZYAN_STATUS_SUCCESS;
+    }
+    const ZyanUSize file_size = (ZyanUSize)file_stat.st_size;
+    const ZyanU8* const file = mmap(ZYAN_NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+
+    const ElfW(Ehdr)* const ehdr = (const ElfW(Ehdr)*)file;
+#if defined(ZYAN_X64)
+    const ZyanU8 elf_class = ELFCLASS64;
+#else
+    const ZyanU8 elf_class = ELFCLASS32;
+#endif
+    if ((ZYAN_MEMCMP(ehdr->e_ident, ELFMAG, SELFMAG) != 0) ||
+        (ehdr->e_ident[EI_CLASS] != elf_class) ||
+        (ehdr->e_shentsize != sizeof(ElfW(Shdr))) ||
+        (ehdr->e_shoff > file_size) ||
+        ((file_size - ehdr->e_shoff) / sizeof(ElfW(Shdr)) < ehdr->e_shnum))
+    {
+        goto Cleanup;
+    }
+
+    const ElfW(Shdr)* const shdrs = (const ElfW(Shdr)*)(file + ehdr->e_shoff);
+    const ElfW(Shdr)* symtab = ZYAN_NULL;
+    for (ZyanUSize i = 0; i < ehdr->e_shnum; ++i)
+    {
+        if (shdrs[i].sh_type == SHT_SYMTAB)
+        {
+            symtab = &shdrs[i];
+            break;
+        }
+        if ((shdrs[i].sh_type == SHT_DYNSYM) && !symtab)
+        {
+            symtab = &shdrs[i];
+        }
+    }
+    if (!symtab || (symtab->sh_offset > file_size) || 
+        (symtab->sh_size > file_size - symtab->sh_offset))
+    {
+        goto Cleanup;
+    }
+
+    const ElfW(Sym)* const symbols = (const ElfW(Sym)*)(file + symtab->sh_offset);
+    const ZyanUSize symbol_count = symtab->sh_size / sizeof(ElfW(Sym));
+    for (ZyanUSize i = 0; i < symbol_count; ++i)
+    {
+        const ElfW(Sym)* const symbol = &symbols[i];
+        if ((ZYREX_ELF_ST_TYPE(symbol->st_info) != STT_FUNC) || (symbol->st_shndx == SHN_UNDEF) ||
+            (symbol->st_size == 0))
+        {
+            continue;
+        }
+
+        ZyrexFunctionRange function;
+        function.address = module->base + symbol->st_value;
+        function.size = symbol->st_size;
+        if (!ZyrexIsExecutableRange(module, &function))
+        {
+            continue;
+        }
+
+        status = ZyanVectorPushBack(functions, &function);
+        if (!ZYAN_SUCCESS(status))
+        {
+            goto Cleanup;
+        }
+    }
+
+Cleanup:
+    munmap((void*)file, file_size);
+    return status;
+}
+
+/**
+ * @brief   Collects the targets of all relative branches inside the given function.
+ *
+ * @param   decoder         A pointer to the `ZydisDecoder` instance.
+ * @param   index           A pointer to the `ZyrexModuleIndex` struct.
+ * @param   function        A pointer to the `ZyrexFunctionRange` struct.
+ *
+ * @return  A zyan status code.
+ *
+ * Only branch targets inside the module image are recorded. Scanning stops at the first byte
+ * sequence that can not be decoded (e.g. embedded data).
+ */
+static ZyanStatus ZyrexCollectBranchTargets(const ZydisDecoder* decoder, ZyrexModuleIndex* index,
+    const ZyrexFunctionRange* function)
+{
+    ZYAN_ASSERT(decoder);
+    ZYAN_ASSERT(index);
+    ZYAN_ASSERT(function);
+
+    ZydisDecodedInstruction instruction;
+    ZyanUSize offset = 0;
+    while (offset < function->size)
+    {
+        const ZyanUPointer address = function->address + offset;
+        if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(decoder, ZYAN_NULL, (const void*)address,
+            function->size - offset, &instruction)))
+        {
+            break;
+        }
+        offset += instruction.length;
+
+        if (!instruction.raw.imm[0].is_relative)
+        {
+            continue;
+        }
+
+        ZyanU64 target;
+        ZYAN_CHECK(ZyrexCalcAbsoluteAddress(&instruction, address, &target));
+        if ((target < index->address_lo) || (target >= index->address_hi))
+        {
+            continue;
+        }
+
+        const ZyanUPointer value = (ZyanUPointer)target;
+        ZYAN_CHECK(ZyanVectorPushBack(&index->branch_targets, &value));
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Builds the index for the given module.
+ *
+ * @param   module  A pointer to the `ZyrexModuleInfo` struct.
+ * @param   index   A pointer to the `ZyrexModuleIndex` struct.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexModuleIndexBuild(const ZyrexModuleInfo* module, ZyrexModuleIndex* index)
+{
+    ZYAN_ASSERT(module);
+    ZYAN_ASSERT(index);
+
+    index->address_lo = module->address_lo;
+    index->address_hi = module->address_hi;
+
+    ZYAN_CHECK(ZyanVectorInit(&index->functions, sizeof(ZyrexFunctionRange), 256, ZYAN_NULL));
+    ZyanStatus status = ZyanVectorInit(&index->branch_targets, sizeof(ZyanUPointer), 1024, 
+        ZYAN_NULL);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyanVectorDestroy(&index->functions);
+        return status;
+    }
+
+    status = ZyrexCollectFunctions(module, &index->functions);
+    if (!ZYAN_SUCCESS(status))
+    {
+        goto Error;
+    }
+    if (index->functions.size == 0)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    qsort(index->functions.data, index->functions.size, sizeof(ZyrexFunctionRange),
+        &ZyrexSortCompareFunctionRange);
+
+    ZydisDecoder decoder;
+#if defined(ZYAN_X86)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_COMPAT_32, ZYDIS_STACK_WIDTH_32);
+#elif defined(ZYAN_X64)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+#else
+#   error "Unsupported architecture detected"
+#endif
+
+    // Scan every function body exactly once, skipping aliases
+    ZyanUPointer previous_address = 0;
+    for (ZyanUSize i = 0; i < index->functions.size; ++i)
+    {
+        const ZyrexFunctionRange* const function = ZyanVectorGet(&index->functions, i);
+        ZYAN_ASSERT(function);
+        if (function->address == previous_address)
+        {
+            continue;
+        }
+        previous_address = function->address;
+
+        status = ZyrexCollectBranchTargets(&decoder, index, function);
+        if (!ZYAN_SUCCESS(status))
+        {
+            goto Error;
+        }
+    }
+
+    // Sort and remove duplicates
+    ZyanUPointer* const targets = (ZyanUPointer*)index->branch_targets.data;
+    ZyanUSize count = index->branch_targets.size;
+    if (count > 0)
+    {
+        qsort(targets, count, sizeof(ZyanUPointer), &ZyrexSortCompareAddress);
+        ZyanUSize unique = 1;
+        for (ZyanUSize i = 1; i < count; ++i)
+        {
+            if (targets[i] != targets[unique - 1])
+            {
+                targets[unique++] = targets[i];
+            }
+        }
+        status = ZyanVectorResize(&index->branch_targets, unique);
+        if (!ZYAN_SUCCESS(status))
+        {
+            goto Error;
+        }
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+
+Error:
+    ZyanVectorDestroy(&index->branch_targets);
+    ZyanVectorDestroy(&index->functions);
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Comparison                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Compares two `ZyrexFunctionRange` structs by address.
+ *
+ * @param   left    A pointer to the first element.
+ * @param   right   A pointer to the second element.
+ *
+ * @return  A value less than, equal to or greater than zero.
+ */
+static ZYAN_DECLARE_COMPARISON_FOR_FIELD(ZyrexCompareFunctionRange, ZyrexFunctionRange, address)
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Module index                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Destroys the given module index.
+ *
+ * @param   index   A pointer to the `ZyrexModuleIndex` pointer.
+ */
+static void ZyrexModuleIndexDestroy(ZyrexModuleIndex** index)
+{
+    ZYAN_ASSERT(index && *index);
+
+    ZyanVectorDestroy(&(*index)->branch_targets);
+    ZyanVectorDestroy(&(*index)->functions);
+
+    // TODO: Replace with ZyanMemoryFree in the future
+    ZYAN_FREE(*index);
+}
+
+/**
+ * @brief   Returns the index of the module that contains the given `address`.
+ *
+ * @param   address A pointer to an address inside the module.
+ * @param   index   Receives a pointer to the `ZyrexModuleIndex` struct or `ZYAN_NULL`, if no
+ *                  information about the module is available.
+ *
+ * @return  A zyan status code.
+ *
+ * The index is built on first use. All cached indices are released, if a module was unloaded
+ * since the last call, as a different module might have been loaded to the same address range.
+ *
+ * This function has to be called while holding the lock. The returned index is valid until the
+ * lock is released.
+ */
+static ZyanStatus ZyrexModuleIndexGet(const void* address, const ZyrexModuleIndex** index)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(index);
+
+    *index = ZYAN_NULL;
+
+#if defined(ZYAN_LINUX)
+
+    ZyanU64 unload_count = g_function_index_data.module_unload_count;
+    dl_iterate_phdr(&ZyrexGetModuleUnloadCountCallback, &unload_count);
+    if (unload_count != g_function_index_data.module_unload_count)
+    {
+        ZYAN_CHECK(ZyanVectorClear(&g_function_index_data.modules));
+        g_function_index_data.module_unload_count = unload_count;
+    }
+
+#endif
+
+    ZYAN_VECTOR_FOREACH(ZyrexModuleIndex*, &g_function_index_data.modules, module,
+    {
+        if (((ZyanUPointer)address >= module->address_lo) &&
+            ((ZyanUPointer)address < module->address_hi))
+        {
+            *index = module;
+            return ZYAN_STATUS_SUCCESS;
+        }
+    });
+
+#if defined(ZYAN_LINUX)
+
+    // TODO: Replace with ZyanMemoryAlloc in the future
+    ZyrexModuleInfo* const module = ZYAN_MALLOC(sizeof(ZyrexModuleInfo));
+    if (!module)
+    {
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    }
+    module->address = (ZyanUPointer)address;
+    module->is_found = ZYAN_FALSE;
+    dl_iterate_phdr(&ZyrexFindModuleCallback, module);
+    if (!module->is_found)
+    {
+        ZYAN_FREE(module);
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    // TODO: Replace with ZyanMemoryAlloc in the future
+    ZyrexModuleIndex* result = ZYAN_MALLOC(sizeof(ZyrexModuleIndex));
+    if (!result)
+    {
+        ZYAN_FREE(module);
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    }
+
+    ZyanStatus status = ZyrexModuleIndexBuild(module, result);
+    ZYAN_FREE(module);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZYAN_FREE(result);
+        return status;
+    }
+    status = ZyanVectorPushBack(&g_function_index_data.modules, &result);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexModuleIndexDestroy(&result);
+        return status;
+    }
+
+    *index = result;
+
+#endif
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Checks, if the given patch window can be safely overwritten.
+ *
+ * @param   index           A pointer to the `ZyrexModuleIndex` struct of the containing module.
+ * @param   function        The entry address of the target function.
+ * @param   patch_address   The start address of the patch window.
+ * @param   patch_size      The size of the patch window.
+ *
+ * @return  `ZYAN_STATUS_SUCCESS` if the patch window is safe, `ZYREX_STATUS_UNSAFE_PATCH_WINDOW`
+ *          if not, or a generic zyan status code if an error occured.
+ *
+ * This function has to be called while holding the lock.
+ */
+static ZyanStatus ZyrexModuleIndexValidatePatchWindow(const ZyrexModuleIndex* index,
+    const void* function, const void* patch_address, ZyanUSize patch_size)
+{
+    ZYAN_ASSERT(index);
+    ZYAN_ASSERT(function);
+    ZYAN_ASSERT(patch_address);
+
+    const ZyanUPointer window_lo = (ZyanUPointer)patch_address;
+    const ZyanUPointer window_hi = window_lo + patch_size;
+
+    // The patch window must not exceed the bounds of the containing function
+    const ZyrexFunctionRange key = { (ZyanUPointer)function, 0 };
+    ZyanUSize found_index;
+    ZYAN_CHECK(ZyanVectorBinarySearch(&index->functions, &key, &found_index,
+        (ZyanComparison)&ZyrexCompareFunctionRange));
+    const ZyrexFunctionRange* range = ZYAN_NULL;
+    if ((found_index < index->functions.size) &&
+        (((const ZyrexFunctionRange*)ZyanVectorGet(&index->functions, found_index))->address ==
+            key.address))
+    {
+        range = ZyanVectorGet(&index->functions, found_index);
+    } else if (found_index > 0)
+    {
+        range = ZyanVectorGet(&index->functions, found_index - 1);
+    }
+    if (range && (key.address < range->address + range->size) &&
+        (window_hi > range->address + range->size))
+    {
+        return ZYREX_STATUS_UNSAFE_PATCH_WINDOW;
+    }
+
+    // No branch may target the interior of the patch window
+    const ZyanUPointer first = window_lo + 1;
+    ZYAN_CHECK(ZyanVectorBinarySearch(&index->branch_targets, &first, &found_index,
+        (ZyanComparison)&ZyanComparePointer));
+    for (ZyanUSize i = found_index; i < index->branch_targets.size; ++i)
+    {
+        const ZyanUPointer target = *(const ZyanUPointer*)ZyanVectorGet(&index->branch_targets, i);
+        if (target >= window_hi)
+        {
+            break;
+        }
+        if (target != (ZyanUPointer)function)
+        {
+            return ZYREX_STATUS_UNSAFE_PATCH_WINDOW;
+        }
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Returns the bounds of the function that starts at the given `address`.
+ *
+ * @param   index   A pointer to the `ZyrexModuleIndex` struct of the containing module.
+ * @param   address A pointer to the entry of the function.
+ * @param   begin   Receives the start address of the function.
+ * @param   end     Receives the end address of the function (exclusive).
+ *
+ * @return  `ZYAN_STATUS_NOT_FOUND`, if no information about the function is available, or a zyan
+ *          status code.
+ *
+ * This function has to be called while holding the lock.
+ */
+static ZyanStatus ZyrexModuleIndexGetFunctionRange(const ZyrexModuleIndex* index,
+    const void* address, ZyanUPointer* begin, ZyanUPointer* end)
+{
+    ZYAN_ASSERT(index);
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(begin);
+    ZYAN_ASSERT(end);
+
+    const ZyrexFunctionRange key = { (ZyanUPointer)address, 0 };
+    ZyanUSize found_index;
+    ZYAN_CHECK(ZyanVectorBinarySearch(&index->functions, &key, &found_index,
+        (ZyanComparison)&ZyrexCompareFunctionRange));
+    if (found_index >= index->functions.size)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+    const ZyrexFunctionRange* const range = ZyanVectorGet(&index->functions, found_index);
+    if ((range->address != key.address) || !range->size)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    *begin = range->address;
+    *end = range->address + range->size;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Initialization & Finalization                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexFunctionIndexInit(void)
+{
+    if (g_function_index_data.is_initialized)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZYAN_CHECK(ZyanVectorInit(&g_function_index_data.modules, sizeof(ZyrexModuleIndex*), 8,
+        (ZyanMemberProcedure)&ZyrexModuleIndexDestroy));
+    const ZyanStatus status = ZyanCriticalSectionInitialize(&g_function_index_data.lock);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyanVectorDestroy(&g_function_index_data.modules);
+        return status;
+    }
+    g_function_index_data.is_initialized = ZYAN_TRUE;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexFunctionIndexClear(void)
+{
+    if (!g_function_index_data.is_initialized)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    g_function_index_data.is_initialized = ZYAN_FALSE;
+    g_function_index_data.is_enabled = ZYAN_FALSE;
+    ZYAN_CHECK(ZyanVectorDestroy(&g_function_index_data.modules));
+
+    return ZyanCriticalSectionDelete(&g_function_index_data.lock);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Validation                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexFunctionIndexValidatePatchWindow(const void* function, const void* patch_address,
+    ZyanUSize patch_size)
+{
+    if (!function || !patch_address)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+    if (!g_function_index_data.is_enabled)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZYAN_CHECK(ZyanCriticalSectionEnter(&g_function_index_data.lock));
+    const ZyrexModuleIndex* index;
+    ZyanStatus status = ZyrexModuleIndexGet(function, &index);
+    if (ZYAN_SUCCESS(status) && index)
+    {
+        status = ZyrexModuleIndexValidatePatchWindow(index, function, patch_address, patch_size);
+    }
+    ZYAN_CHECK(ZyanCriticalSectionLeave(&g_function_index_data.lock));
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Lookup                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexFunctionIndexGetFunctionRange(const void* address, ZyanUPointer* begin,
+    ZyanUPointer* end)
+{
+    if (!address || !begin || !end)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+    if (!g_function_index_data.is_initialized)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    ZYAN_CHECK(ZyanCriticalSectionEnter(&g_function_index_data.lock));
+    const ZyrexModuleIndex* index;
+    ZyanStatus status = ZyrexModuleIndexGet(address, &index);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = index
+            ? ZyrexModuleIndexGetFunctionRange(index, address, begin, end)
+            : ZYAN_STATUS_NOT_FOUND;
+    }
+    ZYAN_CHECK(ZyanCriticalSectionLeave(&g_function_index_data.lock));
+
+    return status;
+}
+
+ZyanStatus ZyrexFunctionIndexGetFunctions(const void* address, ZyanVector* functions)
+{
+    if (!address || !functions)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+    if (!g_function_index_data.is_initialized)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    const ZyrexModuleIndex* index;
+    ZYAN_CHECK(ZyanCriticalSectionEnter(&g_function_index_data.lock));
+    ZyanStatus status = ZyrexModuleIndexGet(address, &index);
+    if (ZYAN_SUCCESS(status) && (!index || (index->functions.size == 0)))
+    {
+        status = ZYAN_STATUS_NOT_FOUND;
+    }
+
+    // The ranges are copied, as the module index might be released after leaving the lock
+    ZyanUPointer previous_address = 0;
+    for (ZyanUSize i = 0; ZYAN_SUCCESS(status) && (i < index->functions.size); ++i)
+    {
+        const ZyrexFunctionRange* const function = ZyanVectorGet(&index->functions, i);
+        ZYAN_ASSERT(function);
+        if (function->address == previous_address)
+        {
+            continue;
+        }
+        previous_address = function->address;
+
+        status = ZyanVectorPushBack(functions, function);
+    }
+    ZYAN_CHECK(ZyanCriticalSectionLeave(&g_function_index_data.lock));
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Configuration                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexSetPatchWindowValidation(ZyanBool enable)
+{
+    if (!g_function_index_data.is_initialized && !enable)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZYAN_CHECK(ZyrexFunctionIndexInit());
+    g_function_index_data.is_enabled = enable;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
@@ -0,0 +1,564 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zycore/Vector.h>
+#include <Zyrex/HookChain.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Internal/HookChain.h>
+#include <Zyrex/Internal/Trampoline.h>
+#include <Zyrex/Internal/Utils.h>
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexHookChainEntry` struct.
+ */
+typedef struct ZyrexHookChainEntry_
+{
+    /**
+     * @brief   The callback address.
+     */
+    const void* callback;
+    /**
+     * @brief   The priority of the callback.
+     */
+    ZyanI32 priority;
+    /**
+     * @brief   A pointer to the memory that receives the address of the next callback.
+     */
+    ZyanConstVoidPointer* next;
+} ZyrexHookChainEntry;
+
+/**
+ * @brief   Defines the `ZyrexHookChain` struct.
+ */
+typedef struct ZyrexHookChain_
+{
+    /**
+     * @brief   The hooked address.
+     */
+    void* address;
+    /**
+     * @brief   The trampoline chunk of the inline hook.
+     */
+    ZyrexTrampolineChunk* trampoline;
+    /**
+     * @brief   The trampoline to the original function.
+     */
+    ZyanConstVoidPointer original;
+    /**
+     * @brief   The callbacks of the chain (sorted by descending priority).
+     */
+    ZyanVector/*<ZyrexHookChainEntry>*/ entries;
+} ZyrexHookChain;
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   Contains global hook chain data.
+ *
+ * The chain metadata is only accessed while modifying a chain. Threads executing the hooked code
+ * exclusively read the `next` pointers and the callback address of the trampoline.
+ */
+static struct
+{
+    /**
+     * @brief   The lock that serializes all modifications of hook chains.
+     */
+    ZyrexSpinLock lock;
+    /**
+     * @brief   Signals, if the hook chain data is initialized.
+     */
+    ZyanBool is_initialized;
+    /**
+     * @brief   All hook chains (sorted by address).
+     */
+    ZyanVector/*<ZyrexHookChain>*/ chains;
+} g_hook_chain_data =
+{
+    ZYREX_SPIN_LOCK_INITIALIZER, ZYAN_FALSE, ZYAN_VECTOR_INITIALIZER
+};
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Helper functions                                                                               */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Compares two hook chains by their address.
+ *
+ * @param   left    A pointer to the first `ZyrexHookChain` struct.
+ * @param   right   A pointer to the second `ZyrexHookChain` struct.
+ *
+ * @return  A value less than zero, zero or a value greater than zero.
+ */
+static ZyanI32 ZyrexCompareHookChain(const ZyrexHookChain* left, const ZyrexHookChain* right)
+{
+    ZYAN_ASSERT(left);
+    ZYAN_ASSERT(right);
+
+    if ((ZyanUPointer)left->address < (ZyanUPointer)right->address)
+    {
+        return -1;
+    }
+    if ((ZyanUPointer)left->address > (ZyanUPointer)right->address)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Returns the callback at the given `index` of the chain.
+ *
+ * @param   chain   A pointer to the `ZyrexHookChain` struct.
+ * @param   index   The index of the callback.
+ *
+ * @return  The callback at the given `index` or the trampoline to the original function, if the
+ *          `index` is past the last callback.
+ */
+static const void* ZyrexHookChainGetCallback(const ZyrexHookChain* chain, ZyanUSize index)
+{
+    ZYAN_ASSERT(chain);
+
+    if (index >= chain->entries.size)
+    {
+        return chain->original;
+    }
+
+    const ZyrexHookChainEntry* const entry = ZyanVectorGet(&chain->entries, index);
+    ZYAN_ASSERT(entry);
+
+    return entry->callback;
+}
+
+/**
+ * @brief   Atomically publishes the given `value` to a `next` pointer.
+ *
+ * @param   next    A pointer to the `next` pointer.
+ * @param   value   The value to publish.
+ */
+static void ZyrexHookChainPublish(ZyanConstVoidPointer* next, const void* value)
+{
+    ZYAN_ASSERT(next);
+
+    ZyrexAtomicStore((volatile ZyanUPointer*)next, (ZyanUPointer)value);
+}
+
+/**
+ * @brief   Links the callback at the given `index` of the chain to its predecessor.
+ *
+ * @param   chain   A pointer to the `ZyrexHookChain` struct.
+ * @param   index   The index of the callback.
+ * @param   target  The new target of the predecessor.
+ *
+ * @return  A zyan status code.
+ *
+ * The first callback of the chain is linked to the trampoline.
+ */
+static ZyanStatus ZyrexHookChainLinkPredecessor(ZyrexHookChain* chain, ZyanUSize index,
+    const void* target)
+{
+    ZYAN_ASSERT(chain);
+
+    if (index == 0)
+    {
+        return ZyrexTrampolineSetCallback(chain->trampoline, target);
+    }
+
+    const ZyrexHookChainEntry* const predecessor = ZyanVectorGet(&chain->entries, index - 1);
+    ZYAN_ASSERT(predecessor);
+
+    ZyrexHookChainPublish(predecessor->next, target);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Chain creation and destruction                                                                 */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Installs the inline hook for a new chain and inserts it at the given `index`.
+ *
+ * @param   index   The insertion index in the chain list.
+ * @param   entry   A pointer to the `ZyrexHookChainEntry` struct of the first callback.
+ * @param   address The address to hook.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexHookChainCreate(ZyanUSize index, const ZyrexHookChainEntry* entry,
+    void* address)
+{
+    ZYAN_ASSERT(entry);
+    ZYAN_ASSERT(address);
+
+    ZyrexHookChain chain;
+    chain.address = address;
+    chain.trampoline = ZYAN_NULL;
+    chain.original = ZYAN_NULL;
+
+    // Allocate all metadata in advance, as the hook can not be reverted once it is installed
+    ZYAN_CHECK(ZyanVectorReserve(&g_hook_chain_data.chains, g_hook_chain_data.chains.size + 1));
+    ZYAN_CHECK(ZyanVectorInit(&chain.entries, sizeof(ZyrexHookChainEntry), 4, ZYAN_NULL));
+    ZyanStatus status = ZyanVectorPushBack(&chain.entries, entry);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyanVectorDestroy(&chain.entries);
+        return status;
+    }
+
+    ZyrexTransaction* transaction;
+    status = ZyrexTransactionCreate(&transaction);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyanVectorDestroy(&chain.entries);
+        return status;
+    }
+
+    // The callback of the hook is exchanged whenever the first callback of the chain changes
+    const ZyrexHookSpec spec =
+    {
+        /* address             */ address,
+        /* callback            */ entry->callback,
+        /* trampoline          */ &chain.original,
+        /* patch_size          */ ZYREX_DEFAULT_PATCH_SIZE,
+        /* flags               */ ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP
+    };
+    ZyanStatus result;
+    status = ZyrexTransactionInstallInlineHooks(transaction, &spec, 1, &result);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = result;
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        // The `next` pointer has to be valid before the hook becomes reachable
+        ZyrexHookChainPublish(entry->next, chain.original);
+        status = ZyrexTransactionUpdateAllThreads(transaction);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexTransactionApply(transaction, ZYAN_NULL);
+    }
+    ZYAN_UNUSED(ZyrexTransactionDestroy(transaction));
+
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexTrampolineFind(chain.original, &chain.trampoline);
+        ZYAN_ASSERT(status == ZYAN_STATUS_TRUE);
+        if (status == ZYAN_STATUS_FALSE)
+        {
+            status = ZYAN_STATUS_NOT_FOUND;
+        }
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyanVectorDestroy(&chain.entries);
+        return status;
+    }
+
+    return ZyanVectorInsert(&g_hook_chain_data.chains, index, &chain);
+}
+
+/**
+ * @brief   Removes the inline hook of the chain at the given `index` and deletes the chain.
+ *
+ * @param   index   The index of the chain in the chain list.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexHookChainDestroy(ZyanUSize index)
+{
+    ZyrexHookChain* const chain = ZyanVectorGetMutable(&g_hook_chain_data.chains, index);
+    ZYAN_ASSERT(chain);
+    ZYAN_ASSERT(chain->entries.size == 1);
+
+    ZyrexTransaction* transaction;
+    ZYAN_CHECK(ZyrexTransactionCreate(&transaction));
+
+    ZyanConstVoidPointer original = chain->original;
+    ZyanStatus status = ZyrexTransactionRemoveInlineHook(transaction, &original);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexTransactionUpdateAllThreads(transaction);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexTransactionApply(transaction, ZYAN_NULL);
+    }
+    ZYAN_UNUSED(ZyrexTransactionDestroy(transaction));
+    ZYAN_CHECK(status);
+
+    // Calls through the `next` pointer of the last callback reach the original function from now
+    // on, as the trampoline was released
+    const ZyrexHookChainEntry* const entry = ZyanVectorGet(&chain->entries, 0);
+    ZYAN_ASSERT(entry);
+    ZyrexHookChainPublish(entry->next, original);
+
+    ZyanVectorDestroy(&chain->entries);
+    ZYAN_CHECK(ZyanVectorDelete(&g_hook_chain_data.chains, index));
+
+    if (g_hook_chain_data.chains.size == 0)
+    {
+        ZyanVectorDestroy(&g_hook_chain_data.chains);
+        g_hook_chain_data.is_initialized = ZYAN_FALSE;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Chain modification                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Adds a callback to the hook chain of the given `address`.
+ *
+ * @param   address     The address to hook.
+ * @param   entry       A pointer to the `ZyrexHookChainEntry` struct of the new callback.
+ *
+ * @return  A zyan status code.
+ *
+ * This function has to be called while holding the lock.
+ */
+static ZyanStatus ZyrexHookChainInsert(void* address, const ZyrexHookChainEntry* entry)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(entry);
+
+    if (!g_hook_chain_data.is_initialized)
+    {
+        ZYAN_CHECK(ZyanVectorInit(&g_hook_chain_data.chains, sizeof(ZyrexHookChain), 8,
+            ZYAN_NULL));
+        g_hook_chain_data.is_initialized = ZYAN_TRUE;
+    }
+
+    ZyrexHookChain key;
+    key.address = address;
+
+    ZyanUSize index;
+    const ZyanStatus status = ZyanVectorBinarySearch(&g_hook_chain_data.chains, &key, &index,
+        (ZyanComparison)&ZyrexCompareHookChain);
+    ZYAN_CHECK(status);
+    if (status == ZYAN_STATUS_FALSE)
+    {
+        return ZyrexHookChainCreate(index, entry, address);
+    }
+
+    ZyrexHookChain* const chain = ZyanVectorGetMutable(&g_hook_chain_data.chains, index);
+    ZYAN_ASSERT(chain);
+
+    // Callbacks with equal priority are invoked in the order they were added
+    ZyanUSize position = chain->entries.size;
+    for (ZyanUSize i = 0; i < chain->entries.size; ++i)
+    {
+        const ZyrexHookChainEntry* const item = ZyanVectorGet(&chain->entries, i);
+        ZYAN_ASSERT(item);
+
+        if (item->callback == entry->callback)
+        {
+            return ZYAN_STATUS_INVALID_OPERATION;
+        }
+        if ((item->priority < entry->priority) && (position == chain->entries.size))
+        {
+            position = i;
+        }
+    }
+
+    // Link the new callback to its successor first and make it reachable afterwards
+    ZyrexHookChainPublish(entry->next, ZyrexHookChainGetCallback(chain, position));
+    ZYAN_CHECK(ZyanVectorInsert(&chain->entries, position, entry));
+
+    const ZyanStatus link_status = ZyrexHookChainLinkPredecessor(chain, position,
+        entry->callback);
+    if (!ZYAN_SUCCESS(link_status))
+    {
+        ZYAN_UNUSED(ZyanVectorDelete(&chain->entries, position));
+    }
+
+    return link_status;
+}
+
+/**
+ * @brief   Removes a callback from the hook chain of the given `address`.
+ *
+ * @param   address     The hooked address.
+ * @param   callback    The callback address.
+ *
+ * @return  A zyan status code.
+ *
+ * This function has to be called while holding the lock.
+ */
+static ZyanStatus ZyrexHookChainErase(void* address, const void* callback)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(callback);
+
+    if (!g_hook_chain_data.is_initialized)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    ZyrexHookChain key;
+    key.address = address;
+
+    ZyanUSize index;
+    const ZyanStatus status = ZyanVectorBinarySearch(&g_hook_chain_data.chains, &key, &index,
+        (ZyanComparison)&ZyrexCompareHookChain);
+    ZYAN_CHECK(status);
+    if (status == ZYAN_STATUS_FALSE)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    ZyrexHookChain* const chain = ZyanVectorGetMutable(&g_hook_chain_data.chains, index);
+    ZYAN_ASSERT(chain);
+
+    ZyanUSize position = 0;
+    while ((position < chain->entries.size) &&
+        (ZyrexHookChainGetCallback(chain, position) != callback))
+    {
+        ++position;
+    }
+    if (position == chain->entries.size)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    if (chain->entries.size == 1)
+    {
+        return ZyrexHookChainDestroy(index);
+    }
+
+    // The removed callback keeps its `next` pointer, as other threads might still execute it
+    ZYAN_CHECK(ZyrexHookChainLinkPredecessor(chain, position,
+        ZyrexHookChainGetCallback(chain, position + 1)));
+
+    return ZyanVectorDelete(&chain->entries, position);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook chain                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+void ZyrexHookChainAcquire(void)
+{
+    ZyrexSpinLockAcquire(&g_hook_chain_data.lock);
+}
+
+void ZyrexHookChainRelease(void)
+{
+    ZyrexSpinLockRelease(&g_hook_chain_data.lock);
+}
+
+void ZyrexHookChainReset(void)
+{
+    if (!g_hook_chain_data.is_initialized)
+    {
+        return;
+    }
+
+    for (ZyanUSize i = 0; i < g_hook_chain_data.chains.size; ++i)
+    {
+        ZyrexHookChain* const chain = ZyanVectorGetMutable(&g_hook_chain_data.chains, i);
+        ZYAN_ASSERT(chain);
+
+        // Threads that are still executing one of the callbacks reach the original function
+        const ZyrexHookChainEntry* const entry =
+            ZyanVectorGet(&chain->entries, chain->entries.size - 1);
+        ZYAN_ASSERT(entry);
+        ZyrexHookChainPublish(entry->next, chain->address);
+
+        ZyanVectorDestroy(&chain->entries);
+    }
+
+    ZyanVectorDestroy(&g_hook_chain_data.chains);
+    g_hook_chain_data.is_initialized = ZYAN_FALSE;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook chain                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexInstallChainedHook(void* address, const void* callback, ZyanI32 priority,
+    ZyanConstVoidPointer* next)
+{
+    if (!address || !callback || !next)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyrexHookChainEntry entry;
+    entry.callback = callback;
+    entry.priority = priority;
+    entry.next = next;
+
+    ZyrexSpinLockAcquire(&g_hook_chain_data.lock);
+    const ZyanStatus status = ZyrexHookChainInsert(address, &entry);
+    ZyrexSpinLockRelease(&g_hook_chain_data.lock);
+
+    return status;
+}
+
+ZyanStatus ZyrexRemoveChainedHook(void* address, const void* callback)
+{
+    if (!address || !callback)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyrexSpinLockAcquire(&g_hook_chain_data.lock);
+    const ZyanStatus status = ZyrexHookChainErase(address, callback);
+    ZyrexSpinLockRelease(&g_hook_chain_data.lock);
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
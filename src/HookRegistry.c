@@ -0,0 +1,754 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zycore/Vector.h>
+#include <Zycore/API/Thread.h>
+#include <Zyrex/HookRegistry.h>
+#include <Zyrex/Internal/HookChain.h>
+#include <Zyrex/Internal/HookRegistry.h>
+#include <Zyrex/Internal/Utils.h>
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The initial number of slots of a hook table (has to be a power of two).
+ */
+#define ZYREX_HOOK_TABLE_MIN_CAPACITY   64
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexHookTableSlot` struct.
+ *
+ * A slot with a `key` of `0` is empty. A slot with a `value` of `0` belongs to a removed entry
+ * and keeps its `key`, which allows readers to continue probing without any synchronization.
+ */
+typedef struct ZyrexHookTableSlot_
+{
+    /**
+     * @brief   The key of the entry.
+     */
+    volatile ZyanUPointer key;
+    /**
+     * @brief   The value of the entry (a pointer to the `ZyrexTrampolineChunk` struct).
+     */
+    volatile ZyanUPointer value;
+} ZyrexHookTableSlot;
+
+/**
+ * @brief   Defines the `ZyrexHookTable` struct.
+ *
+ * An open-addressing hash table with linear probing. Readers access the table without acquiring
+ * any locks. Writers are serialized by the registry lock.
+ */
+typedef struct ZyrexHookTable_
+{
+    /**
+     * @brief   The next table in the list of retired tables.
+     */
+    struct ZyrexHookTable_* next;
+    /**
+     * @brief   The number of slots (a power of two).
+     */
+    ZyanUSize capacity;
+    /**
+     * @brief   The number of slots that contain an entry.
+     */
+    ZyanUSize count;
+    /**
+     * @brief   The number of slots that contain an entry or belong to a removed entry.
+     */
+    ZyanUSize used;
+    /**
+     * @brief   The slots of the table.
+     */
+    ZyrexHookTableSlot* slots;
+} ZyrexHookTable;
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   Contains global hook registry data.
+ *
+ * Readers announce themselves by incrementing `readers` before loading a table pointer. A table
+ * that was replaced by a larger one is retired and only released, after no reader was active
+ * behind the replacement. The same applies to the trampoline chunks of removed hooks, as readers
+ * fill the hook information from the chunk.
+ *
+ * Transactions reserve room for all of their insertions and removals before the patch phase, so
+ * updating the registry after a successful patch can not fail.
+ */
+static struct
+{
+    /**
+     * @brief   The lock that serializes all modifications of the hook registry.
+     */
+    ZyrexSpinLock lock;
+    /**
+     * @brief   The number of active lock-free readers.
+     */
+    volatile ZyanUPointer readers;
+    /**
+     * @brief   The table that maps the address of the hooked function to the trampoline chunk.
+     */
+    volatile ZyanUPointer by_address;
+    /**
+     * @brief   The table that maps the trampoline address to the trampoline chunk.
+     */
+    volatile ZyanUPointer by_original;
+    /**
+     * @brief   The list of retired tables.
+     */
+    ZyrexHookTable* retired;
+    /**
+     * @brief   Signals, if `retired_chunks` was initialized.
+     */
+    ZyanBool is_initialized;
+    /**
+     * @brief   The trampoline chunks of removed hooks that were not released yet.
+     */
+    ZyanVector/*<ZyrexTrampolineChunk*>*/ retired_chunks;
+    /**
+     * @brief   The number of reserved insertions.
+     */
+    ZyanUSize reserved_inserts;
+    /**
+     * @brief   The number of reserved removals.
+     */
+    ZyanUSize reserved_removals;
+} g_hook_registry_data =
+{
+    ZYREX_SPIN_LOCK_INITIALIZER, 0, 0, 0, ZYAN_NULL, ZYAN_FALSE, ZYAN_VECTOR_INITIALIZER, 0, 0
+};
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook table                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the slot index for the given `key`.
+ *
+ * @param   table   A pointer to the `ZyrexHookTable` struct.
+ * @param   key     The key.
+ *
+ * @return  The slot index for the given `key`.
+ */
+static ZyanUSize ZyrexHookTableHash(const ZyrexHookTable* table, ZyanUPointer key)
+{
+    ZYAN_ASSERT(table);
+
+    // Fibonacci hashing spreads the (usually aligned) addresses over the whole table
+    ZyanUPointer hash = key * (ZyanUPointer)0x9E3779B97F4A7C15ULL;
+    hash ^= hash >> (sizeof(ZyanUPointer) * 4);
+
+    return (ZyanUSize)hash & (table->capacity - 1);
+}
+
+/**
+ * @brief   Creates a new hook table.
+ *
+ * @param   capacity    The number of slots (has to be a power of two).
+ *
+ * @return  A pointer to the new `ZyrexHookTable` struct or `ZYAN_NULL`, if there was not enough
+ *          memory.
+ */
+static ZyrexHookTable* ZyrexHookTableCreate(ZyanUSize capacity)
+{
+    ZYAN_ASSERT(capacity && !(capacity & (capacity - 1)));
+
+    // TODO: Replace with ZyanMemoryAlloc in the future
+    ZyrexHookTable* const table =
+        ZYAN_MALLOC(sizeof(ZyrexHookTable) + capacity * sizeof(ZyrexHookTableSlot));
+    if (!table)
+    {
+        return ZYAN_NULL;
+    }
+
+    table->next = ZYAN_NULL;
+    table->capacity = capacity;
+    table->count = 0;
+    table->used = 0;
+    table->slots = (ZyrexHookTableSlot*)(table + 1);
+    ZYAN_MEMSET(table->slots, 0, capacity * sizeof(ZyrexHookTableSlot));
+
+    return table;
+}
+
+/**
+ * @brief   Searches the given `key` in the hook table (lock-free).
+ *
+ * @param   table   A pointer to the `ZyrexHookTable` struct.
+ * @param   key     The key.
+ *
+ * @return  The value of the entry or `0`, if the table does not contain the `key`.
+ */
+static ZyanUPointer ZyrexHookTableFind(const ZyrexHookTable* table, ZyanUPointer key)
+{
+    ZYAN_ASSERT(table);
+    ZYAN_ASSERT(key);
+
+    ZyanUSize index = ZyrexHookTableHash(table, key);
+    for (ZyanUSize i = 0; i < table->capacity; ++i)
+    {
+        const ZyanUPointer current = ZyrexAtomicLoad(&table->slots[index].key);
+        if (current == 0)
+        {
+            break;
+        }
+        if (current == key)
+        {
+            return ZyrexAtomicLoad(&table->slots[index].value);
+        }
+        index = (index + 1) & (table->capacity - 1);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Stores the given `value` for the given `key` in the hook table.
+ *
+ * @param   table   A pointer to the `ZyrexHookTable` struct.
+ * @param   key     The key.
+ * @param   value   The value (`0` to remove the entry).
+ *
+ * The caller has to hold the registry lock and has to make sure the table contains at least one
+ * empty slot. The value is published before the key, so readers never observe a key without its
+ * value.
+ */
+static void ZyrexHookTableStore(ZyrexHookTable* table, ZyanUPointer key, ZyanUPointer value)
+{
+    ZYAN_ASSERT(table);
+    ZYAN_ASSERT(key);
+
+    ZyanUSize index = ZyrexHookTableHash(table, key);
+    while (ZYAN_TRUE)
+    {
+        ZyrexHookTableSlot* const slot = &table->slots[index];
+        if (slot->key == key)
+        {
+            table->count -= (slot->value != 0) ? 1 : 0;
+            table->count += (value != 0) ? 1 : 0;
+            ZyrexAtomicStore(&slot->value, value);
+            return;
+        }
+        if (slot->key == 0)
+        {
+            if (value == 0)
+            {
+                return;
+            }
+
+            ZYAN_ASSERT(table->used < table->capacity);
+            ZyrexAtomicStore(&slot->value, value);
+            ZyrexAtomicStore(&slot->key, key);
+            ++table->count;
+            ++table->used;
+            return;
+        }
+        index = (index + 1) & (table->capacity - 1);
+    }
+}
+
+/**
+ * @brief   Makes sure the hook table referenced by `reference` can take `count` more entries.
+ *
+ * @param   reference   A pointer to the global table pointer.
+ * @param   count       The number of entries.
+ *
+ * @return  A zyan status code.
+ *
+ * The caller has to hold the registry lock. If the load factor gets too high, the live entries
+ * are copied to a new table, which replaces the current one. The current table is retired, as
+ * lock-free readers might still access it.
+ */
+static ZyanStatus ZyrexHookTableReserve(volatile ZyanUPointer* reference, ZyanUSize count)
+{
+    ZYAN_ASSERT(reference);
+
+    ZyrexHookTable* const table = (ZyrexHookTable*)*reference;
+    const ZyanUSize used = table ? table->used : 0;
+    const ZyanUSize capacity_in_use = table ? table->capacity : 0;
+    if ((used + count) * 4 <= capacity_in_use * 3)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    const ZyanUSize live = table ? table->count : 0;
+    ZyanUSize capacity = ZYREX_HOOK_TABLE_MIN_CAPACITY;
+    while ((live + count) * 2 > capacity)
+    {
+        capacity *= 2;
+    }
+
+    ZyrexHookTable* const replacement = ZyrexHookTableCreate(capacity);
+    if (!replacement)
+    {
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    }
+
+    if (table)
+    {
+        for (ZyanUSize i = 0; i < table->capacity; ++i)
+        {
+            const ZyrexHookTableSlot* const slot = &table->slots[i];
+            if (slot->key && slot->value)
+            {
+                ZyrexHookTableStore(replacement, slot->key, slot->value);
+            }
+        }
+
+        table->next = g_hook_registry_data.retired;
+        g_hook_registry_data.retired = table;
+    }
+
+    ZyrexAtomicStore(reference, (ZyanUPointer)replacement);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Registry                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Releases the given list of retired hook tables.
+ *
+ * @param   table   A pointer to the first `ZyrexHookTable` struct of the list or `ZYAN_NULL`.
+ */
+static void ZyrexHookRegistryFreeTables(ZyrexHookTable* table)
+{
+    while (table)
+    {
+        ZyrexHookTable* const next = table->next;
+        ZYAN_FREE(table);
+        table = next;
+    }
+}
+
+/**
+ * @brief   Releases all retired trampoline chunks.
+ *
+ * The caller has to hold the registry lock.
+ */
+static void ZyrexHookRegistryFreeChunks(void)
+{
+    if (!g_hook_registry_data.is_initialized)
+    {
+        return;
+    }
+
+    for (ZyanUSize i = 0; i < g_hook_registry_data.retired_chunks.size; ++i)
+    {
+        ZyrexTrampolineChunk* const* const chunk =
+            ZyanVectorGet(&g_hook_registry_data.retired_chunks, i);
+        ZYAN_ASSERT(chunk);
+
+        ZYAN_UNUSED(ZyrexTrampolineFree(*chunk));
+    }
+    ZYAN_UNUSED(ZyanVectorClear(&g_hook_registry_data.retired_chunks));
+}
+
+/**
+ * @brief   Releases all retired hook tables and trampoline chunks, if no lock-free reader is
+ *          active.
+ *
+ * The caller has to hold the registry lock. Readers that start after this check observe the
+ * current tables only, which do not reference any of the retired chunks.
+ */
+static void ZyrexHookRegistryReclaim(void)
+{
+    if (ZyrexAtomicLoad(&g_hook_registry_data.readers) != 0)
+    {
+        return;
+    }
+
+    ZyrexHookRegistryFreeTables(g_hook_registry_data.retired);
+    g_hook_registry_data.retired = ZYAN_NULL;
+    ZyrexHookRegistryFreeChunks();
+}
+
+/**
+ * @brief   Announces a lock-free reader.
+ */
+static void ZyrexHookRegistryReadBegin(void)
+{
+    ZyrexAtomicFetchAdd(&g_hook_registry_data.readers, 1);
+}
+
+/**
+ * @brief   Signals that a lock-free reader is done.
+ */
+static void ZyrexHookRegistryReadEnd(void)
+{
+    ZyrexAtomicFetchAdd(&g_hook_registry_data.readers, (ZyanUPointer)(-1));
+}
+
+/**
+ * @brief   Fills the given `ZyrexHookInfo` struct.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ * @param   info        Receives information about the hook.
+ */
+static void ZyrexHookRegistryGetInfo(const ZyrexTrampolineChunk* trampoline,
+    ZyrexHookInfo* info)
+{
+    ZYAN_ASSERT(trampoline);
+    ZYAN_ASSERT(info);
+
+    const ZyanUPointer callback_address = ZyrexAtomicLoad(
+        (const volatile ZyanUPointer*)&trampoline->callback->callback_address);
+
+    info->type = ZYREX_HOOK_TYPE_INLINE;
+    info->address = ZyrexTrampolineGetTargetAddress(trampoline);
+    info->original = &trampoline->code_buffer;
+    info->callback = (const void*)trampoline->callback->user_callback_address;
+    info->is_enabled = (callback_address != (ZyanUPointer)&trampoline->code_buffer);
+}
+
+/**
+ * @brief   Searches the given `key` in the table referenced by `reference` and fills the given
+ *          `ZyrexHookInfo` struct.
+ *
+ * @param   reference   A pointer to the global table pointer.
+ * @param   key         The key.
+ * @param   info        Receives information about the hook, if found.
+ *
+ * @return  `ZYAN_STATUS_TRUE`, if a hook was found or `ZYAN_STATUS_FALSE`, if not.
+ */
+static ZyanStatus ZyrexHookRegistryFind(const volatile ZyanUPointer* reference, ZyanUPointer key,
+    ZyrexHookInfo* info)
+{
+    ZYAN_ASSERT(reference);
+    ZYAN_ASSERT(info);
+
+    ZyrexHookRegistryReadBegin();
+
+    ZyanStatus status = ZYAN_STATUS_FALSE;
+    const ZyrexHookTable* const table = (const ZyrexHookTable*)ZyrexAtomicLoad(reference);
+    if (table)
+    {
+        const ZyanUPointer value = ZyrexHookTableFind(table, key);
+        if (value)
+        {
+            ZyrexHookRegistryGetInfo((const ZyrexTrampolineChunk*)value, info);
+            status = ZYAN_STATUS_TRUE;
+        }
+    }
+
+    ZyrexHookRegistryReadEnd();
+
+    return status;
+}
+
+/**
+ * @brief   Adds the removal of a single hook to the transaction passed as `context`
+ *          (`ZyrexHookCallback` callback).
+ *
+ * @param   info    A pointer to the `ZyrexHookInfo` struct of the current hook.
+ * @param   context A pointer to the `ZyrexTransaction` object.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexHookRegistryAddRemoval(const ZyrexHookInfo* info, void* context)
+{
+    ZYAN_ASSERT(info);
+    ZYAN_ASSERT(context);
+
+    ZyanConstVoidPointer original = info->original;
+    return ZyrexTransactionRemoveInlineHook((ZyrexTransaction*)context, &original);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook registry                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexHookRegistryReserve(ZyanUSize insert_count, ZyanUSize remove_count)
+{
+    ZyrexSpinLockAcquire(&g_hook_registry_data.lock);
+
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+    if (!g_hook_registry_data.is_initialized)
+    {
+        status = ZyanVectorInit(&g_hook_registry_data.retired_chunks,
+            sizeof(ZyrexTrampolineChunk*), 8, ZYAN_NULL);
+        g_hook_registry_data.is_initialized = ZYAN_SUCCESS(status);
+    }
+
+    // Reservations of concurrent transactions are taken into account, as their insertions are
+    // not part of the tables yet
+    const ZyanUSize inserts = g_hook_registry_data.reserved_inserts + insert_count;
+    const ZyanUSize removals = g_hook_registry_data.reserved_removals + remove_count;
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexHookTableReserve(&g_hook_registry_data.by_address, inserts);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexHookTableReserve(&g_hook_registry_data.by_original, inserts);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyanVectorReserve(&g_hook_registry_data.retired_chunks,
+            g_hook_registry_data.retired_chunks.size + removals);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        g_hook_registry_data.reserved_inserts = inserts;
+        g_hook_registry_data.reserved_removals = removals;
+    }
+    ZyrexHookRegistryReclaim();
+
+    ZyrexSpinLockRelease(&g_hook_registry_data.lock);
+
+    return status;
+}
+
+void ZyrexHookRegistryUnreserve(ZyanUSize insert_count, ZyanUSize remove_count)
+{
+    ZyrexSpinLockAcquire(&g_hook_registry_data.lock);
+
+    ZYAN_ASSERT(insert_count <= g_hook_registry_data.reserved_inserts);
+    ZYAN_ASSERT(remove_count <= g_hook_registry_data.reserved_removals);
+    g_hook_registry_data.reserved_inserts -= insert_count;
+    g_hook_registry_data.reserved_removals -= remove_count;
+
+    ZyrexSpinLockRelease(&g_hook_registry_data.lock);
+}
+
+void ZyrexHookRegistryInsert(const ZyrexTrampolineChunk* trampoline)
+{
+    ZYAN_ASSERT(trampoline);
+
+    ZyrexSpinLockAcquire(&g_hook_registry_data.lock);
+
+    ZYAN_ASSERT(g_hook_registry_data.reserved_inserts);
+    --g_hook_registry_data.reserved_inserts;
+
+    ZyrexHookTableStore((ZyrexHookTable*)g_hook_registry_data.by_address,
+        (ZyanUPointer)ZyrexTrampolineGetTargetAddress(trampoline), (ZyanUPointer)trampoline);
+    ZyrexHookTableStore((ZyrexHookTable*)g_hook_registry_data.by_original,
+        (ZyanUPointer)&trampoline->code_buffer, (ZyanUPointer)trampoline);
+    ZyrexHookRegistryReclaim();
+
+    ZyrexSpinLockRelease(&g_hook_registry_data.lock);
+}
+
+void ZyrexHookRegistryRemove(ZyrexTrampolineChunk* trampoline)
+{
+    ZYAN_ASSERT(trampoline);
+
+    ZyrexSpinLockAcquire(&g_hook_registry_data.lock);
+
+    ZYAN_ASSERT(g_hook_registry_data.reserved_removals);
+    --g_hook_registry_data.reserved_removals;
+
+    if (g_hook_registry_data.by_address)
+    {
+        ZyrexHookTableStore((ZyrexHookTable*)g_hook_registry_data.by_address,
+            (ZyanUPointer)ZyrexTrampolineGetTargetAddress(trampoline), 0);
+    }
+    if (g_hook_registry_data.by_original)
+    {
+        ZyrexHookTableStore((ZyrexHookTable*)g_hook_registry_data.by_original,
+            (ZyanUPointer)&trampoline->code_buffer, 0);
+    }
+
+    // Readers that found the hook before it was unpublished might still access the chunk. The
+    // vector has room for all reserved removals, so this does not allocate
+    const ZyanStatus status = ZyanVectorPushBack(&g_hook_registry_data.retired_chunks,
+        &trampoline);
+    ZYAN_ASSERT(ZYAN_SUCCESS(status));
+    ZYAN_UNUSED(status);
+    ZyrexHookRegistryReclaim();
+
+    ZyrexSpinLockRelease(&g_hook_registry_data.lock);
+}
+
+ZyanStatus ZyrexHookRegistryClear(void)
+{
+    ZyrexSpinLockAcquire(&g_hook_registry_data.lock);
+
+    if (g_hook_registry_data.reserved_inserts || g_hook_registry_data.reserved_removals)
+    {
+        // A transaction is currently applied
+        ZyrexSpinLockRelease(&g_hook_registry_data.lock);
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    // Unpublish both tables first. Readers that start afterwards do not observe any of them
+    ZyrexHookTable* const by_address = (ZyrexHookTable*)g_hook_registry_data.by_address;
+    ZyrexHookTable* const by_original = (ZyrexHookTable*)g_hook_registry_data.by_original;
+    ZyrexAtomicStore(&g_hook_registry_data.by_address, 0);
+    ZyrexAtomicStore(&g_hook_registry_data.by_original, 0);
+
+    // Wait for the readers that might still access the tables or the retired chunks
+    while (ZyrexAtomicLoad(&g_hook_registry_data.readers) != 0)
+    {
+        ZyanThreadYield();
+    }
+
+    // Readers that started in the meantime can not reach any of the tables or chunks
+    ZYAN_FREE(by_address);
+    ZYAN_FREE(by_original);
+    ZyrexHookRegistryFreeTables(g_hook_registry_data.retired);
+    g_hook_registry_data.retired = ZYAN_NULL;
+    ZyrexHookRegistryFreeChunks();
+    if (g_hook_registry_data.is_initialized)
+    {
+        ZyanVectorDestroy(&g_hook_registry_data.retired_chunks);
+        g_hook_registry_data.is_initialized = ZYAN_FALSE;
+    }
+
+    ZyrexSpinLockRelease(&g_hook_registry_data.lock);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Lookup                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexFindHook(const void* address, ZyrexHookInfo* info)
+{
+    if (!address || !info)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return ZyrexHookRegistryFind(&g_hook_registry_data.by_address, (ZyanUPointer)address, info);
+}
+
+ZyanStatus ZyrexFindHookByOriginal(ZyanConstVoidPointer original, ZyrexHookInfo* info)
+{
+    if (!original || !info)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return ZyrexHookRegistryFind(&g_hook_registry_data.by_original, (ZyanUPointer)original,
+        info);
+}
+
+ZyanStatus ZyrexEnumerateHooks(ZyrexHookCallback callback, void* context)
+{
+    if (!callback)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyrexHookRegistryReadBegin();
+
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+    const ZyrexHookTable* const table =
+        (const ZyrexHookTable*)ZyrexAtomicLoad(&g_hook_registry_data.by_address);
+    for (ZyanUSize i = 0; table && (i < table->capacity); ++i)
+    {
+        const ZyanUPointer value = ZyrexAtomicLoad(&table->slots[i].value);
+        if (!value)
+        {
+            continue;
+        }
+
+        ZyrexHookInfo info;
+        ZyrexHookRegistryGetInfo((const ZyrexTrampolineChunk*)value, &info);
+        status = callback(&info, context);
+        if (!ZYAN_SUCCESS(status))
+        {
+            break;
+        }
+    }
+
+    ZyrexHookRegistryReadEnd();
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Teardown                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexRemoveAllHooks(void)
+{
+    // Hook chains are locked first to keep the lock order of `ZyrexInstallChainedHook`
+    ZyrexHookChainAcquire();
+
+    ZyrexTransaction* transaction;
+    ZyanStatus status = ZyrexTransactionCreate(&transaction);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexHookChainRelease();
+        return status;
+    }
+
+    status = ZyrexEnumerateHooks(&ZyrexHookRegistryAddRemoval, transaction);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexTransactionUpdateAllThreads(transaction);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexTransactionApply(transaction, ZYAN_NULL);
+    }
+    ZYAN_UNUSED(ZyrexTransactionDestroy(transaction));
+
+    if (ZYAN_SUCCESS(status))
+    {
+        ZyrexHookChainReset();
+    }
+
+    ZyrexHookChainRelease();
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
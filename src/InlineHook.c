@@ -24,6 +24,10 @@
 
 ***************************************************************************************************/
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
 #include <Zycore/LibC.h>
 #include <Zyrex/Internal/InlineHook.h>
 #include <Zyrex/Internal/Utils.h>
@@ -57,7 +61,6 @@ ZyanStatus ZyrexMigrateThread(HANDLE thread_handle, const void* source, ZyanUSiz
     const DWORD suspend_count = SuspendThread(thread_handle);
     if (suspend_count == (DWORD)(-1))
     {
-        CloseHandle(thread_handle);
         return ZYAN_STATUS_BAD_SYSTEMCALL;
     }
 
@@ -82,7 +85,7 @@ ZyanStatus ZyrexMigrateThread(HANDLE thread_handle, const void* source, ZyanUSiz
         goto CleanupAndResume;
     }
 
-    const ZyanUPointer source_offset = (ZyanUPointer)source - current_ip;
+    const ZyanUPointer source_offset = current_ip - (ZyanUPointer)source;
     for (ZyanUSize i = 0; i < translation_map->count; ++i)
     {
         switch (direction)
@@ -139,7 +142,6 @@ CleanupAndResume:
         const DWORD value = ResumeThread(thread_handle);
         if (value == (DWORD)(-1))
         {
-            CloseHandle(thread_handle);
             return ZYAN_STATUS_BAD_SYSTEMCALL;
         }
         if (value <= suspend_count + 1)
@@ -151,6 +153,67 @@ CleanupAndResume:
     return status;
 }
 
+#elif defined(ZYAN_LINUX)
+
+ZyanStatus ZyrexMigrateThread(ucontext_t* context, const void* source, ZyanUSize source_length,
+    const void* destination, ZyanUSize destination_length,
+    const ZyrexInstructionTranslationMap* translation_map,
+    ZyrexThreadMigrationDirection direction)
+{
+    ZYAN_ASSERT(context);
+    ZYAN_ASSERT(source);
+    ZYAN_ASSERT(destination);
+    ZYAN_ASSERT(translation_map);
+
+#if defined(ZYAN_X64)
+    greg_t* const ip = &context->uc_mcontext.gregs[REG_RIP];
+#elif defined(ZYAN_X86)
+    greg_t* const ip = &context->uc_mcontext.gregs[REG_EIP];
+#else
+#   error "Unsupported architecture detected"
+#endif
+
+    const ZyanUPointer current_ip = (ZyanUPointer)*ip;
+    if ((current_ip < (ZyanUPointer)source) || (current_ip > (ZyanUPointer)source + source_length))
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    const ZyanUPointer source_offset = current_ip - (ZyanUPointer)source;
+    for (ZyanUSize i = 0; i < translation_map->count; ++i)
+    {
+        const ZyrexInstructionTranslationItem* const item = &translation_map->items[i];
+        switch (direction)
+        {
+        case ZYREX_THREAD_MIGRATION_DIRECTION_SRC_DST:
+            if (item->offset_source == source_offset)
+            {
+                *ip = (greg_t)((ZyanUPointer)destination + item->offset_destination);
+                return ZYAN_STATUS_SUCCESS;
+            }
+            break;
+        case ZYREX_THREAD_MIGRATION_DIRECTION_DST_SRC:
+            if (item->offset_destination == source_offset)
+            {
+                *ip = (greg_t)((ZyanUPointer)destination + item->offset_source);
+                return ZYAN_STATUS_SUCCESS;
+            }
+            break;
+        default:
+            ZYAN_UNREACHABLE;
+        }
+    }
+
+    // A thread that is about to execute the backjump continues behind the relocated instructions
+    if ((direction == ZYREX_THREAD_MIGRATION_DIRECTION_DST_SRC) && 
+        (source_offset == source_length))
+    {
+        *ip = (greg_t)((ZyanUPointer)destination + destination_length);
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
 #endif
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -0,0 +1,246 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Internal/Parallel.h>
+#include <Zyrex/Internal/Utils.h>
+
+#if   defined(ZYAN_WINDOWS)
+#   include <Windows.h>
+#elif defined(ZYAN_POSIX)
+#   include <pthread.h>
+#   include <unistd.h>
+#else
+#   error "Unsupported platform detected"
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexParallelContext` struct.
+ */
+typedef struct ZyrexParallelContext_
+{
+    /**
+     * @brief   The number of work items.
+     */
+    ZyanUSize count;
+    /**
+     * @brief   The index of the next work item to process.
+     */
+    volatile ZyanUPointer next_index;
+    /**
+     * @brief   The callback function.
+     */
+    ZyrexParallelCallback callback;
+    /**
+     * @brief   The user defined context.
+     */
+    void* user_context;
+} ZyrexParallelContext;
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   Contains global parallel execution data.
+ */
+static struct
+{
+    /**
+     * @brief   The maximum number of workers or `0` to use one worker per logical processor.
+     */
+    ZyanUSize max_workers;
+} g_parallel_data =
+{
+    0
+};
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Processes work items until all of them are consumed.
+ *
+ * @param   context A pointer to the `ZyrexParallelContext` struct.
+ */
+static void ZyrexParallelWork(ZyrexParallelContext* context)
+{
+    ZYAN_ASSERT(context);
+
+    while (ZYAN_TRUE)
+    {
+        const ZyanUSize index = ZyrexAtomicFetchAdd(&context->next_index, 1);
+        if (index >= context->count)
+        {
+            break;
+        }
+        context->callback(context->user_context, index);
+    }
+}
+
+#if defined(ZYAN_WINDOWS)
+
+/**
+ * @brief   The entry point of the worker threads.
+ *
+ * @param   parameter   A pointer to the `ZyrexParallelContext` struct.
+ *
+ * @return  Always `0`.
+ */
+static DWORD WINAPI ZyrexParallelWorkerEntry(LPVOID parameter)
+{
+    ZyrexParallelWork((ZyrexParallelContext*)parameter);
+    return 0;
+}
+
+#else
+
+/**
+ * @brief   The entry point of the worker threads.
+ *
+ * @param   parameter   A pointer to the `ZyrexParallelContext` struct.
+ *
+ * @return  Always `ZYAN_NULL`.
+ */
+static void* ZyrexParallelWorkerEntry(void* parameter)
+{
+    ZyrexParallelWork((ZyrexParallelContext*)parameter);
+    return ZYAN_NULL;
+}
+
+#endif
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Information                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanUSize ZyrexGetProcessorCount(void)
+{
+#if defined(ZYAN_WINDOWS)
+
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    return (system_info.dwNumberOfProcessors > 0) ? system_info.dwNumberOfProcessors : 1;
+
+#else
+
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (ZyanUSize)count : 1;
+
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Configuration                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexSetBatchWorkerCount(ZyanUSize count)
+{
+    g_parallel_data.max_workers = count;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Parallel execution                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexParallelFor(ZyanUSize count, ZyrexParallelCallback callback, void* context)
+{
+    if (!callback)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyrexParallelContext parallel_context;
+    parallel_context.count        = count;
+    parallel_context.next_index   = 0;
+    parallel_context.callback     = callback;
+    parallel_context.user_context = context;
+
+    ZyanUSize worker_count = g_parallel_data.max_workers
+        ? g_parallel_data.max_workers
+        : ZyrexGetProcessorCount();
+    worker_count = ZYAN_MIN(worker_count, count / ZYREX_PARALLEL_MIN_ITEMS_PER_WORKER);
+    worker_count = ZYAN_MIN(worker_count, ZYREX_PARALLEL_MAX_WORKERS);
+
+    // The calling thread counts as one of the workers
+    ZyanUSize threads_created = 0;
+#if defined(ZYAN_WINDOWS)
+    HANDLE threads[ZYREX_PARALLEL_MAX_WORKERS];
+#else
+    pthread_t threads[ZYREX_PARALLEL_MAX_WORKERS];
+#endif
+    for (ZyanUSize i = 1; i < worker_count; ++i)
+    {
+#if defined(ZYAN_WINDOWS)
+        threads[threads_created] = CreateThread(ZYAN_NULL, 0, &ZyrexParallelWorkerEntry,
+            &parallel_context, 0, ZYAN_NULL);
+        if (!threads[threads_created])
+        {
+            break;
+        }
+#else
+        if (pthread_create(&threads[threads_created], ZYAN_NULL, &ZyrexParallelWorkerEntry,
+            &parallel_context) != 0)
+        {
+            break;
+        }
+#endif
+        ++threads_created;
+    }
+
+    // Failing to create a worker thread is not fatal, as the remaining workers (or at least the
+    // calling thread) will consume all work items anyways
+    ZyrexParallelWork(&parallel_context);
+
+    for (ZyanUSize i = 0; i < threads_created; ++i)
+    {
+#if defined(ZYAN_WINDOWS)
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], ZYAN_NULL);
+#endif
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
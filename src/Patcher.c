@@ -0,0 +1,565 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zyrex/Patcher.h>
+#include <Zyrex/Internal/Patcher.h>
+#include <Zyrex/Internal/Transaction.h>
+#include <Zyrex/Internal/Utils.h>
+
+#if   defined(ZYAN_WINDOWS)
+#   include <Windows.h>
+#elif defined(ZYAN_POSIX)
+#   include <pthread.h>
+#else
+#   error "Unsupported platform detected"
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `ZyrexCompletion` struct.
+ */
+struct ZyrexCompletion_
+{
+    /**
+     * @brief   The next completion in the patcher queue.
+     */
+    struct ZyrexCompletion_* next;
+    /**
+     * @brief   The transaction object.
+     */
+    ZyrexTransaction* transaction;
+    /**
+     * @brief   The completion callback or `ZYAN_NULL`.
+     */
+    ZyrexCompletionCallback callback;
+    /**
+     * @brief   The user-defined context pointer that is passed to the callback.
+     */
+    void* context;
+    /**
+     * @brief   Signals, if the completion is owned by the patcher thread.
+     *
+     * The patcher thread releases the completion after invoking the callback, if the caller did
+     * not request a completion handle.
+     */
+    ZyanBool is_detached;
+    /**
+     * @brief   Signals, if the transaction was applied.
+     */
+    volatile ZyanUPointer is_done;
+    /**
+     * @brief   The status code of the commit.
+     */
+    ZyanStatus status;
+    /**
+     * @brief   The trampoline address of the operation that failed the transaction.
+     */
+    const void* failed_operation;
+};
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   Contains global patcher data.
+ *
+ * All fields are protected by `lock`.
+ */
+static struct
+{
+#if defined(ZYAN_WINDOWS)
+    /**
+     * @brief   The lock that synchronizes the access to the patcher queue.
+     */
+    SRWLOCK lock;
+    /**
+     * @brief   Signaled when a transaction was queued or the patcher thread has to terminate.
+     */
+    CONDITION_VARIABLE work_available;
+    /**
+     * @brief   Signaled when a transaction was applied.
+     */
+    CONDITION_VARIABLE work_done;
+    /**
+     * @brief   The handle of the patcher thread.
+     */
+    HANDLE thread;
+#else
+    /**
+     * @brief   The lock that synchronizes the access to the patcher queue.
+     */
+    pthread_mutex_t lock;
+    /**
+     * @brief   Signaled when a transaction was queued or the patcher thread has to terminate.
+     */
+    pthread_cond_t work_available;
+    /**
+     * @brief   Signaled when a transaction was applied.
+     */
+    pthread_cond_t work_done;
+    /**
+     * @brief   The handle of the patcher thread.
+     */
+    pthread_t thread;
+#endif
+    /**
+     * @brief   Signals, if the patcher thread is running.
+     */
+    ZyanBool is_running;
+    /**
+     * @brief   Signals, if the patcher thread has to terminate after the queue is drained.
+     */
+    ZyanBool is_stopping;
+    /**
+     * @brief   The first completion in the patcher queue.
+     */
+    ZyrexCompletion* head;
+    /**
+     * @brief   The last completion in the patcher queue.
+     */
+    ZyrexCompletion* tail;
+} g_patcher_data =
+{
+#if defined(ZYAN_WINDOWS)
+    SRWLOCK_INIT, CONDITION_VARIABLE_INIT, CONDITION_VARIABLE_INIT, ZYAN_NULL,
+#else
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, 0,
+#endif
+    ZYAN_FALSE, ZYAN_FALSE, ZYAN_NULL, ZYAN_NULL
+};
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Synchronization                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Acquires the patcher lock.
+ */
+static void ZyrexPatcherLock(void)
+{
+#if defined(ZYAN_WINDOWS)
+    AcquireSRWLockExclusive(&g_patcher_data.lock);
+#else
+    pthread_mutex_lock(&g_patcher_data.lock);
+#endif
+}
+
+/**
+ * @brief   Releases the patcher lock.
+ */
+static void ZyrexPatcherUnlock(void)
+{
+#if defined(ZYAN_WINDOWS)
+    ReleaseSRWLockExclusive(&g_patcher_data.lock);
+#else
+    pthread_mutex_unlock(&g_patcher_data.lock);
+#endif
+}
+
+/**
+ * @brief   Atomically releases the patcher lock and waits for the given condition.
+ *
+ * @param   condition   A pointer to the condition variable.
+ *
+ * The patcher lock is acquired again before this function returns.
+ */
+#if defined(ZYAN_WINDOWS)
+static void ZyrexPatcherWait(CONDITION_VARIABLE* condition)
+{
+    SleepConditionVariableSRW(condition, &g_patcher_data.lock, INFINITE, 0);
+}
+#else
+static void ZyrexPatcherWait(pthread_cond_t* condition)
+{
+    pthread_cond_wait(condition, &g_patcher_data.lock);
+}
+#endif
+
+/**
+ * @brief   Wakes all threads that wait for the given condition.
+ *
+ * @param   condition   A pointer to the condition variable.
+ */
+#if defined(ZYAN_WINDOWS)
+static void ZyrexPatcherSignal(CONDITION_VARIABLE* condition)
+{
+    WakeAllConditionVariable(condition);
+}
+#else
+static void ZyrexPatcherSignal(pthread_cond_t* condition)
+{
+    pthread_cond_broadcast(condition);
+}
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Patcher thread                                                                                 */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Applies the transactions of the given list of completions.
+ *
+ * @param   completions A pointer to the first completion of the list.
+ * @param   count       The number of completions in the list.
+ */
+static void ZyrexPatcherApply(ZyrexCompletion* completions, ZyanUSize count)
+{
+    ZYAN_ASSERT(completions);
+    ZYAN_ASSERT(count);
+
+    // TODO: Replace with ZyanMemoryAlloc in the future
+    ZyrexTransaction** const transactions =
+        ZYAN_MALLOC(count * (sizeof(ZyrexTransaction*) + sizeof(ZyrexApplyResult)));
+    if (!transactions)
+    {
+        // Falls back to one patch phase per transaction
+        for (ZyrexCompletion* current = completions; current; current = current->next)
+        {
+            current->status = ZyrexTransactionApply(current->transaction,
+                &current->failed_operation);
+        }
+        return;
+    }
+    ZyrexApplyResult* const results = (ZyrexApplyResult*)(transactions + count);
+
+    ZyrexCompletion* current = completions;
+    for (ZyanUSize i = 0; i < count; ++i, current = current->next)
+    {
+        transactions[i] = current->transaction;
+    }
+
+    const ZyanStatus status = ZyrexTransactionApplyMultiple(transactions, count, results);
+
+    current = completions;
+    for (ZyanUSize i = 0; i < count; ++i, current = current->next)
+    {
+        current->status = ZYAN_SUCCESS(status) ? results[i].status : status;
+        current->failed_operation = ZYAN_SUCCESS(status) ? results[i].failed_operation : ZYAN_NULL;
+    }
+
+    ZYAN_FREE(transactions);
+}
+
+/**
+ * @brief   Invokes the callbacks of the given list of completions and signals the waiting
+ *          threads.
+ *
+ * @param   completions A pointer to the first completion of the list.
+ */
+static void ZyrexPatcherComplete(ZyrexCompletion* completions)
+{
+    ZyrexCompletion* current = completions;
+    while (current)
+    {
+        // The completion might be released by its owner as soon as it is marked as done
+        ZyrexCompletion* const next = current->next;
+
+        if (current->callback)
+        {
+            current->callback(current->transaction, current->status, current->failed_operation,
+                current->context);
+        }
+
+        if (current->is_detached)
+        {
+            ZYAN_FREE(current);
+        } else
+        {
+            ZyrexPatcherLock();
+            ZyrexAtomicStore(&current->is_done, ZYAN_TRUE);
+            ZyrexPatcherSignal(&g_patcher_data.work_done);
+            ZyrexPatcherUnlock();
+        }
+
+        current = next;
+    }
+}
+
+/**
+ * @brief   Processes the patcher queue until the patcher thread is stopped.
+ */
+static void ZyrexPatcherRun(void)
+{
+    while (ZYAN_TRUE)
+    {
+        ZyrexPatcherLock();
+        while (!g_patcher_data.head && !g_patcher_data.is_stopping)
+        {
+            ZyrexPatcherWait(&g_patcher_data.work_available);
+        }
+
+        // All transactions that were queued in the meantime are applied together
+        ZyrexCompletion* const completions = g_patcher_data.head;
+        g_patcher_data.head = ZYAN_NULL;
+        g_patcher_data.tail = ZYAN_NULL;
+        ZyrexPatcherUnlock();
+
+        if (!completions)
+        {
+            break;
+        }
+
+        ZyanUSize count = 0;
+        for (const ZyrexCompletion* current = completions; current; current = current->next)
+        {
+            ++count;
+        }
+
+        ZyrexPatcherApply(completions, count);
+        ZyrexPatcherComplete(completions);
+    }
+}
+
+#if defined(ZYAN_WINDOWS)
+
+/**
+ * @brief   The entry point of the patcher thread.
+ *
+ * @param   parameter   Unused.
+ *
+ * @return  Always `0`.
+ */
+static DWORD WINAPI ZyrexPatcherEntry(LPVOID parameter)
+{
+    ZYAN_UNUSED(parameter);
+
+    ZyrexPatcherRun();
+    return 0;
+}
+
+#else
+
+/**
+ * @brief   The entry point of the patcher thread.
+ *
+ * @param   parameter   Unused.
+ *
+ * @return  Always `ZYAN_NULL`.
+ */
+static void* ZyrexPatcherEntry(void* parameter)
+{
+    ZYAN_UNUSED(parameter);
+
+    ZyrexPatcherRun();
+    return ZYAN_NULL;
+}
+
+#endif
+
+/**
+ * @brief   Starts the patcher thread, if not already running.
+ *
+ * @return  A zyan status code.
+ *
+ * The caller has to hold the patcher lock.
+ */
+static ZyanStatus ZyrexPatcherStart(void)
+{
+    if (g_patcher_data.is_running)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+#if defined(ZYAN_WINDOWS)
+    g_patcher_data.thread = CreateThread(ZYAN_NULL, 0, &ZyrexPatcherEntry, ZYAN_NULL, 0,
+        ZYAN_NULL);
+    if (!g_patcher_data.thread)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+#else
+    if (pthread_create(&g_patcher_data.thread, ZYAN_NULL, &ZyrexPatcherEntry, ZYAN_NULL) != 0)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+#endif
+
+    g_patcher_data.is_running = ZYAN_TRUE;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Patcher thread                                                                                 */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexPatcherShutdown(void)
+{
+    ZyrexPatcherLock();
+    if (!g_patcher_data.is_running)
+    {
+        ZyrexPatcherUnlock();
+        return ZYAN_STATUS_SUCCESS;
+    }
+    g_patcher_data.is_stopping = ZYAN_TRUE;
+    ZyrexPatcherSignal(&g_patcher_data.work_available);
+    ZyrexPatcherUnlock();
+
+#if defined(ZYAN_WINDOWS)
+    WaitForSingleObject(g_patcher_data.thread, INFINITE);
+    CloseHandle(g_patcher_data.thread);
+#else
+    pthread_join(g_patcher_data.thread, ZYAN_NULL);
+#endif
+
+    ZyrexPatcherLock();
+    g_patcher_data.is_running = ZYAN_FALSE;
+    g_patcher_data.is_stopping = ZYAN_FALSE;
+    ZyrexPatcherUnlock();
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Asynchronous commit                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexTransactionApplyAsync(ZyrexTransaction* transaction,
+    ZyrexCompletionCallback callback, void* context, ZyrexCompletion** completion)
+{
+    if (!transaction)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    // TODO: Replace with ZyanMemoryAlloc in the future
+    ZyrexCompletion* const item = ZYAN_MALLOC(sizeof(ZyrexCompletion));
+    if (!item)
+    {
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    }
+
+    item->next = ZYAN_NULL;
+    item->transaction = transaction;
+    item->callback = callback;
+    item->context = context;
+    item->is_detached = completion ? ZYAN_FALSE : ZYAN_TRUE;
+    item->is_done = ZYAN_FALSE;
+    item->status = ZYAN_STATUS_SUCCESS;
+    item->failed_operation = ZYAN_NULL;
+
+    ZyrexPatcherLock();
+
+    ZyanStatus status = g_patcher_data.is_stopping
+        ? ZYAN_STATUS_INVALID_OPERATION
+        : ZyrexPatcherStart();
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexPatcherUnlock();
+        ZYAN_FREE(item);
+        return status;
+    }
+
+    if (g_patcher_data.tail)
+    {
+        g_patcher_data.tail->next = item;
+    } else
+    {
+        g_patcher_data.head = item;
+    }
+    g_patcher_data.tail = item;
+    ZyrexPatcherSignal(&g_patcher_data.work_available);
+
+    ZyrexPatcherUnlock();
+
+    if (completion)
+    {
+        *completion = item;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexCompletionPoll(const ZyrexCompletion* completion)
+{
+    if (!completion)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return ZyrexAtomicLoad(&completion->is_done) ? ZYAN_STATUS_TRUE : ZYAN_STATUS_FALSE;
+}
+
+ZyanStatus ZyrexCompletionWait(ZyrexCompletion* completion, const void** failed_operation)
+{
+    if (!completion)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyrexPatcherLock();
+    while (!completion->is_done)
+    {
+        ZyrexPatcherWait(&g_patcher_data.work_done);
+    }
+    ZyrexPatcherUnlock();
+
+    if (failed_operation)
+    {
+        *failed_operation = completion->failed_operation;
+    }
+
+    return completion->status;
+}
+
+ZyanStatus ZyrexCompletionDestroy(ZyrexCompletion* completion)
+{
+    if (!completion)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZYAN_UNUSED(ZyrexCompletionWait(completion, ZYAN_NULL));
+    ZYAN_FREE(completion);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
@@ -29,8 +29,19 @@
 #include <Zycore/Types.h>
 #include <Zycore/Vector.h>
 #include <Zydis/Zydis.h>
+#include <Zyrex/Internal/FunctionIndex.h>
 #include <Zyrex/Internal/Relocation.h>
 
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the maximum number of short jumps that are followed when resolving the final
+ *          target of a relocated branch instruction.
+ */
+#define ZYREX_RELOCATION_MAX_JUMP_CHAIN_LENGTH  4
+
 /* ============================================================================================== */
 /* Enums and types                                                                                */
 /* ============================================================================================== */
@@ -121,6 +132,13 @@ typedef struct ZyrexRelocationContext_
      * @brief   The maximum amount of bytes that can be safely written to the destination buffer.
      */
     ZyanUSize destination_length;
+    /**
+     * @brief   The runtime address of the destination buffer.
+     *
+     * All relative offsets are calculated against this address, which allows to relocate code
+     * to a private buffer first and to copy it to its final location later on.
+     */
+    ZyanUPointer destination_address;
     /**
      * @brief   The instruction translation map.
      */
@@ -168,6 +186,28 @@ static void ZyrexAnalyzedInstructionDestroy(ZyrexAnalyzedInstruction* item)
     }
 }
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Relocation context                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Translates a pointer into the destination buffer to the corresponding runtime address.
+ *
+ * @param   context A pointer to the `ZyrexRelocationContext` struct.
+ * @param   pointer A pointer into the destination buffer.
+ *
+ * @return  The runtime address that corresponds to the given `pointer`.
+ */
+static ZyanUPointer ZyrexGetRuntimeAddress(const ZyrexRelocationContext* context,
+    const void* pointer)
+{
+    ZYAN_ASSERT(context);
+    ZYAN_ASSERT((const ZyanU8*)pointer >= (const ZyanU8*)context->destination);
+
+    return context->destination_address + 
+        (ZyanUPointer)((const ZyanU8*)pointer - (const ZyanU8*)context->destination);
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Instruction analysis                                                                           */
 /* ---------------------------------------------------------------------------------------------- */
@@ -348,31 +388,105 @@ static ZyanBool ZyrexIsRelativeMemoryInstruction(const ZydisDecodedInstruction*
 }
 
 /**
- * @brief   Checks if the given relative branch instruction needs to be rewritten in order to
- *          reach the destination address.
+ * @brief   Resolves the final target of the given external relative branch instruction by
+ *          following chains of short jumps.
  *
  * @param   context     A pointer to the `ZyrexRelocationContext` struct.
  * @param   instruction A pointer to the `ZyrexAnalyzedInstruction` struct of the instruction to
- *                      check.
+ *                      resolve.
+ *
+ * @return  The final target address of the branch instruction.
+ *
+ * Only short jumps (`JMP rel8`) are followed and only, if the function index knows the bounds
+ * of the relocated function and both the jump and its target lie inside of them. Short jumps
+ * outside of the function might be another function's entry, e.g. a hot-patch stub or a
+ * temporary redirection of another hook, which can change at any time. Jumps back into the
+ * relocated code and targets that are out of range of the destination buffer are not followed.
+ */
+static ZyanU64 ZyrexResolveBranchTarget(const ZyrexRelocationContext* context,
+    const ZyrexAnalyzedInstruction* instruction)
+{
+    ZYAN_ASSERT(context);
+    ZYAN_ASSERT(instruction);
+    ZYAN_ASSERT(instruction->has_relative_target);
+    ZYAN_ASSERT(instruction->has_external_target);
+
+    const ZyanU64 source_lo = (ZyanU64)(ZyanUPointer)context->source;
+    const ZyanU64 source_hi = source_lo + context->bytes_to_reloc;
+    const ZyanU64 destination = context->destination_address + context->bytes_written;
+
+    ZyanU64 target = instruction->absolute_target_address;
+
+    ZyanUPointer function_begin;
+    ZyanUPointer function_end;
+    if (ZyrexFunctionIndexGetFunctionRange(context->source, &function_begin, &function_end) !=
+        ZYAN_STATUS_SUCCESS)
+    {
+        return target;
+    }
+
+    for (ZyanUSize i = 0; i < ZYREX_RELOCATION_MAX_JUMP_CHAIN_LENGTH; ++i)
+    {
+        // The function entry is excluded, as it might be patched by another hook
+        if ((target <= function_begin) || (target + 2 > function_end))
+        {
+            break;
+        }
+
+        const ZyanU8* const code = (const ZyanU8*)(ZyanUPointer)target;
+        if (code[0] != 0xEB)
+        {
+            break;
+        }
+
+        const ZyanU64 next = target + 2 + (ZyanI64)(ZyanI8)code[1];
+        if ((next < function_begin) || (next >= function_end))
+        {
+            break;
+        }
+        if ((next >= source_lo) && (next < source_hi))
+        {
+            break;
+        }
+        const ZyanI64 distance = (ZyanI64)(next - destination);
+        if ((distance < ZYAN_INT32_MIN / 2) || (distance > ZYAN_INT32_MAX / 2))
+        {
+            break;
+        }
+
+        target = next;
+    }
+
+    return target;
+}
+
+/**
+ * @brief   Checks if the given relative branch instruction needs to be rewritten in order to
+ *          reach the destination address.
+ *
+ * @param   context         A pointer to the `ZyrexRelocationContext` struct.
+ * @param   instruction     A pointer to the `ZyrexAnalyzedInstruction` struct of the instruction
+ *                          to check.
+ * @param   target_address  The absolute target address of the branch instruction.
  *
  * @return  `ZYAN_TRUE` if the given relative branch instruction needs to be rewritten in order to
  *          reach the destination address or `ZYAN_FALSE`, if not.
  */
 static ZyanBool ZyrexShouldRewriteBranchInstruction(ZyrexRelocationContext* context,
-    const ZyrexAnalyzedInstruction* instruction)
+    const ZyrexAnalyzedInstruction* instruction, ZyanU64 target_address)
 {
     ZYAN_ASSERT(context);
     ZYAN_ASSERT(instruction);
     ZYAN_ASSERT(instruction->has_relative_target);
     ZYAN_ASSERT(instruction->has_external_target);
 
-    const ZyanU64 source_address = (ZyanU64)context->destination + context->bytes_written;
+    const ZyanU64 source_address = context->destination_address + context->bytes_written;
 
     switch (instruction->instruction.raw.imm[0].size)
     {
     case 8:
     {
-        const ZyanI64 distance = (ZyanI64)(instruction->absolute_target_address - source_address - 
+        const ZyanI64 distance = (ZyanI64)(target_address - source_address - 
             instruction->instruction.length);
         if ((distance < ZYAN_INT8_MIN) || (distance > ZYAN_INT8_MAX))
         {
@@ -382,7 +496,7 @@ static ZyanBool ZyrexShouldRewriteBranchInstruction(ZyrexRelocationContext* cont
     }
     case 16:
     {
-        const ZyanI64 distance = (ZyanI64)(instruction->absolute_target_address - source_address -
+        const ZyanI64 distance = (ZyanI64)(target_address - source_address -
             instruction->instruction.length);
         if ((distance < ZYAN_INT16_MIN) || (distance > ZYAN_INT16_MAX))
         {
@@ -392,7 +506,7 @@ static ZyanBool ZyrexShouldRewriteBranchInstruction(ZyrexRelocationContext* cont
     }
     case 32:
     {
-        const ZyanI64 distance = (ZyanI64)(instruction->absolute_target_address - source_address -
+        const ZyanI64 distance = (ZyanI64)(target_address - source_address -
             instruction->instruction.length);
         if ((distance < ZYAN_INT32_MIN) || (distance > ZYAN_INT32_MAX))
         {
@@ -512,7 +626,10 @@ static ZyanStatus ZyrexRelocateRelativeBranchInstruction(ZyrexRelocationContext*
         return ZyrexRelocateCommonInstruction(context, instruction);
     }
 
-    if (ZyrexShouldRewriteBranchInstruction(context, instruction))
+    // Skip intermediate jumps
+    const ZyanU64 target_address = ZyrexResolveBranchTarget(context, instruction);
+
+    if (ZyrexShouldRewriteBranchInstruction(context, instruction, target_address))
     {
         // Rewrite branch instructions for which no alternative form with 32-bit offset exists
         switch (instruction->instruction.mnemonic)
@@ -565,12 +682,14 @@ static ZyanStatus ZyrexRelocateRelativeBranchInstruction(ZyrexRelocationContext*
             *address++ = 0xEB;
             *address++ = 0x05;
             ZyrexUpdateRelocationContext(context, 2, (ZyanU8)context->bytes_read,
-                (ZyanU8)context->bytes_written + instruction->instruction.length);
+                (ZyanU8)context->bytes_written);
 
             // Generate `JMP` to `1` branch
-            ZyrexWriteRelativeJump(address, (ZyanUPointer)instruction->absolute_target_address);
-            ZyrexUpdateRelocationContext(context, 2, (ZyanU8)context->bytes_read,
-                (ZyanU8)context->bytes_written + instruction->instruction.length + 2);
+            *address = 0xE9;
+            *(ZyanI32*)(address + 1) = ZyrexCalculateRelativeOffset(ZYREX_SIZEOF_RELATIVE_JUMP,
+                ZyrexGetRuntimeAddress(context, address), (ZyanUPointer)target_address);
+            ZyrexUpdateRelocationContext(context, ZYREX_SIZEOF_RELATIVE_JUMP, 
+                (ZyanU8)context->bytes_read, (ZyanU8)context->bytes_written);
 
             return ZYAN_STATUS_SUCCESS;
         }
@@ -622,8 +741,8 @@ static ZyanStatus ZyrexRelocateRelativeBranchInstruction(ZyrexRelocationContext*
 
         // Write relative offset
         *(ZyanI32*)(address) = 
-            ZyrexCalculateRelativeOffset(4, (ZyanUPointer)address, 
-                (ZyanUPointer)instruction->absolute_target_address);
+            ZyrexCalculateRelativeOffset(4, ZyrexGetRuntimeAddress(context, address), 
+                (ZyanUPointer)target_address);
 
         // Update relocation context
         ZyrexUpdateRelocationContext(context, length, (ZyanU8)context->bytes_read, 
@@ -640,8 +759,7 @@ static ZyanStatus ZyrexRelocateRelativeBranchInstruction(ZyrexRelocationContext*
 
     // Update the relative offset for the new instruction position
     const ZyanI32 value = ZyrexCalculateRelativeOffset(0,
-        (ZyanUPointer)context->destination + context->bytes_written,
-        (ZyanUPointer)instruction->absolute_target_address);
+        context->destination_address + context->bytes_written, (ZyanUPointer)target_address);
 
     switch (instruction->instruction.raw.imm[0].size)
     {
@@ -683,7 +801,7 @@ static ZyanStatus ZyrexRelocateRelativeMemoryInstruction(ZyrexRelocationContext*
 
         // Update the relative offset for the new instruction position
         const ZyanI32 value = ZyrexCalculateRelativeOffset(0, 
-            (ZyanUPointer)context->destination + context->bytes_written, 
+            context->destination_address + context->bytes_written, 
             (ZyanUPointer)instruction->absolute_target_address);
 
         switch (instruction->instruction.raw.disp.size)
@@ -865,8 +983,8 @@ static ZyanStatus ZyrexUpdateInstructionOffsets(ZyrexRelocationContext* context)
 /* ============================================================================================== */
 
 ZyanStatus ZyrexRelocateCode(const void* source, ZyanUSize source_length, 
-    ZyrexTrampolineChunk* trampoline, ZyanUSize min_bytes_to_reloc, ZyanUSize* bytes_read, 
-    ZyanUSize* bytes_written)
+    ZyrexTrampolineChunk* trampoline, ZyanUPointer trampoline_address, 
+    ZyanUSize min_bytes_to_reloc, ZyanUSize* bytes_read, ZyanUSize* bytes_written)
 {
     ZYAN_ASSERT(source);
     ZYAN_ASSERT(source_length);
@@ -882,6 +1000,9 @@ ZyanStatus ZyrexRelocateCode(const void* source, ZyanUSize source_length,
     context.destination          = &trampoline->code_buffer;
     context.destination_length   = ZYREX_TRAMPOLINE_MAX_CODE_SIZE + 
                                    ZYREX_TRAMPOLINE_MAX_CODE_SIZE_BONUS;
+    context.destination_address  = trampoline_address + 
+                                   (ZyanUPointer)((ZyanU8*)&trampoline->code_buffer - 
+                                   (ZyanU8*)trampoline);
     context.translation_map      = &trampoline->translation_map;
     context.instructions_read    = 0;
     context.instructions_written = 0;
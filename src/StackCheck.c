@@ -0,0 +1,198 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
+#include <Zycore/LibC.h>
+#include <Zyrex/Status.h>
+#include <Zyrex/Internal/StackCheck.h>
+
+#if defined(ZYAN_LINUX)
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Memory access                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Reads a pointer-sized value from the given `address`.
+ *
+ * @param   address The address to read from.
+ * @param   value   Receives the value.
+ *
+ * @return  `ZYAN_TRUE`, if the value was read or `ZYAN_FALSE`, if the address is not readable.
+ *
+ * The memory is read through the kernel, which reports an error instead of raising an access
+ * violation, if the address is invalid.
+ */
+static ZyanBool ZyrexReadStackValue(ZyanUPointer address, ZyanUPointer* value)
+{
+    ZYAN_ASSERT(value);
+
+#if defined(ZYAN_WINDOWS)
+
+    SIZE_T size;
+    return ReadProcessMemory(GetCurrentProcess(), (LPCVOID)address, value, sizeof(*value),
+        &size) && (size == sizeof(*value));
+
+#elif defined(ZYAN_LINUX)
+
+    struct iovec local = { value, sizeof(*value) };
+    struct iovec remote = { (void*)address, sizeof(*value) };
+    return process_vm_readv(getpid(), &local, 1, &remote, 1, 0) == (ssize_t)sizeof(*value);
+
+#else
+#   error "Unsupported platform detected"
+#endif
+}
+
+/**
+ * @brief   Captures the code addresses a suspended thread might return to from the given register
+ *          values.
+ *
+ * @param   ip          The instruction pointer of the thread.
+ * @param   sp          The stack pointer of the thread.
+ * @param   fp          The frame pointer of the thread.
+ * @param   addresses   Receives the captured addresses.
+ * @param   count       Receives the number of captured addresses.
+ *
+ * @return  `ZYREX_STATUS_UNSAFE_THREAD_STATE`, if the frame-pointer chain is deeper than
+ *          `ZYREX_STACK_CHECK_MAX_ADDRESSES` or `ZYAN_STATUS_SUCCESS`.
+ *
+ * A truncated stack can not prove that the thread is outside of the checked code, so it is
+ * reported as unsafe instead of passing the check with the addresses captured so far.
+ */
+static ZyanStatus ZyrexCaptureStack(ZyanUPointer ip, ZyanUPointer sp, ZyanUPointer fp,
+    ZyanUPointer* addresses, ZyanUSize* count)
+{
+    ZYAN_ASSERT(addresses);
+    ZYAN_ASSERT(count);
+
+    ZyanUSize n = 0;
+    addresses[n++] = ip;
+
+    ZyanUPointer value;
+    if (ZyrexReadStackValue(sp, &value))
+    {
+        addresses[n++] = value;
+    }
+
+    // Each frame starts with the saved frame pointer of the caller, followed by the return address
+    while ((fp >= sp) && !(fp & (sizeof(ZyanUPointer) - 1)))
+    {
+        ZyanUPointer next;
+        if (!ZyrexReadStackValue(fp, &next) ||
+            !ZyrexReadStackValue(fp + sizeof(ZyanUPointer), &value))
+        {
+            break;
+        }
+        if (n == ZYREX_STACK_CHECK_MAX_ADDRESSES)
+        {
+            *count = n;
+            return ZYREX_STATUS_UNSAFE_THREAD_STATE;
+        }
+        addresses[n++] = value;
+
+        // The stack grows downwards, so a valid chain is strictly increasing
+        if (next <= fp)
+        {
+            break;
+        }
+        fp = next;
+    }
+
+    *count = n;
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Stack capture                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+#if defined(ZYAN_WINDOWS)
+
+ZyanStatus ZyrexCaptureThreadStack(HANDLE thread_handle, ZyanUPointer* addresses,
+    ZyanUSize* count)
+{
+    ZYAN_ASSERT(thread_handle);
+    ZYAN_ASSERT(addresses);
+    ZYAN_ASSERT(count);
+
+    CONTEXT context = { 0 };
+    context.ContextFlags = CONTEXT_CONTROL | CONTEXT_INTEGER;
+    if (!GetThreadContext(thread_handle, &context))
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+#if defined(ZYAN_X64)
+    return ZyrexCaptureStack(context.Rip, context.Rsp, context.Rbp, addresses, count);
+#elif defined(ZYAN_X86)
+    return ZyrexCaptureStack(context.Eip, context.Esp, context.Ebp, addresses, count);
+#else
+#   error "Unsupported architecture detected"
+#endif
+}
+
+#elif defined(ZYAN_LINUX)
+
+ZyanStatus ZyrexCaptureThreadStack(const ucontext_t* context, ZyanUPointer* addresses,
+    ZyanUSize* count)
+{
+    ZYAN_ASSERT(context);
+    ZYAN_ASSERT(addresses);
+    ZYAN_ASSERT(count);
+
+    const greg_t* const gregs = context->uc_mcontext.gregs;
+#if defined(ZYAN_X64)
+    return ZyrexCaptureStack((ZyanUPointer)gregs[REG_RIP], (ZyanUPointer)gregs[REG_RSP],
+        (ZyanUPointer)gregs[REG_RBP], addresses, count);
+#elif defined(ZYAN_X86)
+    return ZyrexCaptureStack((ZyanUPointer)gregs[REG_EIP], (ZyanUPointer)gregs[REG_ESP],
+        (ZyanUPointer)gregs[REG_EBP], addresses, count);
+#else
+#   error "Unsupported architecture detected"
+#endif
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
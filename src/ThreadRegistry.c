@@ -0,0 +1,456 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zycore/Vector.h>
+#include <Zycore/API/Synchronization.h>
+#include <Zyrex/Transaction.h>
+#include <Zyrex/Internal/ThreadRegistry.h>
+#include <Zyrex/Internal/ThreadSuspension.h>
+
+#if defined(ZYAN_WINDOWS)
+#   include <Windows.h>
+#   include <TlHelp32.h>
+#elif defined(ZYAN_LINUX)
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/syscall.h>
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+#if defined(ZYAN_LINUX)
+
+/**
+ * @brief   Defines the `ZyrexLinuxDirent` struct.
+ *
+ * This is the layout of the entries returned by the `getdents64` system call.
+ */
+typedef struct ZyrexLinuxDirent_
+{
+    ZyanU64 d_ino;
+    ZyanI64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+} ZyrexLinuxDirent;
+
+#endif
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   Contains global thread registry data.
+ */
+static struct
+{
+    /**
+     * @brief   Signals, if the registry is initialized.
+     */
+    ZyanBool is_initialized;
+    /**
+     * @brief   Signals, if the registry is enabled.
+     */
+    ZyanBool is_enabled;
+    /**
+     * @brief   The native ids of all registered threads (sorted).
+     */
+    ZyanVector/*<ZyanThreadId>*/ threads;
+    /**
+     * @brief   The lock that protects the registry.
+     */
+    ZyanCriticalSection lock;
+} g_thread_registry_data;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Helper functions                                                                               */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Compares two thread ids.
+ *
+ * @param   left    A pointer to the first thread id.
+ * @param   right   A pointer to the second thread id.
+ *
+ * @return  A value less than zero, zero or a value greater than zero.
+ */
+static ZyanI32 ZyrexCompareThreadId(const ZyanThreadId* left, const ZyanThreadId* right)
+{
+    ZYAN_ASSERT(left);
+    ZYAN_ASSERT(right);
+
+    if (*left < *right)
+    {
+        return -1;
+    }
+    if (*left > *right)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Adds the given thread id to the registry, if not already present.
+ *
+ * @param   thread_id   The native thread id.
+ * @param   context     Unused.
+ *
+ * @return  A zyan status code.
+ *
+ * This function has to be called while holding the lock.
+ */
+static ZyanStatus ZyrexThreadRegistryInsert(ZyanThreadId thread_id, void* context)
+{
+    ZYAN_UNUSED(context);
+
+    ZyanUSize index;
+    const ZyanStatus status = ZyanVectorBinarySearch(&g_thread_registry_data.threads, &thread_id,
+        &index, (ZyanComparison)&ZyrexCompareThreadId);
+    ZYAN_CHECK(status);
+    if (status == ZYAN_STATUS_TRUE)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    return ZyanVectorInsert(&g_thread_registry_data.threads, index, &thread_id);
+}
+
+#if defined(ZYAN_LINUX)
+
+/**
+ * @brief   Parses the name of a `/proc/self/task` entry.
+ *
+ * @param   name    The zero-terminated entry name.
+ *
+ * @return  The native thread id or `0`, if the name is not a decimal number.
+ */
+static ZyanThreadId ZyrexParseThreadId(const char* name)
+{
+    ZYAN_ASSERT(name);
+
+    ZyanThreadId thread_id = 0;
+    for (; *name; ++name)
+    {
+        if ((*name < '0') || (*name > '9'))
+        {
+            return 0;
+        }
+        thread_id = thread_id * 10 + (ZyanThreadId)(*name - '0');
+    }
+
+    return thread_id;
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread enumeration                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanThreadId ZyrexGetCurrentNativeThreadId(void)
+{
+#if defined(ZYAN_WINDOWS)
+    return (ZyanThreadId)GetCurrentThreadId();
+#elif defined(ZYAN_LINUX)
+    return ZyrexGetCurrentKernelThreadId();
+#else
+    ZyanThreadId thread_id = 0;
+    ZyanThreadGetCurrentThreadId(&thread_id);
+    return thread_id;
+#endif
+}
+
+ZyanStatus ZyrexEnumerateThreads(ZyrexThreadCallback callback, void* context)
+{
+    if (!callback)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+#if defined(ZYAN_WINDOWS)
+
+    const DWORD pid = GetCurrentProcessId();
+
+    const HANDLE h_snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, pid);
+    if (h_snapshot == INVALID_HANDLE_VALUE)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+    THREADENTRY32 thread;
+    ZYAN_MEMSET(&thread, 0, sizeof(thread));
+    thread.dwSize = sizeof(thread);
+
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+    if (Thread32First(h_snapshot, &thread))
+    {
+        do
+        {
+            if (thread.th32OwnerProcessID == pid)
+            {
+                status = callback((ZyanThreadId)thread.th32ThreadID, context);
+            }
+        } while (ZYAN_SUCCESS(status) && Thread32Next(h_snapshot, &thread));
+    }
+
+    if (!CloseHandle(h_snapshot))
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+    return status;
+
+#elif defined(ZYAN_LINUX)
+
+    // The directory is read into a stack buffer, as `opendir` allocates memory. Threads might be
+    // enumerated while other threads are suspended and hold the heap lock
+    const int fd = open("/proc/self/task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+    ZyanU64 buffer[512];
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+    while (ZYAN_SUCCESS(status))
+    {
+        const long length = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+        if (length < 0)
+        {
+            status = ZYAN_STATUS_BAD_SYSTEMCALL;
+            break;
+        }
+        if (length == 0)
+        {
+            break;
+        }
+
+        for (long offset = 0; ZYAN_SUCCESS(status) && (offset < length);)
+        {
+            const ZyrexLinuxDirent* const entry =
+                (const ZyrexLinuxDirent*)((const ZyanU8*)buffer + offset);
+            offset += entry->d_reclen;
+
+            const ZyanThreadId thread_id = ZyrexParseThreadId(entry->d_name);
+            if (thread_id)
+            {
+                status = callback(thread_id, context);
+            }
+        }
+    }
+
+    close(fd);
+
+    return status;
+
+#else
+
+    return callback(ZyrexGetCurrentNativeThreadId(), context);
+
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread registry                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexThreadRegistryAcquire(ZyanVector** threads)
+{
+    if (!threads)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+    if (!g_thread_registry_data.is_enabled)
+    {
+        return ZYAN_STATUS_FALSE;
+    }
+
+    ZYAN_CHECK(ZyanCriticalSectionEnter(&g_thread_registry_data.lock));
+    *threads = &g_thread_registry_data.threads;
+
+    return ZYAN_STATUS_TRUE;
+}
+
+ZyanStatus ZyrexThreadRegistryRelease(void)
+{
+    ZyanVector* const threads = &g_thread_registry_data.threads;
+
+    // Removes the entries that were marked while other threads were suspended. The order of the
+    // remaining entries is preserved
+    ZyanUSize count = 0;
+    for (ZyanUSize i = 0; i < threads->size; ++i)
+    {
+        const ZyanThreadId thread_id = *(const ZyanThreadId*)ZyanVectorGet(threads, i);
+        if (thread_id)
+        {
+            *(ZyanThreadId*)ZyanVectorGetMutable(threads, count++) = thread_id;
+        }
+    }
+
+    const ZyanStatus status = ZyanVectorResize(threads, count);
+    ZYAN_CHECK(ZyanCriticalSectionLeave(&g_thread_registry_data.lock));
+
+    return status;
+}
+
+ZyanStatus ZyrexThreadRegistryClear(void)
+{
+    if (!g_thread_registry_data.is_initialized)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    g_thread_registry_data.is_initialized = ZYAN_FALSE;
+    g_thread_registry_data.is_enabled = ZYAN_FALSE;
+    ZYAN_CHECK(ZyanVectorDestroy(&g_thread_registry_data.threads));
+
+    return ZyanCriticalSectionDelete(&g_thread_registry_data.lock);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread registry                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexSetThreadRegistry(ZyanBool enable)
+{
+    if (!g_thread_registry_data.is_initialized)
+    {
+        if (!enable)
+        {
+            return ZYAN_STATUS_SUCCESS;
+        }
+
+        ZYAN_CHECK(ZyanVectorInit(&g_thread_registry_data.threads, sizeof(ZyanThreadId), 64,
+            ZYAN_NULL));
+        const ZyanStatus status = ZyanCriticalSectionInitialize(&g_thread_registry_data.lock);
+        if (!ZYAN_SUCCESS(status))
+        {
+            ZyanVectorDestroy(&g_thread_registry_data.threads);
+            return status;
+        }
+        g_thread_registry_data.is_initialized = ZYAN_TRUE;
+    }
+
+    ZYAN_CHECK(ZyanCriticalSectionEnter(&g_thread_registry_data.lock));
+
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+    if (enable && !g_thread_registry_data.is_enabled)
+    {
+        // Seed the registry with all threads that already exist
+        status = ZyanVectorClear(&g_thread_registry_data.threads);
+        if (ZYAN_SUCCESS(status))
+        {
+            status = ZyrexEnumerateThreads(&ZyrexThreadRegistryInsert, ZYAN_NULL);
+        }
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        g_thread_registry_data.is_enabled = enable;
+    }
+
+    ZYAN_CHECK(ZyanCriticalSectionLeave(&g_thread_registry_data.lock));
+
+    return status;
+}
+
+ZyanStatus ZyrexRegisterThread(void)
+{
+    if (!g_thread_registry_data.is_enabled)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZYAN_CHECK(ZyanCriticalSectionEnter(&g_thread_registry_data.lock));
+    const ZyanStatus status = 
+        ZyrexThreadRegistryInsert(ZyrexGetCurrentNativeThreadId(), ZYAN_NULL);
+    ZYAN_CHECK(ZyanCriticalSectionLeave(&g_thread_registry_data.lock));
+
+    return status;
+}
+
+ZyanStatus ZyrexUnregisterThread(void)
+{
+    if (!g_thread_registry_data.is_enabled)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    const ZyanThreadId thread_id = ZyrexGetCurrentNativeThreadId();
+
+    ZYAN_CHECK(ZyanCriticalSectionEnter(&g_thread_registry_data.lock));
+    ZyanUSize index;
+    ZyanStatus status = ZyanVectorBinarySearch(&g_thread_registry_data.threads, &thread_id,
+        &index, (ZyanComparison)&ZyrexCompareThreadId);
+    if (status == ZYAN_STATUS_TRUE)
+    {
+        status = ZyanVectorDelete(&g_thread_registry_data.threads, index);
+    }
+    ZYAN_CHECK(ZyanCriticalSectionLeave(&g_thread_registry_data.lock));
+
+    return ZYAN_SUCCESS(status) ? ZYAN_STATUS_SUCCESS : status;
+}
+
+ZyanStatus ZyrexGetCurrentThreadId(ZyanThreadId* thread_id)
+{
+    if (!thread_id)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    *thread_id = ZyrexGetCurrentNativeThreadId();
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
@@ -0,0 +1,285 @@
+/***************************************************************************************************
+
+  Zyan Hook Library (Zyrex)
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
+#include <Zycore/Defines.h>
+#include <Zycore/LibC.h>
+#include <Zyrex/Status.h>
+#include <Zyrex/Internal/ThreadSuspension.h>
+
+#if defined(ZYAN_LINUX)
+#   include <errno.h>
+#   include <limits.h>
+#   include <linux/futex.h>
+#   include <signal.h>
+#   include <sys/syscall.h>
+#   include <time.h>
+#   include <unistd.h>
+#endif
+
+#if defined(ZYAN_LINUX)
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the real-time signal that is used to suspend threads.
+ */
+#ifndef ZYREX_THREAD_SUSPEND_SIGNAL
+#   define ZYREX_THREAD_SUSPEND_SIGNAL  (SIGRTMIN + 2)
+#endif
+
+/**
+ * @brief   Defines the time to wait for a thread to acknowledge a suspension request (in
+ *          milliseconds).
+ */
+#define ZYREX_THREAD_SUSPEND_TIMEOUT    1000
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   Contains global thread suspension data.
+ *
+ * Thread-safety is implicitly guaranteed by the transactional API as only one transaction can be
+ * active at a time. All fields except `is_handler_installed` are shared with the signal handler.
+ */
+static struct
+{
+    /**
+     * @brief   Signals, if the suspend signal handler is installed.
+     */
+    ZyanBool is_handler_installed;
+    /**
+     * @brief   The release generation. Parked threads wait on this futex until it changes.
+     */
+    ZyanU32 generation;
+    /**
+     * @brief   The kernel id of the thread that is requested to park or `0`, if the request was
+     *          already claimed.
+     */
+    ZyanU32 requested_thread_id;
+    /**
+     * @brief   Set to `1` by the signal handler as soon as the requested thread is parked.
+     */
+    ZyanU32 is_parked;
+    /**
+     * @brief   The signal context of the thread that acknowledged the current request.
+     */
+    ucontext_t* context;
+} g_thread_suspension_data;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Helper functions                                                                               */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Invokes the `futex` syscall for a private futex.
+ *
+ * @param   address     A pointer to the futex word.
+ * @param   operation   The futex operation (without the `FUTEX_PRIVATE_FLAG`).
+ * @param   value       The operation value.
+ * @param   timeout     An optional timeout for wait operations.
+ *
+ * @return  The return value of the syscall.
+ */
+static long ZyrexFutex(ZyanU32* address, int operation, ZyanU32 value,
+    const struct timespec* timeout)
+{
+    return syscall(SYS_futex, address, operation | FUTEX_PRIVATE_FLAG, value, timeout,
+        ZYAN_NULL, 0);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Signal handler                                                                                 */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   The suspend signal handler that parks the receiving thread until the release
+ *          generation changes.
+ *
+ * @param   signal_number   The signal number.
+ * @param   info            A pointer to the `siginfo_t` struct.
+ * @param   context         A pointer to the `ucontext_t` struct.
+ */
+static void ZyrexSuspendHandler(int signal_number, siginfo_t* info, void* context)
+{
+    ZYAN_UNUSED(signal_number);
+    ZYAN_UNUSED(info);
+
+    const int saved_errno = errno;
+
+    // Claim the request. Stale requests that timed out before delivery are ignored
+    ZyanU32 expected = (ZyanU32)syscall(SYS_gettid);
+    if (!__atomic_compare_exchange_n(&g_thread_suspension_data.requested_thread_id, &expected,
+        0, ZYAN_FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+        errno = saved_errno;
+        return;
+    }
+
+    const ZyanU32 generation = 
+        __atomic_load_n(&g_thread_suspension_data.generation, __ATOMIC_SEQ_CST);
+
+    __atomic_store_n(&g_thread_suspension_data.context, (ucontext_t*)context, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&g_thread_suspension_data.is_parked, 1, __ATOMIC_SEQ_CST);
+    ZyrexFutex(&g_thread_suspension_data.is_parked, FUTEX_WAKE, 1, ZYAN_NULL);
+
+    while (__atomic_load_n(&g_thread_suspension_data.generation, __ATOMIC_SEQ_CST) == 
+        generation)
+    {
+        ZyrexFutex(&g_thread_suspension_data.generation, FUTEX_WAIT, generation, ZYAN_NULL);
+    }
+
+    errno = saved_errno;
+}
+
+/**
+ * @brief   Installs the suspend signal handler, if not already done.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexInstallSuspendHandler(void)
+{
+    if (g_thread_suspension_data.is_handler_installed)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    struct sigaction action;
+    ZYAN_MEMSET(&action, 0, sizeof(action));
+    action.sa_sigaction = &ZyrexSuspendHandler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    // Parked threads must not run any other signal handlers
+    sigfillset(&action.sa_mask);
+    if (sigaction(ZYREX_THREAD_SUSPEND_SIGNAL, &action, ZYAN_NULL) != 0)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+    g_thread_suspension_data.is_handler_installed = ZYAN_TRUE;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread suspension                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanThreadId ZyrexGetCurrentKernelThreadId(void)
+{
+    return (ZyanThreadId)syscall(SYS_gettid);
+}
+
+ZyanStatus ZyrexSuspendThread(ZyanThreadId thread_id, ZyrexSuspendedThread* thread)
+{
+    if (!thread_id || !thread)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZYAN_CHECK(ZyrexInstallSuspendHandler());
+
+    __atomic_store_n(&g_thread_suspension_data.is_parked, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&g_thread_suspension_data.context, ZYAN_NULL, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&g_thread_suspension_data.requested_thread_id, (ZyanU32)thread_id, 
+        __ATOMIC_SEQ_CST);
+
+    if (syscall(SYS_tgkill, getpid(), (pid_t)thread_id, ZYREX_THREAD_SUSPEND_SIGNAL) != 0)
+    {
+        __atomic_store_n(&g_thread_suspension_data.requested_thread_id, 0, __ATOMIC_SEQ_CST);
+        return (errno == ESRCH) ? ZYAN_STATUS_NOT_FOUND : ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+    const struct timespec timeout = { 0, 1000000 };
+    for (ZyanUSize i = 0; i < ZYREX_THREAD_SUSPEND_TIMEOUT; ++i)
+    {
+        if (__atomic_load_n(&g_thread_suspension_data.is_parked, __ATOMIC_SEQ_CST))
+        {
+            break;
+        }
+        ZyrexFutex(&g_thread_suspension_data.is_parked, FUTEX_WAIT, 0, &timeout);
+    }
+
+    if (!__atomic_load_n(&g_thread_suspension_data.is_parked, __ATOMIC_SEQ_CST))
+    {
+        // Revoke the request, unless the thread already claimed it
+        ZyanU32 expected = (ZyanU32)thread_id;
+        if (__atomic_compare_exchange_n(&g_thread_suspension_data.requested_thread_id, 
+            &expected, 0, ZYAN_FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        {
+            // Only a thread that really exited may be skipped by the caller. A pending signal of
+            // a thread that blocks it is ignored by the handler once it is delivered
+            if ((syscall(SYS_tgkill, getpid(), (pid_t)thread_id, 0) != 0) && (errno == ESRCH))
+            {
+                return ZYAN_STATUS_NOT_FOUND;
+            }
+            return ZYREX_STATUS_THREAD_NOT_SUSPENDED;
+        }
+
+        while (!__atomic_load_n(&g_thread_suspension_data.is_parked, __ATOMIC_SEQ_CST))
+        {
+            ZyrexFutex(&g_thread_suspension_data.is_parked, FUTEX_WAIT, 0, ZYAN_NULL);
+        }
+    }
+
+    thread->thread_id = thread_id;
+    thread->context = __atomic_load_n(&g_thread_suspension_data.context, __ATOMIC_SEQ_CST);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexResumeThreads(void)
+{
+    __atomic_fetch_add(&g_thread_suspension_data.generation, 1, __ATOMIC_SEQ_CST);
+    if (ZyrexFutex(&g_thread_suspension_data.generation, FUTEX_WAKE, INT_MAX, ZYAN_NULL) < 0)
+    {
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#endif
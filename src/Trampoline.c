@@ -30,22 +30,326 @@
 #include <Zycore/API/Memory.h>
 #include <Zycore/API/Process.h>
 #include <Zydis/Zydis.h>
+#include <Zyrex/Internal/CodeWriter.h>
+#include <Zyrex/Internal/FunctionIndex.h>
 #include <Zyrex/Internal/Relocation.h>
 #include <Zyrex/Internal/Trampoline.h>
 
 #if   defined(ZYAN_WINDOWS)
 #   include <Windows.h>
 #elif defined(ZYAN_POSIX)
+#   include <errno.h>
+#   include <fcntl.h>
 #   include <unistd.h>
 #   include <sys/mman.h>
 #else
 #   error "Unsupported platform detected"
 #endif
 
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The alignment the NOP padding in front of a function entry is decoded from.
+ *
+ * Compilers align functions (and the patchable area in front of them) to at least 16 bytes, so
+ * this is the closest position in front of the entry that is known to start an instruction.
+ */
+#define ZYREX_PATCH_SITE_PADDING_ALIGNMENT      16
+
+#if defined(ZYAN_POSIX)
+
+/**
+ * @brief   The lowest address that is considered for trampoline-regions.
+ *
+ * Most kernels refuse mappings below `vm.mmap_min_addr`, which defaults to 64 KiB.
+ */
+#define ZYREX_TRAMPOLINE_REGION_MIN_ADDRESS     ((ZyanUPointer)0x10000)
+
+/**
+ * @brief   The end of the user address space.
+ */
+#if defined(ZYAN_X64)
+#   define ZYREX_TRAMPOLINE_REGION_MAX_ADDRESS  ((ZyanUPointer)0x00007FFFFFFFF000ULL)
+#else
+#   define ZYREX_TRAMPOLINE_REGION_MAX_ADDRESS  ((ZyanUPointer)0xFFFFF000UL)
+#endif
+
+/**
+ * @brief   The maximum number of attempts to map a trampoline-region.
+ *
+ * An attempt fails, if another thread maps memory at the selected address in the meantime or if
+ * the kernel refuses the address.
+ */
+#define ZYREX_TRAMPOLINE_REGION_MAX_ATTEMPTS    64
+
+/**
+ * @brief   The `MAP_FIXED_NOREPLACE` flag of the `mmap` syscall.
+ *
+ * Kernels older than 4.17 ignore this flag and treat the address as a hint.
+ */
+#if defined(MAP_FIXED_NOREPLACE)
+#   define ZYREX_MAP_FIXED_NOREPLACE            MAP_FIXED_NOREPLACE
+#elif defined(ZYAN_LINUX)
+#   define ZYREX_MAP_FIXED_NOREPLACE            0x100000
+#else
+#   define ZYREX_MAP_FIXED_NOREPLACE            0
+#endif
+
+#endif
+
 /* ============================================================================================== */
 /* Enums and types                                                                                */
 /* ============================================================================================== */
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Patch site detection                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the accumulated length of the `NOP` instructions at the given `buffer`.
+ *
+ * @param   decoder     A pointer to the `ZydisDecoder` instance.
+ * @param   buffer      The buffer to decode.
+ * @param   size        The size of the buffer.
+ * @param   min_length  The minimum amount of bytes to decode. Decoding stops as soon as this
+ *                      amount of bytes has been consumed or a non-`NOP` instruction is found.
+ *
+ * @return  The accumulated length of the `NOP` instructions at the given `buffer`.
+ */
+static ZyanUSize ZyrexGetLengthOfNopSequence(const ZydisDecoder* decoder, const void* buffer,
+    ZyanUSize size, ZyanUSize min_length)
+{
+    ZYAN_ASSERT(decoder);
+    ZYAN_ASSERT(buffer);
+
+    ZydisDecodedInstruction instruction;
+    ZyanUSize offset = 0;
+    while (offset < min_length)
+    {
+        if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(decoder, ZYAN_NULL, 
+            (const ZyanU8*)buffer + offset, size - offset, &instruction)) ||
+            (instruction.mnemonic != ZYDIS_MNEMONIC_NOP))
+        {
+            break;
+        }
+        offset += instruction.length;
+    }
+
+    return offset;
+}
+
+/**
+ * @brief   Returns the length of the `NOP` padding that ends at the given function `address`.
+ *
+ * @param   decoder     A pointer to the `ZydisDecoder` instance.
+ * @param   address     The address of the function entry.
+ * @param   min_length  The minimum length of the padding.
+ *
+ * @return  The distance between the last instruction boundary that starts at least `min_length`
+ *          bytes in front of `address` and is only followed by `NOP` instructions up to `address`
+ *          or `0`, if there is no such boundary.
+ *
+ * Decoding backwards is not possible on x86, as a position in front of the entry might be the
+ * middle of an instruction. The padding is therefore decoded forward from the closest aligned
+ * position in front of it and is only accepted, if the decoded instructions end exactly at the
+ * function entry. Only padding that resides in the same page as the function entry, which is
+ * known to be readable, is considered.
+ */
+static ZyanUSize ZyrexGetLengthOfNopPadding(const ZydisDecoder* decoder, const void* address,
+    ZyanUSize min_length)
+{
+    ZYAN_ASSERT(decoder);
+    ZYAN_ASSERT(address);
+
+    const ZyanUPointer entry = (ZyanUPointer)address;
+    const ZyanUPointer page = ZYAN_ALIGN_DOWN(entry, ZyanMemoryGetSystemPageSize());
+    if (entry - page < min_length)
+    {
+        return 0;
+    }
+
+    ZydisDecodedInstruction instruction;
+    ZyanUPointer cursor = ZYAN_ALIGN_DOWN(entry - min_length, ZYREX_PATCH_SITE_PADDING_ALIGNMENT);
+    ZyanUPointer padding = 0;
+    while (cursor < entry)
+    {
+        // Instructions that cross the function entry are not decoded at all
+        if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(decoder, ZYAN_NULL, 
+            (const void*)cursor, entry - cursor, &instruction)))
+        {
+            return 0;
+        }
+        if (instruction.mnemonic != ZYDIS_MNEMONIC_NOP)
+        {
+            padding = 0;
+        } else if (entry - cursor >= min_length)
+        {
+            padding = cursor;
+        }
+        cursor += instruction.length;
+    }
+
+    return padding ? (ZyanUSize)(entry - padding) : 0;
+}
+
+/**
+ * @brief   Checks, if the given `address` points to an empty stub function that returns
+ *          immediately (e.g. an unused `__fentry__` or `mcount` implementation).
+ *
+ * @param   decoder A pointer to the `ZydisDecoder` instance.
+ * @param   address The address of the function.
+ *
+ * @return  `ZYAN_TRUE` if the given `address` points to an empty stub function or `ZYAN_FALSE`,
+ *          if not.
+ */
+static ZyanBool ZyrexIsEmptyStubFunction(const ZydisDecoder* decoder, const void* address)
+{
+    ZYAN_ASSERT(decoder);
+    ZYAN_ASSERT(address);
+
+    ZyanUSize size = ZYDIS_MAX_INSTRUCTION_LENGTH;
+#ifdef ZYAN_WINDOWS
+    if (!ZYAN_SUCCESS(ZyrexGetSizeOfReadableMemoryRegion(address, &size)))
+    {
+        return ZYAN_FALSE;
+    }
+#endif
+
+    ZydisDecodedInstruction instruction;
+    ZyanUSize offset = 0;
+    while (offset < size)
+    {
+        if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(decoder, ZYAN_NULL, 
+            (const ZyanU8*)address + offset, size - offset, &instruction)))
+        {
+            return ZYAN_FALSE;
+        }
+        switch (instruction.mnemonic)
+        {
+        case ZYDIS_MNEMONIC_ENDBR32:
+        case ZYDIS_MNEMONIC_ENDBR64:
+        case ZYDIS_MNEMONIC_NOP:
+            offset += instruction.length;
+            continue;
+        case ZYDIS_MNEMONIC_RET:
+            // `RET imm16` modifies the stack-pointer
+            return (instruction.raw.imm[0].size == 0) ? ZYAN_TRUE : ZYAN_FALSE;
+        default:
+            return ZYAN_FALSE;
+        }
+    }
+
+    return ZYAN_FALSE;
+}
+
+/**
+ * @brief   Searches for a patch site at the given `address` that can be hooked without
+ *          relocating any instructions.
+ *
+ * @param   address             The address of the function.
+ * @param   size                The amount of bytes that can be safely read from `address`.
+ * @param   min_bytes_to_patch  The size of the hook jump.
+ * @param   analysis            Receives the patch site information, if a patch site was found.
+ *
+ * @return  `ZYAN_STATUS_TRUE` if a patch site was found, `ZYAN_STATUS_FALSE` if not, or a generic
+ *          zyan status code if an error occured.
+ *
+ * The following patch sites are detected:
+ * - A sequence of `NOP` instructions at the function entry that is large enough for the hook
+ *   jump (`-fpatchable-function-entry`, `-mnop-mcount`)
+ * - A relative `CALL` at the function entry (`call __fentry__` emitted by `-mfentry -pg`)
+ * - A sequence of `NOP` instructions in front of the function entry that is large enough for the
+ *   hook jump, combined with at least 2 bytes of `NOP` instructions at the function entry which
+ *   are replaced by a short jump (`-fpatchable-function-entry=N,M`)
+ *
+ * Calls to an empty stub function are skipped by the trampoline. Any other profiling call is
+ * preserved by the trampoline.
+ *
+ * A leading `ENDBR32`/`ENDBR64` instruction is preserved.
+ */
+static ZyanStatus ZyrexFindPatchSite(const void* address, ZyanUSize size,
+    ZyanUSize min_bytes_to_patch, ZyrexTrampolineAnalysis* analysis)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(analysis);
+
+    ZydisDecoder decoder;
+#if defined(ZYAN_X86)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_COMPAT_32, ZYDIS_STACK_WIDTH_32);
+#elif defined(ZYAN_X64)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+#else
+#   error "Unsupported architecture detected"
+#endif
+
+    // Skip `ENDBR32`/`ENDBR64` to keep indirect branch tracking intact
+    ZydisDecodedInstruction instruction;
+    ZYAN_CHECK(ZydisDecoderDecodeInstruction(&decoder, ZYAN_NULL, address, size, &instruction));
+    ZyanUSize entry_size = 0;
+    if ((instruction.mnemonic == ZYDIS_MNEMONIC_ENDBR32) ||
+        (instruction.mnemonic == ZYDIS_MNEMONIC_ENDBR64))
+    {
+        entry_size = instruction.length;
+        ZYAN_CHECK(ZydisDecoderDecodeInstruction(&decoder, ZYAN_NULL, 
+            (const ZyanU8*)address + entry_size, size - entry_size, &instruction));
+    }
+    const ZyanU8* const entry = (const ZyanU8*)address + entry_size;
+
+    // NOP sled at the function entry
+    const ZyanUSize nop_size = 
+        ZyrexGetLengthOfNopSequence(&decoder, entry, size - entry_size, min_bytes_to_patch);
+    if (nop_size >= min_bytes_to_patch)
+    {
+        analysis->patch_site_type = ZYREX_PATCH_SITE_TYPE_NOP;
+        analysis->patch_address   = entry;
+        analysis->patch_size      = nop_size;
+        return ZYAN_STATUS_TRUE;
+    }
+
+    // Profiling call at the function entry (`call __fentry__`). A `CALL rel32` is the only
+    // instruction that is emitted in front of the prologue, so any target is accepted
+    if ((instruction.mnemonic == ZYDIS_MNEMONIC_CALL) &&
+        (instruction.length >= min_bytes_to_patch) &&
+        instruction.raw.imm[0].is_relative)
+    {
+        ZyanU64 target;
+        ZYAN_CHECK(ZyrexCalcAbsoluteAddress(&instruction, (ZyanU64)entry, &target));
+
+        analysis->patch_site_type = ZYREX_PATCH_SITE_TYPE_PROFILING_CALL;
+        analysis->patch_address   = entry;
+        analysis->patch_size      = instruction.length;
+        analysis->profiling_call_target = 
+            ZyrexIsEmptyStubFunction(&decoder, (const void*)(ZyanUPointer)target)
+                ? 0
+                : (ZyanUPointer)target;
+        return ZYAN_STATUS_TRUE;
+    }
+
+    // NOP padding in front of the function entry
+    if ((entry_size == 0) && (nop_size >= ZYREX_SIZEOF_SHORT_JUMP))
+    {
+        const ZyanUSize padding_size = 
+            ZyrexGetLengthOfNopPadding(&decoder, address, min_bytes_to_patch);
+        const ZyanUSize short_size = 
+            ZyrexGetLengthOfNopSequence(&decoder, entry, size, ZYREX_SIZEOF_SHORT_JUMP);
+        ZYAN_ASSERT(short_size >= ZYREX_SIZEOF_SHORT_JUMP);
+
+        // The hook jump and the padding behind it are assembled in a single patch buffer
+        if (padding_size && (padding_size <= ZYREX_MAX_PATCH_SIZE) &&
+            (padding_size + short_size <= ZYREX_TRAMPOLINE_MAX_CODE_SIZE))
+        {
+            analysis->patch_site_type = ZYREX_PATCH_SITE_TYPE_NOP_PADDING;
+            analysis->patch_address   = (const ZyanU8*)address - padding_size;
+            analysis->patch_size      = padding_size + short_size;
+            return ZYAN_STATUS_TRUE;
+        }
+    }
+
+    return ZYAN_STATUS_FALSE;
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Trampoline region                                                                              */
 /* ---------------------------------------------------------------------------------------------- */
@@ -88,11 +392,14 @@ ZYAN_STATIC_ASSERT(sizeof(ZyrexTrampolineRegion) == sizeof(ZyrexTrampolineChunk)
 /**
  * @brief   Contains global trampoline API data.
  *
- * Thread-safety is implicitly guaranteed by the transactional API as only one transaction can be
- * started at a time.
+ * All fields are protected by `lock`, as multiple transactions can be prepared concurrently.
  */
 static struct
 {
+    /**
+     * @brief   The lock that synchronizes the access to the trampoline API.
+     */
+    ZyrexSpinLock lock;
     /**
      * @brief   Signals, if the trampoline API is initialized.
      */
@@ -108,13 +415,31 @@ static struct
      * @brief   The maximum amount of chunks per trampoline-region.
      */
     ZyanUSize chunks_per_region;
+    /**
+     * @brief   The offset of the callback table inside of each trampoline-region.
+     *
+     * The callback table starts at a page boundary behind the last chunk and is never made
+     * executable.
+     */
+    ZyanUSize callback_table_offset;
     /**
      * @brief   Contains a list of all allocated trampoline-regions.
+     *
+     * Regions stay mapped after their last chunk was released and are reused by later
+     * reservations. Threads that were preempted inside of a released chunk can still finish
+     * executing it, as the code is left intact until the chunk is reused.
      */
     ZyanVector regions;
+    /**
+     * @brief   The trampoline-region that received the most recently reserved chunk.
+     *
+     * Neighbouring functions are usually served by the same region. This region is checked
+     * first, which saves the region lookup when reserving chunks for address-sorted targets.
+     */
+    ZyrexTrampolineRegion* last_region;
 } g_trampoline_data =
 {
-    ZYAN_FALSE, 0, 0, ZYAN_VECTOR_INITIALIZER
+    ZYREX_SPIN_LOCK_INITIALIZER, ZYAN_FALSE, 0, 0, 0, ZYAN_VECTOR_INITIALIZER, ZYAN_NULL
 };
 
 /* ============================================================================================== */
@@ -264,44 +589,37 @@ static ZyanStatus ZyrexGetAddressRangeOfRelativeInstructions(const void* buffer,
 /* ---------------------------------------------------------------------------------------------- */
 
 /**
- * @brief   Checks, if the given region is in a +/-2GiB range to both passed address values.
+ * @brief   Checks, if the given region contains at least one chunk in a +/-2GiB range to both
+ *          passed address values.
  *
  * @param   region_address      The base address of the trampoline region to check.
  * @param   address_lo          The memory address lower bound to be used as condition.
  * @param   address_hi          The memory address upper bound to be used as condition.
  *
- * @return  `ZYAN_STATUS_TRUE` if both address values are in range,
- *          `ZYAN_STATUS_FALSE` if only one address value is in range, or
- *          `ZYAN_STATUS_OUT_OF_RANGE`, if both address values are out of range.
+ * @return  `ZYAN_TRUE` if at least one chunk of the region is in range of both address values or
+ *          `ZYAN_FALSE`, if not.
  */
 static ZyanBool ZyrexTrampolineRegionInRange(ZyanUPointer region_address,
     ZyanUPointer address_lo, ZyanUPointer address_hi)
 {
     ZYAN_ASSERT(g_trampoline_data.is_initialized);
     ZYAN_ASSERT(ZYAN_IS_ALIGNED_TO(region_address, g_trampoline_data.region_size));
+    ZYAN_ASSERT(address_lo <= address_hi);
 
     // Skip the first chunk as it shares memory with the region-header
-    const ZyanIPointer region_base = region_address + sizeof(ZyrexTrampolineChunk);
-
-    const ZyanIPointer distance_lo =
-        region_base - (ZyanIPointer)address_lo + (ZyanIPointer)address_lo < region_base
-            ? sizeof(ZyrexTrampolineChunk)
-            : sizeof(ZyrexTrampolineChunk) * (g_trampoline_data.chunks_per_region - 1);
-    if ((ZYAN_ABS(distance_lo) > ZYREX_RANGEOF_RELATIVE_JUMP))
-    {
-        return ZYAN_FALSE;
-    }
-
-    const ZyanIPointer distance_hi =
-        region_base - (ZyanIPointer)address_hi + (ZyanIPointer)address_hi < region_base
-            ? sizeof(ZyrexTrampolineChunk)
-            : sizeof(ZyrexTrampolineChunk) * (g_trampoline_data.chunks_per_region - 1);
-    if ((ZYAN_ABS(distance_hi) > ZYREX_RANGEOF_RELATIVE_JUMP))
-    {
-        return ZYAN_FALSE;
-    }
-
-    return ZYAN_TRUE;
+    const ZyanUPointer chunk_first = region_address + sizeof(ZyrexTrampolineChunk);
+    const ZyanUPointer chunk_last  = 
+        region_address + sizeof(ZyrexTrampolineChunk) * (g_trampoline_data.chunks_per_region - 1);
+
+    // The range of chunk addresses that can reach and be reached from both address values
+    const ZyanUPointer reach_lo = (address_hi > ZYREX_RANGEOF_RELATIVE_JUMP)
+        ? address_hi - ZYREX_RANGEOF_RELATIVE_JUMP
+        : 0;
+    const ZyanUPointer reach_hi = (address_lo < (ZyanUPointer)(-1) - ZYREX_RANGEOF_RELATIVE_JUMP)
+        ? address_lo + ZYREX_RANGEOF_RELATIVE_JUMP - sizeof(ZyrexTrampolineChunk)
+        : (ZyanUPointer)(-1) - sizeof(ZyrexTrampolineChunk);
+
+    return (chunk_last >= reach_lo) && (chunk_first <= reach_hi);
 }
 
 /**
@@ -462,130 +780,348 @@ static ZyanStatus ZyrexTrampolineRegionInsert(ZyrexTrampolineRegion* region)
     return ZyanVectorInsert(&g_trampoline_data.regions, found_index, &region);
 }
 
+/* ---------------------------------------------------------------------------------------------- */
+
 /**
- * @brief   Removes the given `ZyrexTrampolineRegion` item from the global trampoline-region list.
+ * @brief   Changes the memory protection of the chunks of the passed trampoline-region to `RX`.
  *
- * @param   region  A pointer to the `ZyrexTrampolineRegion` item.
+ * @param   region  A pointer to the `ZyrexTrampolineRegion` struct.
  *
  * @return  A zyan status code.
+ *
+ * The callback table is not affected.
  */
-static ZyanStatus ZyrexTrampolineRegionRemove(ZyrexTrampolineRegion* region)
+static ZyanStatus ZyrexTrampolineRegionProtect(ZyrexTrampolineRegion* region)
 {
     ZYAN_ASSERT(region);
     ZYAN_ASSERT(g_trampoline_data.is_initialized);
     ZYAN_ASSERT(ZYAN_IS_ALIGNED_TO((ZyanUPointer)region, g_trampoline_data.region_size));
 
-    ZyanUSize found_index;
-    const ZyanStatus status =
-        ZyanVectorBinarySearch(&g_trampoline_data.regions, &region, &found_index,
-            (ZyanComparison)&ZyanComparePointer);
-    ZYAN_CHECK(status);
-
-    ZYAN_ASSERT(status == ZYAN_STATUS_TRUE);
-    return ZyanVectorDelete(&g_trampoline_data.regions, found_index);
+    return ZyanMemoryVirtualProtect(region, g_trampoline_data.callback_table_offset, 
+        ZYAN_PAGE_EXECUTE_READ);
 }
 
-/* ---------------------------------------------------------------------------------------------- */
-
 /**
- * @brief   Changes the memory protection of the passed trampoline-region to `RX`.
+ * @brief   Changes the memory protection of the chunks of the passed trampoline-region to `RWX`.
  *
  * @param   region  A pointer to the `ZyrexTrampolineRegion` struct.
  *
  * @return  A zyan status code.
+ *
+ * The callback table is not affected.
  */
-static ZyanStatus ZyrexTrampolineRegionProtect(ZyrexTrampolineRegion* region)
+static ZyanStatus ZyrexTrampolineRegionUnprotect(ZyrexTrampolineRegion* region)
 {
     ZYAN_ASSERT(region);
     ZYAN_ASSERT(g_trampoline_data.is_initialized);
     ZYAN_ASSERT(ZYAN_IS_ALIGNED_TO((ZyanUPointer)region, g_trampoline_data.region_size));
 
-    return ZyanMemoryVirtualProtect(region, sizeof(ZyrexTrampolineChunk), 
-        ZYAN_PAGE_EXECUTE_READ);
+    return ZyanMemoryVirtualProtect(region, g_trampoline_data.callback_table_offset,
+        ZYAN_PAGE_EXECUTE_READWRITE);
 }
 
 /**
- * @brief   Changes the memory protection of the passed trampoline-region to `RWX`.
+ * @brief   Returns the callback data of the trampoline chunk at the given address.
  *
- * @param   region  A pointer to the `ZyrexTrampolineRegion` struct.
+ * @param   chunk_address   The runtime address of the trampoline chunk.
  *
- * @return  A zyan status code.
+ * @return  A pointer to the `ZyrexTrampolineCallback` struct inside of the callback table.
  */
-static ZyanStatus ZyrexTrampolineRegionUnprotect(ZyrexTrampolineRegion* region)
+static ZyrexTrampolineCallback* ZyrexTrampolineRegionGetCallback(
+    const ZyrexTrampolineChunk* chunk_address)
 {
-    ZYAN_ASSERT(region);
+    ZYAN_ASSERT(chunk_address);
     ZYAN_ASSERT(g_trampoline_data.is_initialized);
-    ZYAN_ASSERT(ZYAN_IS_ALIGNED_TO((ZyanUPointer)region, g_trampoline_data.region_size));
 
-    return ZyanMemoryVirtualProtect(region, sizeof(ZyrexTrampolineChunk),
-        ZYAN_PAGE_EXECUTE_READWRITE);
+    const ZyanUPointer region = ZYAN_ALIGN_DOWN((ZyanUPointer)chunk_address,
+        g_trampoline_data.region_size);
+    const ZyanUSize index = ((ZyanUPointer)chunk_address - region) / sizeof(ZyrexTrampolineChunk);
+    ZYAN_ASSERT(index < g_trampoline_data.chunks_per_region);
+
+    return (ZyrexTrampolineCallback*)(region + g_trampoline_data.callback_table_offset) + index;
 }
 
+#if defined(ZYAN_POSIX)
+
 /**
- * Allocates memory for a new trampoline region in a +/-2GiB range of both passed address values
- * and initializes it.
+ * @brief   Selects the trampoline-region address inside of the given unmapped address range that
+ *          is closest to the center of both passed address values.
  *
+ * @param   gap_lo      The start address of the unmapped range.
+ * @param   gap_hi      The end address of the unmapped range.
  * @param   address_lo  The memory address lower bound.
  * @param   address_hi  The memory address upper bound.
- * @param   region      Receives a pointer to the new `ZyrexTrampolineRegion` struct.
- *
- * Regions allocated by this function will have `RWX` memory protection.
- *
- * @return  A zyan status code.
+ * @param   address     Receives the selected address, if it is closer than the current one.
+ * @param   distance    The distance of the current address to the center. Receives the distance
+ *                      of the selected address.
  */
-static ZyanStatus ZyrexTrampolineRegionAllocate(ZyanUPointer address_lo, ZyanUPointer address_hi,
-    ZyrexTrampolineRegion** region)
+static void ZyrexTrampolineRegionCheckGap(ZyanUPointer gap_lo, ZyanUPointer gap_hi,
+    ZyanUPointer address_lo, ZyanUPointer address_hi, ZyanUPointer* address, 
+    ZyanUPointer* distance)
 {
-    ZYAN_ASSERT(region);
-    ZYAN_ASSERT(g_trampoline_data.is_initialized);
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(distance);
 
-#ifdef ZYAN_WINDOWS
+    const ZyanUSize region_size = g_trampoline_data.region_size;
+    if ((gap_hi <= gap_lo) || (gap_hi - gap_lo < region_size))
+    {
+        return;
+    }
+    const ZyanUPointer first = ZYAN_ALIGN_UP(gap_lo, (ZyanUPointer)region_size);
+    const ZyanUPointer last  = ZYAN_ALIGN_DOWN(gap_hi - region_size, (ZyanUPointer)region_size);
+    if (first > last)
+    {
+        return;
+    }
 
-    SYSTEM_INFO system_info;
-    GetSystemInfo(&system_info);
+    const ZyanUPointer mid = address_lo + (address_hi - address_lo) / 2;
+    ZyanUPointer candidate = ZYAN_ALIGN_DOWN(mid, (ZyanUPointer)region_size);
+    candidate = ZYAN_MAX(candidate, first);
+    candidate = ZYAN_MIN(candidate, last);
+    if (!ZyrexTrampolineRegionInRange(candidate, address_lo, address_hi))
+    {
+        return;
+    }
 
-    const ZyanUSize region_size = g_trampoline_data.region_size;
-    const ZyanUPointer mid = (address_lo + address_hi) / 2;
-    const ZyanU8* alloc_address_lo =
-        (const ZyanU8*)ZYAN_ALIGN_DOWN(mid, (ZyanUPointer)region_size);
-    const ZyanU8* alloc_address_hi =
-        (const ZyanU8*)ZYAN_ALIGN_UP(mid, (ZyanUPointer)region_size);
+    const ZyanUPointer candidate_distance = (candidate > mid) ? candidate - mid : mid - candidate;
+    if (candidate_distance < *distance)
+    {
+        *address = candidate;
+        *distance = candidate_distance;
+    }
+}
 
-    MEMORY_BASIC_INFORMATION memory_info;
+#if defined(ZYAN_LINUX)
 
-#endif
+/**
+ * @brief   Searches the unmapped trampoline-region address that is closest to the center of both
+ *          passed address values by reading `/proc/self/maps`.
+ *
+ * @param   address_lo  The memory address lower bound.
+ * @param   address_hi  The memory address upper bound.
+ * @param   floor       The lowest address to consider.
+ * @param   ceiling     The end of the address range to consider.
+ * @param   address     Receives the address of the unmapped region.
+ *
+ * @return  `ZYAN_STATUS_TRUE` if an unmapped region in range of both address values was found,
+ *          `ZYAN_STATUS_FALSE` if not, or a generic zyan status code if an error occured.
+ */
+static ZyanStatus ZyrexTrampolineRegionFindFreeAddress(ZyanUPointer address_lo,
+    ZyanUPointer address_hi, ZyanUPointer floor, ZyanUPointer ceiling, ZyanUPointer* address)
+{
+    ZYAN_ASSERT(address);
 
-    while (ZYAN_TRUE)
+    const int fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
     {
-#ifdef ZYAN_WINDOWS
+        return ZYAN_STATUS_BAD_SYSTEMCALL;
+    }
 
-        // Skip reserved address regions
-        if (alloc_address_lo < (ZyanU8*)system_info.lpMinimumApplicationAddress)
+    ZyanUPointer distance = (ZyanUPointer)(-1);
+    ZyanUPointer gap_lo = floor;
+    char buffer[4096];
+    ZyanUSize length = 0;
+    ZyanBool is_eof = ZYAN_FALSE;
+    ZyanBool is_skipping = ZYAN_FALSE;
+    while (gap_lo < ceiling)
+    {
+        // Find the end of the current line
+        ZyanUSize line_length = 0;
+        while ((line_length < length) && (buffer[line_length] != '\n'))
         {
-            alloc_address_lo = (const ZyanU8*)system_info.lpMinimumApplicationAddress;
-            alloc_address_lo = 
-                (const ZyanU8*)(ZYAN_ALIGN_UP((ZyanUPointer)alloc_address_lo, region_size));
+            ++line_length;
         }
-        if (alloc_address_lo > (ZyanU8*)system_info.lpMaximumApplicationAddress)
+        if ((line_length == length) && (length < sizeof(buffer)) && !is_eof)
         {
-            alloc_address_lo = (const ZyanU8*)system_info.lpMaximumApplicationAddress;
-            alloc_address_lo = 
-                (const ZyanU8*)(ZYAN_ALIGN_DOWN((ZyanUPointer)alloc_address_lo, region_size));
+            const ssize_t count = read(fd, buffer + length, sizeof(buffer) - length);
+            if (count < 0)
+            {
+                close(fd);
+                return ZYAN_STATUS_BAD_SYSTEMCALL;
+            }
+            is_eof = (count == 0);
+            length += (ZyanUSize)count;
+            continue;
         }
-        if (alloc_address_hi < (ZyanU8*)system_info.lpMinimumApplicationAddress)
+        if (length == 0)
         {
-            alloc_address_hi = (const ZyanU8*)system_info.lpMinimumApplicationAddress;
-            alloc_address_lo = 
-                (const ZyanU8*)(ZYAN_ALIGN_UP((ZyanUPointer)alloc_address_lo, region_size));
+            break;
         }
-        if (alloc_address_hi > (ZyanU8*)system_info.lpMaximumApplicationAddress)
+
+        // Overlong lines are processed partially. The address range is at the start
+        const ZyanBool is_complete = (line_length < length);
+        if (is_skipping)
         {
-            alloc_address_hi = (const ZyanU8*)system_info.lpMaximumApplicationAddress;
-            alloc_address_lo = 
-                (const ZyanU8*)(ZYAN_ALIGN_DOWN((ZyanUPointer)alloc_address_lo, region_size));
+            is_skipping = !is_complete;
+        } else
+        {
+            is_skipping = !is_complete && !is_eof;
+
+            // Parse `start-end ...`. The mappings are sorted by address
+            ZyanUSize offset = 0;
+            const ZyanUPointer start = ZyrexParseHexNumber(buffer, line_length, &offset);
+            ++offset;
+            const ZyanUPointer end = ZyrexParseHexNumber(buffer, line_length, &offset);
+
+            ZyrexTrampolineRegionCheckGap(gap_lo, ZYAN_MIN(start, ceiling), address_lo, 
+                address_hi, address, &distance);
+            gap_lo = ZYAN_MAX(gap_lo, end);
         }
 
-//#endif
+        // Consume the line
+        const ZyanUSize consumed = is_complete ? line_length + 1 : length;
+        ZYAN_MEMMOVE(buffer, buffer + consumed, length - consumed);
+        length -= consumed;
+    }
+
+    close(fd);
+
+    ZyrexTrampolineRegionCheckGap(gap_lo, ceiling, address_lo, address_hi, address, &distance);
+
+    return (distance != (ZyanUPointer)(-1)) ? ZYAN_STATUS_TRUE : ZYAN_STATUS_FALSE;
+}
+
+#else
+
+/**
+ * @brief   Searches an unmapped trampoline-region address in range of both passed address values
+ *          by probing the address space with `msync`.
+ *
+ * @param   address_lo  The memory address lower bound.
+ * @param   address_hi  The memory address upper bound.
+ * @param   floor       The lowest address to consider.
+ * @param   ceiling     The end of the address range to consider.
+ * @param   address     Receives the address of the unmapped region.
+ *
+ * @return  `ZYAN_STATUS_TRUE` if an unmapped region in range of both address values was found,
+ *          `ZYAN_STATUS_FALSE` if not, or a generic zyan status code if an error occured.
+ *
+ * `msync` fails with `ENOMEM` for addresses that are not mapped. Candidates are probed in
+ * alternating order starting at the center of both address values.
+ */
+static ZyanStatus ZyrexTrampolineRegionFindFreeAddress(ZyanUPointer address_lo,
+    ZyanUPointer address_hi, ZyanUPointer floor, ZyanUPointer ceiling, ZyanUPointer* address)
+{
+    ZYAN_ASSERT(address);
+
+    const ZyanUSize region_size = g_trampoline_data.region_size;
+    const ZyanUSize page_size = ZyanMemoryGetSystemPageSize();
+    const ZyanUPointer mid = address_lo + (address_hi - address_lo) / 2;
+    ZyanUPointer cursor_lo = ZYAN_ALIGN_DOWN(mid, (ZyanUPointer)region_size);
+    ZyanUPointer cursor_hi = cursor_lo + region_size;
+
+    while (ZYAN_TRUE)
+    {
+        ZyanU8 c = 0;
+        ZyanUPointer candidates[2];
+        if ((cursor_lo >= floor) && (cursor_lo + region_size <= ceiling) &&
+            ZyrexTrampolineRegionInRange(cursor_lo, address_lo, address_hi))
+        {
+            candidates[c++] = cursor_lo;
+            cursor_lo -= region_size;
+        }
+        if ((cursor_hi >= floor) && (cursor_hi + region_size <= ceiling) &&
+            ZyrexTrampolineRegionInRange(cursor_hi, address_lo, address_hi))
+        {
+            candidates[c++] = cursor_hi;
+            cursor_hi += region_size;
+        }
+        if (c == 0)
+        {
+            return ZYAN_STATUS_FALSE;
+        }
+
+        for (ZyanU8 i = 0; i < c; ++i)
+        {
+            ZyanBool is_free = ZYAN_TRUE;
+            for (ZyanUSize offset = 0; offset < region_size; offset += page_size)
+            {
+                if ((msync((void*)(candidates[i] + offset), page_size, MS_ASYNC) == 0) ||
+                    (errno != ENOMEM))
+                {
+                    is_free = ZYAN_FALSE;
+                    break;
+                }
+            }
+            if (is_free)
+            {
+                *address = candidates[i];
+                return ZYAN_STATUS_TRUE;
+            }
+        }
+    }
+}
+
+#endif
+
+#endif
+
+/**
+ * Allocates memory for a new trampoline region in a +/-2GiB range of both passed address values
+ * and initializes it.
+ *
+ * @param   address_lo  The memory address lower bound.
+ * @param   address_hi  The memory address upper bound.
+ * @param   region      Receives a pointer to the new `ZyrexTrampolineRegion` struct.
+ *
+ * The chunks of regions allocated by this function will have `RWX` memory protection. The
+ * callback table is `RW`.
+ *
+ * @return  `ZYAN_STATUS_OUT_OF_RANGE`, if no unused memory is available in range of both address
+ *          values, or a zyan status code.
+ *
+ * On Linux, the unmapped ranges are determined by reading `/proc/self/maps` and the region is
+ * mapped using `MAP_FIXED_NOREPLACE`, which never replaces existing mappings.
+ */
+static ZyanStatus ZyrexTrampolineRegionAllocate(ZyanUPointer address_lo, ZyanUPointer address_hi,
+    ZyrexTrampolineRegion** region)
+{
+    ZYAN_ASSERT(region);
+    ZYAN_ASSERT(g_trampoline_data.is_initialized);
+
+#ifdef ZYAN_WINDOWS
+
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+
+    const ZyanUSize region_size = g_trampoline_data.region_size;
+    const ZyanUPointer mid = (address_lo + address_hi) / 2;
+    const ZyanU8* alloc_address_lo =
+        (const ZyanU8*)ZYAN_ALIGN_DOWN(mid, (ZyanUPointer)region_size);
+    const ZyanU8* alloc_address_hi =
+        (const ZyanU8*)ZYAN_ALIGN_UP(mid, (ZyanUPointer)region_size);
+
+    MEMORY_BASIC_INFORMATION memory_info;
+
+    while (ZYAN_TRUE)
+    {
+        // Skip reserved address regions
+        if (alloc_address_lo < (ZyanU8*)system_info.lpMinimumApplicationAddress)
+        {
+            alloc_address_lo = (const ZyanU8*)system_info.lpMinimumApplicationAddress;
+            alloc_address_lo = 
+                (const ZyanU8*)(ZYAN_ALIGN_UP((ZyanUPointer)alloc_address_lo, region_size));
+        }
+        if (alloc_address_lo > (ZyanU8*)system_info.lpMaximumApplicationAddress)
+        {
+            alloc_address_lo = (const ZyanU8*)system_info.lpMaximumApplicationAddress;
+            alloc_address_lo = 
+                (const ZyanU8*)(ZYAN_ALIGN_DOWN((ZyanUPointer)alloc_address_lo, region_size));
+        }
+        if (alloc_address_hi < (ZyanU8*)system_info.lpMinimumApplicationAddress)
+        {
+            alloc_address_hi = (const ZyanU8*)system_info.lpMinimumApplicationAddress;
+            alloc_address_lo = 
+                (const ZyanU8*)(ZYAN_ALIGN_UP((ZyanUPointer)alloc_address_lo, region_size));
+        }
+        if (alloc_address_hi > (ZyanU8*)system_info.lpMaximumApplicationAddress)
+        {
+            alloc_address_hi = (const ZyanU8*)system_info.lpMaximumApplicationAddress;
+            alloc_address_lo = 
+                (const ZyanU8*)(ZYAN_ALIGN_DOWN((ZyanUPointer)alloc_address_lo, region_size));
+        }
+
+//#endif
 
         // TODO: Only `RESERVE` the memory region and `COMMIT` pages on demand to reduce memory
         // TODO: imprint
@@ -636,111 +1172,699 @@ static ZyanStatus ZyrexTrampolineRegionAllocate(ZyanUPointer address_lo, ZyanUPo
         {
             return ZYAN_STATUS_OUT_OF_RANGE;
         }
+    }
+
 #else
-        ZYAN_UNUSED(address_lo);
-        ZYAN_UNUSED(address_hi);
-#endif
+
+    const ZyanUSize region_size = g_trampoline_data.region_size;
+
+    // Neighbouring functions are usually served by the regions next to the most recent one, which
+    // saves the address space lookup
+    if (g_trampoline_data.last_region)
+    {
+        const ZyanUPointer candidates[2] =
+        {
+            (ZyanUPointer)g_trampoline_data.last_region - region_size,
+            (ZyanUPointer)g_trampoline_data.last_region + region_size
+        };
+        for (ZyanUSize i = 0; i < ZYAN_ARRAY_LENGTH(candidates); ++i)
+        {
+            if ((candidates[i] < ZYREX_TRAMPOLINE_REGION_MIN_ADDRESS) ||
+                (candidates[i] > ZYREX_TRAMPOLINE_REGION_MAX_ADDRESS - region_size) ||
+                !ZyrexTrampolineRegionInRange(candidates[i], address_lo, address_hi))
+            {
+                continue;
+            }
+            void* const result = mmap((void*)candidates[i], region_size, 
+                PROT_READ | PROT_WRITE | PROT_EXEC, 
+                MAP_PRIVATE | MAP_ANONYMOUS | ZYREX_MAP_FIXED_NOREPLACE, -1, 0);
+            if (result == (void*)candidates[i])
+            {
+                *region = (ZyrexTrampolineRegion*)result;
+                goto InitializeRegion;
+            }
+            if (result != MAP_FAILED)
+            {
+                munmap(result, region_size);
+            }
+        }
+    }
+
+    ZyanUPointer floor = ZYREX_TRAMPOLINE_REGION_MIN_ADDRESS;
+    ZyanUPointer ceiling = ZYREX_TRAMPOLINE_REGION_MAX_ADDRESS;
+    for (ZyanUSize i = 0; i < ZYREX_TRAMPOLINE_REGION_MAX_ATTEMPTS; ++i)
+    {
+        ZyanUPointer address;
+        const ZyanStatus status = ZyrexTrampolineRegionFindFreeAddress(address_lo, address_hi, 
+            floor, ceiling, &address);
+        ZYAN_CHECK(status);
+        if (status == ZYAN_STATUS_FALSE)
+        {
+            return ZYAN_STATUS_OUT_OF_RANGE;
+        }
+
+        void* const result = mmap((void*)address, region_size, PROT_READ | PROT_WRITE | PROT_EXEC,
+            MAP_PRIVATE | MAP_ANONYMOUS | ZYREX_MAP_FIXED_NOREPLACE, -1, 0);
+        if (result == (void*)address)
+        {
+            *region = (ZyrexTrampolineRegion*)result;
+            goto InitializeRegion;
+        }
+        if (result != MAP_FAILED)
+        {
+            // The address is only used as a hint, if `MAP_FIXED_NOREPLACE` is not supported and
+            // another thread mapped memory at the same address in the meantime
+            munmap(result, region_size);
+            continue;
+        }
+        if (errno == EEXIST)
+        {
+            continue;
+        }
+
+        // The kernel refused the address (e.g. below `vm.mmap_min_addr` or above the end of the
+        // user address space). Exclude it from the search
+        const ZyanUPointer mid = address_lo + (address_hi - address_lo) / 2;
+        if (address < mid)
+        {
+            floor = address + region_size;
+        } else
+        {
+            ceiling = address;
+        }
     }
 
-    // ZYAN_UNREACHABLE;
+    return ZYAN_STATUS_BAD_SYSTEMCALL;
+
+#endif
 
-#ifdef ZYAN_WINDOWS
 InitializeRegion:
     (*region)->header.signature = ZYREX_TRAMPOLINE_REGION_SIGNATURE;
     (*region)->header.number_of_unused_chunks = g_trampoline_data.chunks_per_region - 1;
+    ZYAN_CHECK(ZyanMemoryVirtualProtect(
+        (ZyanU8*)*region + g_trampoline_data.callback_table_offset,
+        g_trampoline_data.region_size - g_trampoline_data.callback_table_offset,
+        ZYAN_PAGE_READWRITE));
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Trampoline chunk                                                                               */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Checks, if the code-flow can fall through the end of the relocated instructions.
+ *
+ * @param   chunk   A pointer to the `ZyrexTrampolineChunk` struct.
+ * @param   source  A pointer to the relocated source instructions.
+ * @param   size    The size of the relocated source instructions.
+ *
+ * @return  `ZYAN_FALSE` if the last relocated instruction is an unconditional branch or a
+ *          return instruction, `ZYAN_TRUE` if not.
+ *
+ * Internal branch targets are always located inside the relocated code, which makes the
+ * backjump unreachable, if the code-flow can not fall through the last instruction.
+ */
+static ZyanBool ZyrexTrampolineChunkFallsThrough(const ZyrexTrampolineChunk* chunk,
+    const void* source, ZyanUSize size)
+{
+    ZYAN_ASSERT(chunk);
+    ZYAN_ASSERT(source);
+
+    if (chunk->translation_map.count == 0)
+    {
+        return ZYAN_TRUE;
+    }
+
+    ZydisDecoder decoder;
+#if defined(ZYAN_X86)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_COMPAT_32, ZYDIS_STACK_WIDTH_32);
+#elif defined(ZYAN_X64)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+#else
+#   error "Unsupported architecture detected"
+#endif
+
+    const ZyanU8 offset = 
+        chunk->translation_map.items[chunk->translation_map.count - 1].offset_source;
+    ZYAN_ASSERT(offset < size);
+
+    ZydisDecodedInstruction instruction;
+    if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&decoder, ZYAN_NULL, 
+        (const ZyanU8*)source + offset, size - offset, &instruction)))
+    {
+        return ZYAN_TRUE;
+    }
+
+    switch (instruction.mnemonic)
+    {
+    case ZYDIS_MNEMONIC_JMP:
+    case ZYDIS_MNEMONIC_RET:
+        return ZYAN_FALSE;
+    default:
+        return ZYAN_TRUE;
+    }
+}
+
+/**
+ * @brief   Fills the translation map of a trampoline chunk for a patch site that does not require
+ *          any instructions to be relocated.
+ *
+ * @param   chunk       A pointer to the `ZyrexTrampolineChunk` struct.
+ * @param   analysis    A pointer to the `ZyrexTrampolineAnalysis` struct.
+ *
+ * @return  A zyan status code.
+ *
+ * Every instruction inside the patch site is mapped to the beginning of the trampoline code
+ * buffer, which directly jumps back to the original function body.
+ */
+static ZyanStatus ZyrexTrampolineChunkInitPatchSite(ZyrexTrampolineChunk* chunk,
+    const ZyrexTrampolineAnalysis* analysis)
+{
+    ZYAN_ASSERT(chunk);
+    ZYAN_ASSERT(analysis);
+    ZYAN_ASSERT(analysis->patch_site_type != ZYREX_PATCH_SITE_TYPE_DEFAULT);
+
+    ZydisDecoder decoder;
+#if defined(ZYAN_X86)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_COMPAT_32, ZYDIS_STACK_WIDTH_32);
+#elif defined(ZYAN_X64)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+#else
+#   error "Unsupported architecture detected"
+#endif
+
+    ZydisDecodedInstruction instruction;
+    ZyanUSize offset = 0;
+    while (offset < analysis->patch_size)
+    {
+        ZYAN_CHECK(ZydisDecoderDecodeInstruction(&decoder, ZYAN_NULL, 
+            (const ZyanU8*)analysis->patch_address + offset, analysis->patch_size - offset,
+            &instruction));
+
+        ZyrexInstructionTranslationMap* const map = &chunk->translation_map;
+        if (map->count == ZYAN_ARRAY_LENGTH(map->items))
+        {
+            return ZYAN_STATUS_INSUFFICIENT_BUFFER_SIZE;
+        }
+        map->items[map->count].offset_source = (ZyanU8)offset;
+        map->items[map->count].offset_destination = 0;
+        ++map->count;
+
+        offset += instruction.length;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Writes an absolute indirect jump to the given memory operand.
+ *
+ * @param   chunk           A pointer to the trampoline chunk or a private buffer.
+ * @param   chunk_address   The runtime address of the trampoline chunk.
+ * @param   address         The address of the jump instruction inside of `chunk`.
+ * @param   destination     The runtime address of the memory operand.
+ */
+static void ZyrexTrampolineChunkWriteAbsoluteJump(ZyrexTrampolineChunk* chunk,
+    const ZyrexTrampolineChunk* chunk_address, void* address, const void* destination)
+{
+    ZYAN_ASSERT(chunk);
+    ZYAN_ASSERT(chunk_address);
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(destination);
+
+#if defined(ZYAN_X64)
+
+    // The jump is written to the (private) buffer, so the destination is shifted by the distance
+    // between the buffer and the runtime address to get the correct relative offset
+    ZyrexWriteAbsoluteJump(address, (ZyanUPointer)destination -
+        ((ZyanUPointer)chunk_address - (ZyanUPointer)chunk));
+
+#else
+
+    // The memory operand is encoded as an absolute address
+    ZYAN_UNUSED(chunk);
+    ZYAN_UNUSED(chunk_address);
+    ZyrexWriteAbsoluteJump(address, (ZyanUPointer)destination);
+
+#endif
+}
+
+/**
+ * @brief   Writes the backjump from the given trampoline `chunk` to the original code.
+ *
+ * @param   chunk           A pointer to the trampoline chunk or a private buffer.
+ * @param   chunk_address   The runtime address of the trampoline chunk.
+ * @param   address         The address of the jump instruction inside of `chunk`.
+ * @param   destination     The address in the original code to jump back to.
+ *
+ * @return  The size of the jump instruction.
+ *
+ * A direct relative jump is used, if the destination is within reach. This saves the data load
+ * of the indirect jump on every call to the original function. Otherwise an absolute jump that
+ * reads the `backjump_address` is written.
+ */
+static ZyanUSize ZyrexTrampolineChunkWriteBackjump(ZyrexTrampolineChunk* chunk,
+    const ZyrexTrampolineChunk* chunk_address, void* address, ZyanUPointer destination)
+{
+    ZYAN_ASSERT(chunk);
+    ZYAN_ASSERT(chunk_address);
+    ZYAN_ASSERT(address);
+
+    const ZyanUPointer runtime_address =
+        (ZyanUPointer)chunk_address + ((ZyanUPointer)address - (ZyanUPointer)chunk);
+
+#if defined(ZYAN_X64)
+
+    const ZyanIPointer distance = (ZyanIPointer)destination -
+        (ZyanIPointer)(runtime_address + ZYREX_SIZEOF_RELATIVE_JUMP);
+    if (ZYAN_ABS(distance) > ZYREX_RANGEOF_RELATIVE_JUMP)
+    {
+        ZyrexTrampolineChunkWriteAbsoluteJump(chunk, chunk_address, address,
+            &chunk_address->backjump_address);
+        return ZYREX_SIZEOF_ABSOLUTE_JUMP;
+    }
+
 #endif
 
-    return ZYAN_STATUS_SUCCESS;
+    // The jump is written to the (private) buffer, so the offset has to be calculated against
+    // the runtime address
+    ZyanU8* const code = (ZyanU8*)address;
+    code[0] = 0xE9;
+    const ZyanI32 offset = ZyrexCalculateRelativeOffset(ZYREX_SIZEOF_RELATIVE_JUMP,
+        runtime_address, destination);
+    ZYAN_MEMCPY(&code[1], &offset, sizeof(offset));
+
+    return ZYREX_SIZEOF_RELATIVE_JUMP;
+}
+
+/**
+ * @brief   Writes the code that performs a preserved profiling call on behalf of the original
+ *          function.
+ *
+ * @param   chunk           A pointer to the trampoline chunk or a private buffer.
+ * @param   chunk_address   The runtime address of the trampoline chunk.
+ * @param   address         The address of the code inside of `chunk`.
+ * @param   target          The address of the profiling function.
+ * @param   size            Receives the size of the code.
+ *
+ * @return  `ZYAN_STATUS_OUT_OF_RANGE`, if the profiling function is not within reach of the
+ *          trampoline chunk or a zyan status code.
+ *
+ * The address of the original function body (`backjump_address`) is pushed as return address
+ * and the profiling function is entered with a jump. The profiling function returns straight to
+ * the function body, so it sees the same return address as without the hook and no thread ever
+ * returns into the trampoline chunk, which might be released in the meantime.
+ */
+static ZyanStatus ZyrexTrampolineChunkWriteProfilingCall(ZyrexTrampolineChunk* chunk,
+    const ZyrexTrampolineChunk* chunk_address, void* address, ZyanUPointer target,
+    ZyanUSize* size)
+{
+    ZYAN_ASSERT(chunk);
+    ZYAN_ASSERT(chunk_address);
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(size);
+
+    const ZyanUPointer runtime_address =
+        (ZyanUPointer)chunk_address + ((ZyanUPointer)address - (ZyanUPointer)chunk);
+    ZyanU8* const code = (ZyanU8*)address;
+
+#if defined(ZYAN_X64)
+
+    // push qword ptr [rip + backjump_address]
+    code[0] = 0xFF;
+    code[1] = 0x35;
+    const ZyanI32 push_offset = ZyrexCalculateRelativeOffset(6, runtime_address,
+        (ZyanUPointer)&chunk_address->backjump_address);
+    ZYAN_MEMCPY(&code[2], &push_offset, sizeof(push_offset));
+    ZyanUSize offset = 6;
+
+    const ZyanIPointer distance = (ZyanIPointer)target -
+        (ZyanIPointer)(runtime_address + offset + ZYREX_SIZEOF_RELATIVE_JUMP);
+    if (ZYAN_ABS(distance) > ZYREX_RANGEOF_RELATIVE_JUMP)
+    {
+        return ZYAN_STATUS_OUT_OF_RANGE;
+    }
+
+#else
+
+    // push imm32
+    code[0] = 0x68;
+    ZYAN_MEMCPY(&code[1], &chunk->backjump_address, sizeof(ZyanU32));
+    ZyanUSize offset = 5;
+
+#endif
+
+    code[offset] = 0xE9;
+    const ZyanI32 jump_offset = ZyrexCalculateRelativeOffset(ZYREX_SIZEOF_RELATIVE_JUMP,
+        runtime_address + offset, target);
+    ZYAN_MEMCPY(&code[offset + 1], &jump_offset, sizeof(jump_offset));
+
+    *size = offset + ZYREX_SIZEOF_RELATIVE_JUMP;
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Initializes a new trampoline chunk and relocates the instructions from the original
+ *          function.
+ *
+ * @param   chunk           A pointer to the `ZyrexTrampolineChunk` struct that receives the chunk
+ *                          data.
+ * @param   chunk_address   The runtime address of the trampoline chunk.
+ * @param   analysis        A pointer to the `ZyrexTrampolineAnalysis` struct.
+ * @param   callback        The address of the callback function the hook will redirect to.
+ *
+ * @return  A zyan status code.
+ *
+ * The `chunk` might point to a private buffer instead of the actual trampoline chunk. All
+ * relative offsets are calculated against the `chunk_address`.
+ */
+static ZyanStatus ZyrexTrampolineChunkInit(ZyrexTrampolineChunk* chunk,
+    const ZyrexTrampolineChunk* chunk_address, const ZyrexTrampolineAnalysis* analysis,
+    const void* callback)
+{
+    ZYAN_ASSERT(chunk);
+    ZYAN_ASSERT(chunk_address);
+    ZYAN_ASSERT(analysis);
+    ZYAN_ASSERT(callback);
+    ZYAN_ASSERT(analysis->min_bytes_to_reloc <= analysis->source_size);
+
+    ZYAN_MEMSET(chunk, 0, sizeof(ZyrexTrampolineChunk));
+    chunk->is_used = ZYAN_TRUE;
+    chunk->callback = ZyrexTrampolineRegionGetCallback(chunk_address);
+    chunk->patch_size = (ZyanU8)analysis->min_bytes_to_reloc;
+    chunk->patch_site_type = analysis->patch_site_type;
+    chunk->entry_offset = (ZyanI8)((const ZyanU8*)analysis->address - 
+        (const ZyanU8*)analysis->patch_address);
+
+    // The chunk is reserved, but not reachable yet, so its callback data can be written directly
+    chunk->callback->user_callback_address = (ZyanUPointer)callback;
+    chunk->callback->is_direct = ZYAN_FALSE;
+    ZyrexAtomicStore(&chunk->callback->callback_address, (ZyanUPointer)callback);
+    ZyrexTrampolineChunkWriteAbsoluteJump(chunk, chunk_address, &chunk->callback_jump,
+        &chunk->callback->callback_address);
+
+    ZyanUSize bytes_read;
+    ZyanUSize bytes_written;
+
+    if (analysis->patch_site_type == ZYREX_PATCH_SITE_TYPE_DEFAULT)
+    {
+        // Relocate instructions
+        ZYAN_CHECK(ZyrexRelocateCode(analysis->patch_address, analysis->source_size, chunk, 
+            (ZyanUPointer)chunk_address, analysis->min_bytes_to_reloc, &bytes_read, 
+            &bytes_written));
+    } else
+    {
+        // The patch site does not contain any instructions that need to be preserved
+        ZYAN_CHECK(ZyrexTrampolineChunkInitPatchSite(chunk, analysis));
+        bytes_read = analysis->patch_size;
+        bytes_written = 0;
+    }
+
+    ZYAN_ASSERT(bytes_read <= ZYAN_ARRAY_LENGTH(chunk->original_code));
+    ZYAN_ASSERT(bytes_written <= ZYAN_ARRAY_LENGTH(chunk->code_buffer));
+
+    // Write backjump, unless it is unreachable
+    chunk->backjump_address = (ZyanUPointer)analysis->patch_address + bytes_read;
+    ZyanUSize code_size = bytes_written;
+    if (analysis->profiling_call_target)
+    {
+        // The profiling function returns to the original function body on its own
+        ZYAN_CHECK(ZyrexTrampolineChunkWriteProfilingCall(chunk, chunk_address,
+            chunk->code_buffer, analysis->profiling_call_target, &code_size));
+        bytes_written = code_size;
+    } else if ((analysis->patch_site_type != ZYREX_PATCH_SITE_TYPE_DEFAULT) ||
+        ZyrexTrampolineChunkFallsThrough(chunk, analysis->patch_address, bytes_read))
+    {
+        code_size += ZyrexTrampolineChunkWriteBackjump(chunk, chunk_address,
+            &chunk->code_buffer[bytes_written], chunk->backjump_address);
+    }
+    chunk->code_buffer_size = (ZyanU8)bytes_written;
+
+    // Fill remaining space with `INT 3` instructions
+    ZYAN_ASSERT(code_size <= sizeof(chunk->code_buffer));
+    ZYAN_MEMSET(&chunk->code_buffer[code_size], 0xCC, sizeof(chunk->code_buffer) - code_size);
+
+    // Backup original instructions 
+    chunk->original_code_size = (ZyanU8)bytes_read;
+    ZYAN_MEMCPY(chunk->original_code, analysis->patch_address, bytes_read);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Chunk management                                                                               */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Reserves a trampoline chunk in range of the given analysis result.
+ *
+ * @param   analysis    A pointer to the `ZyrexTrampolineAnalysis` struct.
+ * @param   trampoline  Receives a pointer to the reserved trampoline chunk.
+ *
+ * @return  A zyan status code.
+ *
+ * The caller has to hold the trampoline lock.
+ */
+static ZyanStatus ZyrexTrampolineChunkReserve(const ZyrexTrampolineAnalysis* analysis,
+    ZyrexTrampolineChunk** trampoline)
+{
+    ZYAN_ASSERT(analysis);
+    ZYAN_ASSERT(trampoline);
+
+    if (!g_trampoline_data.is_initialized)
+    {
+        ZYAN_CHECK(ZyanVectorInit(&g_trampoline_data.regions, sizeof(ZyrexTrampolineRegion*), 8, 
+            ZYAN_NULL));
+
+        // The callback table occupies the trailing pages of the region
+        const ZyanUSize page_size = ZyanMemoryGetSystemPageSize();
+        const ZyanUSize region_size =
+            ZYAN_MAX(ZyanMemoryGetSystemAllocationGranularity(), 2 * page_size);
+        const ZyanUSize chunk_count = region_size /
+            (sizeof(ZyrexTrampolineChunk) + sizeof(ZyrexTrampolineCallback));
+        const ZyanUSize table_offset = ZYAN_ALIGN_DOWN(
+            region_size - chunk_count * sizeof(ZyrexTrampolineCallback), page_size);
+
+        g_trampoline_data.region_size = region_size;
+        g_trampoline_data.chunks_per_region = table_offset / sizeof(ZyrexTrampolineChunk);
+        g_trampoline_data.callback_table_offset = table_offset;
+
+        g_trampoline_data.is_initialized = ZYAN_TRUE;
+    }
+
+    const ZyanUPointer lo = analysis->address_lo;
+    const ZyanUPointer hi = analysis->address_hi;
+
+    ZyanBool is_new_region = ZYAN_FALSE;
+    ZyrexTrampolineRegion* region = g_trampoline_data.last_region;
+    ZyrexTrampolineChunk* chunk;
+    ZyanStatus status = ZYAN_STATUS_TRUE;
+    if (!region || !ZyrexTrampolineRegionFindChunkInRegion(region, lo, hi, &chunk))
+    {
+        status = ZyrexTrampolineRegionFindChunk(lo, hi, &region, &chunk);
+        ZYAN_CHECK(status);
+    }
+
+    switch (status)
+    {
+    case ZYAN_STATUS_TRUE:
+    {
+        ZYAN_ASSERT(region);
+        ZYAN_ASSERT(chunk);
+        ZYAN_CHECK(ZyrexTrampolineRegionUnprotect(region));
+        break;
+    }
+    case ZYAN_STATUS_FALSE:
+    {
+        ZYAN_CHECK(ZyrexTrampolineRegionAllocate(lo, hi, &region));
+        is_new_region = ZyrexTrampolineRegionFindChunkInRegion(region, lo, hi, &chunk);
+        ZYAN_ASSERT(is_new_region);
+        ZYAN_ASSERT(region);
+        ZYAN_ASSERT(chunk);
+        break;
+    }
+    default:
+        ZYAN_UNREACHABLE;
+    }
+
+    ZYAN_ASSERT(region->header.number_of_unused_chunks > 0);
+
+    chunk->is_used = ZYAN_TRUE;
+    --region->header.number_of_unused_chunks;
+    ZYAN_UNUSED(ZyrexTrampolineRegionProtect(region));
+
+    if (is_new_region)
+    {
+        ZYAN_UNUSED(ZyrexTrampolineRegionInsert(region));
+    }
+    g_trampoline_data.last_region = region;
+
+    *trampoline = chunk;
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Copies the given private `buffer` to the actual trampoline chunk.
+ *
+ * @param   trampoline  A pointer to the trampoline chunk.
+ * @param   buffer      A pointer to the private buffer.
+ *
+ * @return  A zyan status code.
+ *
+ * The caller has to hold the trampoline lock.
+ */
+static ZyanStatus ZyrexTrampolineChunkPublish(ZyrexTrampolineChunk* trampoline,
+    const ZyrexTrampolineChunk* buffer)
+{
+    ZYAN_ASSERT(trampoline);
+    ZYAN_ASSERT(buffer);
+
+    if (!g_trampoline_data.is_initialized)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    ZyrexTrampolineRegion* const region = (ZyrexTrampolineRegion*)ZYAN_ALIGN_DOWN(
+        (ZyanUPointer)trampoline, g_trampoline_data.region_size);
+
+    if (ZyrexCodeWriterGetBackend() == ZYREX_CODE_WRITER_BACKEND_PROCESS_MEMORY)
+    {
+        ZYAN_CHECK(ZyrexWriteCode(trampoline, buffer, sizeof(ZyrexTrampolineChunk)));
+    }
+    else
+    {
+        ZYAN_CHECK(ZyrexTrampolineRegionUnprotect(region));
+        ZYAN_MEMCPY(trampoline, buffer, sizeof(ZyrexTrampolineChunk));
+        ZYAN_UNUSED(ZyrexTrampolineRegionProtect(region));
+    }
+
+    return ZyanProcessFlushInstructionCache(trampoline, sizeof(ZyrexTrampolineChunk));
 }
 
 /**
- * @brief   Frees the memory of the given trampoline region.
+ * @brief   Releases the given trampoline chunk.
  *
- * @param   region  A pointer to the `ZyrexTrampolineRegion` struct.
+ * @param   trampoline  A pointer to the trampoline chunk.
  *
  * @return  A zyan status code.
+ *
+ * The caller has to hold the trampoline lock. The region of the chunk is never unmapped, even if
+ * this was its last chunk in use.
  */
-static ZyanStatus ZyrexTrampolineRegionFree(ZyrexTrampolineRegion* region)
+static ZyanStatus ZyrexTrampolineChunkFree(ZyrexTrampolineChunk* trampoline)
 {
-    ZYAN_ASSERT(region);
-    ZYAN_ASSERT(g_trampoline_data.is_initialized);
-    ZYAN_ASSERT(ZYAN_IS_ALIGNED_TO((ZyanUPointer)region, g_trampoline_data.region_size));
+    ZYAN_ASSERT(trampoline);
 
-    return ZyanMemoryVirtualFree(region, g_trampoline_data.region_size);
-}
+    if (!g_trampoline_data.is_initialized)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
 
-/* ---------------------------------------------------------------------------------------------- */
-/* Trampoline chunk                                                                               */
-/* ---------------------------------------------------------------------------------------------- */
+    const ZyanUPointer region_address = ZYAN_ALIGN_DOWN((ZyanUPointer)trampoline, 
+        g_trampoline_data.region_size);
+    ZyanUSize found_index;
+    const ZyanStatus status =
+        ZyanVectorBinarySearch(&g_trampoline_data.regions, &region_address, &found_index, 
+            (ZyanComparison)&ZyanComparePointer);
+    ZYAN_CHECK(status);
+
+    if (status == ZYAN_STATUS_FALSE)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    // The stack check only covers the hooked functions, so a thread might still execute the
+    // trampoline. Unmapping the region would crash such a thread
+    ZyrexTrampolineRegion* const region = (ZyrexTrampolineRegion*)region_address;
+    ZYAN_CHECK(ZyrexTrampolineRegionUnprotect(region));
+    ++region->header.number_of_unused_chunks;
+    trampoline->is_used = ZYAN_FALSE;
+
+    return ZyrexTrampolineRegionProtect(region);
+}
 
 /**
- * @brief   Initializes a new trampoline chunk and relocates the instructions from the original
- *          function.
+ * @brief   Searches the trampoline chunk that contains the given `original` code buffer.
  *
- * @param   chunk               A pointer to the `ZyrexTrampolineChunk` struct.
- * @param   address             The address of the function to create the trampoline for.
- * @param   callback            The address of the callback function the hook will redirect to.
- * @param   min_bytes_to_reloc  Specifies the minimum amount of  bytes that need to be relocated
- *                              to the trampoline (usually equals the size of the branch
- *                              instruction used for hooking).
- *                              This function might copy more bytes on demand to keep individual
- *                              instructions intact.
- * @param   max_bytes_to_read   The maximum amount of bytes that can be safely read from the given
- *                              `address`.
+ * @param   original    The address of the code buffer.
+ * @param   trampoline  Receives a pointer to the trampoline chunk, if found.
  *
- * @return  A zyan status code.
+ * @return  `ZYAN_STATUS_TRUE`, if the chunk was found, `ZYAN_STATUS_FALSE`, if not, or a generic
+ *          zyan status code.
+ *
+ * The caller has to hold the trampoline lock.
  */
-static ZyanStatus ZyrexTrampolineChunkInit(ZyrexTrampolineChunk* chunk, const void* address,
-    const void* callback, ZyanUSize min_bytes_to_reloc, ZyanUSize max_bytes_to_read)
+static ZyanStatus ZyrexTrampolineChunkFind(const void* original, ZyrexTrampolineChunk** trampoline)
 {
-    ZYAN_ASSERT(chunk);
-    ZYAN_ASSERT(address);
-    ZYAN_ASSERT(callback);
-    ZYAN_ASSERT(min_bytes_to_reloc <= max_bytes_to_read);
+    ZYAN_ASSERT(original);
+    ZYAN_ASSERT(trampoline);
 
-    chunk->is_used = ZYAN_TRUE;
-    chunk->callback_address = (ZyanUPointer)callback;
+    if (!g_trampoline_data.is_initialized)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
 
-#if defined(ZYAN_X64)
-    
-    ZyrexWriteAbsoluteJump(&chunk->callback_jump, (ZyanUPointer)&chunk->callback_address);
-    ZYAN_CHECK(ZyanProcessFlushInstructionCache(&chunk->callback_jump, 
-        ZYREX_SIZEOF_ABSOLUTE_JUMP));
+    const ZyanUPointer region_address = ZYAN_ALIGN_DOWN((ZyanUPointer)original, 
+        g_trampoline_data.region_size);
 
-#endif
+    ZyanUSize found_index;
+    const ZyanStatus status = 
+        ZyanVectorBinarySearch(&g_trampoline_data.regions, &region_address, &found_index, 
+            (ZyanComparison)&ZyanComparePointer);
+    ZYAN_CHECK(status);
+    
+    if (status == ZYAN_STATUS_FALSE)
+    {
+        return ZYAN_STATUS_FALSE;
+    }
 
-    ZyanUSize bytes_read;
-    ZyanUSize bytes_written;
+    ZyrexTrampolineRegion** const element = 
+        ZyanVectorGetMutable(&g_trampoline_data.regions, found_index);
+    ZYAN_ASSERT(element && *element);
 
-    // Relocate instructions
-    ZYAN_CHECK(ZyrexRelocateCode(address, max_bytes_to_read, chunk, min_bytes_to_reloc, 
-        &bytes_read, &bytes_written));
+    ZyrexTrampolineRegion* const region = *element;
+    ZYAN_ASSERT(region->header.signature == ZYREX_TRAMPOLINE_REGION_SIGNATURE);
 
-    ZYAN_ASSERT(bytes_read <= ZYAN_ARRAY_LENGTH(chunk->original_code));
-    ZYAN_ASSERT(bytes_written <= ZYAN_ARRAY_LENGTH(chunk->code_buffer));
+    for (ZyanUSize i = 1; i < g_trampoline_data.chunks_per_region; ++i)
+    {
+        ZyrexTrampolineChunk* const chunk = &region->chunks[i];
+        ZYAN_ASSERT(chunk);
 
-    // Write backjump
-    ZyrexWriteAbsoluteJump(&chunk->code_buffer[bytes_written],
-        (ZyanUPointer)&chunk->backjump_address);
-    chunk->code_buffer_size = (ZyanU8)bytes_written;
-    chunk->backjump_address = (ZyanUPointer)address + bytes_read;
+        if (!chunk->is_used)
+        {
+            continue;
+        }
 
-    // Fill remaining space with `INT 3` instructions
-    const ZyanUSize bytes_remaining = sizeof(chunk->code_buffer) - bytes_written;
-    if (bytes_remaining > 0)
-    {
-        ZYAN_MEMSET(&chunk->code_buffer[bytes_written + ZYREX_SIZEOF_ABSOLUTE_JUMP], 0xCC,
-            bytes_remaining - ZYREX_SIZEOF_ABSOLUTE_JUMP);
+        if ((ZyanUPointer)&chunk->code_buffer == (ZyanUPointer)original)
+        {
+            *trampoline = chunk;
+            return ZYAN_STATUS_TRUE;
+        }
     }
 
-    ZYAN_CHECK(ZyanProcessFlushInstructionCache(&chunk->code_buffer, 
-        ZYREX_TRAMPOLINE_MAX_CODE_SIZE_WITH_BACKJUMP + ZYREX_TRAMPOLINE_MAX_CODE_SIZE_BONUS));
+    return ZYAN_STATUS_FALSE;
+}
 
-    // Backup original instructions 
-    chunk->original_code_size = (ZyanU8)bytes_read;
-    ZYAN_MEMCPY(chunk->original_code, address, bytes_read);
+/**
+ * @brief   Atomically updates the callback address of the given trampoline chunk.
+ *
+ * @param   trampoline              A pointer to the trampoline chunk.
+ * @param   callback_address        The new address the callback jump redirects to.
+ * @param   user_callback_address   The new address of the user callback function.
+ *
+ * The callback data lives in the writable callback table, so no memory protection has to be
+ * changed. The caller has to hold the trampoline lock.
+ */
+static void ZyrexTrampolineChunkSetCallbackAddress(ZyrexTrampolineChunk* trampoline,
+    ZyanUPointer callback_address, ZyanUPointer user_callback_address)
+{
+    ZYAN_ASSERT(trampoline);
+    ZYAN_ASSERT(trampoline->callback);
 
-    return ZYAN_STATUS_SUCCESS;
+    trampoline->callback->user_callback_address = user_callback_address;
+    ZyrexAtomicStore(&trampoline->callback->callback_address, callback_address);
 }
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -756,7 +1880,39 @@ static ZyanStatus ZyrexTrampolineChunkInit(ZyrexTrampolineChunk* chunk, const vo
 ZyanStatus ZyrexTrampolineCreate(const void* address, const void* callback,
     ZyanUSize min_bytes_to_reloc, ZyrexTrampolineChunk** trampoline)
 {
-    if (!address || !callback || (min_bytes_to_reloc < 1) || !trampoline)
+    if (!address || !callback || (min_bytes_to_reloc < 1) || 
+        (min_bytes_to_reloc > ZYREX_MAX_PATCH_SIZE) || !trampoline)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyrexTrampolineAnalysis analysis;
+    ZYAN_CHECK(ZyrexTrampolineAnalyze(address, min_bytes_to_reloc, &analysis));
+
+    ZyrexTrampolineChunk* chunk;
+    ZYAN_CHECK(ZyrexTrampolineReserve(&analysis, &chunk));
+
+    ZyrexTrampolineChunk buffer;
+    ZyanStatus status = ZyrexTrampolineInit(&buffer, chunk, &analysis, callback);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexTrampolinePublish(chunk, &buffer);
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZYAN_UNUSED(ZyrexTrampolineFree(chunk));
+        return status;
+    }
+
+    *trampoline = chunk;
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexTrampolineAnalyze(const void* address, ZyanUSize min_bytes_to_reloc,
+    ZyrexTrampolineAnalysis* analysis)
+{
+    if (!address || (min_bytes_to_reloc < 1) || (min_bytes_to_reloc > ZYREX_MAX_PATCH_SIZE) || 
+        !analysis)
     {
         return ZYAN_STATUS_INVALID_ARGUMENT;
     }
@@ -771,18 +1927,45 @@ ZyanStatus ZyrexTrampolineCreate(const void* address, const void* callback,
     }
 #endif
 
-    if (!g_trampoline_data.is_initialized)
-    {
-        ZYAN_CHECK(ZyanVectorInit(&g_trampoline_data.regions, sizeof(ZyrexTrampolineRegion*), 8, 
-            ZYAN_NULL));
+    analysis->address            = address;
+    analysis->source_size        = source_size;
+    analysis->min_bytes_to_reloc = min_bytes_to_reloc;
+    analysis->patch_site_type    = ZYREX_PATCH_SITE_TYPE_DEFAULT;
+    analysis->patch_address      = address;
+    analysis->patch_size         = 0;
+    analysis->profiling_call_target = 0;
 
-        g_trampoline_data.region_size = ZyanMemoryGetSystemAllocationGranularity();
-        g_trampoline_data.chunks_per_region =
-            g_trampoline_data.region_size / sizeof(ZyrexTrampolineChunk);
+    // Patch sites that do not require relocation only need the trampoline chunk to be in range
+    // of the patch address
+    const ZyanStatus status = 
+        ZyrexFindPatchSite(address, source_size, min_bytes_to_reloc, analysis);
+    ZYAN_CHECK(status);
+    if (status == ZYAN_STATUS_TRUE)
+    {
+        // Only the hook jump (and the short jump at the function entry) is written
+        const ZyanUSize patch_size = 
+            (analysis->patch_site_type == ZYREX_PATCH_SITE_TYPE_NOP_PADDING)
+                ? analysis->patch_size
+                : min_bytes_to_reloc;
+        ZYAN_CHECK(ZyrexFunctionIndexValidatePatchWindow(address, analysis->patch_address, 
+            patch_size));
+
+        analysis->address_lo = (ZyanUPointer)analysis->patch_address;
+        analysis->address_hi = (ZyanUPointer)analysis->patch_address;
+
+        // The trampoline jumps to a preserved profiling function using a relative offset
+        const ZyanUPointer target = analysis->profiling_call_target;
+        if (target)
+        {
+            analysis->address_lo = ZYAN_MIN(analysis->address_lo, target);
+            analysis->address_hi = ZYAN_MAX(analysis->address_hi, target);
+        }
 
-        g_trampoline_data.is_initialized = ZYAN_TRUE;
+        return ZYAN_STATUS_SUCCESS;
     }
 
+    ZYAN_CHECK(ZyrexFunctionIndexValidatePatchWindow(address, address, min_bytes_to_reloc));
+
 #ifdef ZYAN_X64
 
     // Gather memory address lower and upper bounds in order to find a suitable memory region for
@@ -790,16 +1973,22 @@ ZyanStatus ZyrexTrampolineCreate(const void* address, const void* callback,
     ZyanUPointer lo = (ZyanUPointer)(-1);
     ZyanUPointer hi = 0;
     ZYAN_CHECK(ZyrexGetAddressRangeOfRelativeInstructions(address, source_size,
-        ZYREX_SIZEOF_RELATIVE_JUMP, &lo, &hi));
+        min_bytes_to_reloc, &lo, &hi));
 
+    // The absolute hook jump does not need to reach the trampoline chunk, but the target
+    // address is still used as a hint for the trampoline placement, if the relocated code does
+    // not contain any relative instructions
     const ZyanUPointer address_value = (ZyanUPointer)address;
-    if (address_value < lo)
-    {
-        lo = address_value;
-    }
-    if (address_value > hi)
+    if ((min_bytes_to_reloc < ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP) || (lo > hi))
     {
-        hi = address_value;
+        if (address_value < lo)
+        {
+            lo = address_value;
+        }
+        if (address_value > hi)
+        {
+            hi = address_value;
+        }
     }
 
     if ((hi - lo) > ZYREX_RANGEOF_RELATIVE_JUMP)
@@ -814,59 +2003,52 @@ ZyanStatus ZyrexTrampolineCreate(const void* address, const void* callback,
 
 #endif
 
-    ZyanBool is_new_region = ZYAN_FALSE;
-    ZyrexTrampolineRegion* region;
-    ZyrexTrampolineChunk* chunk;
-    ZyanStatus status = ZyrexTrampolineRegionFindChunk(lo, hi, &region, &chunk);
-    ZYAN_CHECK(status);
+    analysis->address_lo = lo;
+    analysis->address_hi = hi;
 
-    switch (status)
-    {
-    case ZYAN_STATUS_TRUE:
-    {
-        ZYAN_ASSERT(region);
-        ZYAN_ASSERT(chunk);
-        ZYAN_CHECK(ZyrexTrampolineRegionUnprotect(region));
-        break;
-    }
-    case ZYAN_STATUS_FALSE:
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexTrampolineReserve(const ZyrexTrampolineAnalysis* analysis,
+    ZyrexTrampolineChunk** trampoline)
+{
+    if (!analysis || !trampoline)
     {
-        ZYAN_CHECK(ZyrexTrampolineRegionAllocate(lo, hi, &region));
-        is_new_region = ZyrexTrampolineRegionFindChunkInRegion(region, lo, hi, &chunk);
-        ZYAN_ASSERT(is_new_region);
-        ZYAN_ASSERT(region);
-        ZYAN_ASSERT(chunk);
-        break;
-    }
-    default:
-        ZYAN_UNREACHABLE;
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    ZYAN_ASSERT(region->header.number_of_unused_chunks > 0);
+    ZyrexSpinLockAcquire(&g_trampoline_data.lock);
+    const ZyanStatus status = ZyrexTrampolineChunkReserve(analysis, trampoline);
+    ZyrexSpinLockRelease(&g_trampoline_data.lock);
 
-    status = ZyrexTrampolineChunkInit(chunk, address, callback, min_bytes_to_reloc, source_size);
-    if (!ZYAN_SUCCESS(status))
+    return status;
+}
+
+ZyanStatus ZyrexTrampolineInit(ZyrexTrampolineChunk* buffer,
+    const ZyrexTrampolineChunk* trampoline, const ZyrexTrampolineAnalysis* analysis,
+    const void* callback)
+{
+    if (!buffer || !trampoline || !analysis || !callback)
     {
-        if (is_new_region)
-        {
-            ZYAN_UNUSED(ZyrexTrampolineRegionFree(region));
-        } else
-        {
-            ZYAN_UNUSED(ZyrexTrampolineRegionProtect(region));
-        }
-        return status;
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    --region->header.number_of_unused_chunks;
-    ZYAN_UNUSED(ZyrexTrampolineRegionProtect(region));
+    return ZyrexTrampolineChunkInit(buffer, trampoline, analysis, callback);
+}
 
-    if (is_new_region)
+ZyanStatus ZyrexTrampolinePublish(ZyrexTrampolineChunk* trampoline,
+    const ZyrexTrampolineChunk* buffer)
+{
+    if (!trampoline || !buffer)
     {
-        ZYAN_UNUSED(ZyrexTrampolineRegionInsert(region));
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    *trampoline = chunk;
-    return ZYAN_STATUS_SUCCESS;
+    ZyrexSpinLockAcquire(&g_trampoline_data.lock);
+    const ZyanStatus status = ZyrexTrampolineChunkPublish(trampoline, buffer);
+    ZyrexSpinLockRelease(&g_trampoline_data.lock);
+
+    return status;
 }
 
 ZyanStatus ZyrexTrampolineFree(ZyrexTrampolineChunk* trampoline)
@@ -875,46 +2057,55 @@ ZyanStatus ZyrexTrampolineFree(ZyrexTrampolineChunk* trampoline)
     {
         return ZYAN_STATUS_INVALID_ARGUMENT;
     }
-    if (!g_trampoline_data.is_initialized)
-    {
-        return ZYAN_STATUS_INVALID_OPERATION;
-    }
 
-    const ZyanUPointer region_address = ZYAN_ALIGN_DOWN((ZyanUPointer)trampoline, 
-        g_trampoline_data.region_size);
-    ZyanUSize found_index;
-    const ZyanStatus status =
-        ZyanVectorBinarySearch(&g_trampoline_data.regions, &region_address, &found_index, 
-            (ZyanComparison)&ZyanComparePointer);
-    ZYAN_CHECK(status);
+    ZyrexSpinLockAcquire(&g_trampoline_data.lock);
+    const ZyanStatus status = ZyrexTrampolineChunkFree(trampoline);
+    ZyrexSpinLockRelease(&g_trampoline_data.lock);
 
-    if (status == ZYAN_STATUS_FALSE)
+    return status;
+}
+
+ZyanStatus ZyrexTrampolineSetCallback(ZyrexTrampolineChunk* trampoline, const void* callback)
+{
+    if (!trampoline || !callback)
     {
-        return ZYAN_STATUS_NOT_FOUND;
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    ZyrexTrampolineRegion* const region = (ZyrexTrampolineRegion*)region_address;
-    if (region->header.number_of_unused_chunks == g_trampoline_data.chunks_per_region - 1 - 1)
+    if (trampoline->callback->is_direct)
     {
-        ZYAN_CHECK(ZyrexTrampolineRegionRemove(region));
-        ZYAN_CHECK(ZyrexTrampolineRegionFree(region));
+        return ZYAN_STATUS_INVALID_OPERATION;
     }
-    else
+
+    // The lock keeps the enabled state and the user callback consistent with each other
+    ZyrexSpinLockAcquire(&g_trampoline_data.lock);
+    const ZyanUPointer callback_address = trampoline->callback->callback_address;
+    const ZyanBool is_enabled = (callback_address != (ZyanUPointer)&trampoline->code_buffer);
+    ZyrexTrampolineChunkSetCallbackAddress(trampoline,
+        is_enabled ? (ZyanUPointer)callback : callback_address, (ZyanUPointer)callback);
+    ZyrexSpinLockRelease(&g_trampoline_data.lock);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexTrampolineSetEnabled(ZyrexTrampolineChunk* trampoline, ZyanBool enable)
+{
+    if (!trampoline)
     {
-        ZYAN_CHECK(ZyrexTrampolineRegionUnprotect(region));
-        ++region->header.number_of_unused_chunks;
-        trampoline->is_used = ZYAN_FALSE;
-        ZYAN_CHECK(ZyrexTrampolineRegionProtect(region));
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
-
-    ZyanUSize size;
-    ZYAN_CHECK(ZyanVectorGetSize(&g_trampoline_data.regions, &size));
-    if (size == 0)
+    if (trampoline->callback->is_direct)
     {
-        ZYAN_CHECK(ZyanVectorDestroy(&g_trampoline_data.regions));
-        g_trampoline_data.is_initialized = ZYAN_FALSE;
+        return ZYAN_STATUS_INVALID_OPERATION;
     }
 
+    ZyrexSpinLockAcquire(&g_trampoline_data.lock);
+    const ZyanUPointer user_callback_address = trampoline->callback->user_callback_address;
+    ZyrexTrampolineChunkSetCallbackAddress(trampoline,
+        enable ? user_callback_address : (ZyanUPointer)&trampoline->code_buffer,
+        user_callback_address);
+    ZyrexSpinLockRelease(&g_trampoline_data.lock);
+
     return ZYAN_STATUS_SUCCESS;
 }
 
@@ -928,50 +2119,12 @@ ZyanStatus ZyrexTrampolineFind(const void* original, ZyrexTrampolineChunk** tram
     {
         return ZYAN_STATUS_INVALID_ARGUMENT;
     }
-    if (!g_trampoline_data.is_initialized)
-    {
-        return ZYAN_STATUS_INVALID_OPERATION;
-    }
-
-    const ZyanUPointer region_address = ZYAN_ALIGN_DOWN((ZyanUPointer)original, 
-        g_trampoline_data.region_size);
-
-    ZyanUSize found_index;
-    const ZyanStatus status = 
-        ZyanVectorBinarySearch(&g_trampoline_data.regions, &region_address, &found_index, 
-            (ZyanComparison)&ZyanComparePointer);
-    ZYAN_CHECK(status);
-    
-    if (status == ZYAN_STATUS_FALSE)
-    {
-        return ZYAN_STATUS_FALSE;
-    }
-
-    ZyrexTrampolineRegion** const element = 
-        ZyanVectorGetMutable(&g_trampoline_data.regions, found_index);
-    ZYAN_ASSERT(element && *element);
-
-    ZyrexTrampolineRegion* const region = *element;
-    ZYAN_ASSERT(region->header.signature == ZYREX_TRAMPOLINE_REGION_SIGNATURE);
-
-    for (ZyanUSize i = 1; i < g_trampoline_data.chunks_per_region; ++i)
-    {
-        ZyrexTrampolineChunk* const chunk = &region->chunks[i];
-        ZYAN_ASSERT(chunk);
-
-        if (!chunk->is_used)
-        {
-            continue;
-        }
 
-        if ((ZyanUPointer)&chunk->code_buffer == (ZyanUPointer)original)
-        {
-            *trampoline = chunk;
-            return ZYAN_STATUS_TRUE;
-        }
-    }
+    ZyrexSpinLockAcquire(&g_trampoline_data.lock);
+    const ZyanStatus status = ZyrexTrampolineChunkFind(original, trampoline);
+    ZyrexSpinLockRelease(&g_trampoline_data.lock);
 
-    return ZYAN_STATUS_FALSE;
+    return status;
 }
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -24,6 +24,10 @@
 
 ***************************************************************************************************/
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#   define _GNU_SOURCE
+#endif
+
 #include <stdlib.h>
 #include <stdint.h>
 #include <Zycore/LibC.h>
@@ -33,14 +37,40 @@
 #include <Zycore/API/Memory.h>
 #include <Zycore/API/Process.h>
 #include <Zyrex/Transaction.h>
+#include <Zyrex/Internal/CodeWriter.h>
+#include <Zyrex/Internal/FunctionIndex.h>
+#include <Zyrex/Internal/HookRegistry.h>
 #include <Zyrex/Internal/InlineHook.h>
+#include <Zyrex/Internal/Parallel.h>
+#include <Zyrex/Internal/StackCheck.h>
+#include <Zyrex/Internal/ThreadRegistry.h>
+#include <Zyrex/Internal/ThreadSuspension.h>
 #include <Zyrex/Internal/Trampoline.h>
+#include <Zyrex/Internal/Transaction.h>
 
-#ifdef ZYAN_WINDOWS
+#if defined(ZYAN_WINDOWS)
 #   include <Windows.h>
 #   include <TlHelp32.h>
+#elif defined(ZYAN_POSIX)
+#   include <pthread.h>
+#   include <time.h>
 #endif
 
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of thread-update list entries that are reserved for threads that are
+ *          created after the threads were counted.
+ */
+#define ZYREX_THREAD_LIST_HEADROOM      16
+
+/**
+ * @brief   The maximum number of pages that are patched by a single operation.
+ */
+#define ZYREX_MAX_PAGES_PER_OPERATION   2
+
 /* ============================================================================================== */
 /* Enums and types                                                                                */
 /* ============================================================================================== */
@@ -60,6 +90,34 @@ typedef enum ZyrexOperationAction_
      ZYREX_OPERATION_ACTION_REMOVE
 } ZyrexOperationAction;
 
+/**
+ * @brief   Defines the `ZyrexReplacementHook` struct.
+ */
+struct ZyrexReplacementHook_
+{
+    /**
+     * @brief   The address of the replaced function.
+     */
+    void* address;
+    /**
+     * @brief   The address of the replacement function.
+     */
+    const void* replacement;
+    /**
+     * @brief   The number of bytes that are overwritten by the jump to the replacement function.
+     */
+    ZyanU8 patch_size;
+    /**
+     * @brief   Signals, if the first instruction of the replaced function covers all of the
+     *          overwritten bytes.
+     */
+    ZyanBool is_single_instruction;
+    /**
+     * @brief   The original bytes of the replaced function.
+     */
+    ZyanU8 original_code[ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP];
+};
+
 /**
  * @brief   Defines the `ZyrexOperation` struct.
  */
@@ -81,6 +139,29 @@ typedef struct ZyrexOperation_
      * @brief   The trampoline chunk.
      */
     ZyrexTrampolineChunk* trampoline;
+    /**
+     * @brief   The branch target that is written by a call-site operation.
+     */
+    const void* target;
+    /**
+     * @brief   The branch target the call site is expected to have before a call-site operation
+     *          is applied.
+     */
+    const void* expected_target;
+    /**
+     * @brief   The metadata of a replacement hook.
+     */
+    ZyrexReplacementHook* replacement;
+    /**
+     * @brief   The start address of the code that is retired by the operation.
+     *
+     * The range is empty, if the stack check was disabled when the operation was added.
+     */
+    ZyanUPointer retired_begin;
+    /**
+     * @brief   The end address of the code that is retired by the operation (exclusive).
+     */
+    ZyanUPointer retired_end;
     /**
      * @brief   This value points to the memory that is passed by the user to store the trampoline
      *          pointer.
@@ -88,6 +169,83 @@ typedef struct ZyrexOperation_
     //ZyanConstVoidPointer* trampoline_accessor;
 } ZyrexOperation;
 
+/**
+ * @brief   Defines the `ZyrexBatchItem` struct.
+ *
+ * Holds the intermediate state of a single hook during batch installation.
+ */
+typedef struct ZyrexBatchItem_
+{
+    /**
+     * @brief   The status of the current hook.
+     */
+    ZyanStatus status;
+    /**
+     * @brief   The result of the prologue analysis.
+     */
+    ZyrexTrampolineAnalysis analysis;
+    /**
+     * @brief   The reserved trampoline chunk.
+     */
+    ZyrexTrampolineChunk* trampoline;
+    /**
+     * @brief   The private buffer that receives the trampoline data before it is published to
+     *          the actual trampoline chunk.
+     */
+    ZyrexTrampolineChunk buffer;
+} ZyrexBatchItem;
+
+/**
+ * @brief   Defines the `ZyrexBatchOrderItem` struct.
+ *
+ * Maps the position of a hook in the address-sorted batch to its index in the `specs` array.
+ */
+typedef struct ZyrexBatchOrderItem_
+{
+    /**
+     * @brief   The address of the target function.
+     */
+    ZyanUPointer address;
+    /**
+     * @brief   The index of the hook in the `specs` array.
+     */
+    ZyanUSize index;
+} ZyrexBatchOrderItem;
+
+/**
+ * @brief   Defines the `ZyrexBatchContext` struct.
+ */
+typedef struct ZyrexBatchContext_
+{
+    /**
+     * @brief   The hook specifications.
+     */
+    const ZyrexHookSpec* specs;
+    /**
+     * @brief   The batch items.
+     */
+    ZyrexBatchItem* items;
+} ZyrexBatchContext;
+
+/**
+ * @brief   Defines the `ZyrexTransaction` struct.
+ */
+struct ZyrexTransaction_
+{
+    /**
+     * @brief   A list with all pending operations.
+     */
+    ZyanVector/*<ZyrexOperation>*/ pending_operations;
+    /**
+     * @brief   A list with the native ids of all threads to update.
+     */
+    ZyanVector/*<ZyanThreadId>*/ thread_ids;
+    /**
+     * @brief   Signals, if all threads should be updated.
+     */
+    ZyanBool update_all_threads;
+};
+
 /* ============================================================================================== */
 /* Globals                                                                                        */
 /* ============================================================================================== */
@@ -98,28 +256,127 @@ typedef struct ZyrexOperation_
 static struct
 {
     /**
-     * @brief   The id of the thread that started the current transaction.
+     * @brief   The lock that serializes the patch phase of all transactions.
+     *
+     * The patch phase begins with the suspension of the first thread and ends after all threads
+     * were resumed. Transactions can be prepared concurrently outside of the patch phase.
+     *
+     * The lock is held across thread suspension and stack-check delays, so waiting threads block
+     * instead of spinning.
+     */
+#if defined(ZYAN_WINDOWS)
+    SRWLOCK patch_lock;
+#else
+    pthread_mutex_t patch_lock;
+#endif
+    /**
+     * @brief   The id of the thread that started the global transaction or `0`, if no global
+     *          transaction is active.
      */
-    volatile ZyanThreadId transaction_thread_id;
+    volatile ZyanUPointer transaction_thread_id;
     /**
-     * @brief   A list with all pending operations.
+     * @brief   The global transaction that is used by `ZyrexTransactionBegin`.
      */
-    ZyanVector/*<ZyrexOperation>*/ pending_operations;
+    ZyrexTransaction transaction;
+    /**
+     * @brief   Signals, if the global transaction holds the patch lock.
+     */
+    ZyanBool is_patching;
+    /**
+     * @brief   The mode that is used to write hook jumps.
+     */
+    ZyrexPatchMode patch_mode;
+    /**
+     * @brief   The maximum time threads are kept suspended at once (in nanoseconds) or `0`, if
+     *          transactions are committed without interruption.
+     */
+    ZyanU64 pause_budget;
+    /**
+     * @brief   Signals, if the stacks of all suspended threads are checked before code is
+     *          retired.
+     */
+    ZyanBool is_stack_check_enabled;
+    /**
+     * @brief   The number of times the stack check is repeated, before a commit fails.
+     */
+    ZyanU32 stack_check_retries;
+    /**
+     * @brief   The time threads are resumed for between two stack checks (in milliseconds).
+     */
+    ZyanU32 stack_check_delay;
 
-#ifdef ZYAN_WINDOWS
+#if defined(ZYAN_WINDOWS)
 
     /**
      * @brief   A list with all threads to update.
      */
     ZyanVector/*<HANDLE>*/ threads_to_update;
 
+#elif defined(ZYAN_LINUX)
+
+    /**
+     * @brief   A list with all threads to update.
+     */
+    ZyanVector/*<ZyrexSuspendedThread>*/ threads_to_update;
+
+#endif
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
+
+    /**
+     * @brief   The memory that backs the thread-update list.
+     */
+    void* thread_buffer;
+
 #endif
+    /**
+     * @brief   The merged page ranges of the operations that are currently committed.
+     */
+    ZyanVector/*<ZyrexProtectedRegion>*/ ranges;
+    /**
+     * @brief   The original protection of the pages of the operations that are currently
+     *          committed.
+     */
+    ZyanVector/*<ZyrexProtectedRegion>*/ regions;
+    /**
+     * @brief   The memory that backs `ranges` and `regions`.
+     */
+    void* region_buffer;
+    /**
+     * @brief   The time at which the first thread of the current patch phase was suspended or
+     *          `0`, if no thread was suspended yet.
+     */
+    ZyanU64 pause_begin;
+    /**
+     * @brief   Signals, if the thread registry is held by the current patch phase.
+     */
+    ZyanBool is_registry_acquired;
+    /**
+     * @brief   Signals, if threads were added to any transaction of the current patch phase.
+     */
+    ZyanBool has_thread_updates;
+    /**
+     * @brief   The statistics of the current patch phase.
+     */
+    ZyrexTransactionStatistics phase_statistics;
+    /**
+     * @brief   The statistics of the last committed or aborted transaction.
+     */
+    ZyrexTransactionStatistics statistics;
 } g_transaction_data =
 {
-    0, ZYAN_VECTOR_INITIALIZER,
-#ifdef ZYAN_WINDOWS
-    ZYAN_VECTOR_INITIALIZER
+#if defined(ZYAN_WINDOWS)
+    SRWLOCK_INIT,
+#else
+    PTHREAD_MUTEX_INITIALIZER,
+#endif
+    0,
+    { ZYAN_VECTOR_INITIALIZER, ZYAN_VECTOR_INITIALIZER, ZYAN_FALSE },
+    ZYAN_FALSE, ZYREX_PATCH_MODE_SUSPEND, 0, ZYAN_FALSE, 0, 0,
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
+    ZYAN_VECTOR_INITIALIZER, ZYAN_NULL,
 #endif
+    ZYAN_VECTOR_INITIALIZER, ZYAN_VECTOR_INITIALIZER, ZYAN_NULL,
+    0, ZYAN_FALSE, ZYAN_FALSE, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }
 };
 
 /* ============================================================================================== */
@@ -147,146 +404,126 @@ static void ZyrexWindowsHandleDestroy(HANDLE* item)
 #endif
 
 /* ---------------------------------------------------------------------------------------------- */
-/* Code Patching                                                                                  */
+/* Patch lock                                                                                     */
 /* ---------------------------------------------------------------------------------------------- */
 
 /**
- * @brief   Writes the hook jump which redirects the code-flow from the given `address` to the
- *          `trampoline`.
- *
- * @param   address     The target address.
- * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ * @brief   Acquires the patch lock.
  *
- * @return  A zyan status code.
+ * The calling thread blocks while the lock is held by another thread. The lock is not recursive.
  */
-static ZyanStatus ZyrexWriteHookJump(void* address, const ZyrexTrampolineChunk* trampoline)
+static void ZyrexPatchLockAcquire(void)
 {
-    ZYAN_ASSERT(address);
-    ZYAN_ASSERT(trampoline);
-
-    ZYAN_CHECK(ZyanMemoryVirtualProtect(address, ZYREX_SIZEOF_RELATIVE_JUMP,
-        ZYAN_PAGE_EXECUTE_READWRITE));
-
-#if defined(ZYAN_X64)
-
-    ZyrexWriteRelativeJump(address, (ZyanUPointer)&trampoline->callback_jump);
-
-#elif defined(ZYAN_X86)
-
-    ZyrexWriteRelativeJump(address, (ZyanUPointer)trampoline->callback_address);
-
+#if defined(ZYAN_WINDOWS)
+    AcquireSRWLockExclusive(&g_transaction_data.patch_lock);
 #else
-#   error "Unsupported platform"
+    pthread_mutex_lock(&g_transaction_data.patch_lock);
 #endif
-
-    // TODO: Restore actual protection
-    ZYAN_CHECK(ZyanMemoryVirtualProtect(address, ZYREX_SIZEOF_RELATIVE_JUMP,
-        ZYAN_PAGE_EXECUTE_READ));
-
-    return ZyanProcessFlushInstructionCache(address, ZYREX_SIZEOF_RELATIVE_JUMP);
 }
 
 /**
- * @brief   Reads the original code instructions from the `trampoline` and restores them to the
- *          given `address`.
+ * @brief   Releases the patch lock.
  *
- * @param   address     The target address.
- * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
- *
- * @return  A zyan status code.
+ * The lock has to be released by the thread that acquired it.
  */
-static ZyanStatus ZyrexRestoreInstructions(void* address, const ZyrexTrampolineChunk* trampoline)
+static void ZyrexPatchLockRelease(void)
 {
-    ZYAN_CHECK(ZyanMemoryVirtualProtect(address, ZYREX_SIZEOF_RELATIVE_JUMP,
-        ZYAN_PAGE_EXECUTE_READWRITE));
-
-    ZYAN_MEMCPY(address, &trampoline->original_code, trampoline->original_code_size);
-
-    // TODO: Restore actual protection
-    ZYAN_CHECK(ZyanMemoryVirtualProtect(address, ZYREX_SIZEOF_RELATIVE_JUMP,
-        ZYAN_PAGE_EXECUTE_READ));
-
-    return ZyanProcessFlushInstructionCache(address, ZYREX_SIZEOF_RELATIVE_JUMP);
+#if defined(ZYAN_WINDOWS)
+    ReleaseSRWLockExclusive(&g_transaction_data.patch_lock);
+#else
+    pthread_mutex_unlock(&g_transaction_data.patch_lock);
+#endif
 }
 
 /* ---------------------------------------------------------------------------------------------- */
-
-/* ============================================================================================== */
-/* Exported functions                                                                             */
-/* ============================================================================================== */
-
-/* ---------------------------------------------------------------------------------------------- */
-/* Transaction                                                                                    */
+/* Thread suspension                                                                              */
 /* ---------------------------------------------------------------------------------------------- */
 
-ZyanStatus ZyrexTransactionBegin(void)
+/**
+ * @brief   Returns a monotonic timestamp.
+ *
+ * @return  The current value of a monotonic clock (in nanoseconds).
+ */
+static ZyanU64 ZyrexGetTimestamp(void)
 {
-    if (g_transaction_data.transaction_thread_id != 0)
-    {
-        return ZYAN_STATUS_INVALID_OPERATION;
-    }
+#if defined(ZYAN_WINDOWS)
 
-#ifdef ZYAN_WINDOWS
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
 
-    // TODO: Use platform independent APIs
-    if (InterlockedCompareExchange((volatile LONG*)&g_transaction_data.transaction_thread_id,
-        (LONG)GetCurrentThreadId(), 0) != 0)
-    {
-        return ZYAN_STATUS_INVALID_OPERATION;
-    }
+    return (ZyanU64)(counter.QuadPart / frequency.QuadPart) * 1000000000 +
+        (ZyanU64)(counter.QuadPart % frequency.QuadPart) * 1000000000 / 
+        (ZyanU64)frequency.QuadPart;
 
 #else
 
-    ZyanThreadId tid;
-    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
-    g_transaction_data.transaction_thread_id = tid;
-
-#endif
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
 
-    ZYAN_CHECK(ZyanVectorInit(&g_transaction_data.pending_operations, sizeof(ZyrexOperation),
-        16, ZYAN_NULL));
+    return (ZyanU64)time.tv_sec * 1000000000 + (ZyanU64)time.tv_nsec;
 
-#ifdef ZYAN_WINDOWS
+#endif
+}
 
-    const ZyanStatus status = ZyanVectorInit(&g_transaction_data.threads_to_update,
-        sizeof(HANDLE), 16, (ZyanMemberProcedure)&ZyrexWindowsHandleDestroy);
-    if (!ZYAN_SUCCESS(status))
+/**
+ * @brief   Marks the begin of the pause, if this is the first suspended thread of the current
+ *          patch phase.
+ */
+static void ZyrexBeginPause(void)
+{
+    if (!g_transaction_data.pause_begin)
     {
-        ZyanVectorDestroy(&g_transaction_data.pending_operations);
-        return status;
+        g_transaction_data.pause_begin = ZyrexGetTimestamp();
     }
-
-#endif
-
-    return ZYAN_STATUS_SUCCESS;
 }
 
-ZyanStatus ZyrexUpdateThread(ZyanThreadId thread_id)
+/**
+ * @brief   Counts the given thread (thread enumeration callback).
+ *
+ * @param   thread_id   The native id of the thread.
+ * @param   context     A pointer to the `ZyanUSize` counter.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexCountThreadCallback(ZyanThreadId thread_id, void* context)
 {
-    ZyanThreadId tid;
-    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
+    ZYAN_UNUSED(thread_id);
+    ZYAN_ASSERT(context);
 
-    if (g_transaction_data.transaction_thread_id != tid)
-    {
-        return ZYAN_STATUS_INVALID_OPERATION;
-    }
+    ++*(ZyanUSize*)context;
 
-#ifdef ZYAN_WINDOWS
+    return ZYAN_STATUS_SUCCESS;
+}
 
-    ZYAN_ASSERT(g_transaction_data.pending_operations.data);
-    ZYAN_ASSERT(g_transaction_data.threads_to_update.data);
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
 
-    if (thread_id == GetCurrentThreadId())
+/**
+ * @brief   Suspends the thread with the given native id and adds it to the thread-update list.
+ *
+ * @param   thread_id   The native id of the thread.
+ *
+ * @return  `ZYAN_STATUS_INSUFFICIENT_BUFFER_SIZE`, if the thread-update list is full,
+ *          `ZYAN_STATUS_NOT_FOUND`, if the thread does not exist or a zyan status code.
+ */
+static ZyanStatus ZyrexSuspendAndAddThread(ZyanThreadId thread_id)
+{
+    // The list is never grown while other threads are suspended
+    if (g_transaction_data.threads_to_update.size == g_transaction_data.threads_to_update.capacity)
     {
-        return ZYAN_STATUS_SUCCESS;
+        return ZYAN_STATUS_INSUFFICIENT_BUFFER_SIZE;
     }
 
+#if defined(ZYAN_WINDOWS)
+
     const DWORD desired_access = THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_SET_CONTEXT;
-    const HANDLE handle = OpenThread(desired_access, ZYAN_FALSE, thread_id);
+    const HANDLE handle = OpenThread(desired_access, ZYAN_FALSE, (DWORD)thread_id);
     if (handle == ZYAN_NULL)
     {
-        return ZYAN_STATUS_INVALID_ARGUMENT;
+        return ZYAN_STATUS_NOT_FOUND;
     }
+    ZyrexBeginPause();
     if (SuspendThread(handle) == (DWORD)(-1))
     {
         CloseHandle(handle);
@@ -297,69 +534,2698 @@ ZyanStatus ZyrexUpdateThread(ZyanThreadId thread_id)
 
 #else
 
-    ZYAN_UNUSED(thread_id);
-    return ZYAN_STATUS_SUCCESS;
+    ZyrexBeginPause();
+
+    ZyrexSuspendedThread thread;
+    ZYAN_CHECK(ZyrexSuspendThread(thread_id, &thread));
+
+    return ZyanVectorPushBack(&g_transaction_data.threads_to_update, &thread);
 
 #endif
 }
 
-ZyanStatus ZyrexUpdateAllThreads(void)
+/**
+ * @brief   Checks, if the thread with the given native id is in the thread-update list.
+ *
+ * @param   thread_id   The native id of the thread.
+ *
+ * @return  `ZYAN_TRUE`, if the thread is in the thread-update list or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool ZyrexIsThreadSuspended(ZyanThreadId thread_id)
 {
-    ZyanThreadId tid;
-    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
-
-    if (g_transaction_data.transaction_thread_id != tid)
+    for (ZyanUSize i = 0; i < g_transaction_data.threads_to_update.size; ++i)
     {
-        return ZYAN_STATUS_INVALID_OPERATION;
+#if defined(ZYAN_WINDOWS)
+        const HANDLE* const thread_handle =
+            (const HANDLE*)ZyanVectorGet(&g_transaction_data.threads_to_update, i);
+        ZYAN_ASSERT(thread_handle);
+
+        if (GetThreadId(*thread_handle) == (DWORD)thread_id)
+        {
+            return ZYAN_TRUE;
+        }
+#else
+        const ZyrexSuspendedThread* const thread =
+            (const ZyrexSuspendedThread*)ZyanVectorGet(&g_transaction_data.threads_to_update, i);
+        ZYAN_ASSERT(thread);
+
+        if (thread->thread_id == thread_id)
+        {
+            return ZYAN_TRUE;
+        }
+#endif
     }
 
-#ifdef ZYAN_WINDOWS
+    return ZYAN_FALSE;
+}
 
-    ZYAN_ASSERT(g_transaction_data.pending_operations.data);
-    ZYAN_ASSERT(g_transaction_data.threads_to_update.data);
+/**
+ * @brief   Suspends the given thread and adds it to the thread-update list, if not already done
+ *          (thread enumeration callback).
+ *
+ * @param   thread_id   The native id of the thread.
+ * @param   context     A pointer to a `ZyanBool` that is set, if a new thread was suspended.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexSuspendThreadCallback(ZyanThreadId thread_id, void* context)
+{
+    ZYAN_ASSERT(context);
 
-    const DWORD pid = GetCurrentProcessId();
+    if ((thread_id == ZyrexGetCurrentNativeThreadId()) || ZyrexIsThreadSuspended(thread_id))
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
 
-    const HANDLE h_snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, pid);
-    if (h_snapshot == INVALID_HANDLE_VALUE)
+    // Threads that exited in the meantime are skipped
+    const ZyanStatus status = ZyrexSuspendAndAddThread(thread_id);
+    if (status == ZYAN_STATUS_NOT_FOUND)
     {
-        return ZYAN_STATUS_BAD_SYSTEMCALL;
+        return ZYAN_STATUS_SUCCESS;
     }
+    ZYAN_CHECK(status);
 
-    THREADENTRY32 thread;
-    ZYAN_MEMSET(&thread, 0, sizeof(thread));
-    thread.dwSize = sizeof(thread);
+    *(ZyanBool*)context = ZYAN_TRUE;
 
-    if (Thread32First(h_snapshot, &thread))
-    {
-        do
-        {
-            if ((thread.th32OwnerProcessID == pid) && (thread.th32ThreadID != tid))
-            {
-                const HANDLE h_thread =
-                    OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_SET_CONTEXT,
-                        ZYAN_FALSE, thread.th32ThreadID);
-                if (h_thread != ZYAN_NULL)
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Suspends all threads in the thread registry and adds them to the thread-update list.
+ *
+ * @param   threads A pointer to the vector of registered native thread ids.
+ *
+ * @return  A zyan status code.
+ *
+ * Threads that exited without unregistering themselves are marked for removal from the
+ * registry. Deleting them right away might shrink the vector while other threads are suspended.
+ */
+static ZyanStatus ZyrexSuspendRegisteredThreads(ZyanVector* threads)
+{
+    ZYAN_ASSERT(threads);
+
+    const ZyanThreadId current_thread_id = ZyrexGetCurrentNativeThreadId();
+
+    for (ZyanUSize i = 0; i < threads->size; ++i)
+    {
+        ZyanThreadId* const thread_id = ZyanVectorGetMutable(threads, i);
+        ZYAN_ASSERT(thread_id);
+
+        if (!*thread_id || (*thread_id == current_thread_id) ||
+            ZyrexIsThreadSuspended(*thread_id))
+        {
+            continue;
+        }
+
+        const ZyanStatus status = ZyrexSuspendAndAddThread(*thread_id);
+        if (status == ZYAN_STATUS_NOT_FOUND)
+        {
+            *thread_id = 0;
+            continue;
+        }
+        ZYAN_CHECK(status);
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+#endif
+
+/**
+ * @brief   Migrates the thread at the given index of the thread-update list from the `source`
+ *          code to the `destination` code.
+ *
+ * @param   index               The index of the thread in the thread-update list.
+ * @param   source              A pointer to the source code.
+ * @param   source_length       The length of the source code.
+ * @param   destination         A pointer to the destination code.
+ * @param   destination_length  The length of the destination code.
+ * @param   translation_map     A pointer to the instruction translation map.
+ * @param   direction           The migration direction.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexMigrateThreadAt(ZyanUSize index, const void* source,
+    ZyanUSize source_length, const void* destination, ZyanUSize destination_length,
+    const ZyrexInstructionTranslationMap* translation_map,
+    ZyrexThreadMigrationDirection direction)
+{
+#if defined(ZYAN_WINDOWS)
+
+    const HANDLE* const thread_handle =
+        (const HANDLE*)ZyanVectorGet(&g_transaction_data.threads_to_update, index);
+    ZYAN_ASSERT(thread_handle);
+
+    return ZyrexMigrateThread(*thread_handle, source, source_length, destination,
+        destination_length, translation_map, direction);
+
+#elif defined(ZYAN_LINUX)
+
+    const ZyrexSuspendedThread* const thread =
+        (const ZyrexSuspendedThread*)ZyanVectorGet(&g_transaction_data.threads_to_update, index);
+    ZYAN_ASSERT(thread);
+
+    return ZyrexMigrateThread(thread->context, source, source_length, destination,
+        destination_length, translation_map, direction);
+
+#else
+
+    ZYAN_UNUSED(index);
+    ZYAN_UNUSED(source);
+    ZYAN_UNUSED(source_length);
+    ZYAN_UNUSED(destination);
+    ZYAN_UNUSED(destination_length);
+    ZYAN_UNUSED(translation_map);
+    ZYAN_UNUSED(direction);
+
+    return ZYAN_STATUS_SUCCESS;
+
+#endif
+}
+
+/**
+ * @brief   Migrates all threads in the thread-update list from the `source` code to the
+ *          `destination` code.
+ *
+ * @param   source              A pointer to the source code.
+ * @param   source_length       The length of the source code.
+ * @param   destination         A pointer to the destination code.
+ * @param   destination_length  The length of the destination code.
+ * @param   translation_map     A pointer to the instruction translation map.
+ * @param   direction           The migration direction.
+ *
+ * @return  A zyan status code.
+ *
+ * If a thread can not be migrated, the threads that were already migrated are moved back to the
+ * `source` code, so either all or none of the threads are migrated.
+ */
+static ZyanStatus ZyrexMigrateThreads(const void* source, ZyanUSize source_length,
+    const void* destination, ZyanUSize destination_length,
+    const ZyrexInstructionTranslationMap* translation_map,
+    ZyrexThreadMigrationDirection direction)
+{
+    for (ZyanUSize i = 0; i < g_transaction_data.threads_to_update.size; ++i)
+    {
+        const ZyanStatus status = ZyrexMigrateThreadAt(i, source, source_length, destination,
+            destination_length, translation_map, direction);
+        if (ZYAN_SUCCESS(status))
+        {
+            continue;
+        }
+
+        const ZyrexThreadMigrationDirection reverse =
+            (direction == ZYREX_THREAD_MIGRATION_DIRECTION_SRC_DST)
+                ? ZYREX_THREAD_MIGRATION_DIRECTION_DST_SRC
+                : ZYREX_THREAD_MIGRATION_DIRECTION_SRC_DST;
+        while (i-- > 0)
+        {
+            ZYAN_UNUSED(ZyrexMigrateThreadAt(i, destination, destination_length, source,
+                source_length, translation_map, reverse));
+        }
+
+        return status;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Resumes all threads in the thread-update list at once, clears the list and updates
+ *          the statistics of the current patch phase.
+ */
+static void ZyrexResumeAllThreads(void)
+{
+    ZyanUSize thread_count = 0;
+
+#if defined(ZYAN_WINDOWS)
+
+    thread_count = g_transaction_data.threads_to_update.size;
+    ZYAN_VECTOR_FOREACH(HANDLE, &g_transaction_data.threads_to_update, handle,
+    {
+        ResumeThread(handle);
+    });
+
+    ZyanVectorClear(&g_transaction_data.threads_to_update);
+
+#elif defined(ZYAN_LINUX)
+
+    thread_count = g_transaction_data.threads_to_update.size;
+    if (thread_count)
+    {
+        ZyrexResumeThreads();
+    }
+
+    ZyanVectorClear(&g_transaction_data.threads_to_update);
+
+#endif
+
+    if (g_transaction_data.is_registry_acquired)
+    {
+        ZyrexThreadRegistryRelease();
+        g_transaction_data.is_registry_acquired = ZYAN_FALSE;
+    }
+
+    ZyrexTransactionStatistics* const statistics = &g_transaction_data.phase_statistics;
+    statistics->thread_count = ZYAN_MAX(statistics->thread_count, thread_count);
+    if (g_transaction_data.pause_begin)
+    {
+        const ZyanU64 pause_time = ZyrexGetTimestamp() - g_transaction_data.pause_begin;
+        statistics->pause_time += pause_time;
+        statistics->max_pause_time = ZYAN_MAX(statistics->max_pause_time, pause_time);
+        ++statistics->slice_count;
+    }
+    g_transaction_data.pause_begin = 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Batch installation                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Analyzes the prologue of a single target function (worker callback).
+ *
+ * @param   context A pointer to the `ZyrexBatchContext` struct.
+ * @param   index   The index of the batch item.
+ */
+static void ZyrexBatchAnalyze(void* context, ZyanUSize index)
+{
+    const ZyrexBatchContext* const batch = (const ZyrexBatchContext*)context;
+    ZyrexBatchItem* const item = &batch->items[index];
+
+    const ZyrexHookSpec* const spec = &batch->specs[index];
+    const ZyanUSize patch_size = spec->patch_size ? spec->patch_size : ZYREX_DEFAULT_PATCH_SIZE;
+
+    item->trampoline = ZYAN_NULL;
+    if (!spec->address || !spec->callback || !spec->trampoline ||
+        (patch_size < ZYREX_DEFAULT_PATCH_SIZE) || (patch_size > ZYREX_MAX_PATCH_SIZE))
+    {
+        item->status = ZYAN_STATUS_INVALID_ARGUMENT;
+        return;
+    }
+
+    item->status = ZyrexTrampolineAnalyze(spec->address, patch_size, &item->analysis);
+}
+
+/**
+ * @brief   Compares two `ZyrexBatchOrderItem` structs by address (`qsort` callback).
+ *
+ * @param   left    A pointer to the first `ZyrexBatchOrderItem` struct.
+ * @param   right   A pointer to the second `ZyrexBatchOrderItem` struct.
+ *
+ * @return  A negative value, zero or a positive value, if the `left` item is ordered before,
+ *          equal to or after the `right` item.
+ *
+ * Items with the same address keep their original order.
+ */
+static int ZyrexBatchCompareOrderItem(const void* left, const void* right)
+{
+    const ZyrexBatchOrderItem* const a = (const ZyrexBatchOrderItem*)left;
+    const ZyrexBatchOrderItem* const b = (const ZyrexBatchOrderItem*)right;
+
+    if (a->address != b->address)
+    {
+        return (a->address < b->address) ? -1 : 1;
+    }
+    return (a->index < b->index) ? -1 : ((a->index > b->index) ? 1 : 0);
+}
+
+/**
+ * @brief   Checks, if a 5-byte relative branch at the given `address` can reach the given
+ *          `destination`.
+ *
+ * @param   address     The address of the branch instruction.
+ * @param   destination The branch target.
+ *
+ * @return  `ZYAN_TRUE`, if the destination is within reach or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool ZyrexIsRelativeBranchReachable(ZyanUPointer address, ZyanUPointer destination)
+{
+#if defined(ZYAN_X64)
+
+    const ZyanIPointer distance = (ZyanIPointer)destination -
+        (ZyanIPointer)(address + ZYREX_SIZEOF_RELATIVE_JUMP);
+    return (ZYAN_ABS(distance) <= ZYREX_RANGEOF_RELATIVE_JUMP);
+
+#else
+
+    ZYAN_UNUSED(address);
+    ZYAN_UNUSED(destination);
+
+    return ZYAN_TRUE;
+
+#endif
+}
+
+/**
+ * @brief   Checks, if the hook jump written to the given `address` can redirect to the callback
+ *          function of the given `trampoline` directly.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ * @param   address     The patch address.
+ *
+ * @return  `ZYAN_TRUE`, if the callback function is within reach of the hook jump or
+ *          `ZYAN_FALSE`, if not.
+ */
+static ZyanBool ZyrexIsCallbackReachable(const ZyrexTrampolineChunk* trampoline,
+    ZyanUPointer address)
+{
+    ZYAN_ASSERT(trampoline);
+
+#if defined(ZYAN_X64)
+
+    if (trampoline->patch_size >= ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP)
+    {
+        return ZYAN_TRUE;
+    }
+
+#endif
+
+    return ZyrexIsRelativeBranchReachable(address,
+        trampoline->callback->user_callback_address);
+}
+
+/**
+ * @brief   Selects the destination of the hook jump of the given `trampoline`.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ * @param   flags       A combination of `ZyrexInlineHookFlags` values.
+ *
+ * @return  `ZYAN_STATUS_OUT_OF_RANGE`, if `ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK` was passed and
+ *          the callback function is out of reach of the hook jump, or a zyan status code.
+ *
+ * The hook jump redirects to the callback function directly, if it is within reach, unless
+ * `ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP` was passed. The trampoline chunk must not be reachable
+ * by the hooked code yet.
+ */
+static ZyanStatus ZyrexSelectHookJumpDestination(const ZyrexTrampolineChunk* trampoline,
+    ZyanU32 flags)
+{
+    ZYAN_ASSERT(trampoline);
+
+    const ZyanU32 mask =
+        ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK | ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP;
+    if ((flags & mask) == mask)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+    if (flags & ZYREX_INLINE_HOOK_FLAG_CALLBACK_JUMP)
+    {
+        trampoline->callback->is_direct = ZYAN_FALSE;
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    const ZyanBool is_reachable = ZyrexIsCallbackReachable(trampoline,
+        (ZyanUPointer)ZyrexTrampolineGetPatchAddress(trampoline));
+    if (!is_reachable && (flags & ZYREX_INLINE_HOOK_FLAG_DIRECT_CALLBACK))
+    {
+        return ZYAN_STATUS_OUT_OF_RANGE;
+    }
+    trampoline->callback->is_direct = is_reachable;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Relocates the prologue of a single target function to the private buffer of the
+ *          batch item (worker callback).
+ *
+ * @param   context A pointer to the `ZyrexBatchContext` struct.
+ * @param   index   The index of the batch item.
+ */
+static void ZyrexBatchRelocate(void* context, ZyanUSize index)
+{
+    const ZyrexBatchContext* const batch = (const ZyrexBatchContext*)context;
+    ZyrexBatchItem* const item = &batch->items[index];
+
+    if (!ZYAN_SUCCESS(item->status))
+    {
+        return;
+    }
+
+    const ZyrexHookSpec* const spec = &batch->specs[index];
+    item->status = ZyrexTrampolineInit(&item->buffer, item->trampoline, &item->analysis,
+        spec->callback);
+
+    if (ZYAN_SUCCESS(item->status))
+    {
+        // The callback data of the private buffer already points to the final callback table
+        item->status = ZyrexSelectHookJumpDestination(&item->buffer, spec->flags);
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Code Patching                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Checks, if the given range of the patch window covers a single original instruction.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ * @param   offset      The offset of the range relative to the patch address.
+ * @param   size        The size of the range.
+ *
+ * @return  `ZYAN_TRUE`, if no original instruction starts inside of the range (excluding the
+ *          first byte) or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool ZyrexIsSingleInstructionRange(const ZyrexTrampolineChunk* trampoline,
+    ZyanUSize offset, ZyanUSize size)
+{
+    ZYAN_ASSERT(trampoline);
+
+    const ZyrexInstructionTranslationMap* const map = &trampoline->translation_map;
+    for (ZyanUSize i = 0; i < map->count; ++i)
+    {
+        const ZyanUSize offset_source = map->items[i].offset_source;
+        if ((offset_source > offset) && (offset_source < offset + size))
+        {
+            return ZYAN_FALSE;
+        }
+    }
+
+    return ZYAN_TRUE;
+}
+
+/**
+ * @brief   Writes the given code to a range of the patch window.
+ *
+ * @param   address     The patch address.
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ * @param   offset      The offset of the range relative to the patch address.
+ * @param   code        A pointer to the code to write.
+ * @param   size        The size of the code.
+ * @param   detour      The address to redirect threads to, that execute the range while it is
+ *                      being modified.
+ *
+ * @return  `ZYAN_STATUS_INVALID_OPERATION`, if the breakpoint patch mode is active, the range
+ *          spans multiple instructions and no threads were added to the transaction, or a zyan
+ *          status code.
+ *
+ * The code is written live, if the breakpoint patch mode is active and the range covers a single
+ * instruction before and after the write. Otherwise the code is written directly, which is only
+ * safe while the threads that might execute it are suspended.
+ */
+static ZyanStatus ZyrexWritePatchRange(void* address, const ZyrexTrampolineChunk* trampoline,
+    ZyanUSize offset, const void* code, ZyanUSize size, const void* detour)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(trampoline);
+    ZYAN_ASSERT(code);
+
+    void* const destination = (ZyanU8*)address + offset;
+    if ((g_transaction_data.patch_mode == ZYREX_PATCH_MODE_BREAKPOINT) &&
+        ZyrexIsSingleInstructionRange(trampoline, offset, size))
+    {
+        return ZyrexWriteCodeLive(destination, code, size, detour);
+    }
+    if ((g_transaction_data.patch_mode == ZYREX_PATCH_MODE_BREAKPOINT) &&
+        !g_transaction_data.has_thread_updates)
+    {
+        // Threads might be executing any of the overwritten instructions
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    return ZyrexWriteCode(destination, code, size);
+}
+
+/**
+ * @brief   Checks, if the instruction at the given `address` is a `call rel32` or `jmp rel32`
+ *          instruction without prefixes.
+ *
+ * @param   address The instruction address.
+ *
+ * @return  `ZYAN_TRUE`, if the instruction is a relative call or jump or `ZYAN_FALSE`, if not.
+ */
+static ZyanBool ZyrexIsCallSite(const void* address)
+{
+    ZYAN_ASSERT(address);
+
+    const ZyanU8 opcode = *(const ZyanU8*)address;
+    return (opcode == 0xE8) || (opcode == 0xE9);
+}
+
+/**
+ * @brief   Returns the branch target of the call site at the given `address`.
+ *
+ * @param   address The address of the `call rel32` or `jmp rel32` instruction.
+ *
+ * @return  The branch target.
+ */
+static const void* ZyrexGetCallSiteTarget(const void* address)
+{
+    ZYAN_ASSERT(address);
+
+    ZyanI32 offset;
+    ZYAN_MEMCPY(&offset, (const ZyanU8*)address + 1, sizeof(offset));
+
+    return (const void*)((ZyanUPointer)address + ZYREX_SIZEOF_RELATIVE_JUMP +
+        (ZyanIPointer)offset);
+}
+
+/**
+ * @brief   Redirects the call site at the given `address` to the given `target`.
+ *
+ * @param   address The address of the `call rel32` or `jmp rel32` instruction.
+ * @param   target  The new branch target.
+ *
+ * @return  `ZYAN_STATUS_INVALID_OPERATION`, if the breakpoint patch mode is active, the
+ *          displacement can not be written atomically and no threads were added to the
+ *          transaction, or a zyan status code.
+ *
+ * Only the 4-byte displacement is written. In the breakpoint patch mode, the displacement is
+ * written using a single atomic store, if it does not cross an aligned 8-byte word and the
+ * `ZYREX_CODE_WRITER_BACKEND_PROTECT` backend is active. A transient breakpoint inside of the
+ * instruction can not be used and writes through the process memory file are not atomic, so any
+ * other call site can only be redirected while the threads that might execute it are suspended.
+ */
+static ZyanStatus ZyrexWriteCallSiteTarget(void* address, const void* target)
+{
+    ZYAN_ASSERT(address);
+
+    const ZyanI32 offset = ZyrexCalculateRelativeOffset(ZYREX_SIZEOF_RELATIVE_JUMP,
+        (ZyanUPointer)address, (ZyanUPointer)target);
+
+    ZyanU8* const displacement = (ZyanU8*)address + 1;
+    const ZyanUPointer word = ZYAN_ALIGN_DOWN((ZyanUPointer)displacement, 8);
+    if (g_transaction_data.patch_mode == ZYREX_PATCH_MODE_BREAKPOINT)
+    {
+        if ((ZyrexCodeWriterGetBackend() == ZYREX_CODE_WRITER_BACKEND_PROTECT) &&
+            ((ZyanUPointer)displacement + sizeof(offset) <= word + 8))
+        {
+            return ZyrexWriteCodeLive(displacement, &offset, sizeof(offset), target);
+        }
+        if (!g_transaction_data.has_thread_updates)
+        {
+            return ZYAN_STATUS_INVALID_OPERATION;
+        }
+    }
+
+    return ZyrexWriteCode(displacement, &offset, sizeof(offset));
+}
+
+/**
+ * @brief   Assembles the jump from the replaced function to the replacement function.
+ *
+ * @param   hook    A pointer to the `ZyrexReplacementHook` struct.
+ * @param   code    Receives the jump instruction. The buffer must be able to hold
+ *                  `hook->patch_size` bytes.
+ */
+static void ZyrexAssembleReplacementJump(const ZyrexReplacementHook* hook, ZyanU8* code)
+{
+    ZYAN_ASSERT(hook);
+    ZYAN_ASSERT(code);
+
+#if defined(ZYAN_X64)
+
+    if (hook->patch_size == ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP)
+    {
+        ZyrexWriteInlineAbsoluteJump(code, (ZyanUPointer)hook->replacement);
+        return;
+    }
+
+#endif
+
+    ZYAN_ASSERT(hook->patch_size == ZYREX_SIZEOF_RELATIVE_JUMP);
+
+    // The jump is assembled in a local buffer, so the offset has to be calculated manually
+    code[0] = 0xE9;
+    const ZyanI32 offset = ZyrexCalculateRelativeOffset(ZYREX_SIZEOF_RELATIVE_JUMP,
+        (ZyanUPointer)hook->address, (ZyanUPointer)hook->replacement);
+    ZYAN_MEMCPY(&code[1], &offset, sizeof(offset));
+}
+
+/**
+ * @brief   Writes the given code to the patch window of a replacement hook.
+ *
+ * @param   hook    A pointer to the `ZyrexReplacementHook` struct.
+ * @param   code    A pointer to the code to write.
+ *
+ * @return  `ZYAN_STATUS_INVALID_OPERATION`, if the breakpoint patch mode is active, the patch
+ *          window spans multiple instructions and no threads were added to the transaction, or a
+ *          zyan status code.
+ *
+ * The code is written live, if the breakpoint patch mode is active and the patch window covers a
+ * single instruction. Threads that hit the transient breakpoint continue in the replacement
+ * function.
+ */
+static ZyanStatus ZyrexWriteReplacementCode(const ZyrexReplacementHook* hook, const ZyanU8* code)
+{
+    ZYAN_ASSERT(hook);
+    ZYAN_ASSERT(code);
+
+    if (g_transaction_data.patch_mode == ZYREX_PATCH_MODE_BREAKPOINT)
+    {
+        if (hook->is_single_instruction)
+        {
+            return ZyrexWriteCodeLive(hook->address, code, hook->patch_size, hook->replacement);
+        }
+        if (!g_transaction_data.has_thread_updates)
+        {
+            return ZYAN_STATUS_INVALID_OPERATION;
+        }
+    }
+
+    return ZyrexWriteCode(hook->address, code, hook->patch_size);
+}
+
+/**
+ * @brief   Writes the jump from the replaced function to the replacement function.
+ *
+ * @param   hook    A pointer to the `ZyrexReplacementHook` struct.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexWriteReplacementJump(const ZyrexReplacementHook* hook)
+{
+    ZYAN_ASSERT(hook);
+
+    ZyanU8 code[ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP];
+    ZyrexAssembleReplacementJump(hook, code);
+
+    return ZyrexWriteReplacementCode(hook, code);
+}
+
+/**
+ * @brief   Makes the code of the given range of pending operations writable.
+ *
+ * @param   operations  A pointer to the vector of pending operations.
+ * @param   first       The index of the first operation.
+ * @param   count       The number of operations.
+ *
+ * @return  A zyan status code.
+ *
+ * The protection is changed once per distinct page range instead of once per operation. The
+ * original protection of all affected pages is stored in the `regions` buffer of the patch
+ * phase, which was reserved in advance, so no memory is allocated.
+ *
+ * The caller has to hold the patch lock.
+ */
+static ZyanStatus ZyrexUnprotectPendingOperations(const ZyanVector* operations,
+    ZyanUSize first, ZyanUSize count)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(first + count <= operations->size);
+
+    ZyanVector* const ranges = &g_transaction_data.ranges;
+    ZYAN_CHECK(ZyanVectorClear(ranges));
+
+    for (ZyanUSize i = first; i < first + count; ++i)
+    {
+        const ZyrexOperation* const item = ZyanVectorGet(operations, i);
+        ZYAN_ASSERT(item);
+
+        ZyanUSize size;
+        switch (item->type)
+        {
+        case ZYREX_HOOK_TYPE_INLINE:
+            size = item->trampoline->original_code_size;
+            break;
+        case ZYREX_HOOK_TYPE_CALL_SITE:
+            size = ZYREX_SIZEOF_RELATIVE_JUMP;
+            break;
+        case ZYREX_HOOK_TYPE_REPLACEMENT:
+            size = item->replacement->patch_size;
+            break;
+        default:
+            continue;
+        }
+
+        ZYAN_CHECK(ZyrexProtectedRegionsAdd(ranges, item->address, size));
+    }
+
+    return ZyrexProtectedRegionsUnprotect(ranges, &g_transaction_data.regions);
+}
+
+/**
+ * @brief   Assembles the hook jump which redirects the code-flow from the given `address` to the
+ *          given `destination`.
+ *
+ * @param   address     The target address.
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ * @param   destination The destination of the hook jump.
+ * @param   code        Receives the jump instruction. The buffer must be able to hold
+ *                      `trampoline->patch_size` bytes.
+ *
+ * @return  The size of the jump instruction.
+ */
+static ZyanUSize ZyrexAssembleHookJump(const void* address,
+    const ZyrexTrampolineChunk* trampoline, ZyanUPointer destination, ZyanU8* code)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(trampoline);
+    ZYAN_ASSERT(code);
+
+#if defined(ZYAN_X64)
+
+    if (trampoline->patch_size >= ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP)
+    {
+        ZyrexWriteInlineAbsoluteJump(code, destination);
+        return ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP;
+    }
+
+#elif !defined(ZYAN_X86)
+#   error "Unsupported platform"
+#else
+
+    ZYAN_UNUSED(trampoline);
+
+#endif
+
+    // The jump is assembled in a local buffer, so the offset has to be calculated manually
+    code[0] = 0xE9;
+    const ZyanI32 offset = ZyrexCalculateRelativeOffset(ZYREX_SIZEOF_RELATIVE_JUMP,
+        (ZyanUPointer)address, destination);
+    ZYAN_MEMCPY(&code[1], &offset, sizeof(offset));
+
+    return ZYREX_SIZEOF_RELATIVE_JUMP;
+}
+
+/**
+ * @brief   Writes the hook jump which redirects the code-flow from the given `address` to the
+ *          `trampoline`.
+ *
+ * @param   address     The target address.
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexWriteHookJump(void* address, const ZyrexTrampolineChunk* trampoline)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(trampoline);
+
+    // The callback is reached directly, if it is within reach of the hook jump. Otherwise the
+    // callback jump of the trampoline is used, which allows to exchange the callback without
+    // modifying the hooked code
+    const ZyanUPointer destination = trampoline->callback->is_direct
+        ? trampoline->callback->user_callback_address
+        : (ZyanUPointer)&trampoline->callback_jump;
+
+    ZyanU8 code[ZYREX_MAX_PATCH_SIZE];
+    const ZyanUSize jump_size = ZyrexAssembleHookJump(address, trampoline, destination, code);
+
+    if (trampoline->patch_site_type != ZYREX_PATCH_SITE_TYPE_NOP_PADDING)
+    {
+        // Fill the remaining space of the patch window
+        ZYAN_ASSERT(jump_size <= trampoline->patch_size);
+        ZYAN_MEMSET(&code[jump_size], 0xCC, trampoline->patch_size - jump_size);
+
+        return ZyrexWritePatchRange(address, trampoline, 0, code, trampoline->patch_size,
+            (const void*)destination);
+    }
+
+    // Fill the remaining space of the padding. The function entry is written separately
+    const ZyanUSize entry_offset = (ZyanUSize)trampoline->entry_offset;
+    ZYAN_ASSERT((jump_size <= entry_offset) && (entry_offset <= ZYAN_ARRAY_LENGTH(code)));
+    ZYAN_MEMSET(&code[jump_size], 0xCC, entry_offset - jump_size);
+
+    // The padding is unreachable until the function entry is redirected
+    ZYAN_CHECK(ZyrexWriteCode(address, code, entry_offset));
+
+    // Redirect the function entry to the hook jump inside the padding
+    code[0] = 0xEB;
+    code[1] = (ZyanU8)(-(ZyanI8)(entry_offset + ZYREX_SIZEOF_SHORT_JUMP));
+    return ZyrexWritePatchRange(address, trampoline, entry_offset, code, 
+        ZYREX_SIZEOF_SHORT_JUMP, address);
+}
+
+/**
+ * @brief   Reads the original code instructions from the `trampoline` and restores them to the
+ *          given `address`.
+ *
+ * @param   address     The target address.
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexRestoreInstructions(void* address, const ZyrexTrampolineChunk* trampoline)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(trampoline);
+
+    // Threads that hit the transient breakpoint execute the relocated instructions instead
+    const void* const detour = &trampoline->code_buffer;
+
+    if (trampoline->patch_site_type != ZYREX_PATCH_SITE_TYPE_NOP_PADDING)
+    {
+        return ZyrexWritePatchRange(address, trampoline, 0, trampoline->original_code,
+            trampoline->patch_size, detour);
+    }
+
+    // Restore the function entry first to make the padding unreachable
+    const ZyanUSize entry_offset = (ZyanUSize)trampoline->entry_offset;
+    ZYAN_CHECK(ZyrexWritePatchRange(address, trampoline, entry_offset, 
+        &trampoline->original_code[entry_offset], ZYREX_SIZEOF_SHORT_JUMP, detour));
+
+    return ZyrexWriteCode(address, trampoline->original_code, entry_offset);
+}
+
+/**
+ * @brief   Checks, if the code at the given `address` still matches the `expected` bytes.
+ *
+ * @param   address     The address of the live code.
+ * @param   expected    A pointer to the expected code bytes.
+ * @param   size        The number of bytes to compare.
+ *
+ * @return  `ZYAN_TRUE`, if the code is unchanged or `ZYAN_FALSE`, if not.
+ *
+ * The bytes are compared using 64-bit loads. As `size` is bounded by the maximum size of the
+ * relocated code, this check is cheap enough to be performed for every hook.
+ */
+static ZyanBool ZyrexIsCodeUnchanged(const void* address, const ZyanU8* expected, ZyanUSize size)
+{
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(expected);
+    ZYAN_ASSERT(size <= ZYREX_TRAMPOLINE_MAX_CODE_SIZE);
+
+    const ZyanU8* const live = (const ZyanU8*)address;
+
+    ZyanU64 difference = 0;
+    ZyanUSize i = 0;
+    for (; i + sizeof(ZyanU64) <= size; i += sizeof(ZyanU64))
+    {
+        ZyanU64 a;
+        ZyanU64 b;
+        ZYAN_MEMCPY(&a, &live[i], sizeof(ZyanU64));
+        ZYAN_MEMCPY(&b, &expected[i], sizeof(ZyanU64));
+        difference |= a ^ b;
+    }
+    for (; i < size; ++i)
+    {
+        difference |= (ZyanU64)(live[i] ^ expected[i]);
+    }
+
+    return (difference == 0) ? ZYAN_TRUE : ZYAN_FALSE;
+}
+
+/**
+ * @brief   Redirects the hook jump of the given `trampoline` from the callback function to the
+ *          callback jump, while other threads might execute it.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ *
+ * @return  A zyan status code.
+ *
+ * The hook jump is written as a single instruction using `ZyrexWriteCodeLive`. Threads that hit
+ * the transient breakpoint continue at the callback jump, which redirects to the same callback
+ * function. Hooks that are not committed yet only have their flag cleared, as the commit writes
+ * the hook jump afterwards.
+ *
+ * The caller has to hold the patch lock.
+ */
+static ZyanStatus ZyrexRedirectHookJumpToCallbackJump(ZyrexTrampolineChunk* trampoline)
+{
+    ZYAN_ASSERT(trampoline);
+    ZYAN_ASSERT(trampoline->callback->is_direct);
+
+    void* const address = ZyrexTrampolineGetPatchAddress(trampoline);
+
+    // The hook jump is only present, while the hook is committed. The patch lock prevents
+    // concurrent commits from writing or restoring it in the meantime
+    ZyanU8 code[ZYREX_MAX_PATCH_SIZE];
+    ZyanUSize size = ZyrexAssembleHookJump(address, trampoline,
+        trampoline->callback->user_callback_address, code);
+    if (!ZyrexIsCodeUnchanged(address, code, size))
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+    size = ZyrexAssembleHookJump(address, trampoline, (ZyanUPointer)&trampoline->callback_jump,
+        code);
+
+    ZyrexProtectedRegion range_buffer[1];
+    ZyrexProtectedRegion region_buffer[ZYREX_MAX_PAGES_PER_OPERATION];
+    ZyanVector ranges;
+    ZyanVector regions;
+    ZYAN_CHECK(ZyanVectorInitCustomBuffer(&ranges, sizeof(ZyrexProtectedRegion), range_buffer,
+        ZYAN_ARRAY_LENGTH(range_buffer), ZYAN_NULL));
+    ZYAN_CHECK(ZyanVectorInitCustomBuffer(&regions, sizeof(ZyrexProtectedRegion), region_buffer,
+        ZYAN_ARRAY_LENGTH(region_buffer), ZYAN_NULL));
+    ZYAN_CHECK(ZyrexProtectedRegionsAdd(&ranges, address, size));
+    ZYAN_CHECK(ZyrexProtectedRegionsUnprotect(&ranges, &regions));
+
+    const ZyanStatus status = ZyrexWriteCodeLive(address, code, size, &trampoline->callback_jump);
+    ZYAN_UNUSED(ZyrexProtectedRegionsRestore(&regions));
+
+    return status;
+}
+
+/**
+ * @brief   Makes sure that the hook jump of the given `trampoline` redirects to the callback
+ *          jump.
+ *
+ * @param   trampoline  A pointer to the `ZyrexTrampolineChunk` struct.
+ *
+ * @return  A zyan status code.
+ *
+ * This is required before the callback of a hook can be exchanged or the hook can be disabled.
+ * The hook jump is rewritten at most once per hook.
+ */
+static ZyanStatus ZyrexDisableDirectCallback(ZyrexTrampolineChunk* trampoline)
+{
+    ZYAN_ASSERT(trampoline);
+
+    // The flag is never set again, once it was cleared
+    if (!trampoline->callback->is_direct)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZyrexPatchLockAcquire();
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+    if (trampoline->callback->is_direct)
+    {
+        status = ZyrexRedirectHookJumpToCallbackJump(trampoline);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        trampoline->callback->is_direct = ZYAN_FALSE;
+    }
+    ZyrexPatchLockRelease();
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Patch phase                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Replaces the buffer of the thread-update list.
+ *
+ * @param   capacity    The number of threads the list can hold.
+ *
+ * @return  A zyan status code.
+ *
+ * The list never allocates memory on its own. Adding a thread to a full list fails with
+ * `ZYAN_STATUS_INSUFFICIENT_BUFFER_SIZE`. The caller has to hold the patch lock and the list has
+ * to be empty.
+ */
+static ZyanStatus ZyrexThreadListInit(ZyanUSize capacity)
+{
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
+
+#if defined(ZYAN_WINDOWS)
+    const ZyanUSize element_size = sizeof(HANDLE);
+    const ZyanMemberProcedure destructor = (ZyanMemberProcedure)&ZyrexWindowsHandleDestroy;
+#else
+    const ZyanUSize element_size = sizeof(ZyrexSuspendedThread);
+    const ZyanMemberProcedure destructor = ZYAN_NULL;
+#endif
+
+    void* const buffer = ZYAN_MALLOC(capacity * element_size);
+    if (!buffer)
+    {
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    }
+
+    ZYAN_FREE(g_transaction_data.thread_buffer);
+    g_transaction_data.thread_buffer = buffer;
+
+    return ZyanVectorInitCustomBuffer(&g_transaction_data.threads_to_update, element_size, buffer,
+        capacity, destructor);
+
+#else
+
+    ZYAN_UNUSED(capacity);
+    return ZYAN_STATUS_SUCCESS;
+
+#endif
+}
+
+/**
+ * @brief   Acquires the patch lock and reserves all memory that is needed while threads are
+ *          suspended.
+ *
+ * @param   transactions    A pointer to the array of transactions that are committed.
+ * @param   count           The number of transactions.
+ *
+ * @return  A zyan status code.
+ *
+ * The thread-update list has room for the threads of all transactions and the page buffers have
+ * room for the largest transaction. This keeps the heap untouched between the suspension of the
+ * first thread and the resumption of the last one, as a suspended thread might hold the heap
+ * lock.
+ */
+static ZyanStatus ZyrexPatchPhaseBegin(ZyrexTransaction* const* transactions, ZyanUSize count)
+{
+    ZYAN_ASSERT(transactions || !count);
+
+    ZyanUSize thread_count = ZYREX_THREAD_LIST_HEADROOM;
+    ZyanUSize operation_count = 1;
+    ZyanBool update_all_threads = ZYAN_FALSE;
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        thread_count += transactions[i]->thread_ids.size;
+        operation_count = ZYAN_MAX(operation_count, transactions[i]->pending_operations.size);
+        update_all_threads |= transactions[i]->update_all_threads;
+    }
+    const ZyanBool has_thread_updates = update_all_threads ||
+        (thread_count > ZYREX_THREAD_LIST_HEADROOM);
+    if (update_all_threads)
+    {
+        ZYAN_CHECK(ZyrexEnumerateThreads(&ZyrexCountThreadCallback, &thread_count));
+    }
+
+    ZyrexPatchLockAcquire();
+
+    const ZyanUSize region_count = operation_count * ZYREX_MAX_PAGES_PER_OPERATION;
+    ZyrexProtectedRegion* const buffer =
+        ZYAN_MALLOC((operation_count + region_count) * sizeof(ZyrexProtectedRegion));
+    ZyanStatus status = buffer ? ZYAN_STATUS_SUCCESS : ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyanVectorInitCustomBuffer(&g_transaction_data.ranges,
+            sizeof(ZyrexProtectedRegion), buffer, operation_count, ZYAN_NULL);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyanVectorInitCustomBuffer(&g_transaction_data.regions,
+            sizeof(ZyrexProtectedRegion), buffer + operation_count, region_count, ZYAN_NULL);
+    }
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexThreadListInit(thread_count);
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZYAN_FREE(buffer);
+        ZyrexPatchLockRelease();
+        return status;
+    }
+    g_transaction_data.region_buffer = buffer;
+    g_transaction_data.has_thread_updates = has_thread_updates;
+
+    ZYAN_MEMSET(&g_transaction_data.phase_statistics, 0, sizeof(ZyrexTransactionStatistics));
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Resumes all threads in the thread-update list, releases the memory of the patch
+ *          phase, publishes the statistics of the patch phase and releases the patch lock.
+ */
+static void ZyrexPatchPhaseEnd(void)
+{
+    ZyrexResumeAllThreads();
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
+    ZyanVectorDestroy(&g_transaction_data.threads_to_update);
+    ZYAN_FREE(g_transaction_data.thread_buffer);
+    g_transaction_data.thread_buffer = ZYAN_NULL;
+#endif
+    ZyanVectorDestroy(&g_transaction_data.ranges);
+    ZyanVectorDestroy(&g_transaction_data.regions);
+    ZYAN_FREE(g_transaction_data.region_buffer);
+    g_transaction_data.region_buffer = ZYAN_NULL;
+    g_transaction_data.statistics = g_transaction_data.phase_statistics;
+    ZyrexPatchLockRelease();
+}
+
+/**
+ * @brief   Suspends the thread with the given native id and adds it to the thread-update list,
+ *          if not already done.
+ *
+ * @param   thread_id   The native id of the thread.
+ *
+ * @return  `ZYAN_STATUS_NOT_FOUND`, if the thread does not exist or a zyan status code.
+ *
+ * The caller has to hold the patch lock.
+ */
+static ZyanStatus ZyrexPatchPhaseUpdateThread(ZyanThreadId thread_id)
+{
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
+
+    if ((thread_id == ZyrexGetCurrentNativeThreadId()) || ZyrexIsThreadSuspended(thread_id))
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    return ZyrexSuspendAndAddThread(thread_id);
+
+#else
+
+    ZYAN_UNUSED(thread_id);
+    return ZYAN_STATUS_SUCCESS;
+
+#endif
+}
+
+/**
+ * @brief   Suspends all threads (except the calling one) and adds them to the thread-update list.
+ *
+ * @return  A zyan status code.
+ *
+ * The caller has to hold the patch lock.
+ */
+static ZyanStatus ZyrexPatchPhaseUpdateAllThreads(void)
+{
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
+
+    if (g_transaction_data.is_registry_acquired)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    ZyanVector* threads;
+    const ZyanStatus status = ZyrexThreadRegistryAcquire(&threads);
+    ZYAN_CHECK(status);
+    if (status == ZYAN_STATUS_TRUE)
+    {
+        // The registry is held until the patch phase ends, which blocks threads that are about
+        // to register themselves. A single-threaded process does not suspend anything
+        g_transaction_data.is_registry_acquired = ZYAN_TRUE;
+        return ZyrexSuspendRegisteredThreads(threads);
+    }
+
+    // Threads that are not suspended yet might create new threads. Repeat the enumeration until
+    // no new threads are found
+    ZyanBool found_new_thread = ZYAN_TRUE;
+    while (found_new_thread)
+    {
+        found_new_thread = ZYAN_FALSE;
+        ZYAN_CHECK(ZyrexEnumerateThreads(&ZyrexSuspendThreadCallback, &found_new_thread));
+    }
+
+#endif
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Checks, if any suspended thread executes or returns into code that is retired by the
+ *          given range of operations.
+ *
+ * @param   operations          A pointer to the vector of pending operations.
+ * @param   first               The index of the first operation.
+ * @param   count               The number of operations.
+ * @param   failed_operation    Receives the trampoline address (or the target address for hooks
+ *                              without a trampoline) of the first operation whose code is in use.
+ *                              This parameter is optional.
+ *
+ * @return  `ZYREX_STATUS_UNSAFE_THREAD_STATE`, if the code of an operation is in use or a zyan
+ *          status code.
+ *
+ * A thread whose stack is too deep to be captured completely is treated as unsafe as well. In
+ * this case, `failed_operation` is not written.
+ */
+static ZyanStatus ZyrexCheckThreadStacks(const ZyanVector* operations, ZyanUSize first,
+    ZyanUSize count, const void** failed_operation)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(first + count <= operations->size);
+
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
+
+    if (!g_transaction_data.is_stack_check_enabled)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    for (ZyanUSize i = 0; i < g_transaction_data.threads_to_update.size; ++i)
+    {
+        ZyanUPointer addresses[ZYREX_STACK_CHECK_MAX_ADDRESSES];
+        ZyanUSize address_count;
+
+#if defined(ZYAN_WINDOWS)
+        const HANDLE* const thread_handle =
+            (const HANDLE*)ZyanVectorGet(&g_transaction_data.threads_to_update, i);
+        ZYAN_ASSERT(thread_handle);
+
+        ZYAN_CHECK(ZyrexCaptureThreadStack(*thread_handle, addresses, &address_count));
+#else
+        const ZyrexSuspendedThread* const thread =
+            (const ZyrexSuspendedThread*)ZyanVectorGet(&g_transaction_data.threads_to_update, i);
+        ZYAN_ASSERT(thread);
+
+        ZYAN_CHECK(ZyrexCaptureThreadStack(thread->context, addresses, &address_count));
+#endif
+
+        for (ZyanUSize j = first; j < first + count; ++j)
+        {
+            const ZyrexOperation* const item = ZyanVectorGet(operations, j);
+            ZYAN_ASSERT(item);
+
+            for (ZyanUSize k = 0; k < address_count; ++k)
+            {
+                if ((addresses[k] < item->retired_begin) || (addresses[k] >= item->retired_end))
+                {
+                    continue;
+                }
+                if (failed_operation)
+                {
+                    *failed_operation = (item->type == ZYREX_HOOK_TYPE_INLINE)
+                        ? (const void*)&item->trampoline->code_buffer
+                        : item->address;
+                }
+                return ZYREX_STATUS_UNSAFE_THREAD_STATE;
+            }
+        }
+    }
+
+#else
+
+    ZYAN_UNUSED(operations);
+    ZYAN_UNUSED(first);
+    ZYAN_UNUSED(count);
+    ZYAN_UNUSED(failed_operation);
+
+#endif
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Verifies that the code of the targets of the given range of attach operations was not
+ *          modified after the hooks were added.
+ *
+ * @param   operations          A pointer to the vector of pending operations.
+ * @param   first               The index of the first operation.
+ * @param   count               The number of operations.
+ * @param   failed_operation    Receives the trampoline address of the first operation whose
+ *                              target was modified. This parameter is optional.
+ *
+ * @return  `ZYREX_STATUS_CODE_MODIFIED`, if the code of a hook target was modified or
+ *          `ZYAN_STATUS_SUCCESS`, if not.
+ */
+static ZyanStatus ZyrexVerifyPendingOperations(const ZyanVector* operations, ZyanUSize first,
+    ZyanUSize count, const void** failed_operation)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(first + count <= operations->size);
+
+    // Another library or a JIT compiler might have modified one of the targets after the hook
+    // was added to the transaction. Overwriting the code would silently break the other patch
+    for (ZyanUSize i = first; i < first + count; ++i)
+    {
+        const ZyrexOperation* const item = ZyanVectorGet(operations, i);
+        ZYAN_ASSERT(item);
+
+        if (item->type == ZYREX_HOOK_TYPE_CALL_SITE)
+        {
+            if (!ZyrexIsCallSite(item->address) ||
+                (ZyrexGetCallSiteTarget(item->address) != item->expected_target))
+            {
+                if (failed_operation)
+                {
+                    *failed_operation = item->address;
+                }
+                return ZYREX_STATUS_CODE_MODIFIED;
+            }
+            continue;
+        }
+
+        if (item->type == ZYREX_HOOK_TYPE_REPLACEMENT)
+        {
+            ZyanU8 jump[ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP];
+            ZyrexAssembleReplacementJump(item->replacement, jump);
+            const ZyanU8* const expected = (item->action == ZYREX_OPERATION_ACTION_ATTACH)
+                ? item->replacement->original_code
+                : jump;
+            if (!ZyrexIsCodeUnchanged(item->address, expected, item->replacement->patch_size))
+            {
+                if (failed_operation)
+                {
+                    *failed_operation = item->address;
+                }
+                return ZYREX_STATUS_CODE_MODIFIED;
+            }
+            continue;
+        }
+
+        if ((item->type != ZYREX_HOOK_TYPE_INLINE) || 
+            (item->action != ZYREX_OPERATION_ACTION_ATTACH))
+        {
+            continue;
+        }
+
+        if (!ZyrexIsCodeUnchanged(item->address, item->trampoline->original_code,
+            item->trampoline->original_code_size))
+        {
+            if (failed_operation)
+            {
+                *failed_operation = &item->trampoline->code_buffer;
+            }
+            return ZYREX_STATUS_CODE_MODIFIED;
+        }
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Reverts the given range of operations, which were already applied.
+ *
+ * @param   operations  A pointer to the vector of pending operations.
+ * @param   first       The index of the first operation.
+ * @param   count       The number of applied operations.
+ *
+ * The caller has to hold the patch lock. Removed hooks are written again and attached hooks are
+ * removed in reverse order.
+ */
+static void ZyrexPatchPhaseRevert(const ZyanVector* operations, ZyanUSize first,
+    ZyanUSize count)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(first + count <= operations->size);
+
+    if (!ZYAN_SUCCESS(ZyrexUnprotectPendingOperations(operations, first, count)))
+    {
+        return;
+    }
+
+    for (ZyanUSize i = first + count; i-- > first;)
+    {
+        const ZyrexOperation* item = ZyanVectorGet(operations, i);
+        ZYAN_ASSERT(item);
+
+        if (item->type == ZYREX_HOOK_TYPE_CALL_SITE)
+        {
+            ZYAN_UNUSED(ZyrexWriteCallSiteTarget(item->address, item->expected_target));
+            continue;
+        }
+        if (item->type == ZYREX_HOOK_TYPE_REPLACEMENT)
+        {
+            ZYAN_UNUSED((item->action == ZYREX_OPERATION_ACTION_ATTACH)
+                ? ZyrexWriteReplacementCode(item->replacement, item->replacement->original_code)
+                : ZyrexWriteReplacementJump(item->replacement));
+            continue;
+        }
+        if (item->type != ZYREX_HOOK_TYPE_INLINE)
+        {
+            continue;
+        }
+
+        switch (item->action)
+        {
+        case ZYREX_OPERATION_ACTION_ATTACH:
+            ZYAN_UNUSED(ZyrexMigrateThreads(&item->trampoline->code_buffer,
+                item->trampoline->code_buffer_size, item->address,
+                item->trampoline->original_code_size, &item->trampoline->translation_map,
+                ZYREX_THREAD_MIGRATION_DIRECTION_DST_SRC));
+            ZYAN_UNUSED(ZyrexRestoreInstructions(item->address, item->trampoline));
+            break;
+        case ZYREX_OPERATION_ACTION_REMOVE:
+            ZYAN_UNUSED(ZyrexMigrateThreads(item->address, item->trampoline->original_code_size,
+                &item->trampoline->code_buffer, item->trampoline->code_buffer_size,
+                &item->trampoline->translation_map, ZYREX_THREAD_MIGRATION_DIRECTION_SRC_DST));
+            ZYAN_UNUSED(ZyrexWriteHookJump(item->address, item->trampoline));
+            break;
+        default:
+            ZYAN_UNREACHABLE;
+        }
+    }
+
+    ZyrexProtectedRegionsSynchronize(&g_transaction_data.regions);
+    ZyrexProtectedRegionsRestore(&g_transaction_data.regions);
+}
+
+/**
+ * @brief   Performs the given range of hook attach/remove operations and migrates all threads in
+ *          the thread-update list.
+ *
+ * @param   operations          A pointer to the vector of pending operations.
+ * @param   first               The index of the first operation.
+ * @param   count               The number of operations.
+ * @param   failed_operation    Receives the trampoline address of the operation that failed the
+ *                              transaction or `ZYAN_NULL`. This parameter is optional.
+ * @param   applied_count       Receives the number of operations that were applied.
+ *
+ * @return  `ZYREX_STATUS_CODE_MODIFIED`, if the code of a hook target was modified after the hook
+ *          was added, or a generic zyan status code.
+ *
+ * The caller has to hold the patch lock. The trampolines of removed hooks are not released by
+ * this function, as a suspended thread might hold the trampoline lock.
+ *
+ * The code of all hook targets is verified before the first byte is written. No operation is
+ * applied, if the verification fails. If writing an operation fails, that operation and all
+ * operations of the range that were already applied are reverted, so either all or none of the
+ * operations are applied.
+ */
+static ZyanStatus ZyrexPatchPhaseCommit(const ZyanVector* operations, ZyanUSize first,
+    ZyanUSize count, const void** failed_operation, ZyanUSize* applied_count)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(first + count <= operations->size);
+    ZYAN_ASSERT(applied_count);
+
+    *applied_count = 0;
+    if (failed_operation)
+    {
+        *failed_operation = ZYAN_NULL;
+    }
+
+    ZYAN_CHECK(ZyrexVerifyPendingOperations(operations, first, count, failed_operation));
+
+    ZyanStatus status = ZyrexUnprotectPendingOperations(operations, first, count);
+    const ZyanBool is_unprotected = ZYAN_SUCCESS(status);
+    ZyanISize i = (ZyanISize)first;
+    for (; ZYAN_SUCCESS(status) && (i < (ZyanISize)(first + count)); ++i)
+    {
+        const ZyrexOperation* item = ZyanVectorGet(operations, i);
+        ZYAN_ASSERT(item);
+
+        switch (item->type)
+        {
+        case ZYREX_HOOK_TYPE_INLINE:
+            switch (item->action)
+            {
+            case ZYREX_OPERATION_ACTION_ATTACH:
+            {
+                status = ZyrexMigrateThreads(item->address, item->trampoline->original_code_size,
+                    &item->trampoline->code_buffer, item->trampoline->code_buffer_size,
+                    &item->trampoline->translation_map,
+                    ZYREX_THREAD_MIGRATION_DIRECTION_SRC_DST);
+                if (ZYAN_SUCCESS(status))
+                {
+                    status = ZyrexWriteHookJump(item->address, item->trampoline);
+                }
+                break;
+            }
+            case ZYREX_OPERATION_ACTION_REMOVE:
+            {
+                status = ZyrexMigrateThreads(&item->trampoline->code_buffer,
+                    item->trampoline->code_buffer_size, item->address,
+                    item->trampoline->original_code_size, &item->trampoline->translation_map,
+                    ZYREX_THREAD_MIGRATION_DIRECTION_DST_SRC);
+                if (ZYAN_SUCCESS(status))
+                {
+                    status = ZyrexRestoreInstructions(item->address, item->trampoline);
+                }
+                break;
+            }
+            default:
+                ZYAN_UNREACHABLE;
+            }
+            break;
+        case ZYREX_HOOK_TYPE_EXCEPTION:
+            break;
+        case ZYREX_HOOK_TYPE_CONTEXT:
+            break;
+        case ZYREX_HOOK_TYPE_CALL_SITE:
+            // The call site is a single instruction, which does not require thread migration
+            status = ZyrexWriteCallSiteTarget(item->address, item->target);
+            break;
+        case ZYREX_HOOK_TYPE_REPLACEMENT:
+            // The original code is never executed again, so there is no code to migrate threads to
+            status = (item->action == ZYREX_OPERATION_ACTION_ATTACH)
+                ? ZyrexWriteReplacementJump(item->replacement)
+                : ZyrexWriteReplacementCode(item->replacement, item->replacement->original_code);
+            break;
+        default:
+            ZYAN_UNREACHABLE;
+        }
+
+        if (!ZYAN_SUCCESS(status))
+        {
+            if (failed_operation && (item->type == ZYREX_HOOK_TYPE_INLINE))
+            {
+                *failed_operation = &item->trampoline->code_buffer;
+            }
+            if (failed_operation && (item->type != ZYREX_HOOK_TYPE_INLINE))
+            {
+                *failed_operation = item->address;
+            }
+            break;
+        }
+    }
+
+    if (is_unprotected)
+    {
+        // A single cross-core serialization covers all code that was written
+        ZyrexProtectedRegionsSynchronize(&g_transaction_data.regions);
+        ZyrexProtectedRegionsRestore(&g_transaction_data.regions);
+    }
+
+    if (!ZYAN_SUCCESS(status))
+    {
+        // The failed operation might have been written partially
+        if (is_unprotected)
+        {
+            ZyrexPatchPhaseRevert(operations, first, (ZyanUSize)i - first + 1);
+        }
+        return status;
+    }
+
+    *applied_count = count;
+
+    return status;
+}
+
+/**
+ * @brief   Returns the end of the group of consecutive operations that patch the same page as the
+ *          operation at the given index.
+ *
+ * @param   operations  A pointer to the vector of pending operations.
+ * @param   first       The index of the first operation of the group.
+ *
+ * @return  The index behind the last operation of the group.
+ */
+static ZyanUSize ZyrexGetPageGroupEnd(const ZyanVector* operations, ZyanUSize first)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(first < operations->size);
+
+    const ZyanUPointer page_size = ZyanMemoryGetSystemPageSize();
+
+    const ZyrexOperation* const item = ZyanVectorGet(operations, first);
+    ZYAN_ASSERT(item);
+    const ZyanUPointer page = ZYAN_ALIGN_DOWN((ZyanUPointer)item->address, page_size);
+
+    ZyanUSize end = first + 1;
+    for (; end < operations->size; ++end)
+    {
+        const ZyrexOperation* const current = ZyanVectorGet(operations, end);
+        ZYAN_ASSERT(current);
+
+        if (ZYAN_ALIGN_DOWN((ZyanUPointer)current->address, page_size) != page)
+        {
+            break;
+        }
+    }
+
+    return end;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transaction                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `ZyrexTransaction` struct.
+ *
+ * @param   transaction A pointer to the `ZyrexTransaction` struct.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexTransactionInit(ZyrexTransaction* transaction)
+{
+    ZYAN_ASSERT(transaction);
+
+    ZYAN_CHECK(ZyanVectorInit(&transaction->pending_operations, sizeof(ZyrexOperation), 16,
+        ZYAN_NULL));
+
+    const ZyanStatus status = ZyanVectorInit(&transaction->thread_ids, sizeof(ZyanThreadId), 8,
+        ZYAN_NULL);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyanVectorDestroy(&transaction->pending_operations);
+        return status;
+    }
+
+    transaction->update_all_threads = ZYAN_FALSE;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Finalizes the given `ZyrexTransaction` struct.
+ *
+ * @param   transaction A pointer to the `ZyrexTransaction` struct.
+ */
+static void ZyrexTransactionFinalize(ZyrexTransaction* transaction)
+{
+    ZYAN_ASSERT(transaction);
+
+    ZyanVectorDestroy(&transaction->pending_operations);
+    ZyanVectorDestroy(&transaction->thread_ids);
+}
+
+/**
+ * @brief   Releases the trampolines and replacement hooks of the first `count` operations that
+ *          match the given `action`.
+ *
+ * @param   operations  A pointer to the vector of operations.
+ * @param   count       The number of operations to process.
+ * @param   action      The operation action.
+ */
+static void ZyrexFreeTrampolines(const ZyanVector* operations, ZyanUSize count,
+    ZyrexOperationAction action)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(count <= operations->size);
+
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        const ZyrexOperation* const item = ZyanVectorGet(operations, i);
+        ZYAN_ASSERT(item);
+
+        if (item->action != action)
+        {
+            continue;
+        }
+        // The trampolines of removed inline hooks are released by the hook registry, as
+        // lock-free readers might still access them
+        if ((item->type == ZYREX_HOOK_TYPE_INLINE) && (action == ZYREX_OPERATION_ACTION_ATTACH))
+        {
+            ZYAN_UNUSED(ZyrexTrampolineFree(item->trampoline));
+        }
+        if (item->type == ZYREX_HOOK_TYPE_REPLACEMENT)
+        {
+            ZYAN_FREE(item->replacement);
+        }
+    }
+}
+
+/**
+ * @brief   Counts the inline hook operations, which update the hook registry.
+ *
+ * @param   operations      A pointer to the vector of operations.
+ * @param   first           The index of the first operation.
+ * @param   insert_count    Receives the number of inline hooks that are attached.
+ * @param   remove_count    Receives the number of inline hooks that are removed.
+ */
+static void ZyrexCountRegistryOperations(const ZyanVector* operations, ZyanUSize first,
+    ZyanUSize* insert_count, ZyanUSize* remove_count)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(first <= operations->size);
+    ZYAN_ASSERT(insert_count);
+    ZYAN_ASSERT(remove_count);
+
+    *insert_count = 0;
+    *remove_count = 0;
+    for (ZyanUSize i = first; i < operations->size; ++i)
+    {
+        const ZyrexOperation* const item = ZyanVectorGet(operations, i);
+        ZYAN_ASSERT(item);
+
+        if (item->type == ZYREX_HOOK_TYPE_INLINE)
+        {
+            *insert_count += (item->action == ZYREX_OPERATION_ACTION_ATTACH) ? 1 : 0;
+            *remove_count += (item->action == ZYREX_OPERATION_ACTION_REMOVE) ? 1 : 0;
+        }
+    }
+}
+
+/**
+ * @brief   Reserves room in the hook registry for all inline hook operations of the given
+ *          transactions.
+ *
+ * @param   transactions    A pointer to an array of `ZyrexTransaction` pointers.
+ * @param   count           The number of transactions.
+ *
+ * @return  A zyan status code.
+ *
+ * Every transaction has to be passed to `ZyrexRegisterOperations` afterwards, which consumes or
+ * releases the reservation.
+ */
+static ZyanStatus ZyrexReserveRegistry(ZyrexTransaction* const* transactions, ZyanUSize count)
+{
+    ZYAN_ASSERT(transactions || !count);
+
+    ZyanUSize insert_count = 0;
+    ZyanUSize remove_count = 0;
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        ZyanUSize inserts;
+        ZyanUSize removals;
+        ZyrexCountRegistryOperations(&transactions[i]->pending_operations, 0, &inserts,
+            &removals);
+        insert_count += inserts;
+        remove_count += removals;
+    }
+
+    return ZyrexHookRegistryReserve(insert_count, remove_count);
+}
+
+/**
+ * @brief   Updates the hook registry for the first `count` operations, which were applied.
+ *
+ * @param   operations  A pointer to the vector of operations.
+ * @param   count       The number of applied operations.
+ *
+ * The trampolines of removed hooks are handed over to the hook registry. The reservation of the
+ * remaining operations is released.
+ *
+ * This function has to be called after all threads were resumed.
+ */
+static void ZyrexRegisterOperations(const ZyanVector* operations, ZyanUSize count)
+{
+    ZYAN_ASSERT(operations);
+    ZYAN_ASSERT(count <= operations->size);
+
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        const ZyrexOperation* const item = ZyanVectorGet(operations, i);
+        ZYAN_ASSERT(item);
+
+        if (item->type != ZYREX_HOOK_TYPE_INLINE)
+        {
+            continue;
+        }
+
+        switch (item->action)
+        {
+        case ZYREX_OPERATION_ACTION_ATTACH:
+            ZyrexHookRegistryInsert(item->trampoline);
+            break;
+        case ZYREX_OPERATION_ACTION_REMOVE:
+            ZyrexHookRegistryRemove(item->trampoline);
+            break;
+        default:
+            ZYAN_UNREACHABLE;
+        }
+    }
+
+    ZyanUSize insert_count;
+    ZyanUSize remove_count;
+    ZyrexCountRegistryOperations(operations, count, &insert_count, &remove_count);
+    ZyrexHookRegistryUnreserve(insert_count, remove_count);
+}
+
+/**
+ * @brief   Records the code that is retired by the given operation, if the stack check is
+ *          enabled.
+ *
+ * @param   operation   A pointer to the `ZyrexOperation` struct.
+ * @param   function    The entry address of the retired function.
+ * @param   size        The number of bytes to check, if the bounds of the function are unknown.
+ */
+static void ZyrexOperationSetRetiredCode(ZyrexOperation* operation, const void* function,
+    ZyanUSize size)
+{
+    ZYAN_ASSERT(operation);
+    ZYAN_ASSERT(function);
+
+    if (!g_transaction_data.is_stack_check_enabled)
+    {
+        return;
+    }
+
+    // The function index is queried while preparing the transaction, as it might allocate
+    // memory or wait for a lock that is held by a suspended thread
+    if (!ZYAN_SUCCESS(ZyrexFunctionIndexGetFunctionRange(function, &operation->retired_begin,
+        &operation->retired_end)))
+    {
+        operation->retired_begin = (ZyanUPointer)function;
+        operation->retired_end = (ZyanUPointer)function + size;
+    }
+}
+
+/**
+ * @brief   Adds an inline hook to the given transaction.
+ *
+ * @param   transaction A pointer to the `ZyrexTransaction` struct.
+ * @param   address     The address to hook.
+ * @param   callback    The callback address.
+ * @param   patch_size  The size of the patch window.
+ * @param   flags       A combination of `ZyrexInlineHookFlags` values.
+ * @param   trampoline  Receives the address of the trampoline to the original function.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexTransactionAddInlineHook(ZyrexTransaction* transaction, void* address,
+    const void* callback, ZyanUSize patch_size, ZyanU32 flags, ZyanConstVoidPointer* trampoline)
+{
+    ZYAN_ASSERT(transaction);
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(callback);
+    ZYAN_ASSERT(trampoline);
+
+    ZyrexOperation operation =
+    {
+        /* type                */ ZYREX_HOOK_TYPE_INLINE,
+        /* action              */ ZYREX_OPERATION_ACTION_ATTACH,
+        /* address             */ ZYAN_NULL,
+        /* trampoline          */ ZYAN_NULL,
+        /* target              */ ZYAN_NULL,
+        /* expected_target     */ ZYAN_NULL,
+        /* replacement         */ ZYAN_NULL,
+        /* retired_begin       */ 0,
+        /* retired_end         */ 0
+    };
+    ZYAN_CHECK(ZyrexTrampolineCreate(address, callback, patch_size, &operation.trampoline));
+    operation.address = ZyrexTrampolineGetPatchAddress(operation.trampoline);
+    ZyrexOperationSetRetiredCode(&operation, address, operation.trampoline->original_code_size);
+
+    ZyanStatus status = ZyrexSelectHookJumpDestination(operation.trampoline, flags);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyanVectorPushBack(&transaction->pending_operations, &operation);
+    }
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZYAN_UNUSED(ZyrexTrampolineFree(operation.trampoline));
+        return status;
+    }
+
+    *trampoline = &operation.trampoline->code_buffer;
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Adds multiple inline hooks to the given transaction.
+ *
+ * @param   transaction A pointer to the `ZyrexTransaction` struct.
+ * @param   specs       A pointer to an array of `ZyrexHookSpec` structs.
+ * @param   count       The number of elements in the `specs` array.
+ * @param   results     A pointer to an array of `count` status codes that receives the result for
+ *                      each individual hook.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexTransactionAddInlineHooks(ZyrexTransaction* transaction,
+    const ZyrexHookSpec* specs, ZyanUSize count, ZyanStatus* results)
+{
+    ZYAN_ASSERT(transaction);
+    ZYAN_ASSERT(specs);
+    ZYAN_ASSERT(results);
+
+    if (count == 0)
+    {
+        return ZYAN_STATUS_SUCCESS;
+    }
+
+    // TODO: Replace with ZyanMemoryAlloc in the future
+    ZyrexBatchItem* const items = ZYAN_MALLOC(count * sizeof(ZyrexBatchItem));
+    if (!items)
+    {
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    }
+
+    ZyrexBatchContext context;
+    context.specs = specs;
+    context.items = items;
+
+    // Analyze all target functions in parallel. This step decodes the prologues and determines
+    // the address range each trampoline chunk has to reach
+    ZyanStatus status = ZyrexParallelFor(count, &ZyrexBatchAnalyze, &context);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZYAN_FREE(items);
+        return status;
+    }
+
+    // Process the targets in ascending address order. Neighbouring functions share their
+    // trampoline-region, which lets the chunk placement reuse the previous region lookup, and the
+    // operations are enqueued in the order in which the commit touches the prologue pages
+    // TODO: Replace with ZyanMemoryAlloc in the future
+    ZyrexBatchOrderItem* const order = ZYAN_MALLOC(count * sizeof(ZyrexBatchOrderItem));
+    if (!order)
+    {
+        ZYAN_FREE(items);
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    }
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        order[i].address = (ZyanUPointer)specs[i].address;
+        order[i].index = i;
+    }
+    qsort(order, count, sizeof(ZyrexBatchOrderItem), &ZyrexBatchCompareOrderItem);
+
+    // Chunk placement modifies the global trampoline-region list and has to be done serially
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        ZyrexBatchItem* const item = &items[order[i].index];
+
+        if (!ZYAN_SUCCESS(item->status))
+        {
+            continue;
+        }
+        item->status = ZyrexTrampolineReserve(&item->analysis, &item->trampoline);
+    }
+
+    // Relocate all prologues in parallel. The code is written to private buffers, but the
+    // relative offsets are already calculated against the final chunk addresses
+    status = ZyrexParallelFor(count, &ZyrexBatchRelocate, &context);
+
+    // Publish the trampoline chunks and enqueue the operations
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyanVectorReserve(&transaction->pending_operations,
+            transaction->pending_operations.size + count);
+    }
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        const ZyanUSize index = order[i].index;
+        ZyrexBatchItem* const item = &items[index];
+
+        if (ZYAN_SUCCESS(item->status) && !ZYAN_SUCCESS(status))
+        {
+            item->status = status;
+        }
+        if (ZYAN_SUCCESS(item->status))
+        {
+            item->status = ZyrexTrampolinePublish(item->trampoline, &item->buffer);
+        }
+        if (ZYAN_SUCCESS(item->status))
+        {
+            ZyrexOperation operation =
+            {
+                /* type                */ ZYREX_HOOK_TYPE_INLINE,
+                /* action              */ ZYREX_OPERATION_ACTION_ATTACH,
+                /* address             */ ZYAN_NULL,
+                /* trampoline          */ ZYAN_NULL,
+                /* target              */ ZYAN_NULL,
+                /* expected_target     */ ZYAN_NULL,
+                /* replacement         */ ZYAN_NULL,
+                /* retired_begin       */ 0,
+                /* retired_end         */ 0
+            };
+            operation.address = ZyrexTrampolineGetPatchAddress(item->trampoline);
+            operation.trampoline = item->trampoline;
+            ZyrexOperationSetRetiredCode(&operation, specs[index].address,
+                item->trampoline->original_code_size);
+
+            item->status = ZyanVectorPushBack(&transaction->pending_operations, &operation);
+        }
+
+        if (ZYAN_SUCCESS(item->status))
+        {
+            *specs[index].trampoline = &item->trampoline->code_buffer;
+        } else if (item->trampoline)
+        {
+            ZYAN_UNUSED(ZyrexTrampolineFree(item->trampoline));
+        }
+
+        results[index] = item->status;
+    }
+
+    ZYAN_FREE(order);
+    ZYAN_FREE(items);
+
+    return status;
+}
+
+/**
+ * @brief   Adds the removal of an inline hook to the given transaction.
+ *
+ * @param   transaction A pointer to the `ZyrexTransaction` struct.
+ * @param   original    A pointer to the trampoline address received during the hook attaching.
+ *                      Receives the address of the original function.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexTransactionAddInlineHookRemoval(ZyrexTransaction* transaction,
+    ZyanConstVoidPointer* original)
+{
+    ZYAN_ASSERT(transaction);
+    ZYAN_ASSERT(original);
+
+    ZyrexTrampolineChunk* trampoline;
+    const ZyanStatus status = ZyrexTrampolineFind(*original, &trampoline);
+    ZYAN_CHECK(status);
+    if (status == ZYAN_STATUS_FALSE)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
+
+    ZyrexOperation operation =
+    {
+        /* type                */ ZYREX_HOOK_TYPE_INLINE,
+        /* action              */ ZYREX_OPERATION_ACTION_REMOVE,
+        /* address             */ ZYAN_NULL,
+        /* trampoline          */ ZYAN_NULL,
+        /* target              */ ZYAN_NULL,
+        /* expected_target     */ ZYAN_NULL,
+        /* replacement         */ ZYAN_NULL,
+        /* retired_begin       */ 0,
+        /* retired_end         */ 0
+    };
+    operation.address = ZyrexTrampolineGetPatchAddress(trampoline);
+    operation.trampoline = trampoline;
+    ZyrexOperationSetRetiredCode(&operation,
+        (const void*)trampoline->callback->user_callback_address, 1);
+
+    ZYAN_CHECK(ZyanVectorPushBack(&transaction->pending_operations, &operation));
+
+    *original = ZyrexTrampolineGetTargetAddress(trampoline);
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Adds a call-site operation to the given transaction.
+ *
+ * @param   transaction A pointer to the `ZyrexTransaction` struct.
+ * @param   action      The operation action.
+ * @param   address     The address of the `call rel32` or `jmp rel32` instruction.
+ * @param   target      The new branch target.
+ * @param   original    Receives the current branch target. This parameter is optional.
+ *
+ * @return  `ZYAN_STATUS_OUT_OF_RANGE`, if the new branch target is not within reach of the call
+ *          site or a generic zyan status code.
+ */
+static ZyanStatus ZyrexTransactionAddCallSiteOperation(ZyrexTransaction* transaction,
+    ZyrexOperationAction action, void* address, const void* target,
+    ZyanConstVoidPointer* original)
+{
+    ZYAN_ASSERT(transaction);
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(target);
+
+    if (!ZyrexIsCallSite(address))
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+    if (!ZyrexIsRelativeBranchReachable((ZyanUPointer)address, (ZyanUPointer)target))
+    {
+        return ZYAN_STATUS_OUT_OF_RANGE;
+    }
+
+    ZyrexOperation operation =
+    {
+        /* type                */ ZYREX_HOOK_TYPE_CALL_SITE,
+        /* action              */ action,
+        /* address             */ address,
+        /* trampoline          */ ZYAN_NULL,
+        /* target              */ ZYAN_NULL,
+        /* expected_target     */ ZYAN_NULL,
+        /* replacement         */ ZYAN_NULL,
+        /* retired_begin       */ 0,
+        /* retired_end         */ 0
+    };
+    operation.target = target;
+    operation.expected_target = ZyrexGetCallSiteTarget(address);
+
+    ZYAN_CHECK(ZyanVectorPushBack(&transaction->pending_operations, &operation));
+
+    if (original)
+    {
+        *original = operation.expected_target;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Adds a replacement hook to the given transaction.
+ *
+ * @param   transaction A pointer to the `ZyrexTransaction` struct.
+ * @param   address     The address of the function to replace.
+ * @param   replacement The address of the replacement function.
+ * @param   hook        Receives the replacement hook handle.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexTransactionAddReplacementHook(ZyrexTransaction* transaction,
+    void* address, const void* replacement, ZyrexReplacementHook** hook)
+{
+    ZYAN_ASSERT(transaction);
+    ZYAN_ASSERT(address);
+    ZYAN_ASSERT(replacement);
+    ZYAN_ASSERT(hook);
+
+    ZyanU8 patch_size = ZYREX_SIZEOF_RELATIVE_JUMP;
+    if (!ZyrexIsRelativeBranchReachable((ZyanUPointer)address, (ZyanUPointer)replacement))
+    {
+        // Relative jumps reach the whole address space on x86, so this only happens on x64
+        patch_size = ZYREX_SIZEOF_INLINE_ABSOLUTE_JUMP;
+    }
+
+    ZYAN_CHECK(ZyrexFunctionIndexValidatePatchWindow(address, address, patch_size));
+
+    ZydisDecoder decoder;
+#if defined(ZYAN_X86)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_COMPAT_32, ZYDIS_STACK_WIDTH_32);
+#elif defined(ZYAN_X64)
+    ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+#else
+#   error "Unsupported architecture detected"
+#endif
+
+    ZydisDecodedInstruction instruction;
+    const ZyanBool is_single_instruction =
+        ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&decoder, ZYAN_NULL, address,
+            ZYDIS_MAX_INSTRUCTION_LENGTH, &instruction)) && (instruction.length >= patch_size);
+
+    ZyrexReplacementHook* const data = ZYAN_MALLOC(sizeof(ZyrexReplacementHook));
+    if (!data)
+    {
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
+    }
+    data->address = address;
+    data->replacement = replacement;
+    data->patch_size = patch_size;
+    data->is_single_instruction = is_single_instruction;
+    ZYAN_MEMCPY(data->original_code, address, patch_size);
+
+    ZyrexOperation operation =
+    {
+        /* type                */ ZYREX_HOOK_TYPE_REPLACEMENT,
+        /* action              */ ZYREX_OPERATION_ACTION_ATTACH,
+        /* address             */ address,
+        /* trampoline          */ ZYAN_NULL,
+        /* target              */ ZYAN_NULL,
+        /* expected_target     */ ZYAN_NULL,
+        /* replacement         */ ZYAN_NULL,
+        /* retired_begin       */ 0,
+        /* retired_end         */ 0
+    };
+    operation.replacement = data;
+    ZyrexOperationSetRetiredCode(&operation, address, patch_size);
+
+    const ZyanStatus status = ZyanVectorPushBack(&transaction->pending_operations, &operation);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZYAN_FREE(data);
+        return status;
+    }
+
+    *hook = data;
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Adds the removal of a replacement hook to the given transaction.
+ *
+ * @param   transaction A pointer to the `ZyrexTransaction` struct.
+ * @param   hook        The replacement hook handle.
+ *
+ * @return  A zyan status code.
+ */
+static ZyanStatus ZyrexTransactionAddReplacementHookRemoval(ZyrexTransaction* transaction,
+    ZyrexReplacementHook* hook)
+{
+    ZYAN_ASSERT(transaction);
+    ZYAN_ASSERT(hook);
+
+    ZyrexOperation operation =
+    {
+        /* type                */ ZYREX_HOOK_TYPE_REPLACEMENT,
+        /* action              */ ZYREX_OPERATION_ACTION_REMOVE,
+        /* address             */ ZYAN_NULL,
+        /* trampoline          */ ZYAN_NULL,
+        /* target              */ ZYAN_NULL,
+        /* expected_target     */ ZYAN_NULL,
+        /* replacement         */ ZYAN_NULL,
+        /* retired_begin       */ 0,
+        /* retired_end         */ 0
+    };
+    operation.address = hook->address;
+    operation.replacement = hook;
+    ZyrexOperationSetRetiredCode(&operation, hook->replacement, 1);
+
+    return ZyanVectorPushBack(&transaction->pending_operations, &operation);
+}
+
+/**
+ * @brief   Suspends the threads of all given transactions and adds them to the list of threads to
+ *          be updated by the current patch phase.
+ *
+ * @param   transactions    A pointer to the array of transactions in the batch.
+ * @param   count           The number of transactions in the batch.
+ *
+ * @return  A zyan status code.
+ *
+ * The caller has to hold the patch lock.
+ *
+ * The thread registry is acquired before the first thread is suspended, as a suspended thread
+ * might hold its lock. If the thread-update list turns out to be too small, all threads are
+ * resumed, the list is grown and the threads are suspended again.
+ */
+static ZyanStatus ZyrexPatchPhaseSuspendThreads(ZyrexTransaction* const* transactions,
+    ZyanUSize count)
+{
+    ZYAN_ASSERT(transactions || !count);
+
+    while (ZYAN_TRUE)
+    {
+        ZyanStatus status = ZYAN_STATUS_SUCCESS;
+        for (ZyanUSize i = 0; i < count; ++i)
+        {
+            if (transactions[i]->update_all_threads)
+            {
+                status = ZyrexPatchPhaseUpdateAllThreads();
+                break;
+            }
+        }
+        for (ZyanUSize i = 0; ZYAN_SUCCESS(status) && (i < count); ++i)
+        {
+            const ZyanVector* const thread_ids = &transactions[i]->thread_ids;
+            for (ZyanUSize j = 0; ZYAN_SUCCESS(status) && (j < thread_ids->size); ++j)
+            {
+                const ZyanThreadId* const thread_id = ZyanVectorGet(thread_ids, j);
+                ZYAN_ASSERT(thread_id);
+
+                // Threads that exited after they were added to the transaction are skipped
+                status = ZyrexPatchPhaseUpdateThread(*thread_id);
+                if (status == ZYAN_STATUS_NOT_FOUND)
                 {
-                    if (SuspendThread(h_thread) == (DWORD)(-1))
-                    {
-                        CloseHandle(h_thread);
-                    }
-                    else
-                    {
-                        ZyanVectorPushBack(&g_transaction_data.threads_to_update, &h_thread);
-                    }
+                    status = ZYAN_STATUS_SUCCESS;
                 }
             }
-        } while (Thread32Next(h_snapshot, &thread));
+        }
+
+        if (status != ZYAN_STATUS_INSUFFICIENT_BUFFER_SIZE)
+        {
+            return status;
+        }
+
+#if defined(ZYAN_WINDOWS) || defined(ZYAN_LINUX)
+        const ZyanUSize capacity = g_transaction_data.threads_to_update.capacity * 2;
+#else
+        const ZyanUSize capacity = 0;
+#endif
+        ZyrexResumeAllThreads();
+        ZYAN_CHECK(ZyrexThreadListInit(capacity));
+    }
+}
+
+/**
+ * @brief   Waits until no suspended thread executes or returns into code that is retired by the
+ *          given range of operations.
+ *
+ * @param   transactions        A pointer to the array of transactions in the batch.
+ * @param   count               The number of transactions in the batch.
+ * @param   operations          A pointer to the vector of pending operations.
+ * @param   first               The index of the first operation.
+ * @param   n                   The number of operations.
+ * @param   failed_operation    Receives the address of the first operation whose code is still
+ *                              in use after the last retry. This parameter is optional.
+ *
+ * @return  `ZYREX_STATUS_UNSAFE_THREAD_STATE`, if the code is still in use after the configured
+ *          number of retries or a zyan status code.
+ *
+ * The caller has to hold the patch lock and the threads of all transactions in the batch have to
+ * be suspended. Before each retry, all threads are resumed for the configured delay, which gives
+ * them a chance to leave the retired code, and are suspended again afterwards.
+ */
+static ZyanStatus ZyrexPatchPhaseWaitForSafeStacks(ZyrexTransaction* const* transactions,
+    ZyanUSize count, const ZyanVector* operations, ZyanUSize first, ZyanUSize n,
+    const void** failed_operation)
+{
+    ZYAN_ASSERT(transactions);
+
+    for (ZyanU32 attempt = 0; ; ++attempt)
+    {
+        const ZyanStatus status = ZyrexCheckThreadStacks(operations, first, n, failed_operation);
+        if ((status != ZYREX_STATUS_UNSAFE_THREAD_STATE) ||
+            (attempt >= g_transaction_data.stack_check_retries))
+        {
+            return status;
+        }
+
+        ZyrexResumeAllThreads();
+        if (g_transaction_data.stack_check_delay)
+        {
+            ZyanThreadSleep(g_transaction_data.stack_check_delay);
+        } else
+        {
+            ZyanThreadYield();
+        }
+
+        ZYAN_CHECK(ZyrexPatchPhaseSuspendThreads(transactions, count));
+    }
+}
+
+/**
+ * @brief   Commits the operations of one transaction of a batch in slices that keep the threads
+ *          suspended for at most the configured pause budget.
+ *
+ * @param   transactions        A pointer to the array of transactions in the batch.
+ * @param   count               The number of transactions in the batch.
+ * @param   index               The index of the transaction to commit.
+ * @param   failed_operation    Receives the trampoline address of the operation that failed the
+ *                              transaction or `ZYAN_NULL`. This parameter is optional.
+ * @param   applied_count       Receives the number of operations that were applied.
+ *
+ * @return  `ZYREX_STATUS_CODE_MODIFIED`, if the code of a hook target was modified after the hook
+ *          was added, or a generic zyan status code.
+ *
+ * The caller has to hold the patch lock and the threads of all transactions in the batch have to
+ * be suspended.
+ *
+ * Operations are applied in groups of consecutive operations on the same page. Once the pause
+ * budget is exceeded, all threads are resumed and the threads of the batch are suspended again
+ * before the next group is applied. The transaction stays atomic: if any group fails, all
+ * operations applied by earlier slices are reverted and `applied_count` is set to `0`.
+ */
+static ZyanStatus ZyrexPatchPhaseCommitSliced(ZyrexTransaction* const* transactions,
+    ZyanUSize count, ZyanUSize index, const void** failed_operation, ZyanUSize* applied_count)
+{
+    ZYAN_ASSERT(transactions);
+    ZYAN_ASSERT(index < count);
+    ZYAN_ASSERT(applied_count);
+
+    const ZyanVector* const operations = &transactions[index]->pending_operations;
+
+    *applied_count = 0;
+    if (failed_operation)
+    {
+        *failed_operation = ZYAN_NULL;
+    }
+
+    // All targets are verified up front, as no slice must be applied if a later one would fail
+    ZYAN_CHECK(ZyrexVerifyPendingOperations(operations, 0, operations->size, failed_operation));
+
+    ZyanStatus status = ZYAN_STATUS_SUCCESS;
+    ZyanUSize applied = 0;
+    for (ZyanUSize first = 0; first < operations->size;)
+    {
+        if (first && g_transaction_data.pause_begin && (ZyrexGetTimestamp() -
+            g_transaction_data.pause_begin >= g_transaction_data.pause_budget))
+        {
+            ZyrexResumeAllThreads();
+            ZyanThreadYield();
+
+            status = ZyrexPatchPhaseSuspendThreads(transactions, count);
+            if (!ZYAN_SUCCESS(status))
+            {
+                break;
+            }
+        }
+
+        const ZyanUSize end = ZyrexGetPageGroupEnd(operations, first);
+
+        status = ZyrexPatchPhaseWaitForSafeStacks(transactions, count, operations, first,
+            end - first, failed_operation);
+        if (!ZYAN_SUCCESS(status))
+        {
+            break;
+        }
+
+        ZyanUSize group_applied;
+        status = ZyrexPatchPhaseCommit(operations, first, end - first, failed_operation,
+            &group_applied);
+        applied += group_applied;
+        if (!ZYAN_SUCCESS(status))
+        {
+            break;
+        }
+
+        first = end;
+    }
+
+    if (!ZYAN_SUCCESS(status) && applied)
+    {
+        ZyrexPatchPhaseRevert(operations, 0, applied);
+        applied = 0;
+    }
+
+    *applied_count = applied;
+
+    return status;
+}
+
+/**
+ * @brief   Commits the operations of one transaction of a batch, either at once or in slices, if
+ *          a pause budget is configured.
+ *
+ * @param   transactions        A pointer to the array of transactions in the batch.
+ * @param   count               The number of transactions in the batch.
+ * @param   index               The index of the transaction to commit.
+ * @param   failed_operation    Receives the trampoline address of the operation that failed the
+ *                              transaction or `ZYAN_NULL`. This parameter is optional.
+ * @param   applied_count       Receives the number of operations that were applied.
+ *
+ * @return  `ZYREX_STATUS_CODE_MODIFIED`, if the code of a hook target was modified after the hook
+ *          was added, or a generic zyan status code.
+ *
+ * The caller has to hold the patch lock.
+ */
+static ZyanStatus ZyrexPatchPhaseCommitTransaction(ZyrexTransaction* const* transactions,
+    ZyanUSize count, ZyanUSize index, const void** failed_operation, ZyanUSize* applied_count)
+{
+    ZYAN_ASSERT(transactions);
+    ZYAN_ASSERT(index < count);
+
+    if (g_transaction_data.pause_budget)
+    {
+        return ZyrexPatchPhaseCommitSliced(transactions, count, index, failed_operation,
+            applied_count);
+    }
+
+    const ZyanVector* const operations = &transactions[index]->pending_operations;
+
+    *applied_count = 0;
+    ZYAN_CHECK(ZyrexPatchPhaseWaitForSafeStacks(transactions, count, operations, 0,
+        operations->size, failed_operation));
+
+    return ZyrexPatchPhaseCommit(operations, 0, operations->size, failed_operation,
+        applied_count);
+}
+
+/**
+ * @brief   Finishes the given transaction after its operations were committed and all threads
+ *          were resumed.
+ *
+ * @param   transaction     A pointer to the `ZyrexTransaction` struct.
+ * @param   applied_count   The number of operations that were applied.
+ * @param   status          The status code of the commit.
+ *
+ * @return  The status code of the commit or a generic zyan status code.
+ *
+ * The hook registry is updated and the reservation of the operations that were not applied is
+ * released. The transaction is left untouched, if none of its operations were applied.
+ * Otherwise the trampolines of removed hooks are released and the transaction is cleared for
+ * reuse.
+ */
+static ZyanStatus ZyrexTransactionFinish(ZyrexTransaction* transaction, ZyanUSize applied_count,
+    ZyanStatus status)
+{
+    ZYAN_ASSERT(transaction);
+
+    ZyrexRegisterOperations(&transaction->pending_operations, applied_count);
+    if (!ZYAN_SUCCESS(status) && !applied_count)
+    {
+        return status;
+    }
+
+    ZyrexFreeTrampolines(&transaction->pending_operations, applied_count,
+        ZYREX_OPERATION_ACTION_REMOVE);
+    ZYAN_CHECK(ZyanVectorClear(&transaction->pending_operations));
+    ZYAN_CHECK(ZyanVectorClear(&transaction->thread_ids));
+    transaction->update_all_threads = ZYAN_FALSE;
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Global transaction                                                                             */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Checks, if the global transaction was started by the calling thread.
+ *
+ * @return  `ZYAN_STATUS_INVALID_OPERATION`, if the global transaction is not owned by the calling
+ *          thread or a zyan status code.
+ */
+static ZyanStatus ZyrexCheckTransactionThread(void)
+{
+    ZyanThreadId tid;
+    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
+
+    if (ZyrexAtomicLoad(&g_transaction_data.transaction_thread_id) != (ZyanUPointer)tid)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief   Ends the global transaction.
+ *
+ * @param   action  The action of the operations whose trampolines are released.
+ * @param   count   The number of operations to release the trampolines for.
+ */
+static void ZyrexEndGlobalTransaction(ZyrexOperationAction action, ZyanUSize count)
+{
+    if (g_transaction_data.is_patching)
+    {
+        ZyrexPatchPhaseEnd();
+        g_transaction_data.is_patching = ZYAN_FALSE;
+
+        // The first `count` operations were applied, if the transaction was committed
+        ZyrexRegisterOperations(&g_transaction_data.transaction.pending_operations,
+            (action == ZYREX_OPERATION_ACTION_REMOVE) ? count : 0);
+    }
+
+    ZyrexFreeTrampolines(&g_transaction_data.transaction.pending_operations, count, action);
+    ZyrexTransactionFinalize(&g_transaction_data.transaction);
+
+    ZyrexAtomicStore(&g_transaction_data.transaction_thread_id, 0);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transaction objects                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexTransactionApplyMultiple(ZyrexTransaction* const* transactions, ZyanUSize count,
+    ZyrexApplyResult* results)
+{
+    if (!transactions || !results)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        if (!transactions[i])
+        {
+            return ZYAN_STATUS_INVALID_ARGUMENT;
+        }
+        results[i].status = ZYAN_STATUS_SUCCESS;
+        results[i].failed_operation = ZYAN_NULL;
+        results[i].applied_count = 0;
+    }
+
+    // The registry can not be extended while threads are suspended, and an applied operation can
+    // not be reverted anymore
+    ZYAN_CHECK(ZyrexReserveRegistry(transactions, count));
+    ZyanStatus status = ZyrexPatchPhaseBegin(transactions, count);
+    if (!ZYAN_SUCCESS(status))
+    {
+        for (ZyanUSize i = 0; i < count; ++i)
+        {
+            ZyrexRegisterOperations(&transactions[i]->pending_operations, 0);
+        }
+        return status;
+    }
+
+    // The threads of all transactions are suspended at once
+    status = ZyrexPatchPhaseSuspendThreads(transactions, count);
+    for (ZyanUSize i = 0; ZYAN_SUCCESS(status) && (i < count); ++i)
+    {
+        results[i].status = ZyrexPatchPhaseCommitTransaction(transactions, count, i,
+            &results[i].failed_operation, &results[i].applied_count);
+    }
+
+    ZyrexPatchPhaseEnd();
+
+    for (ZyanUSize i = 0; i < count; ++i)
+    {
+        // The transactions are left untouched, if the threads could not be suspended
+        results[i].status = ZyrexTransactionFinish(transactions[i], results[i].applied_count,
+            ZYAN_SUCCESS(status) ? results[i].status : status);
+    }
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Configuration                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexSetPatchMode(ZyrexPatchMode mode)
+{
+    switch (mode)
+    {
+    case ZYREX_PATCH_MODE_SUSPEND:
+        break;
+    case ZYREX_PATCH_MODE_BREAKPOINT:
+#if !defined(ZYAN_WINDOWS) && !defined(ZYAN_LINUX)
+        return ZYAN_STATUS_INVALID_OPERATION;
+#endif
+        break;
+    default:
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (ZyrexAtomicLoad(&g_transaction_data.transaction_thread_id) != 0)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    // Waits for the patch phase of concurrent transactions to complete
+    ZyrexPatchLockAcquire();
+    g_transaction_data.patch_mode = mode;
+    ZyrexPatchLockRelease();
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexSetPauseBudget(ZyanU64 budget)
+{
+    if (ZyrexAtomicLoad(&g_transaction_data.transaction_thread_id) != 0)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    ZyrexPatchLockAcquire();
+    g_transaction_data.pause_budget = budget;
+    ZyrexPatchLockRelease();
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexSetStackCheck(ZyanBool enable, ZyanU32 retry_count, ZyanU32 retry_delay)
+{
+    if (ZyrexAtomicLoad(&g_transaction_data.transaction_thread_id) != 0)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    // The bounds of the retired functions are taken from the function index
+    if (enable)
+    {
+        ZYAN_CHECK(ZyrexFunctionIndexInit());
+    }
+
+    ZyrexPatchLockAcquire();
+    g_transaction_data.is_stack_check_enabled = enable;
+    g_transaction_data.stack_check_retries = retry_count;
+    g_transaction_data.stack_check_delay = retry_delay;
+    ZyrexPatchLockRelease();
+
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexSetCodeWriterBackend(ZyrexCodeWriterBackend backend)
+{
+    if (ZyrexAtomicLoad(&g_transaction_data.transaction_thread_id) != 0)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    // Waits for the patch phase of concurrent transactions to complete
+    ZyrexPatchLockAcquire();
+    const ZyanStatus status = ZyrexCodeWriterSetBackend(backend);
+    ZyrexPatchLockRelease();
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transaction                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexTransactionBegin(void)
+{
+    ZyanThreadId tid;
+    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
+
+    if (ZyrexAtomicCompareExchange(&g_transaction_data.transaction_thread_id, 0,
+        (ZyanUPointer)tid) != 0)
+    {
+        return ZYAN_STATUS_INVALID_OPERATION;
+    }
+
+    const ZyanStatus status = ZyrexTransactionInit(&g_transaction_data.transaction);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZyrexAtomicStore(&g_transaction_data.transaction_thread_id, 0);
+        return status;
     }
 
-    if (!CloseHandle(h_snapshot))
-    {
-        return ZYAN_STATUS_BAD_SYSTEMCALL;
-    }
+    return ZYAN_STATUS_SUCCESS;
+}
+
+ZyanStatus ZyrexUpdateThread(ZyanThreadId thread_id)
+{
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
+
+    // The thread is suspended by the commit, after the trampolines of all hooks were allocated
+    return ZyanVectorPushBack(&g_transaction_data.transaction.thread_ids, &thread_id);
+}
 
-#endif
+ZyanStatus ZyrexUpdateAllThreads(void)
+{
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
+
+    g_transaction_data.transaction.update_all_threads = ZYAN_TRUE;
 
     return ZYAN_STATUS_SUCCESS;
 }
@@ -371,160 +3237,144 @@ ZyanStatus ZyrexTransactionCommit(void)
 
 ZyanStatus ZyrexTransactionCommitEx(const void** failed_operation)
 {
-    ZYAN_UNUSED(failed_operation);
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
 
-    ZyanThreadId tid;
-    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
+    ZyrexTransaction* const transaction = &g_transaction_data.transaction;
 
-    if (g_transaction_data.transaction_thread_id != tid)
+    ZYAN_CHECK(ZyrexReserveRegistry(&transaction, 1));
+    const ZyanStatus begin_status = ZyrexPatchPhaseBegin(&transaction, 1);
+    if (!ZYAN_SUCCESS(begin_status))
     {
-        return ZYAN_STATUS_INVALID_OPERATION;
+        ZyrexRegisterOperations(&transaction->pending_operations, 0);
+        return begin_status;
     }
+    g_transaction_data.is_patching = ZYAN_TRUE;
 
-    ZYAN_ASSERT(g_transaction_data.pending_operations.data);
-#ifdef ZYAN_WINDOWS
-    ZYAN_ASSERT(g_transaction_data.threads_to_update.data);
-#endif
+    ZyanUSize applied_count = 0;
+    ZyanStatus status = ZyrexPatchPhaseSuspendThreads(&transaction, 1);
+    if (ZYAN_SUCCESS(status))
+    {
+        status = ZyrexPatchPhaseCommitTransaction(&transaction, 1, 0, failed_operation,
+            &applied_count);
+    }
 
-    ZyanISize revert_index = (ZyanISize)(-1);
-    ZyanStatus status = ZYAN_STATUS_SUCCESS;
-    for (ZyanISize i = 0; i < (ZyanISize)g_transaction_data.pending_operations.size; ++i)
+    if (!ZYAN_SUCCESS(status) && !applied_count)
     {
-        const ZyrexOperation* item = ZyanVectorGet(&g_transaction_data.pending_operations, i);
-        ZYAN_ASSERT(item);
+        // No operation was applied. The transaction is aborted as a whole
+        ZyrexEndGlobalTransaction(ZYREX_OPERATION_ACTION_ATTACH,
+            g_transaction_data.transaction.pending_operations.size);
+        return status;
+    }
 
-        switch (item->type)
-        {
-        case ZYREX_HOOK_TYPE_INLINE:
-            switch (item->action)
-            {
-            case ZYREX_OPERATION_ACTION_ATTACH:
-            {
-#ifdef ZYAN_WINDOWS
+    ZyrexEndGlobalTransaction(ZYREX_OPERATION_ACTION_REMOVE, applied_count);
 
-                for (ZyanISize j = 0; j < (ZyanISize)g_transaction_data.threads_to_update.size;
-                    ++j)
-                {
-                    const HANDLE* const thread_handle =
-                        (const HANDLE*)ZyanVectorGet(&g_transaction_data.threads_to_update, j);
-                    ZYAN_ASSERT(thread_handle);
-
-                    // TODO: Handle status code
-                    ZyrexMigrateThread(*thread_handle, item->address,
-                        item->trampoline->original_code_size, &item->trampoline->code_buffer,
-                        item->trampoline->code_buffer_size, &item->trampoline->translation_map,
-                        ZYREX_THREAD_MIGRATION_DIRECTION_SRC_DST);
-                }
+    return status;
+}
 
-#endif
+ZyanStatus ZyrexTransactionAbort(void)
+{
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
 
-                // TODO: Check if code has changed between this call and the Attach*
-                status = ZyrexWriteHookJump(item->address, item->trampoline);
-                break;
-            }
-            case ZYREX_OPERATION_ACTION_REMOVE:
-            {
-#ifdef ZYAN_WINDOWS
+    ZyrexEndGlobalTransaction(ZYREX_OPERATION_ACTION_ATTACH,
+        g_transaction_data.transaction.pending_operations.size);
 
-                for (ZyanISize j = 0; j < (ZyanISize)g_transaction_data.threads_to_update.size;
-                    ++j)
-                {
-                    const HANDLE* const thread_handle =
-                        (const HANDLE*)ZyanVectorGet(&g_transaction_data.threads_to_update, j);
-                    ZYAN_ASSERT(thread_handle);
-
-                    // TODO: Handle status code
-                    ZyrexMigrateThread(*thread_handle, &item->trampoline->code_buffer,
-                        item->trampoline->code_buffer_size, item->address,
-                        item->trampoline->original_code_size, &item->trampoline->translation_map,
-                        ZYREX_THREAD_MIGRATION_DIRECTION_DST_SRC);
-                }
+    return ZYAN_STATUS_SUCCESS;
+}
 
-#endif
+ZyanStatus ZyrexGetTransactionStatistics(ZyrexTransactionStatistics* statistics)
+{
+    if (!statistics)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
 
-                status = ZyrexRestoreInstructions(item->address, item->trampoline);
-                if (ZYAN_SUCCESS(status))
-                {
-                    status = ZyrexTrampolineFree(item->trampoline);
-                    if (status == ZYAN_STATUS_FALSE)
-                    {
-                        status = ZYAN_STATUS_NOT_FOUND;
-                    }
-                }
-                break;
-            }
-            default:
-                ZYAN_UNREACHABLE;
-            }
-            break;
-        case ZYREX_HOOK_TYPE_EXCEPTION:
-            break;
-        case ZYREX_HOOK_TYPE_CONTEXT:
-            break;
-        default:
-            ZYAN_UNREACHABLE;
-        }
+    *statistics = g_transaction_data.statistics;
 
-        if (!ZYAN_SUCCESS(status))
-        {
-            revert_index = i - 1;
-            break;
-        }
+    return ZYAN_STATUS_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transaction objects                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexTransactionCreate(ZyrexTransaction** transaction)
+{
+    if (!transaction)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    if (revert_index >= 0)
+    // TODO: Replace with ZyanMemoryAlloc in the future
+    ZyrexTransaction* const data = ZYAN_MALLOC(sizeof(ZyrexTransaction));
+    if (!data)
     {
-        // TODO: Revert changes
+        return ZYAN_STATUS_NOT_ENOUGH_MEMORY;
     }
 
-#ifdef ZYAN_WINDOWS
+    const ZyanStatus status = ZyrexTransactionInit(data);
+    if (!ZYAN_SUCCESS(status))
+    {
+        ZYAN_FREE(data);
+        return status;
+    }
 
-    ZyanVectorDestroy(&g_transaction_data.threads_to_update);
+    *transaction = data;
+    return ZYAN_STATUS_SUCCESS;
+}
 
-#endif
+ZyanStatus ZyrexTransactionDestroy(ZyrexTransaction* transaction)
+{
+    if (!transaction)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
 
-    ZyanVectorDestroy(&g_transaction_data.pending_operations);
-    g_transaction_data.transaction_thread_id = 0;
+    ZyrexFreeTrampolines(&transaction->pending_operations,
+        transaction->pending_operations.size, ZYREX_OPERATION_ACTION_ATTACH);
+    ZyrexTransactionFinalize(transaction);
+    ZYAN_FREE(transaction);
 
     return ZYAN_STATUS_SUCCESS;
 }
 
-ZyanStatus ZyrexTransactionAbort(void)
+ZyanStatus ZyrexTransactionUpdateThread(ZyrexTransaction* transaction, ZyanThreadId thread_id)
 {
-    ZyanThreadId tid;
-    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
-
-    if (g_transaction_data.transaction_thread_id != tid)
+    if (!transaction)
     {
-        return ZYAN_STATUS_INVALID_OPERATION;
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    ZYAN_ASSERT(g_transaction_data.pending_operations.data);
-#ifdef ZYAN_WINDOWS
-    ZYAN_ASSERT(g_transaction_data.threads_to_update.data);
-#endif
+    return ZyanVectorPushBack(&transaction->thread_ids, &thread_id);
+}
 
-    ZYAN_VECTOR_FOREACH_MUTABLE(const ZyrexOperation, &g_transaction_data.pending_operations, 
-        operation,
+ZyanStatus ZyrexTransactionUpdateAllThreads(ZyrexTransaction* transaction)
+{
+    if (!transaction)
     {
-        ZyrexTrampolineFree(operation->trampoline);
-    });
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
 
-#ifdef ZYAN_WINDOWS
+    transaction->update_all_threads = ZYAN_TRUE;
 
-    ZYAN_VECTOR_FOREACH(HANDLE, &g_transaction_data.threads_to_update, handle,
-    {
-        ResumeThread(handle);
-    });
+    return ZYAN_STATUS_SUCCESS;
+}
 
-    ZyanVectorDestroy(&g_transaction_data.threads_to_update);
+ZyanStatus ZyrexTransactionApply(ZyrexTransaction* transaction, const void** failed_operation)
+{
+    if (!transaction)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
 
-#endif
+    ZyrexApplyResult result;
+    ZYAN_CHECK(ZyrexTransactionApplyMultiple(&transaction, 1, &result));
 
-    ZyanVectorDestroy(&g_transaction_data.pending_operations);
-    g_transaction_data.transaction_thread_id = 0;
+    if (failed_operation)
+    {
+        *failed_operation = result.failed_operation;
+    }
 
-    return ZYAN_STATUS_SUCCESS;
+    return result.status;
 }
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -534,78 +3384,240 @@ ZyanStatus ZyrexTransactionAbort(void)
 ZyanStatus ZyrexInstallInlineHook(void* address, const void* callback,
     ZyanConstVoidPointer* trampoline)
 {
-    if (!address || !callback || !trampoline)
+    return ZyrexInstallInlineHookEx(address, callback, ZYREX_DEFAULT_PATCH_SIZE, trampoline);
+}
+
+ZyanStatus ZyrexInstallInlineHookEx(void* address, const void* callback,
+    ZyanUSize patch_size, ZyanConstVoidPointer* trampoline)
+{
+    if (!address || !callback || (patch_size < ZYREX_DEFAULT_PATCH_SIZE) || 
+        (patch_size > ZYREX_MAX_PATCH_SIZE) || !trampoline)
     {
         return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    ZyanThreadId tid;
-    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
+
+    return ZyrexTransactionAddInlineHook(&g_transaction_data.transaction, address, callback,
+        patch_size, ZYREX_INLINE_HOOK_FLAG_NONE, trampoline);
+}
 
-    if (g_transaction_data.transaction_thread_id != tid)
+ZyanStatus ZyrexInstallInlineHooks(const ZyrexHookSpec* specs, ZyanUSize count,
+    ZyanStatus* results)
+{
+    if (!specs || !results)
     {
-        return ZYAN_STATUS_INVALID_OPERATION;
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    ZYAN_ASSERT(g_transaction_data.pending_operations.data);
-#ifdef ZYAN_WINDOWS
-    ZYAN_ASSERT(g_transaction_data.threads_to_update.data);
-#endif
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
 
-    ZyrexOperation operation =
+    return ZyrexTransactionAddInlineHooks(&g_transaction_data.transaction, specs, count, results);
+}
+
+ZyanStatus ZyrexTransactionInstallInlineHook(ZyrexTransaction* transaction, void* address,
+    const void* callback, ZyanConstVoidPointer* trampoline)
+{
+    return ZyrexTransactionInstallInlineHookEx(transaction, address, callback,
+        ZYREX_DEFAULT_PATCH_SIZE, trampoline);
+}
+
+ZyanStatus ZyrexTransactionInstallInlineHookEx(ZyrexTransaction* transaction, void* address,
+    const void* callback, ZyanUSize patch_size, ZyanConstVoidPointer* trampoline)
+{
+    if (!transaction || !address || !callback || (patch_size < ZYREX_DEFAULT_PATCH_SIZE) ||
+        (patch_size > ZYREX_MAX_PATCH_SIZE) || !trampoline)
     {
-        /* type                */ ZYREX_HOOK_TYPE_INLINE,
-        /* action              */ ZYREX_OPERATION_ACTION_ATTACH,
-        /* address             */ ZYAN_NULL,
-        /* trampoline          */ ZYAN_NULL
-    };
-    operation.address = address;
-    ZYAN_CHECK(ZyrexTrampolineCreate(address, callback, ZYREX_SIZEOF_RELATIVE_JUMP,
-        &operation.trampoline));
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
 
-    *trampoline = &operation.trampoline->code_buffer;
+    return ZyrexTransactionAddInlineHook(transaction, address, callback, patch_size,
+        ZYREX_INLINE_HOOK_FLAG_NONE, trampoline);
+}
+
+ZyanStatus ZyrexTransactionInstallInlineHooks(ZyrexTransaction* transaction,
+    const ZyrexHookSpec* specs, ZyanUSize count, ZyanStatus* results)
+{
+    if (!transaction || !specs || !results)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return ZyrexTransactionAddInlineHooks(transaction, specs, count, results);
+}
+
+ZyanStatus ZyrexInstallReplacementHook(void* address, const void* replacement,
+    ZyrexReplacementHook** hook)
+{
+    if (!address || !replacement || !hook)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
 
-    return ZyanVectorPushBack(&g_transaction_data.pending_operations, &operation);
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
+
+    return ZyrexTransactionAddReplacementHook(&g_transaction_data.transaction, address,
+        replacement, hook);
+}
+
+ZyanStatus ZyrexTransactionInstallReplacementHook(ZyrexTransaction* transaction, void* address,
+    const void* replacement, ZyrexReplacementHook** hook)
+{
+    if (!transaction || !address || !replacement || !hook)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return ZyrexTransactionAddReplacementHook(transaction, address, replacement, hook);
 }
 
 /* ---------------------------------------------------------------------------------------------- */
-/* Hook installation                                                                              */
+/* Hook removal                                                                                   */
 /* ---------------------------------------------------------------------------------------------- */
 
 ZyanStatus ZyrexRemoveInlineHook(ZyanConstVoidPointer* original)
 {
-    ZyanThreadId tid;
-    ZYAN_CHECK(ZyanThreadGetCurrentThreadId(&tid));
+    if (!original)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
+
+    return ZyrexTransactionAddInlineHookRemoval(&g_transaction_data.transaction, original);
+}
 
-    if (g_transaction_data.transaction_thread_id != tid)
+ZyanStatus ZyrexTransactionRemoveInlineHook(ZyrexTransaction* transaction,
+    ZyanConstVoidPointer* original)
+{
+    if (!transaction || !original)
     {
-        return ZYAN_STATUS_INVALID_OPERATION;
+        return ZYAN_STATUS_INVALID_ARGUMENT;
     }
 
-    ZYAN_ASSERT(g_transaction_data.pending_operations.data);
-#ifdef ZYAN_WINDOWS
-    ZYAN_ASSERT(g_transaction_data.threads_to_update.data);
-#endif
+    return ZyrexTransactionAddInlineHookRemoval(transaction, original);
+}
+
+ZyanStatus ZyrexRemoveReplacementHook(ZyrexReplacementHook* hook)
+{
+    if (!hook)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
+
+    return ZyrexTransactionAddReplacementHookRemoval(&g_transaction_data.transaction, hook);
+}
+
+ZyanStatus ZyrexTransactionRemoveReplacementHook(ZyrexTransaction* transaction,
+    ZyrexReplacementHook* hook)
+{
+    if (!transaction || !hook)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return ZyrexTransactionAddReplacementHookRemoval(transaction, hook);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Call-site hooks                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexInstallCallSiteHook(void* address, const void* callback,
+    ZyanConstVoidPointer* original)
+{
+    if (!address || !callback || !original)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
+
+    return ZyrexTransactionAddCallSiteOperation(&g_transaction_data.transaction,
+        ZYREX_OPERATION_ACTION_ATTACH, address, callback, original);
+}
+
+ZyanStatus ZyrexTransactionInstallCallSiteHook(ZyrexTransaction* transaction, void* address,
+    const void* callback, ZyanConstVoidPointer* original)
+{
+    if (!transaction || !address || !callback || !original)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return ZyrexTransactionAddCallSiteOperation(transaction, ZYREX_OPERATION_ACTION_ATTACH,
+        address, callback, original);
+}
+
+ZyanStatus ZyrexRemoveCallSiteHook(void* address, const void* original)
+{
+    if (!address || !original)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZYAN_CHECK(ZyrexCheckTransactionThread());
+
+    return ZyrexTransactionAddCallSiteOperation(&g_transaction_data.transaction,
+        ZYREX_OPERATION_ACTION_REMOVE, address, original, ZYAN_NULL);
+}
+
+ZyanStatus ZyrexTransactionRemoveCallSiteHook(ZyrexTransaction* transaction, void* address,
+    const void* original)
+{
+    if (!transaction || !address || !original)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    return ZyrexTransactionAddCallSiteOperation(transaction, ZYREX_OPERATION_ACTION_REMOVE,
+        address, original, ZYAN_NULL);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hook control                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+ZyanStatus ZyrexSetInlineHookEnabled(ZyanConstVoidPointer original, ZyanBool enable)
+{
+    if (!original)
+    {
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
 
     ZyrexTrampolineChunk* trampoline;
-    ZYAN_CHECK(ZyrexTrampolineFind(*original, &trampoline));
+    const ZyanStatus status = ZyrexTrampolineFind(original, &trampoline);
+    ZYAN_CHECK(status);
+    if (status == ZYAN_STATUS_FALSE)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
 
-    ZyanVoidPointer const target =
-        (ZyanVoidPointer)(trampoline->backjump_address - trampoline->original_code_size);
+    ZYAN_CHECK(ZyrexDisableDirectCallback(trampoline));
 
-    ZyrexOperation operation =
+    return ZyrexTrampolineSetEnabled(trampoline, enable);
+}
+
+ZyanStatus ZyrexSetInlineHookCallback(ZyanConstVoidPointer original, const void* callback)
+{
+    if (!original || !callback)
     {
-        /* type                */ ZYREX_HOOK_TYPE_INLINE,
-        /* action              */ ZYREX_OPERATION_ACTION_REMOVE,
-        /* address             */ ZYAN_NULL,
-        /* trampoline          */ ZYAN_NULL
-    };
-    operation.address = target;
-    operation.trampoline = trampoline;
+        return ZYAN_STATUS_INVALID_ARGUMENT;
+    }
+
+    ZyrexTrampolineChunk* trampoline;
+    const ZyanStatus status = ZyrexTrampolineFind(original, &trampoline);
+    ZYAN_CHECK(status);
+    if (status == ZYAN_STATUS_FALSE)
+    {
+        return ZYAN_STATUS_NOT_FOUND;
+    }
 
-    *original = target;
+    ZYAN_CHECK(ZyrexDisableDirectCallback(trampoline));
 
-    return ZyanVectorPushBack(&g_transaction_data.pending_operations, &operation);
+    return ZyrexTrampolineSetCallback(trampoline, callback);
 }
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -26,7 +26,13 @@
 
 #include <Zycore/Zycore.h>
 #include <Zydis/Zydis.h>
+#include <Zyrex/HookRegistry.h>
 #include <Zyrex/Zyrex.h>
+#include <Zyrex/Internal/CodeWriter.h>
+#include <Zyrex/Internal/FunctionIndex.h>
+#include <Zyrex/Internal/HookRegistry.h>
+#include <Zyrex/Internal/Patcher.h>
+#include <Zyrex/Internal/ThreadRegistry.h>
 
 /* ============================================================================================== */
 /* Exported functions                                                                             */
@@ -51,13 +57,17 @@ ZyanStatus ZyrexInitialize(void)
         return ZYAN_STATUS_MISSING_DEPENDENCY;     
     }
 
-    return ZYAN_STATUS_SUCCESS;
+    return ZyrexCodeWriterInit();
 }
 
 ZyanStatus ZyrexShutdown(void)
 {
-    // nothing to do here at the moment
-    return ZYAN_STATUS_SUCCESS;
+    ZYAN_CHECK(ZyrexPatcherShutdown());
+    ZYAN_CHECK(ZyrexRemoveAllHooks());
+    ZYAN_CHECK(ZyrexHookRegistryClear());
+    ZYAN_CHECK(ZyrexFunctionIndexClear());
+
+    return ZyrexThreadRegistryClear();
 }
 
 /* ---------------------------------------------------------------------------------------------- */